@@ -10,6 +10,7 @@
 #include "envoy/common/pure.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Filesystem {
@@ -52,6 +53,15 @@ public:
    */
   virtual Api::IoCallSizeResult write(absl::string_view buffer) PURE;
 
+  /**
+   * Write several buffers to the file in order, using as few system calls as possible. The file
+   * must be explicitly opened before writing.
+   *
+   * @return ssize_t number of bytes written, which is less than the total size of the buffers if
+   *         the file could only be written in part, or -1 for failure
+   */
+  virtual Api::IoCallSizeResult writev(absl::Span<const absl::string_view> buffers) PURE;
+
   /**
    * Close the file.
    *
@@ -75,6 +75,31 @@ public:
                                          const Http::ResponseTrailerMap& response_trailers,
                                          const StreamInfo::StreamInfo& stream_info,
                                          absl::string_view local_reply_body) const PURE;
+
+  /**
+   * Append a value extracted from the provided headers/trailers/stream to a string. This is the
+   * same value as format(), and providers override this to avoid the intermediate string.
+   * @param output supplies the string to append the value to.
+   * @param request_headers supplies the request headers.
+   * @param response_headers supplies the response headers.
+   * @param response_trailers supplies the response trailers.
+   * @param stream_info supplies the stream info.
+   * @param local_reply_body supplies the local reply body.
+   * @return bool false if there is no value, in which case nothing is appended.
+   */
+  virtual bool formatTo(std::string& output, const Http::RequestHeaderMap& request_headers,
+                        const Http::ResponseHeaderMap& response_headers,
+                        const Http::ResponseTrailerMap& response_trailers,
+                        const StreamInfo::StreamInfo& stream_info,
+                        absl::string_view local_reply_body) const {
+    const absl::optional<std::string> value =
+        format(request_headers, response_headers, response_trailers, stream_info, local_reply_body);
+    if (!value.has_value()) {
+      return false;
+    }
+    output.append(value.value());
+    return true;
+  }
 };
 
 using FormatterProviderPtr = std::unique_ptr<FormatterProvider>;
@@ -439,6 +439,18 @@ public:
    */
   virtual RetryStatus shouldHedgeRetryPerTryTimeout(DoRetryCallback callback) PURE;
 
+  /**
+   * Determine whether a "hedged" retry should be sent because the request takes longer than the
+   * recent latency of the cluster. As with shouldHedgeRetryPerTryTimeout(), the original request
+   * is not canceled, but the retry is sent without backoff.
+   * @param callback supplies the callback that will be invoked when the retry should take place.
+   *                 The callback will never be called inline.
+   * @return RetryStatus if a retry should take place. @param callback will be called at some point
+   *         in the future. Otherwise a retry should not take place and the callback will never be
+   *         called.
+   */
+  virtual RetryStatus shouldHedgeRetryLatency(DoRetryCallback callback) PURE;
+
   /**
    * Called when a host was attempted but the request failed and is eligible for another retry.
    * Should be used to update whatever internal state depends on previously attempted hosts.
@@ -504,6 +516,12 @@ public:
    * @return true if the trace span should be sampled.
    */
   virtual bool traceSampled() const PURE;
+
+  /**
+   * @return true if the request should be shadowed as it is received instead of once it is
+   *         complete.
+   */
+  virtual bool streamBody() const PURE;
 };
 
 using ShadowPolicyPtr = std::shared_ptr<ShadowPolicy>;
@@ -622,6 +640,19 @@ public:
 /**
  * Route level hedging policy.
  */
+/**
+ * Configuration of latency based hedging.
+ */
+struct LatencyHedgingConfig {
+  // Percentile of the recent response latency of the cluster after which a request is hedged.
+  double latency_percentile_;
+  std::chrono::milliseconds min_delay_;
+  // Number of recent responses of the cluster required before requests are hedged.
+  uint64_t min_samples_;
+  // Maximum number of hedged requests, as a percentage of the recent responses of the cluster.
+  double budget_percent_;
+};
+
 class HedgePolicy {
 public:
   virtual ~HedgePolicy() = default;
@@ -643,6 +674,12 @@ public:
    * will be canceled immediately.
    */
   virtual bool hedgeOnPerTryTimeout() const PURE;
+
+  /**
+   * @return the configuration of latency based hedging, if a hedged request should be sent when
+   * a request takes longer than the recent latency of the cluster.
+   */
+  virtual const absl::optional<LatencyHedgingConfig>& latencyHedging() const PURE;
 };
 
 class MetadataMatchCriterion {
@@ -4,16 +4,42 @@
 #include <memory>
 #include <string>
 
+#include "envoy/buffer/buffer.h"
 #include "envoy/http/async_client.h"
+#include "envoy/http/header_map.h"
 #include "envoy/http/message.h"
 
 namespace Envoy {
 namespace Router {
 
 /**
- * Interface used to shadow complete requests to an alternate upstream cluster in a "fire and
- * forget" fashion. Right now this interface takes a fully buffered request and cannot be used for
- * streaming. This is sufficient for current use cases.
+ * A shadow request whose body is sent as it is received. Destroying the stream before the end of
+ * the request has been sent resets the shadow request. Otherwise the shadow request completes in
+ * the background.
+ */
+class ShadowStream {
+public:
+  virtual ~ShadowStream() = default;
+
+  /**
+   * Send request data to the shadow cluster.
+   * @param data supplies the data to send, which is drained.
+   * @param end_stream supplies whether this is the last data of the request.
+   */
+  virtual void sendData(Buffer::Instance& data, bool end_stream) PURE;
+
+  /**
+   * Send request trailers to the shadow cluster, which ends the request.
+   * @param trailers supplies the trailers to send.
+   */
+  virtual void sendTrailers(const Http::RequestTrailerMap& trailers) PURE;
+};
+
+using ShadowStreamPtr = std::unique_ptr<ShadowStream>;
+
+/**
+ * Interface used to shadow requests to an alternate upstream cluster in a "fire and forget"
+ * fashion, either fully buffered or streamed.
  */
 class ShadowWriter {
 public:
@@ -27,6 +53,18 @@ public:
    */
   virtual void shadow(const std::string& cluster, Http::RequestMessagePtr&& request,
                       const Http::AsyncClient::RequestOptions& options) PURE;
+
+  /**
+   * Start shadowing a request whose body is streamed.
+   * @param cluster supplies the cluster name to shadow to.
+   * @param headers supplies the request headers.
+   * @param options supplies the options of the shadow stream.
+   * @return the stream to send the rest of the request on, or nullptr if the request could not be
+   *         shadowed.
+   */
+  virtual ShadowStreamPtr streamingShadow(const std::string& cluster,
+                                          Http::RequestHeaderMapPtr&& headers,
+                                          const Http::AsyncClient::StreamOptions& options) PURE;
 };
 
 using ShadowWriterPtr = std::unique_ptr<ShadowWriter>;
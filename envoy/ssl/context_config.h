@@ -184,6 +184,12 @@ public:
    * @return True if stateless TLS session resumption is disabled, false otherwise.
    */
   virtual bool disableStatelessSessionResumption() const PURE;
+
+  /**
+   * @return the maximum number of sessions held by the stateful session cache. 0 means that the
+   * internal session cache of the TLS library is used instead.
+   */
+  virtual uint32_t maxStatefulSessions() const PURE;
 };
 
 using ServerContextConfigPtr = std::unique_ptr<ServerContextConfig>;
@@ -559,6 +559,9 @@ public:
   COUNTER(upstream_cx_none_healthy)                                                                \
   COUNTER(upstream_cx_overflow)                                                                    \
   COUNTER(upstream_cx_pool_overflow)                                                               \
+  COUNTER(upstream_cx_preconnect)                                                                  \
+  COUNTER(upstream_cx_preconnect_hit)                                                              \
+  COUNTER(upstream_cx_preconnect_wasted)                                                           \
   COUNTER(upstream_cx_protocol_error)                                                              \
   COUNTER(upstream_cx_rx_bytes_total)                                                              \
   COUNTER(upstream_cx_total)                                                                       \
@@ -571,6 +574,9 @@ public:
   COUNTER(upstream_internal_redirect_succeeded_total)                                              \
   COUNTER(upstream_rq_cancelled)                                                                   \
   COUNTER(upstream_rq_completed)                                                                   \
+  COUNTER(upstream_rq_latency_hedge)                                                               \
+  COUNTER(upstream_rq_latency_hedge_budget_exceeded)                                               \
+  COUNTER(upstream_rq_latency_hedge_won)                                                           \
   COUNTER(upstream_rq_maintenance_mode)                                                            \
   COUNTER(upstream_rq_max_duration_reached)                                                        \
   COUNTER(upstream_rq_pending_failure_eject)                                                       \
@@ -585,6 +591,7 @@ public:
   COUNTER(upstream_rq_retry_overflow)                                                              \
   COUNTER(upstream_rq_retry_success)                                                               \
   COUNTER(upstream_rq_rx_reset)                                                                    \
+  COUNTER(upstream_rq_shared_pool_handoff)                                                         \
   COUNTER(upstream_rq_timeout)                                                                     \
   COUNTER(upstream_rq_total)                                                                       \
   COUNTER(upstream_rq_tx_reset)                                                                    \
@@ -708,6 +715,55 @@ class ClusterTypedMetadataFactory : public Envoy::Config::TypedMetadataFactory {
 
 class TypedLoadBalancerFactory;
 
+/**
+ * Configuration of the adaptive preconnect policy of a cluster.
+ */
+struct AdaptivePreconnectConfig {
+  // Time constant of the moving averages of the stream arrival rate and connection establishment
+  // time.
+  std::chrono::milliseconds decay_time_;
+  // Multiplier applied to the predicted number of streams.
+  double burst_factor_;
+};
+
+/**
+ * Tracks the recent response latency of the requests sent to a cluster, and the hedged requests
+ * sent to it because of that latency. Older samples decay so that the tracked values follow the
+ * recent behavior of the cluster. All methods are thread safe and the values approximate.
+ */
+class ResponseLatencyTracker {
+public:
+  virtual ~ResponseLatencyTracker() = default;
+
+  /**
+   * Records the latency of a response.
+   * @param latency supplies the time between sending the request and receiving the response
+   *        headers.
+   */
+  virtual void recordLatency(std::chrono::microseconds latency) PURE;
+
+  /**
+   * @param percentile supplies the percentile to compute, in [0, 100].
+   * @param min_samples supplies the number of recent samples required to compute the percentile.
+   * @return the latency percentile, or absl::nullopt if there are fewer than min_samples samples.
+   */
+  virtual absl::optional<std::chrono::microseconds> latencyPercentile(double percentile,
+                                                                      uint64_t min_samples) const
+      PURE;
+
+  /**
+   * @param budget_percent supplies the maximum number of hedged requests, as a percentage of the
+   *        recent samples.
+   * @return true if the hedge budget allows another hedged request.
+   */
+  virtual bool hedgeBudgetAvailable(double budget_percent) const PURE;
+
+  /**
+   * Accounts for a hedged request sent to the cluster.
+   */
+  virtual void recordHedge() PURE;
+};
+
 /**
  * Information about a given upstream cluster.
  */
@@ -761,6 +817,11 @@ public:
    */
   virtual float peekaheadRatio() const PURE;
 
+  /**
+   * @return the adaptive preconnect configuration, if adaptive preconnect is enabled.
+   */
+  virtual const absl::optional<AdaptivePreconnectConfig>& adaptivePreconnect() const PURE;
+
   /**
    * @return soft limit on size of the cluster's connections read and write buffers.
    */
@@ -996,6 +1057,17 @@ public:
    */
   virtual bool connectionPoolPerDownstreamConnection() const PURE;
 
+  /**
+   * @return the number of workers owning the HTTP/2 connections to each host, if the HTTP/2
+   *         connection pools of the cluster are shared between workers.
+   */
+  virtual absl::optional<uint32_t> sharedHttp2PoolOwnerWorkers() const PURE;
+
+  /**
+   * @return the tracker of the response latency of the cluster, used by latency based hedging.
+   */
+  virtual ResponseLatencyTracker& responseLatencyTracker() const PURE;
+
   /**
    * @return true if this cluster is configured to ignore hosts for the purpose of load balancing
    * computations until they have been health checked for the first time.
@@ -1,6 +1,9 @@
 #include "source/common/access_log/access_log_manager_impl.h"
 
+#include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/common/exception.h"
 
@@ -34,23 +37,92 @@ AccessLogManagerImpl::createAccessLog(const Filesystem::FilePathAndType& file_in
   if (access_logs_.count(file_name)) {
     return access_logs_[file_name];
   }
+  if (flusher_ == nullptr) {
+    flusher_ = std::make_shared<AccessLogFlusher>(api_.threadFactory());
+  }
   access_logs_[file_name] =
       std::make_shared<AccessLogFileImpl>(std::move(file), dispatcher_, lock_, file_stats_,
-                                          file_flush_interval_msec_, api_.threadFactory());
+                                          file_flush_interval_msec_, flusher_, api_.timeSource());
   return access_logs_[file_name];
 }
 
+AccessLogFlusher::~AccessLogFlusher() {
+  {
+    Thread::LockGuard lock(lock_);
+    ASSERT(pending_files_.empty());
+    exit_ = true;
+    flush_event_.notifyOne();
+  }
+
+  if (flush_thread_ != nullptr) {
+    flush_thread_->join();
+  }
+}
+
+void AccessLogFlusher::requestFlush(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  if (flush_thread_ == nullptr) {
+    flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); },
+                                                 Thread::Options{"AccessLogFlush"});
+  }
+  pending_files_.push_back(&file);
+  flush_event_.notifyOne();
+}
+
+void AccessLogFlusher::removeFile(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  while (flushing_file_ == &file) {
+    flush_done_event_.wait(lock_);
+  }
+  // The file may have queued itself again during its last flush.
+  pending_files_.remove(&file);
+}
+
+void AccessLogFlusher::flushThreadFunc() {
+  while (true) {
+    AccessLogFileImpl* file = nullptr;
+    {
+      Thread::LockGuard lock(lock_);
+      if (flushing_file_ != nullptr) {
+        flushing_file_ = nullptr;
+        flush_done_event_.notifyAll();
+      }
+      while (pending_files_.empty() && !exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        flush_event_.wait(lock_);
+      }
+
+      if (exit_) {
+        return;
+      }
+
+      file = pending_files_.front();
+      pending_files_.pop_front();
+      flushing_file_ = file;
+    }
+
+    // The lock is not held while flushing, so that the files can be written and flushes requested
+    // in the meantime.
+    file->flushFromFlushThread();
+  }
+}
+
 AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                                      Thread::BasicLockable& lock, AccessLogFileStats& stats,
                                      std::chrono::milliseconds flush_interval_msec,
-                                     Thread::ThreadFactory& thread_factory)
+                                     AccessLogFlusherSharedPtr flusher, TimeSource& time_source)
     : file_(std::move(file)), file_lock_(lock),
       flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        recordFlushLatencies();
+        // Until the first write, there is nothing to flush nor any file to reopen.
+        if (started_) {
+          requestFlush();
+        }
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
-      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
+      flusher_(std::move(flusher)), time_source_(time_source),
+      flush_interval_msec_(flush_interval_msec), stats_(stats) {
   flush_timer_->enableTimer(flush_interval_msec_);
   auto open_result = open();
   if (!open_result.return_value_) {
@@ -67,6 +139,14 @@ Filesystem::FlagSet AccessLogFileImpl::defaultFlags() {
   return default_flags;
 }
 
+uint32_t AccessLogFileImpl::writeShardIndex() {
+  // Threads are assigned shards round robin the first time they write to any file, which spreads
+  // the workers over distinct shards as long as there are fewer workers than shards.
+  static std::atomic<uint32_t> next_index{0};
+  thread_local const uint32_t index = next_index++ % NUM_WRITE_SHARDS;
+  return index;
+}
+
 Api::IoCallBoolResult AccessLogFileImpl::open() {
   Api::IoCallBoolResult result = file_->open(defaultFlags());
   return result;
@@ -75,21 +155,13 @@ Api::IoCallBoolResult AccessLogFileImpl::open() {
 void AccessLogFileImpl::reopen() { reopen_file_ = true; }
 
 AccessLogFileImpl::~AccessLogFileImpl() {
-  {
-    Thread::LockGuard lock(write_lock_);
-    flush_thread_exit_ = true;
-    flush_event_.notifyOne();
-  }
-
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
-  }
+  flusher_->removeFile(*this);
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
+  Thread::LockGuard flush_lock(flush_lock_);
+  collectWrites();
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
-    }
+    doWrite(about_to_write_buffer_);
     const Api::IoCallBoolResult result = file_->close();
     ASSERT(result.return_value_, fmt::format("unable to close file '{}': {}", file_->path(),
                                              result.err_->getErrorDetails()));
@@ -97,7 +169,16 @@ AccessLogFileImpl::~AccessLogFileImpl() {
 }
 
 void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
+  const uint64_t length = buffer.length();
+  if (length == 0) {
+    return;
+  }
+
   Buffer::RawSliceVector slices = buffer.getRawSlices();
+  absl::FixedArray<absl::string_view> data(slices.size());
+  for (size_t i = 0; i < slices.size(); ++i) {
+    data[i] = absl::string_view(static_cast<char*>(slices[i].mem_), slices[i].len_);
+  }
 
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different AccessLogFileImpl pointing to the same underlying file. This can happen either via
@@ -107,109 +188,114 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   //            will never block network workers, but does mean that only a single flush thread can
   //            actually flush to disk. In the future it would be nice if we did away with the cross
   //            process lock or had multiple locks.
+  const MonotonicTime start = time_source_.monotonicTime();
   {
     Thread::LockGuard lock(file_lock_);
-    for (const Buffer::RawSlice& slice : slices) {
-      absl::string_view data(static_cast<char*>(slice.mem_), slice.len_);
-      const Api::IoCallSizeResult result = file_->write(data);
-      if (result.ok() && result.return_value_ == static_cast<ssize_t>(slice.len_)) {
-        stats_.write_completed_.inc();
-      } else {
-        // Probably disk full.
-        stats_.write_failed_.inc();
-      }
+    const Api::IoCallSizeResult result = file_->writev(data);
+    if (result.ok() && result.return_value_ == static_cast<ssize_t>(length)) {
+      stats_.write_completed_.inc();
+    } else {
+      // Probably disk full.
+      stats_.write_failed_.inc();
+    }
+  }
+  const auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+      time_source_.monotonicTime() - start);
+  {
+    Thread::LockGuard lock(flush_latencies_lock_);
+    if (flush_latencies_.size() < MAX_FLUSH_LATENCIES) {
+      flush_latencies_.push_back(latency);
     }
   }
 
-  stats_.write_total_buffered_.sub(buffer.length());
-  buffer.drain(buffer.length());
+  stats_.write_total_buffered_.sub(length);
+  buffered_size_ -= length;
+  buffer.drain(length);
 }
 
-void AccessLogFileImpl::flushThreadFunc() {
-
-  while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
-
-    {
-      Thread::LockGuard write_lock(write_lock_);
+void AccessLogFileImpl::recordFlushLatencies() {
+  std::vector<std::chrono::milliseconds> latencies;
+  {
+    Thread::LockGuard lock(flush_latencies_lock_);
+    latencies.swap(flush_latencies_);
+  }
+  for (const std::chrono::milliseconds latency : latencies) {
+    stats_.flush_latency_.recordValue(latency.count());
+  }
+}
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_ && !reopen_file_) {
-        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
-      }
+void AccessLogFileImpl::collectWrites() {
+  for (WriteShard& shard : write_shards_) {
+    Thread::LockGuard lock(shard.lock_);
+    about_to_write_buffer_.move(shard.buffer_);
+  }
+}
 
-      if (flush_thread_exit_) {
-        return;
-      }
+void AccessLogFileImpl::requestFlush() {
+  // Only queue the file once however many threads ask for a flush before it starts.
+  if (!flush_requested_.exchange(true)) {
+    flusher_->requestFlush(*this);
+  }
+}
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
+void AccessLogFileImpl::flushFromFlushThread() {
+  Thread::LockGuard flush_lock(flush_lock_);
+  // Data written from now on needs another flush.
+  flush_requested_ = false;
+  collectWrites();
+
+  // if we failed to reopen before, do it next loop.
+  if (reopen_file_) {
+    if (file_->isOpen()) {
+      const Api::IoCallBoolResult result = file_->close();
+      ASSERT(result.return_value_, fmt::format("unable to close file '{}': {}", file_->path(),
+                                               result.err_->getErrorDetails()));
     }
-
-    // if we failed to reopen before, do it next loop.
-    if (reopen_file_) {
-      if (file_->isOpen()) {
-        const Api::IoCallBoolResult result = file_->close();
-        ASSERT(result.return_value_, fmt::format("unable to close file '{}': {}", file_->path(),
-                                                 result.err_->getErrorDetails()));
-      }
-      const Api::IoCallBoolResult open_result = open();
-      if (!open_result.return_value_) {
-        stats_.reopen_failed_.inc();
-      } else {
-        reopen_file_ = false;
-      }
+    const Api::IoCallBoolResult open_result = open();
+    if (!open_result.return_value_) {
+      stats_.reopen_failed_.inc();
+      // Retry right away, the other files queued in the meantime being flushed first.
+      requestFlush();
+    } else {
+      reopen_file_ = false;
     }
-    // doWrite no matter file isOpen, if not, we can drain buffer
-    doWrite(about_to_write_buffer_);
   }
+  // doWrite no matter file isOpen, if not, we can drain buffer
+  doWrite(about_to_write_buffer_);
 }
 
 void AccessLogFileImpl::flush() {
-  std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
-
-  {
-    Thread::LockGuard write_lock(write_lock_);
-
-    // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
-    // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
-    // but has not yet completed doWrite(). This would allow flush() to
-    // return before the pending data has actually been written to disk.
-    flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
-  }
-
+  // flush_lock_ must be held while collecting the writes or else it is possible that the flush
+  // thread has already moved data from the write shards to about_to_write_buffer_ but has not yet
+  // completed doWrite(). This would allow flush() to return before the pending data has actually
+  // been written to disk.
+  Thread::LockGuard flush_lock(flush_lock_);
+  collectWrites();
   doWrite(about_to_write_buffer_);
 }
 
 void AccessLogFileImpl::write(absl::string_view data) {
-  Thread::LockGuard lock(write_lock_);
-
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  // Drop the data rather than buffering it without bound when the disk can not keep up. The
+  // writing threads are usually workers, which must never block on the disk.
+  if (buffered_size_ + data.length() > MAX_BUFFERED_SIZE) {
+    stats_.write_dropped_.inc();
+    return;
   }
 
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+  const uint64_t buffered_size = buffered_size_ += data.length();
+  {
+    WriteShard& shard = write_shards_[writeShardIndex()];
+    Thread::LockGuard lock(shard.lock_);
+    shard.buffer_.add(data.data(), data.size());
   }
-}
 
-void AccessLogFileImpl::createFlushStructures() {
-  flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); },
-                                               Thread::Options{"AccessLogFlush"});
+  // The first write to a file is flushed right away, later ones on timer or once enough data
+  // accumulates.
+  if (!started_.exchange(true) || buffered_size > MIN_FLUSH_SIZE) {
+    requestFlush();
+  }
 }
 
 } // namespace AccessLog
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/api.h"
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/filesystem/filesystem.h"
 #include "envoy/stats/stats_macros.h"
@@ -17,29 +24,72 @@
 
 namespace Envoy {
 
-#define ACCESS_LOG_FILE_STATS(COUNTER, GAUGE)                                                      \
+#define ACCESS_LOG_FILE_STATS(COUNTER, GAUGE, HISTOGRAM)                                           \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
   COUNTER(write_buffered)                                                                          \
   COUNTER(write_completed)                                                                         \
+  COUNTER(write_dropped)                                                                           \
   COUNTER(write_failed)                                                                            \
-  GAUGE(write_total_buffered, Accumulate)
+  GAUGE(write_total_buffered, Accumulate)                                                          \
+  HISTOGRAM(flush_latency, Milliseconds)
 
 struct AccessLogFileStats {
-  ACCESS_LOG_FILE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ACCESS_LOG_FILE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                        GENERATE_HISTOGRAM_STRUCT)
 };
 
 namespace AccessLog {
 
+class AccessLogFileImpl;
+
+/**
+ * A single thread flushing all the access log files of a process to disk. Files are flushed one
+ * at a time in the order their flushes were requested, so a file being written slowly delays the
+ * other files but never the threads writing to them. The thread is started on the first flush
+ * request.
+ */
+class AccessLogFlusher {
+public:
+  AccessLogFlusher(Thread::ThreadFactory& thread_factory) : thread_factory_(thread_factory) {}
+  ~AccessLogFlusher();
+
+  /**
+   * Queues a flush of a file. Called from any thread.
+   */
+  void requestFlush(AccessLogFileImpl& file);
+
+  /**
+   * Removes the pending flush of a file and waits for its ongoing flush if any. The file is never
+   * flushed by the flush thread once this returns.
+   */
+  void removeFile(AccessLogFileImpl& file);
+
+private:
+  void flushThreadFunc();
+
+  Thread::ThreadFactory& thread_factory_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar flush_event_;
+  Thread::CondVar flush_done_event_;
+  std::list<AccessLogFileImpl*> pending_files_ ABSL_GUARDED_BY(lock_);
+  AccessLogFileImpl* flushing_file_ ABSL_GUARDED_BY(lock_){};
+  bool exit_ ABSL_GUARDED_BY(lock_){};
+  Thread::ThreadPtr flush_thread_ ABSL_GUARDED_BY(lock_);
+};
+
+using AccessLogFlusherSharedPtr = std::shared_ptr<AccessLogFlusher>;
+
 class AccessLogManagerImpl : public AccessLogManager, Logger::Loggable<Logger::Id::main> {
 public:
   AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
                        Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
                        Stats::Store& stats_store)
       : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
-        lock_(lock), file_stats_{
-                         ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
-                                               POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {}
+        lock_(lock), file_stats_{ACCESS_LOG_FILE_STATS(
+                         POOL_COUNTER_PREFIX(stats_store, "filesystem."),
+                         POOL_GAUGE_PREFIX(stats_store, "filesystem."),
+                         POOL_HISTOGRAM_PREFIX(stats_store, "filesystem."))} {}
   ~AccessLogManagerImpl() override;
 
   // AccessLog::AccessLogManager
@@ -52,22 +102,26 @@ private:
   Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
   AccessLogFileStats file_stats_;
+  // Shared with the files, which may outlive the manager.
+  AccessLogFlusherSharedPtr flusher_;
   absl::node_hash_map<std::string, AccessLogFileSharedPtr> access_logs_;
 };
 
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * Writes are buffered in memory and written to disk by the flush thread of an AccessLogFlusher,
+ * which is shared by all the files of the process. Each thread appends to one of several write
+ * shards, so that worker threads logging to the same file seldom contend on a lock. A flush
+ * writes the data of all the shards with a single vectored write. Writes are dropped rather than
+ * blocking the writing thread when the disk can not keep up.
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
   AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
                     std::chrono::milliseconds flush_interval_msec,
-                    Thread::ThreadFactory& thread_factory);
+                    AccessLogFlusherSharedPtr flusher, TimeSource& time_source);
   ~AccessLogFileImpl() override;
 
   // AccessLog::AccessLogFile
@@ -81,24 +135,44 @@ public:
   void reopen() override;
   void flush() override;
 
+  // Maximum size of the data waiting to be written, beyond which writes are dropped.
+  static constexpr uint64_t MAX_BUFFERED_SIZE = 1024 * 1024 * 16;
+
 private:
+  friend class AccessLogFlusher;
+
+  // The buffered writes of a subset of the threads. A thread always writes to the same shard.
+  struct WriteShard {
+    Thread::MutexBasicLockable lock_;
+    Buffer::OwnedImpl buffer_ ABSL_GUARDED_BY(lock_);
+  };
+
   void doWrite(Buffer::Instance& buffer);
-  void flushThreadFunc();
+  // Called by the flush thread of flusher_.
+  void flushFromFlushThread();
+  void requestFlush();
+  // Moves the data of all the shards to about_to_write_buffer_. Requires flush_lock_.
+  void collectWrites();
+  // Records the latencies of the flushes made since the last call into stats_. Main thread only.
+  void recordFlushLatencies();
   Api::IoCallBoolResult open();
-  void createFlushStructures();
 
   // return default flags set which used by open
   static Filesystem::FlagSet defaultFlags();
+  // return the index of the write shard of the calling thread
+  static uint32_t writeShardIndex();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  static constexpr uint32_t NUM_WRITE_SHARDS = 32;
+  // Maximum number of flush latencies kept between two flush timer events.
+  static constexpr size_t MAX_FLUSH_LATENCIES = 1024;
 
   Filesystem::FilePtr file_;
 
   // These locks are always acquired in the following order if multiple locks are held:
-  //    1) write_lock_
-  //    2) flush_lock_
-  //    3) file_lock_
+  //    1) flush_lock_
+  //    2) the lock_ of a write shard, or file_lock_
   Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
                                           // to disk. This is used to make sure that file blocks do
                                           // not get interleaved by multiple processes writing to
@@ -108,28 +182,27 @@ private:
                                           // concurrent access to the about_to_write_buffer_, fd_,
                                           // and all other data used during flushing and file
                                           // re-opening.
-  Thread::MutexBasicLockable
-      write_lock_; // The lock is used when filling the flush buffer. It allows
-                   // multiple threads to write to the same file at relatively
-                   // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
-  Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
+  std::array<WriteShard, NUM_WRITE_SHARDS> write_shards_; // Filled by the writing threads, and
+                                                          // emptied by flushes in index order.
+  std::atomic<uint64_t> buffered_size_{}; // The size of the data written but not flushed yet.
+  std::atomic<bool> flush_requested_{};   // Set while the file is queued in flusher_.
+  std::atomic<bool> started_{};           // Set by the first write, which is flushed right away.
   std::atomic<bool> reopen_file_{};
-  Buffer::OwnedImpl
-      flush_buffer_ ABSL_GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It
-                                                  // gets filled and then flushed either when max
-                                                  // size is reached or when a timer fires.
   // TODO(jmarantz): this should be ABSL_GUARDED_BY(flush_lock_) but the analysis cannot poke
   // through the std::make_unique assignment. I do not believe it's possible to annotate this
   // properly now due to limitations in the clang thread annotation analysis.
-  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
-                                            // continue to fill. This buffer is then used for the
-                                            // final write to disk.
+  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only while flushing. Data
+                                            // is moved from the write shards under their locks,
+                                            // and then the locks are released so that the shards
+                                            // can continue to fill. This buffer is then used for
+                                            // the final write to disk.
+  // Histograms can only be recorded on threads registered with the stats store, so the flush
+  // thread keeps the flush latencies here until the next flush timer event.
+  Thread::MutexBasicLockable flush_latencies_lock_;
+  std::vector<std::chrono::milliseconds> flush_latencies_ ABSL_GUARDED_BY(flush_latencies_lock_);
   Event::TimerPtr flush_timer_;
-  Thread::ThreadFactory& thread_factory_;
+  const AccessLogFlusherSharedPtr flusher_;
+  TimeSource& time_source_;
   const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
                                                         // matter if it reached the MIN_FLUSH_SIZE
                                                         // or not.
@@ -1,5 +1,7 @@
 #include "source/common/conn_pool/conn_pool_base.h"
 
+#include <cmath>
+
 #include "source/common/common/assert.h"
 #include "source/common/common/debug_recursion_checker.h"
 #include "source/common/network/transport_socket_options_impl.h"
@@ -26,7 +28,12 @@ ConnPoolImplBase::ConnPoolImplBase(
     Upstream::ClusterConnectivityState& state)
     : state_(state), host_(host), priority_(priority), dispatcher_(dispatcher),
       socket_options_(options), transport_socket_options_(transport_socket_options),
-      upstream_ready_cb_(dispatcher_.createSchedulableCallback([this]() { onUpstreamReady(); })) {}
+      upstream_ready_cb_(dispatcher_.createSchedulableCallback([this]() { onUpstreamReady(); })) {
+  const auto& adaptive_preconnect = host_->cluster().adaptivePreconnect();
+  if (adaptive_preconnect.has_value()) {
+    demand_estimator_.emplace(adaptive_preconnect.value());
+  }
+}
 
 ConnPoolImplBase::~ConnPoolImplBase() {
   ASSERT(isIdleImpl());
@@ -98,7 +105,8 @@ bool ConnPoolImplBase::shouldCreateNewConnection(float global_preconnect_ratio)
     // new streams are established or torn down and simply attempts to maintain
     // the correct ratio of streams and anticipated capacity.
     return shouldConnect(pending_streams_.size(), num_active_streams_, connecting_stream_capacity_,
-                         perUpstreamPreconnectRatio());
+                         perUpstreamPreconnectRatio()) ||
+           adaptivePreconnectNeeded();
   }
 }
 
@@ -106,6 +114,26 @@ float ConnPoolImplBase::perUpstreamPreconnectRatio() const {
   return host_->cluster().perUpstreamPreconnectRatio();
 }
 
+bool ConnPoolImplBase::adaptivePreconnectNeeded() const {
+  // As for the other preconnect policies, pools without traffic are not preconnected.
+  if (!demand_estimator_.has_value() || (pending_streams_.empty() && num_active_streams_ == 0)) {
+    return false;
+  }
+  const uint64_t predicted_streams =
+      demand_estimator_->predictedStreams(dispatcher_.timeSource().monotonicTime());
+  // The spare capacity is what is left for new streams once pending streams are served. Ready
+  // clients are only summed up to the predicted demand, so that this stays cheap with many idle
+  // connections.
+  uint64_t spare_capacity = connecting_stream_capacity_ > pending_streams_.size()
+                                ? connecting_stream_capacity_ - pending_streams_.size()
+                                : 0;
+  for (auto it = ready_clients_.begin();
+       it != ready_clients_.end() && spare_capacity < predicted_streams; ++it) {
+    spare_capacity += std::max<int64_t>((*it)->currentUnusedCapacity(), 0);
+  }
+  return spare_capacity < predicted_streams;
+}
+
 ConnPoolImplBase::ConnectionResult ConnPoolImplBase::tryCreateNewConnections() {
   ASSERT(!is_draining_for_deletion_);
   ConnPoolImplBase::ConnectionResult result;
@@ -152,6 +180,11 @@ ConnPoolImplBase::tryCreateNewConnection(float global_preconnect_ratio) {
     ASSERT(std::numeric_limits<uint64_t>::max() - connecting_stream_capacity_ >=
            static_cast<uint64_t>(client->currentUnusedCapacity()));
     ASSERT(client->real_host_description_);
+    // A connection which is not needed to serve the pending streams is created ahead of demand.
+    if (pending_streams_.size() <= connecting_stream_capacity_) {
+      client->preconnected_ = true;
+      host_->cluster().stats().upstream_cx_preconnect_.inc();
+    }
     // Increase the connecting capacity to reflect the streams this connection can serve.
     incrConnectingAndConnectedStreamCapacity(client->currentUnusedCapacity(), *client);
     LinkedList::moveIntoList(std::move(client), owningList(client->state()));
@@ -175,6 +208,10 @@ void ConnPoolImplBase::attachStreamToClient(Envoy::ConnectionPool::ActiveClient&
     return;
   }
   ENVOY_CONN_LOG(debug, "creating stream", client);
+  if (client.preconnected_) {
+    client.preconnected_ = false;
+    host_->cluster().stats().upstream_cx_preconnect_hit_.inc();
+  }
 
   // Latch capacity before updating remaining streams.
   uint64_t capacity = client.currentUnusedCapacity();
@@ -247,6 +284,9 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStreamImpl(AttachContext& cont
 
   ASSERT(static_cast<ssize_t>(connecting_stream_capacity_) ==
          connectingCapacity(connecting_clients_)); // O(n) debug check.
+  if (demand_estimator_.has_value()) {
+    demand_estimator_->onStreamArrival(dispatcher_.timeSource().monotonicTime());
+  }
   if (!ready_clients_.empty()) {
     ActiveClient& client = *ready_clients_.front();
     ENVOY_CONN_LOG(debug, "using existing connection", client);
@@ -439,6 +479,10 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
     ENVOY_CONN_LOG(debug, "client disconnected, failure reason: {}", client, failure_reason);
 
     Envoy::Upstream::reportUpstreamCxDestroy(host_, event);
+    if (client.preconnected_) {
+      client.preconnected_ = false;
+      host_->cluster().stats().upstream_cx_preconnect_wasted_.inc();
+    }
     const bool incomplete_stream = client.closingWithIncompleteStream();
     if (incomplete_stream) {
       Envoy::Upstream::reportUpstreamCxDestroyActiveRequest(host_, event);
@@ -515,6 +559,9 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
     ASSERT(connecting_stream_capacity_ >= client.currentUnusedCapacity());
     connecting_stream_capacity_ -= client.currentUnusedCapacity();
     client.has_handshake_completed_ = true;
+    if (demand_estimator_.has_value()) {
+      demand_estimator_->onConnectionEstablished(client.conn_connect_ms_->elapsed());
+    }
     client.conn_connect_ms_->complete();
     client.conn_connect_ms_.reset();
     ASSERT(client.state() == ActiveClient::State::Connecting);
@@ -550,6 +597,41 @@ void ConnPoolImplBase::onConnectionEvent(ActiveClient& client, absl::string_view
   }
 }
 
+PreconnectDemandEstimator::PreconnectDemandEstimator(
+    const Upstream::AdaptivePreconnectConfig& config)
+    : decay_seconds_(std::chrono::duration<double>(config.decay_time_).count()),
+      burst_factor_(config.burst_factor_) {}
+
+void PreconnectDemandEstimator::onStreamArrival(MonotonicTime now) {
+  // Each arrival adds 1 / decay_seconds_ to a rate decaying exponentially over time, which
+  // converges to the number of arrivals per second for a steady arrival rate.
+  arrival_rate_ = arrivalRate(now) + 1.0 / decay_seconds_;
+  last_arrival_ = now;
+}
+
+void PreconnectDemandEstimator::onConnectionEstablished(std::chrono::milliseconds connect_time) {
+  const double sample = std::chrono::duration<double>(connect_time).count();
+  if (connect_seconds_.has_value()) {
+    connect_seconds_ = connect_seconds_.value() + ConnectTimeWeight * (sample - *connect_seconds_);
+  } else {
+    connect_seconds_ = sample;
+  }
+}
+
+double PreconnectDemandEstimator::arrivalRate(MonotonicTime now) const {
+  const double elapsed = std::chrono::duration<double>(now - last_arrival_).count();
+  return arrival_rate_ * std::exp(-elapsed / decay_seconds_);
+}
+
+uint32_t PreconnectDemandEstimator::predictedStreams(MonotonicTime now) const {
+  if (!connect_seconds_.has_value()) {
+    return 0;
+  }
+  const double predicted = std::ceil(arrivalRate(now) * connect_seconds_.value() * burst_factor_);
+  return static_cast<uint32_t>(
+      std::min<double>(predicted, std::numeric_limits<uint32_t>::max()));
+}
+
 PendingStream::PendingStream(ConnPoolImplBase& parent, bool can_send_early_data)
     : parent_(parent), can_send_early_data_(can_send_early_data) {
   parent_.host()->cluster().stats().upstream_rq_pending_total_.inc();
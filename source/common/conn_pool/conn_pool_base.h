@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/common/conn_pool.h"
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection.h"
 #include "envoy/stats/timespan.h"
@@ -11,6 +12,7 @@
 #include "source/common/common/linked_object.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace ConnectionPool {
@@ -128,6 +130,8 @@ public:
   bool timed_out_{false};
   // TODO(danzh) remove this once http codec exposes the handshake state for h3.
   bool has_handshake_completed_{false};
+  // True if this connection was created ahead of demand and has not served a stream yet.
+  bool preconnected_{false};
 
 private:
   State state_{State::Connecting};
@@ -154,6 +158,35 @@ public:
 
 using PendingStreamPtr = std::unique_ptr<PendingStream>;
 
+// Tracks exponentially weighted moving averages of the stream arrival rate and of the connection
+// establishment time of a pool, to predict how many streams will arrive while a new connection is
+// being established.
+class PreconnectDemandEstimator {
+public:
+  explicit PreconnectDemandEstimator(const Upstream::AdaptivePreconnectConfig& config);
+
+  void onStreamArrival(MonotonicTime now);
+  void onConnectionEstablished(std::chrono::milliseconds connect_time);
+
+  // Returns the number of streams (rounded up) predicted to arrive while a connection is being
+  // established, or 0 before the first connection has been established.
+  uint32_t predictedStreams(MonotonicTime now) const;
+
+  // Returns the stream arrival rate in streams per second.
+  double arrivalRate(MonotonicTime now) const;
+
+private:
+  // The weight of a new connection establishment time sample.
+  static constexpr double ConnectTimeWeight = 0.2;
+
+  const double decay_seconds_;
+  const double burst_factor_;
+  // The arrival rate as of last_arrival_.
+  double arrival_rate_{};
+  MonotonicTime last_arrival_;
+  absl::optional<double> connect_seconds_;
+};
+
 using ActiveClientPtr = std::unique_ptr<ActiveClient>;
 
 // Base class that handles stream queueing logic shared between connection pool implementations.
@@ -315,6 +348,10 @@ protected:
 
   float perUpstreamPreconnectRatio() const;
 
+  // Returns true if adaptive preconnect is enabled and the spare capacity of the pool is not enough
+  // to serve the streams predicted to arrive while a new connection is being established.
+  bool adaptivePreconnectNeeded() const;
+
   ConnectionPool::Cancellable*
   addPendingStream(Envoy::ConnectionPool::PendingStreamPtr&& pending_stream) {
     LinkedList::moveIntoList(std::move(pending_stream), pending_streams_);
@@ -372,6 +409,8 @@ private:
 
   Event::SchedulableCallbackPtr upstream_ready_cb_;
   Common::DebugRecursionChecker recursion_checker_;
+  // Set if adaptive preconnect is enabled.
+  absl::optional<PreconnectDemandEstimator> demand_estimator_;
 };
 
 } // namespace ConnectionPool
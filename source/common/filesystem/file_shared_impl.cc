@@ -19,6 +19,21 @@ Api::IoError::IoErrorCode IoFileError::getErrorCode() const {
 
 std::string IoFileError::getErrorDetails() const { return errorDetails(errno_); }
 
+Api::IoCallSizeResult FileSharedImpl::writev(absl::Span<const absl::string_view> buffers) {
+  ssize_t written = 0;
+  for (const absl::string_view buffer : buffers) {
+    Api::IoCallSizeResult result = write(buffer);
+    if (result.return_value_ == -1) {
+      return written > 0 ? resultSuccess(written) : std::move(result);
+    }
+    written += result.return_value_;
+    if (static_cast<size_t>(result.return_value_) != buffer.size()) {
+      break;
+    }
+  }
+  return resultSuccess(written);
+}
+
 bool FileSharedImpl::isOpen() const { return fd_ != INVALID_HANDLE; };
 
 std::string FileSharedImpl::path() const { return filepath_and_type_.path_; };
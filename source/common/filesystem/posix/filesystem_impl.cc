@@ -1,13 +1,17 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <climits>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "envoy/common/exception.h"
 
@@ -47,6 +51,32 @@ Api::IoCallSizeResult FileImplPosix::write(absl::string_view buffer) {
   return rc != -1 ? resultSuccess(rc) : resultFailure(rc, errno);
 };
 
+Api::IoCallSizeResult FileImplPosix::writev(absl::Span<const absl::string_view> buffers) {
+  std::vector<iovec> iov;
+  iov.reserve(std::min<size_t>(buffers.size(), IOV_MAX));
+  ssize_t written = 0;
+  while (!buffers.empty()) {
+    // A single system call takes at most IOV_MAX buffers.
+    const size_t num_buffers = std::min<size_t>(buffers.size(), IOV_MAX);
+    size_t size = 0;
+    iov.clear();
+    for (const absl::string_view buffer : buffers.subspan(0, num_buffers)) {
+      iov.push_back({const_cast<char*>(buffer.data()), buffer.size()});
+      size += buffer.size();
+    }
+    const ssize_t rc = ::writev(fd_, iov.data(), iov.size());
+    if (rc == -1) {
+      return written > 0 ? resultSuccess(written) : resultFailure(rc, errno);
+    }
+    written += rc;
+    if (static_cast<size_t>(rc) != size) {
+      break;
+    }
+    buffers.remove_prefix(num_buffers);
+  }
+  return resultSuccess(written);
+}
+
 Api::IoCallBoolResult FileImplPosix::close() {
   ASSERT(isOpen());
   int rc = ::close(fd_);
@@ -2,9 +2,11 @@
 
 #include <algorithm>
 #include <climits>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <iterator>
 #include <memory>
 #include <regex>
 #include <string>
@@ -28,6 +30,8 @@
 #include "source/common/runtime/runtime_features.h"
 #include "source/common/stream_info/utility.h"
 
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "fmt/format.h"
 
@@ -56,6 +60,165 @@ const std::regex& getSystemTimeFormatNewlinePattern() {
 }
 const std::regex& getNewlinePattern() { CONSTRUCT_ON_FIRST_USE(std::regex, "\n"); }
 
+// Returns the length of the valid UTF-8 sequence at the start of str, or 0 if there is none.
+size_t utf8SequenceLength(absl::string_view str) {
+  const uint8_t lead = str[0];
+  size_t length;
+  uint32_t min_code_point;
+  uint32_t code_point;
+  if (lead >= 0xc0 && lead < 0xe0) {
+    length = 2;
+    min_code_point = 0x80;
+    code_point = lead & 0x1f;
+  } else if (lead >= 0xe0 && lead < 0xf0) {
+    length = 3;
+    min_code_point = 0x800;
+    code_point = lead & 0x0f;
+  } else if (lead >= 0xf0 && lead < 0xf8) {
+    length = 4;
+    min_code_point = 0x10000;
+    code_point = lead & 0x07;
+  } else {
+    return 0;
+  }
+  if (str.size() < length) {
+    return 0;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    const uint8_t c = str[i];
+    if ((c & 0xc0) != 0x80) {
+      return 0;
+    }
+    code_point = (code_point << 6) | (c & 0x3f);
+  }
+  // Reject overlong encodings, surrogates and code points beyond the Unicode range.
+  if (code_point < min_code_point || (code_point >= 0xd800 && code_point < 0xe000) ||
+      code_point > 0x10ffff) {
+    return 0;
+  }
+  return length;
+}
+
+// Appends str as a quoted JSON string. Invalid UTF-8 bytes are replaced with U+FFFD. Like the
+// protobuf JSON printer, '<' and '>' are escaped so that the output can be embedded in HTML.
+void appendJsonString(std::string& output, absl::string_view str) {
+  output.push_back('"');
+  size_t unescaped = 0;
+  size_t i = 0;
+  while (i < str.size()) {
+    const uint8_t c = str[i];
+    if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\' && c != '<' && c != '>') {
+      ++i;
+      continue;
+    }
+    if (c >= 0x80) {
+      const size_t length = utf8SequenceLength(str.substr(i));
+      if (length > 0) {
+        i += length;
+        continue;
+      }
+    }
+    output.append(str.data() + unescaped, i - unescaped);
+    switch (c) {
+    case '"':
+      output.append("\\\"");
+      break;
+    case '\\':
+      output.append("\\\\");
+      break;
+    case '\b':
+      output.append("\\b");
+      break;
+    case '\f':
+      output.append("\\f");
+      break;
+    case '\n':
+      output.append("\\n");
+      break;
+    case '\r':
+      output.append("\\r");
+      break;
+    case '\t':
+      output.append("\\t");
+      break;
+    case '<':
+      output.append("\\u003c");
+      break;
+    case '>':
+      output.append("\\u003e");
+      break;
+    default:
+      if (c < 0x20) {
+        absl::StrAppendFormat(&output, "\\u%04x", c);
+      } else {
+        output.append("\\ufffd");
+      }
+      break;
+    }
+    unescaped = ++i;
+  }
+  output.append(str.data() + unescaped, str.size() - unescaped);
+  output.push_back('"');
+}
+
+// Appends a Value the way the protobuf JSON printer does.
+void appendJsonValue(std::string& output, const ProtobufWkt::Value& value) {
+  switch (value.kind_case()) {
+  case ProtobufWkt::Value::kNumberValue: {
+    const double number = value.number_value();
+    if (std::isnan(number)) {
+      output.append("\"NaN\"");
+    } else if (std::isinf(number)) {
+      output.append(number > 0 ? "\"Infinity\"" : "\"-Infinity\"");
+    } else {
+      // The shortest representation which round trips.
+      fmt::format_to(std::back_inserter(output), "{}", number);
+    }
+    break;
+  }
+  case ProtobufWkt::Value::kStringValue:
+    appendJsonString(output, value.string_value());
+    break;
+  case ProtobufWkt::Value::kBoolValue:
+    output.append(value.bool_value() ? "true" : "false");
+    break;
+  case ProtobufWkt::Value::kStructValue: {
+    // Sorted for the output not to depend on the order of the map.
+    std::vector<const Protobuf::Map<std::string, ProtobufWkt::Value>::value_type*> fields;
+    fields.reserve(value.struct_value().fields().size());
+    for (const auto& field : value.struct_value().fields()) {
+      fields.push_back(&field);
+    }
+    std::sort(fields.begin(), fields.end(),
+              [](const auto* lhs, const auto* rhs) { return lhs->first < rhs->first; });
+    output.push_back('{');
+    for (const auto* field : fields) {
+      if (output.back() != '{') {
+        output.push_back(',');
+      }
+      appendJsonString(output, field->first);
+      output.push_back(':');
+      appendJsonValue(output, field->second);
+    }
+    output.push_back('}');
+    break;
+  }
+  case ProtobufWkt::Value::kListValue:
+    output.push_back('[');
+    for (const auto& element : value.list_value().values()) {
+      if (output.back() != '[') {
+        output.push_back(',');
+      }
+      appendJsonValue(output, element);
+    }
+    output.push_back(']');
+    break;
+  default:
+    output.append("null");
+    break;
+  }
+}
+
 } // namespace
 
 const std::string SubstitutionFormatUtils::DEFAULT_FORMAT =
@@ -129,28 +292,185 @@ std::string FormatterImpl::format(const Http::RequestHeaderMap& request_headers,
                                   const StreamInfo::StreamInfo& stream_info,
                                   absl::string_view local_reply_body) const {
   std::string log_line;
-  log_line.reserve(256);
+  log_line.reserve(size_hint_.load(std::memory_order_relaxed));
 
   for (const FormatterProviderPtr& provider : providers_) {
-    const auto bit = provider->format(request_headers, response_headers, response_trailers,
-                                      stream_info, local_reply_body);
-    log_line += bit.value_or(empty_value_string_);
+    if (!provider->formatTo(log_line, request_headers, response_headers, response_trailers,
+                            stream_info, local_reply_body)) {
+      log_line += empty_value_string_;
+    }
   }
 
+  size_hint_.store(log_line.size(), std::memory_order_relaxed);
   return log_line;
 }
 
+JsonFormatterImpl::JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping,
+                                     bool preserve_types, bool omit_empty_values)
+    : JsonFormatterImpl(format_mapping, preserve_types, omit_empty_values, {}) {}
+
+JsonFormatterImpl::JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping,
+                                     bool preserve_types, bool omit_empty_values,
+                                     const std::vector<CommandParserPtr>& commands)
+    : omit_empty_values_(omit_empty_values), preserve_types_(preserve_types),
+      empty_value_(omit_empty_values_ ? EMPTY_STRING : DefaultUnspecifiedValueString) {
+  compileStruct(format_mapping, EMPTY_STRING, commands);
+}
+
+void JsonFormatterImpl::compileStruct(const ProtobufWkt::Struct& struct_format, std::string key,
+                                      const std::vector<CommandParserPtr>& commands) {
+  ops_.push_back({OpType::BeginObject, std::move(key), {}});
+  // Same order as the std::map of StructFormatter.
+  std::vector<const std::string*> keys;
+  keys.reserve(struct_format.fields().size());
+  for (const auto& pair : struct_format.fields()) {
+    keys.push_back(&pair.first);
+  }
+  std::sort(keys.begin(), keys.end(),
+            [](const std::string* lhs, const std::string* rhs) { return *lhs < *rhs; });
+  for (const std::string* name : keys) {
+    std::string member_key;
+    appendJsonString(member_key, *name);
+    member_key.push_back(':');
+    compileValue(struct_format.fields().at(*name), std::move(member_key), commands);
+  }
+  ops_.push_back({OpType::EndObject, EMPTY_STRING, {}});
+}
+
+void JsonFormatterImpl::compileList(const ProtobufWkt::ListValue& list_format, std::string key,
+                                    const std::vector<CommandParserPtr>& commands) {
+  ops_.push_back({OpType::BeginList, std::move(key), {}});
+  for (const auto& value : list_format.values()) {
+    compileValue(value, EMPTY_STRING, commands);
+  }
+  ops_.push_back({OpType::EndList, EMPTY_STRING, {}});
+}
+
+void JsonFormatterImpl::compileValue(const ProtobufWkt::Value& value_format, std::string key,
+                                     const std::vector<CommandParserPtr>& commands) {
+  switch (value_format.kind_case()) {
+  case ProtobufWkt::Value::kStringValue:
+    ops_.push_back({OpType::Value, std::move(key),
+                    SubstitutionFormatParser::parse(value_format.string_value(), commands)});
+    break;
+
+  case ProtobufWkt::Value::kStructValue:
+    compileStruct(value_format.struct_value(), std::move(key), commands);
+    break;
+
+  case ProtobufWkt::Value::kListValue:
+    compileList(value_format.list_value(), std::move(key), commands);
+    break;
+
+  default:
+    throw EnvoyException("Only string values, nested structs and list values are "
+                         "supported in structured access log format.");
+  }
+}
+
+bool JsonFormatterImpl::writeValue(const Op& op, std::string& output, std::string& scratch,
+                                   const Http::RequestHeaderMap& request_headers,
+                                   const Http::ResponseHeaderMap& response_headers,
+                                   const Http::ResponseTrailerMap& response_trailers,
+                                   const StreamInfo::StreamInfo& stream_info,
+                                   absl::string_view local_reply_body) const {
+  ASSERT(!op.providers_.empty());
+  scratch.clear();
+  if (op.providers_.size() == 1) {
+    const auto& provider = op.providers_.front();
+    if (preserve_types_) {
+      const ProtobufWkt::Value value = provider->formatValue(
+          request_headers, response_headers, response_trailers, stream_info, local_reply_body);
+      if (omit_empty_values_ && value.kind_case() == ProtobufWkt::Value::kNullValue) {
+        return false;
+      }
+      appendJsonValue(output, value);
+      return true;
+    }
+
+    if (!provider->formatTo(scratch, request_headers, response_headers, response_trailers,
+                            stream_info, local_reply_body)) {
+      if (omit_empty_values_) {
+        return false;
+      }
+      scratch = DefaultUnspecifiedValueString;
+    }
+    appendJsonString(output, scratch);
+    return true;
+  }
+  // Multiple providers forces string output.
+  for (const auto& provider : op.providers_) {
+    if (!provider->formatTo(scratch, request_headers, response_headers, response_trailers,
+                            stream_info, local_reply_body)) {
+      scratch += empty_value_;
+    }
+  }
+  appendJsonString(output, scratch);
+  return true;
+}
+
 std::string JsonFormatterImpl::format(const Http::RequestHeaderMap& request_headers,
                                       const Http::ResponseHeaderMap& response_headers,
                                       const Http::ResponseTrailerMap& response_trailers,
                                       const StreamInfo::StreamInfo& stream_info,
                                       absl::string_view local_reply_body) const {
-  const ProtobufWkt::Struct output_struct = struct_formatter_.format(
-      request_headers, response_headers, response_trailers, stream_info, local_reply_body);
+  std::string log_line;
+  log_line.reserve(size_hint_.load(std::memory_order_relaxed));
+  // The values are formatted here before being escaped into the log line.
+  std::string scratch;
+  // For each open object or list, whether a member or element has been written to it.
+  absl::InlinedVector<bool, 8> has_elements;
+
+  // Writes the separator and the key of a new member or element.
+  const auto begin_element = [&](const Op& op) {
+    if (!has_elements.empty()) {
+      if (has_elements.back()) {
+        log_line.push_back(',');
+      }
+      has_elements.back() = true;
+    }
+    log_line.append(op.key_);
+  };
 
-  const std::string log_line =
-      MessageUtil::getJsonStringFromMessageOrDie(output_struct, false, true);
-  return absl::StrCat(log_line, "\n");
+  for (const Op& op : ops_) {
+    switch (op.type_) {
+    case OpType::BeginObject:
+      begin_element(op);
+      log_line.push_back('{');
+      has_elements.push_back(false);
+      break;
+    case OpType::BeginList:
+      begin_element(op);
+      log_line.push_back('[');
+      has_elements.push_back(false);
+      break;
+    case OpType::EndObject:
+      log_line.push_back('}');
+      has_elements.pop_back();
+      break;
+    case OpType::EndList:
+      log_line.push_back(']');
+      has_elements.pop_back();
+      break;
+    case OpType::Value: {
+      // Omitted values are rolled back along with their separator and key.
+      const size_t size = log_line.size();
+      const bool had_elements = has_elements.back();
+      begin_element(op);
+      if (!writeValue(op, log_line, scratch, request_headers, response_headers, response_trailers,
+                      stream_info, local_reply_body)) {
+        log_line.resize(size);
+        has_elements.back() = had_elements;
+      }
+      break;
+    }
+    }
+  }
+  ASSERT(has_elements.empty());
+
+  log_line.push_back('\n');
+  size_hint_.store(log_line.size(), std::memory_order_relaxed);
+  return log_line;
 }
 
 StructFormatter::StructFormatter(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
@@ -1544,6 +1864,14 @@ ProtobufWkt::Value PlainStringFormatter::formatValue(const Http::RequestHeaderMa
   return str_;
 }
 
+bool PlainStringFormatter::formatTo(std::string& output, const Http::RequestHeaderMap&,
+                                    const Http::ResponseHeaderMap&,
+                                    const Http::ResponseTrailerMap&,
+                                    const StreamInfo::StreamInfo&, absl::string_view) const {
+  output.append(str_.string_value());
+  return true;
+}
+
 absl::optional<std::string>
 LocalReplyBodyFormatter::format(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                 const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
@@ -1559,6 +1887,15 @@ ProtobufWkt::Value LocalReplyBodyFormatter::formatValue(const Http::RequestHeade
   return ValueUtil::stringValue(std::string(local_reply_body));
 }
 
+bool LocalReplyBodyFormatter::formatTo(std::string& output, const Http::RequestHeaderMap&,
+                                       const Http::ResponseHeaderMap&,
+                                       const Http::ResponseTrailerMap&,
+                                       const StreamInfo::StreamInfo&,
+                                       absl::string_view local_reply_body) const {
+  output.append(local_reply_body);
+  return true;
+}
+
 HeaderFormatter::HeaderFormatter(const std::string& main_header,
                                  const std::string& alternative_header,
                                  absl::optional<size_t> max_length)
@@ -1598,6 +1935,20 @@ ProtobufWkt::Value HeaderFormatter::formatValue(const Http::HeaderMap& headers)
   return ValueUtil::stringValue(val);
 }
 
+bool HeaderFormatter::formatTo(std::string& output, const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* header = findHeader(headers);
+  if (!header) {
+    return false;
+  }
+
+  absl::string_view val = header->value().getStringView();
+  if (max_length_) {
+    val = val.substr(0, max_length_.value());
+  }
+  output.append(val);
+  return true;
+}
+
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
                                                  const std::string& alternative_header,
                                                  absl::optional<size_t> max_length)
@@ -1615,6 +1966,13 @@ ProtobufWkt::Value ResponseHeaderFormatter::formatValue(
   return HeaderFormatter::formatValue(response_headers);
 }
 
+bool ResponseHeaderFormatter::formatTo(std::string& output, const Http::RequestHeaderMap&,
+                                       const Http::ResponseHeaderMap& response_headers,
+                                       const Http::ResponseTrailerMap&,
+                                       const StreamInfo::StreamInfo&, absl::string_view) const {
+  return HeaderFormatter::formatTo(output, response_headers);
+}
+
 RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
                                                const std::string& alternative_header,
                                                absl::optional<size_t> max_length)
@@ -1634,6 +1992,14 @@ RequestHeaderFormatter::formatValue(const Http::RequestHeaderMap& request_header
   return HeaderFormatter::formatValue(request_headers);
 }
 
+bool RequestHeaderFormatter::formatTo(std::string& output,
+                                      const Http::RequestHeaderMap& request_headers,
+                                      const Http::ResponseHeaderMap&,
+                                      const Http::ResponseTrailerMap&,
+                                      const StreamInfo::StreamInfo&, absl::string_view) const {
+  return HeaderFormatter::formatTo(output, request_headers);
+}
+
 ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_header,
                                                    const std::string& alternative_header,
                                                    absl::optional<size_t> max_length)
@@ -1653,6 +2019,13 @@ ResponseTrailerFormatter::formatValue(const Http::RequestHeaderMap&, const Http:
   return HeaderFormatter::formatValue(response_trailers);
 }
 
+bool ResponseTrailerFormatter::formatTo(std::string& output, const Http::RequestHeaderMap&,
+                                        const Http::ResponseHeaderMap&,
+                                        const Http::ResponseTrailerMap& response_trailers,
+                                        const StreamInfo::StreamInfo&, absl::string_view) const {
+  return HeaderFormatter::formatTo(output, response_trailers);
+}
+
 HeadersByteSizeFormatter::HeadersByteSizeFormatter(const HeaderType header_type)
     : header_type_(header_type) {}
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <bitset>
 #include <functional>
 #include <list>
@@ -136,7 +137,7 @@ private:
 };
 
 /**
- * Composite formatter implementation.
+ * Composite formatter implementation. The providers append their values directly to the log line.
  */
 class FormatterImpl : public Formatter {
 public:
@@ -154,6 +155,8 @@ public:
 private:
   const std::string& empty_value_string_;
   std::vector<FormatterProviderPtr> providers_;
+  // The size of the last log line, used to size the next one.
+  mutable std::atomic<size_t> size_hint_{256};
 };
 
 // Helper classes for StructFormatter::StructFormatMapVisitor.
@@ -240,14 +243,17 @@ private:
 
 using StructFormatterPtr = std::unique_ptr<StructFormatter>;
 
+/**
+ * A formatter for JSON log formats. The format is compiled to a flat list of operations, and the
+ * log line is written directly from the values of the providers, without building a Struct. The
+ * output is the JSON serialization of the Struct built by StructFormatter for the same format.
+ */
 class JsonFormatterImpl : public Formatter {
 public:
   JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
-                    bool omit_empty_values)
-      : struct_formatter_(format_mapping, preserve_types, omit_empty_values) {}
+                    bool omit_empty_values);
   JsonFormatterImpl(const ProtobufWkt::Struct& format_mapping, bool preserve_types,
-                    bool omit_empty_values, const std::vector<CommandParserPtr>& commands)
-      : struct_formatter_(format_mapping, preserve_types, omit_empty_values, commands) {}
+                    bool omit_empty_values, const std::vector<CommandParserPtr>& commands);
 
   // Formatter::format
   std::string format(const Http::RequestHeaderMap& request_headers,
@@ -257,7 +263,38 @@ public:
                      absl::string_view local_reply_body) const override;
 
 private:
-  const StructFormatter struct_formatter_;
+  enum class OpType { BeginObject, EndObject, BeginList, EndList, Value };
+  struct Op {
+    OpType type_;
+    // The JSON encoded key and colon of the members of objects, empty for the elements of lists.
+    std::string key_;
+    // The providers of Value operations.
+    std::vector<FormatterProviderPtr> providers_;
+  };
+
+  void compileStruct(const ProtobufWkt::Struct& struct_format, std::string key,
+                     const std::vector<CommandParserPtr>& commands);
+  void compileList(const ProtobufWkt::ListValue& list_format, std::string key,
+                   const std::vector<CommandParserPtr>& commands);
+  void compileValue(const ProtobufWkt::Value& value_format, std::string key,
+                    const std::vector<CommandParserPtr>& commands);
+
+  // Writes the value of a Value operation.
+  // @return false if the value is omitted, in which case the output is left in an unspecified
+  //         state.
+  bool writeValue(const Op& op, std::string& output, std::string& scratch,
+                  const Http::RequestHeaderMap& request_headers,
+                  const Http::ResponseHeaderMap& response_headers,
+                  const Http::ResponseTrailerMap& response_trailers,
+                  const StreamInfo::StreamInfo& stream_info,
+                  absl::string_view local_reply_body) const;
+
+  const bool omit_empty_values_;
+  const bool preserve_types_;
+  const std::string empty_value_;
+  std::vector<Op> ops_;
+  // The size of the last log line, used to size the next one.
+  mutable std::atomic<size_t> size_hint_{256};
 };
 
 /**
@@ -275,6 +312,9 @@ public:
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
+  bool formatTo(std::string& output, const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
+                absl::string_view) const override;
 
 private:
   ProtobufWkt::Value str_;
@@ -294,6 +334,9 @@ public:
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view local_reply_body) const override;
+  bool formatTo(std::string& output, const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
+                absl::string_view local_reply_body) const override;
 };
 
 class HeaderFormatter {
@@ -304,6 +347,7 @@ public:
 protected:
   absl::optional<std::string> format(const Http::HeaderMap& headers) const;
   ProtobufWkt::Value formatValue(const Http::HeaderMap& headers) const;
+  bool formatTo(std::string& output, const Http::HeaderMap& headers) const;
 
 private:
   const Http::HeaderEntry* findHeader(const Http::HeaderMap& headers) const;
@@ -356,6 +400,9 @@ public:
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
+  bool formatTo(std::string& output, const Http::RequestHeaderMap& request_headers,
+                const Http::ResponseHeaderMap&, const Http::ResponseTrailerMap&,
+                const StreamInfo::StreamInfo&, absl::string_view) const override;
 };
 
 /**
@@ -374,6 +421,9 @@ public:
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
+  bool formatTo(std::string& output, const Http::RequestHeaderMap&,
+                const Http::ResponseHeaderMap& response_headers, const Http::ResponseTrailerMap&,
+                const StreamInfo::StreamInfo&, absl::string_view) const override;
 };
 
 /**
@@ -392,6 +442,9 @@ public:
   ProtobufWkt::Value formatValue(const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
                                  const Http::ResponseTrailerMap&, const StreamInfo::StreamInfo&,
                                  absl::string_view) const override;
+  bool formatTo(std::string& output, const Http::RequestHeaderMap&, const Http::ResponseHeaderMap&,
+                const Http::ResponseTrailerMap& response_trailers, const StreamInfo::StreamInfo&,
+                absl::string_view) const override;
 };
 
 /**
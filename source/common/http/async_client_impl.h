@@ -115,8 +115,12 @@ private:
       return additional_request_chance_;
     }
     bool hedgeOnPerTryTimeout() const override { return false; }
+    const absl::optional<Router::LatencyHedgingConfig>& latencyHedging() const override {
+      return latency_hedging_;
+    }
 
     const envoy::type::v3::FractionalPercent additional_request_chance_;
+    const absl::optional<Router::LatencyHedgingConfig> latency_hedging_;
   };
 
   struct NullRateLimitPolicy : public Router::RateLimitPolicy {
@@ -21,12 +21,10 @@ namespace Http {
 namespace {
 REGISTER_FACTORY(SkipActionFactory, Matcher::ActionFactory<Matching::HttpFilterActionContext>);
 
-template <class T> using FilterList = std::list<std::unique_ptr<T>>;
-
 // Shared helper for recording the latest filter used.
 template <class T>
-void recordLatestDataFilter(const typename FilterList<T>::iterator current_filter,
-                            T*& latest_filter, const FilterList<T>& filters) {
+void recordLatestDataFilter(const typename T::Iterator current_filter,
+                            typename T::Element*& latest_filter, T& filters) {
   // If this is the first time we're calling onData, just record the current filter.
   if (latest_filter == nullptr) {
     latest_filter = current_filter->get();
@@ -485,7 +483,7 @@ void FilterManager::addStreamDecoderFilterWorker(StreamDecoderFilterSharedPtr fi
   //     - B
   //     - C
   // The decoder filter chain will iterate through filters A, B, C.
-  LinkedList::moveIntoListBack(std::move(wrapper), decoder_filters_);
+  decoder_filters_.add(std::move(wrapper));
 }
 
 void FilterManager::addStreamEncoderFilterWorker(StreamEncoderFilterSharedPtr filter,
@@ -499,7 +497,8 @@ void FilterManager::addStreamEncoderFilterWorker(StreamEncoderFilterSharedPtr fi
   }
 
   filter->setEncoderFilterCallbacks(*wrapper);
-  // Note: configured encoder filters are prepended to encoder_filters_.
+  // Note: configured encoder filters are appended to encoder_filters_, which is iterated in
+  // reverse.
   // This means that if filters are configured in the following order (assume all three filters are
   // both decoder/encoder filters):
   //   http_filters:
@@ -507,7 +506,7 @@ void FilterManager::addStreamEncoderFilterWorker(StreamEncoderFilterSharedPtr fi
   //     - B
   //     - C
   // The encoder filter chain will iterate through filters C, B, A.
-  LinkedList::moveIntoList(std::move(wrapper), encoder_filters_);
+  encoder_filters_.add(std::move(wrapper));
 }
 
 void FilterManager::addAccessLogHandler(AccessLog::InstanceSharedPtr handler) {
@@ -515,7 +514,7 @@ void FilterManager::addAccessLogHandler(AccessLog::InstanceSharedPtr handler) {
 }
 
 void FilterManager::maybeContinueDecoding(
-    const std::list<ActiveStreamDecoderFilterPtr>::iterator& continue_data_entry) {
+    const StreamDecoderFilters::Iterator& continue_data_entry) {
   if (continue_data_entry != decoder_filters_.end()) {
     // We use the continueDecoding() code since it will correctly handle not calling
     // decodeHeaders() again. Fake setting StopSingleIteration since the continueDecoding() code
@@ -530,9 +529,9 @@ void FilterManager::maybeContinueDecoding(
 void FilterManager::decodeHeaders(ActiveStreamDecoderFilter* filter, RequestHeaderMap& headers,
                                   bool end_stream) {
   // Headers filter iteration should always start with the next filter if available.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry =
+  StreamDecoderFilters::Iterator entry =
       commonDecodePrefix(filter, FilterIterationStartState::AlwaysStartFromNext);
-  std::list<ActiveStreamDecoderFilterPtr>::iterator continue_data_entry = decoder_filters_.end();
+  StreamDecoderFilters::Iterator continue_data_entry = decoder_filters_.end();
 
   for (; entry != decoder_filters_.end(); entry++) {
     (*entry)->maybeEvaluateMatchTreeWithNewData(
@@ -628,7 +627,7 @@ void FilterManager::decodeData(ActiveStreamDecoderFilter* filter, Buffer::Instan
   auto trailers_added_entry = decoder_filters_.end();
   const bool trailers_exists_at_start = filter_manager_callbacks_.requestTrailers().has_value();
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry =
+  StreamDecoderFilters::Iterator entry =
       commonDecodePrefix(filter, filter_iteration_start_state);
 
   for (; entry != decoder_filters_.end(); entry++) {
@@ -768,7 +767,7 @@ void FilterManager::decodeTrailers(ActiveStreamDecoderFilter* filter, RequestTra
   }
 
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry =
+  StreamDecoderFilters::Iterator entry =
       commonDecodePrefix(filter, FilterIterationStartState::CanStartFromCurrent);
 
   for (; entry != decoder_filters_.end(); entry++) {
@@ -809,7 +808,7 @@ void FilterManager::decodeTrailers(ActiveStreamDecoderFilter* filter, RequestTra
 
 void FilterManager::decodeMetadata(ActiveStreamDecoderFilter* filter, MetadataMap& metadata_map) {
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry =
+  StreamDecoderFilters::Iterator entry =
       commonDecodePrefix(filter, FilterIterationStartState::CanStartFromCurrent);
 
   for (; entry != decoder_filters_.end(); entry++) {
@@ -844,7 +843,7 @@ void FilterManager::maybeEndDecode(bool end_stream) {
 
 void FilterManager::disarmRequestTimeout() { filter_manager_callbacks_.disarmRequestTimeout(); }
 
-std::list<ActiveStreamEncoderFilterPtr>::iterator
+StreamEncoderFilters::Iterator
 FilterManager::commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_stream,
                                   FilterIterationStartState filter_iteration_start_state) {
   // Only do base state setting on the initial call. Subsequent calls for filtering do not touch
@@ -856,27 +855,27 @@ FilterManager::commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_st
   }
 
   if (filter_iteration_start_state == FilterIterationStartState::CanStartFromCurrent &&
-      (*(filter->entry()))->iterate_from_current_filter_) {
+      filter->iterate_from_current_filter_) {
     // The filter iteration has been stopped for all frame types, and now the iteration continues.
     // The current filter's encoding callback has not be called. Call it now.
-    return filter->entry();
+    return encoder_filters_.entry(*filter);
   }
-  return std::next(filter->entry());
+  return std::next(encoder_filters_.entry(*filter));
 }
 
-std::list<ActiveStreamDecoderFilterPtr>::iterator
+StreamDecoderFilters::Iterator
 FilterManager::commonDecodePrefix(ActiveStreamDecoderFilter* filter,
                                   FilterIterationStartState filter_iteration_start_state) {
   if (!filter) {
     return decoder_filters_.begin();
   }
   if (filter_iteration_start_state == FilterIterationStartState::CanStartFromCurrent &&
-      (*(filter->entry()))->iterate_from_current_filter_) {
+      filter->iterate_from_current_filter_) {
     // The filter iteration has been stopped for all frame types, and now the iteration continues.
     // The current filter's callback function has not been called. Call it now.
-    return filter->entry();
+    return decoder_filters_.entry(*filter);
   }
-  return std::next(filter->entry());
+  return std::next(decoder_filters_.entry(*filter));
 }
 
 void FilterManager::onLocalReply(StreamFilterBase::LocalReplyData& data) {
@@ -1048,7 +1047,7 @@ void FilterManager::encode1xxHeaders(ActiveStreamEncoderFilter* filter,
   // end-stream, and because there are normal headers coming there's no need for
   // complex continuation logic.
   // 100-continue filter iteration should always start with the next filter if available.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  StreamEncoderFilters::Iterator entry =
       commonEncodePrefix(filter, false, FilterIterationStartState::AlwaysStartFromNext);
   for (; entry != encoder_filters_.end(); entry++) {
     if ((*entry)->skipFilter()) {
@@ -1070,7 +1069,7 @@ void FilterManager::encode1xxHeaders(ActiveStreamEncoderFilter* filter,
 }
 
 void FilterManager::maybeContinueEncoding(
-    const std::list<ActiveStreamEncoderFilterPtr>::iterator& continue_data_entry) {
+    const StreamEncoderFilters::Iterator& continue_data_entry) {
   if (continue_data_entry != encoder_filters_.end()) {
     // We use the continueEncoding() code since it will correctly handle not calling
     // encodeHeaders() again. Fake setting StopSingleIteration since the continueEncoding() code
@@ -1091,9 +1090,9 @@ void FilterManager::encodeHeaders(ActiveStreamEncoderFilter* filter, ResponseHea
   disarmRequestTimeout();
 
   // Headers filter iteration should always start with the next filter if available.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  StreamEncoderFilters::Iterator entry =
       commonEncodePrefix(filter, end_stream, FilterIterationStartState::AlwaysStartFromNext);
-  std::list<ActiveStreamEncoderFilterPtr>::iterator continue_data_entry = encoder_filters_.end();
+  StreamEncoderFilters::Iterator continue_data_entry = encoder_filters_.end();
 
   for (; entry != encoder_filters_.end(); entry++) {
     (*entry)->maybeEvaluateMatchTreeWithNewData(
@@ -1176,7 +1175,7 @@ void FilterManager::encodeMetadata(ActiveStreamEncoderFilter* filter,
                                    MetadataMapPtr&& metadata_map_ptr) {
   filter_manager_callbacks_.resetIdleTimer();
 
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  StreamEncoderFilters::Iterator entry =
       commonEncodePrefix(filter, false, FilterIterationStartState::CanStartFromCurrent);
 
   for (; entry != encoder_filters_.end(); entry++) {
@@ -1245,7 +1244,7 @@ void FilterManager::encodeData(ActiveStreamEncoderFilter* filter, Buffer::Instan
   filter_manager_callbacks_.resetIdleTimer();
 
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  StreamEncoderFilters::Iterator entry =
       commonEncodePrefix(filter, end_stream, filter_iteration_start_state);
   auto trailers_added_entry = encoder_filters_.end();
 
@@ -1321,7 +1320,7 @@ void FilterManager::encodeTrailers(ActiveStreamEncoderFilter* filter,
   filter_manager_callbacks_.resetIdleTimer();
 
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  StreamEncoderFilters::Iterator entry =
       commonEncodePrefix(filter, true, FilterIterationStartState::CanStartFromCurrent);
   for (; entry != encoder_filters_.end(); entry++) {
     (*entry)->maybeEvaluateMatchTreeWithNewData(
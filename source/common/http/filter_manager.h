@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/common/optref.h"
@@ -17,7 +18,6 @@
 
 #include "source/common/buffer/watermark_buffer.h"
 #include "source/common/common/dump_state_utils.h"
-#include "source/common/common/linked_object.h"
 #include "source/common/common/logger.h"
 #include "source/common/grpc/common.h"
 #include "source/common/http/header_utility.h"
@@ -215,8 +215,7 @@ struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks,
  * Wrapper for a stream decoder filter.
  */
 struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
-                                   public StreamDecoderFilterCallbacks,
-                                   LinkedObject<ActiveStreamDecoderFilter> {
+                                   public StreamDecoderFilterCallbacks {
   ActiveStreamDecoderFilter(FilterManager& parent, StreamDecoderFilterSharedPtr filter,
                             FilterMatchStateSharedPtr match_state, bool dual_filter)
       : ActiveStreamFilterBase(parent, dual_filter, std::move(match_state)), handle_(filter) {}
@@ -301,6 +300,8 @@ struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
   absl::optional<Router::ConfigConstSharedPtr> routeConfig();
 
   StreamDecoderFilterSharedPtr handle_;
+  // Position of this filter in the decoder filter storage of the parent.
+  size_t entry_index_{};
   bool is_grpc_request_{};
 };
 
@@ -310,8 +311,7 @@ using ActiveStreamDecoderFilterPtr = std::unique_ptr<ActiveStreamDecoderFilter>;
  * Wrapper for a stream encoder filter.
  */
 struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
-                                   public StreamEncoderFilterCallbacks,
-                                   LinkedObject<ActiveStreamEncoderFilter> {
+                                   public StreamEncoderFilterCallbacks {
   ActiveStreamEncoderFilter(FilterManager& parent, StreamEncoderFilterSharedPtr filter,
                             FilterMatchStateSharedPtr match_state, bool dual_filter)
       : ActiveStreamFilterBase(parent, dual_filter, std::move(match_state)), handle_(filter) {}
@@ -359,10 +359,54 @@ struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
   void responseDataDrained();
 
   StreamEncoderFilterSharedPtr handle_;
+  // Position of this filter in the encoder filter storage of the parent.
+  size_t entry_index_{};
 };
 
 using ActiveStreamEncoderFilterPtr = std::unique_ptr<ActiveStreamEncoderFilter>;
 
+/**
+ * Contiguous storage of the decoder filters of a stream. Filters are appended in configuration
+ * order and iterated in the same order.
+ */
+struct StreamDecoderFilters {
+  using Element = ActiveStreamDecoderFilter;
+  using Iterator = std::vector<ActiveStreamDecoderFilterPtr>::iterator;
+
+  Iterator begin() { return entries_.begin(); }
+  Iterator end() { return entries_.end(); }
+  Iterator entry(const ActiveStreamDecoderFilter& filter) {
+    return entries_.begin() + filter.entry_index_;
+  }
+  void add(ActiveStreamDecoderFilterPtr filter) {
+    filter->entry_index_ = entries_.size();
+    entries_.push_back(std::move(filter));
+  }
+
+  std::vector<ActiveStreamDecoderFilterPtr> entries_;
+};
+
+/**
+ * Contiguous storage of the encoder filters of a stream. Filters are appended in configuration
+ * order and iterated in reverse order.
+ */
+struct StreamEncoderFilters {
+  using Element = ActiveStreamEncoderFilter;
+  using Iterator = std::vector<ActiveStreamEncoderFilterPtr>::reverse_iterator;
+
+  Iterator begin() { return entries_.rbegin(); }
+  Iterator end() { return entries_.rend(); }
+  Iterator entry(const ActiveStreamEncoderFilter& filter) {
+    return entries_.rbegin() + (entries_.size() - 1 - filter.entry_index_);
+  }
+  void add(ActiveStreamEncoderFilterPtr filter) {
+    filter->entry_index_ = entries_.size();
+    entries_.push_back(std::move(filter));
+  }
+
+  std::vector<ActiveStreamEncoderFilterPtr> entries_;
+};
+
 /**
  * Callbacks invoked by the FilterManager to pass filter data/events back to the caller.
  */
@@ -948,11 +992,11 @@ private:
   enum class FilterIterationStartState { AlwaysStartFromNext, CanStartFromCurrent };
 
   // Returns the encoder filter to start iteration with.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator
+  StreamEncoderFilters::Iterator
   commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_stream,
                      FilterIterationStartState filter_iteration_start_state);
   // Returns the decoder filter to start iteration with.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator
+  StreamDecoderFilters::Iterator
   commonDecodePrefix(ActiveStreamDecoderFilter* filter,
                      FilterIterationStartState filter_iteration_start_state);
   void addDecodedData(ActiveStreamDecoderFilter& filter, Buffer::Instance& data, bool streaming);
@@ -961,7 +1005,7 @@ private:
   // Helper function for the case where we have a header only request, but a filter adds a body
   // to it.
   void maybeContinueDecoding(
-      const std::list<ActiveStreamDecoderFilterPtr>::iterator& maybe_continue_data_entry);
+      const StreamDecoderFilters::Iterator& maybe_continue_data_entry);
   void decodeHeaders(ActiveStreamDecoderFilter* filter, RequestHeaderMap& headers, bool end_stream);
   // Sends data through decoding filter chains. filter_iteration_start_state indicates which
   // filter to start the iteration with.
@@ -976,7 +1020,7 @@ private:
   // filters before calling encodeHeadersInternal which does final header munging and passes the
   // headers to the encoder.
   void maybeContinueEncoding(
-      const std::list<ActiveStreamEncoderFilterPtr>::iterator& maybe_continue_data_entry);
+      const StreamEncoderFilters::Iterator& maybe_continue_data_entry);
   void encodeHeaders(ActiveStreamEncoderFilter* filter, ResponseHeaderMap& headers,
                      bool end_stream);
   // Sends data through encoding filter chains. filter_iteration_start_state indicates which
@@ -1010,10 +1054,10 @@ private:
   Buffer::BufferMemoryAccountSharedPtr account_;
   const bool proxy_100_continue_;
 
-  std::list<ActiveStreamDecoderFilterPtr> decoder_filters_;
-  std::list<ActiveStreamEncoderFilterPtr> encoder_filters_;
-  std::list<StreamFilterBase*> filters_;
-  std::list<AccessLog::InstanceSharedPtr> access_log_handlers_;
+  StreamDecoderFilters decoder_filters_;
+  StreamEncoderFilters encoder_filters_;
+  std::vector<StreamFilterBase*> filters_;
+  std::vector<AccessLog::InstanceSharedPtr> access_log_handlers_;
 
   // Stores metadata added in the decoding filter that is being processed. Will be cleared before
   // processing the next filter. The storage is created on demand. We need to store metadata
@@ -270,6 +270,7 @@ void ConnectionImpl::StreamImpl::encodeHeadersBase(const HeaderMap& headers, boo
   }
 
   local_end_stream_ = end_stream;
+  parent_.stats_.tx_header_bytes_.add(headers.byteSize());
   submitHeaders(headers, end_stream ? nullptr : &provider);
   if (parent_.sendPendingFramesAndHandleError()) {
     // Intended to check through coverage that this error case is tested
@@ -619,6 +620,7 @@ void ConnectionImpl::StreamImpl::submitTrailers(const HeaderMap& trailers) {
     return;
   }
 
+  parent_.stats_.tx_header_bytes_.add(trailers.byteSize());
   if (parent_.use_new_codec_wrapper_) {
     std::vector<http2::adapter::Header> final_headers = buildHeaders(trailers);
     parent_.adapter_->SubmitTrailer(stream_id_, final_headers);
@@ -677,7 +679,7 @@ void ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size_t
 
   parent_.stats_.pending_send_bytes_.sub(length);
   output.move(*pending_send_data_, length);
-  parent_.connection_.write(output, false);
+  parent_.writeOutboundFrames(output);
 }
 
 void ConnectionImpl::ClientStreamImpl::submitHeaders(const HeaderMap& headers,
@@ -907,6 +909,8 @@ ConnectionImpl::ConnectionImpl(Network::Connection& connection, CodecStats& stat
       protocol_constraints_(stats, http2_options),
       skip_dispatching_frames_for_closed_connection_(Runtime::runtimeFeatureEnabled(
           "envoy.reloadable_features.skip_dispatching_frames_for_closed_connection")),
+      max_coalesced_write_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(http2_options, max_coalesced_write_bytes, 0)),
       dispatching_(false), raised_goaway_(false),
       delay_keepalive_timeout_(Runtime::runtimeFeatureEnabled(
           "envoy.reloadable_features.http2_delay_keepalive_timeout")),
@@ -1148,6 +1152,10 @@ Status ConnectionImpl::onBeforeFrameReceived(const nghttp2_frame_hd* hd) {
   if (hd->type != NGHTTP2_HEADERS && hd->type != NGHTTP2_DATA) {
     status = trackInboundFrames(hd, 0);
   }
+  if (hd->type == NGHTTP2_HEADERS || hd->type == NGHTTP2_CONTINUATION) {
+    // This includes the padding and priority fields of HEADERS frames, if any.
+    stats_.rx_header_block_bytes_.add(hd->length);
+  }
 
   return status;
 }
@@ -1296,6 +1304,9 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
       stream->bytes_meter_->addHeaderBytesSent(frame->hd.length + H2_FRAME_HEADER_SIZE);
     }
   }
+  if (frame->hd.type == NGHTTP2_HEADERS || frame->hd.type == NGHTTP2_CONTINUATION) {
+    stats_.tx_header_block_bytes_.add(frame->hd.length);
+  }
   switch (frame->hd.type) {
   case NGHTTP2_GOAWAY: {
     ENVOY_CONN_LOG(debug, "sent goaway code={}", connection_, frame->goaway.error_code);
@@ -1412,16 +1423,35 @@ ssize_t ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   addOutboundFrameFragment(buffer, data, length);
 
   // While the buffer is transient the fragment it contains will be moved into the
-  // write_buffer_ of the underlying connection_ by the write method below.
+  // write_buffer_ of the underlying connection_ by writeOutboundFrames(), possibly after being
+  // coalesced with other frames in outbound_frames_.
   // This creates lifetime dependency between the write_buffer_ of the underlying connection
   // and the codec object. Specifically the write_buffer_ MUST be either fully drained or
   // deleted before the codec object is deleted. This is presently guaranteed by the
   // destruction order of the Network::ConnectionImpl object where write_buffer_ is
   // destroyed before the filter_manager_ which owns the codec through Http::ConnectionManagerImpl.
-  connection_.write(buffer, false);
+  writeOutboundFrames(buffer);
   return length;
 }
 
+void ConnectionImpl::writeOutboundFrames(Buffer::OwnedImpl& frames) {
+  if (max_coalesced_write_bytes_ == 0) {
+    connection_.write(frames, false);
+    return;
+  }
+
+  outbound_frames_.move(frames);
+  if (outbound_frames_.length() >= max_coalesced_write_bytes_) {
+    flushOutboundFrames();
+  }
+}
+
+void ConnectionImpl::flushOutboundFrames() {
+  if (outbound_frames_.length() > 0) {
+    connection_.write(outbound_frames_, false);
+  }
+}
+
 Status ConnectionImpl::onStreamClose(StreamImpl* stream, uint32_t error_code) {
   if (stream) {
     const int32_t stream_id = stream->stream_id_;
@@ -1553,6 +1583,7 @@ int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
     stats_.headers_cb_no_stream_.inc();
     return 0;
   }
+  stats_.rx_header_bytes_.add(name.size() + value.size());
 
   // TODO(10646): Switch to use HeaderUtility::checkHeaderNameForUnderscores().
   auto should_return = checkHeaderNameForUnderscores(name.getStringView());
@@ -1587,6 +1618,8 @@ Status ConnectionImpl::sendPendingFrames() {
   } else {
     rc = nghttp2_session_send(session_);
   }
+  // Write the frames coalesced while sending, if any, in a single write.
+  flushOutboundFrames();
   if (rc != 0) {
     ASSERT(rc == NGHTTP2_ERR_CALLBACK_FAILURE);
     return codecProtocolError(nghttp2_strerror(rc));
@@ -1925,7 +1958,10 @@ ConnectionImpl::Http2Callbacks::~Http2Callbacks() { nghttp2_session_callbacks_de
 ConnectionImpl::Http2Options::Http2Options(
     const envoy::config::core::v3::Http2ProtocolOptions& http2_options, uint32_t max_headers_kb) {
   og_options_.perspective = http2::adapter::Perspective::kServer;
-  og_options_.max_hpack_encoding_table_capacity = http2_options.hpack_table_size().value();
+  // The encoder table defaults to the size advertised for the decoder table.
+  const uint32_t hpack_encoder_table_size = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      http2_options, hpack_encoder_table_size, http2_options.hpack_table_size().value());
+  og_options_.max_hpack_encoding_table_capacity = hpack_encoder_table_size;
   og_options_.max_header_list_bytes = max_headers_kb * 1024;
   og_options_.max_header_field_size = max_headers_kb * 1024;
   og_options_.allow_extended_connect = http2_options.allow_connect();
@@ -1943,9 +1979,8 @@ ConnectionImpl::Http2Options::Http2Options(
   // codec_impl::saveHeader.
   nghttp2_option_set_max_send_header_block_length(options_, 0x2000000);
 
-  if (http2_options.hpack_table_size().value() != NGHTTP2_DEFAULT_HEADER_TABLE_SIZE) {
-    nghttp2_option_set_max_deflate_dynamic_table_size(options_,
-                                                      http2_options.hpack_table_size().value());
+  if (hpack_encoder_table_size != NGHTTP2_DEFAULT_HEADER_TABLE_SIZE) {
+    nghttp2_option_set_max_deflate_dynamic_table_size(options_, hpack_encoder_table_size);
   }
 
   if (http2_options.allow_metadata()) {
@@ -644,6 +644,13 @@ protected:
 
   const bool skip_dispatching_frames_for_closed_connection_;
 
+  // If non-zero, the frames generated by a sendPendingFrames() call are coalesced in
+  // outbound_frames_ and written to the connection once this many bytes are pending, and when the
+  // call completes. Declared after protocol_constraints_ as the drain trackers of pending frames
+  // reference it.
+  const uint32_t max_coalesced_write_bytes_;
+  Buffer::OwnedImpl outbound_frames_;
+
   // Called when a stream encodes to the http2 connection which enables us to
   // keep the active_streams list in LRU if deferred processing.
   void updateActiveStreamsOnEncode(StreamImpl& stream) {
@@ -685,6 +692,11 @@ private:
 
   // Adds buffer fragment for a new outbound frame to the supplied Buffer::OwnedImpl.
   void addOutboundFrameFragment(Buffer::OwnedImpl& output, const uint8_t* data, size_t length);
+  // Writes outbound frames to the connection, or queues them in outbound_frames_ if write
+  // coalescing is enabled. The frames are moved, not copied.
+  void writeOutboundFrames(Buffer::OwnedImpl& frames);
+  // Writes the frames queued in outbound_frames_ to the connection.
+  void flushOutboundFrames();
   virtual Status trackInboundFrames(const nghttp2_frame_hd* hd, uint32_t padding_length) PURE;
   void onKeepaliveResponse();
   void onKeepaliveResponseTimeout();
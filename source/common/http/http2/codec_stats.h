@@ -23,11 +23,15 @@ namespace Http2 {
   COUNTER(outbound_control_flood)                                                                  \
   COUNTER(outbound_flood)                                                                          \
   COUNTER(requests_rejected_with_underscores_in_headers)                                           \
+  COUNTER(rx_header_block_bytes)                                                                   \
+  COUNTER(rx_header_bytes)                                                                         \
   COUNTER(rx_messaging_error)                                                                      \
   COUNTER(rx_reset)                                                                                \
   COUNTER(stream_refused_errors)                                                                   \
   COUNTER(trailers)                                                                                \
   COUNTER(tx_flush_timeout)                                                                        \
+  COUNTER(tx_header_block_bytes)                                                                   \
+  COUNTER(tx_header_bytes)                                                                         \
   COUNTER(tx_reset)                                                                                \
   COUNTER(keepalive_timeout)                                                                       \
   GAUGE(streams_active, Accumulate)                                                                \
@@ -20,7 +20,11 @@ namespace Http3 {
   COUNTER(metadata_not_supported_error)                                                            \
   COUNTER(quic_version_h3_29)                                                                      \
   COUNTER(quic_version_rfc_v1)                                                                     \
-  COUNTER(tx_flush_timeout)
+  COUNTER(tx_flush_timeout)                                                                        \
+  COUNTER(rx_header_block_bytes)                                                                   \
+  COUNTER(rx_header_bytes)                                                                         \
+  COUNTER(tx_header_block_bytes)                                                                   \
+  COUNTER(tx_header_bytes)
 
 /**
  * Wrapper struct for the HTTP/3 codec stats. @see stats_macros.h
@@ -0,0 +1,425 @@
+#include "source/common/http/shared_conn_pool.h"
+
+#include <algorithm>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/assert.h"
+#include "source/common/common/dump_state_utils.h"
+#include "source/common/common/hash.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/network/socket_impl.h"
+
+namespace Envoy {
+namespace Http {
+
+uint32_t WorkerDispatcherRegistry::registerWorker(Event::Dispatcher& dispatcher) {
+  absl::MutexLock lock(&mutex_);
+  dispatchers_.push_back(&dispatcher);
+  return dispatchers_.size() - 1;
+}
+
+void WorkerDispatcherRegistry::unregisterWorker(uint32_t index) {
+  absl::MutexLock lock(&mutex_);
+  ASSERT(index < dispatchers_.size());
+  dispatchers_[index] = nullptr;
+}
+
+bool WorkerDispatcherRegistry::post(uint32_t index, Event::PostCb callback) {
+  absl::MutexLock lock(&mutex_);
+  // The lock is held while posting so that the dispatcher can not be destroyed concurrently.
+  if (index >= dispatchers_.size() || dispatchers_[index] == nullptr) {
+    return false;
+  }
+  dispatchers_[index]->post(std::move(callback));
+  return true;
+}
+
+bool WorkerDispatcherRegistry::allRegistered() const {
+  absl::MutexLock lock(&mutex_);
+  return dispatchers_.size() >= workers_;
+}
+
+SharedConnPool::SharedConnPool(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+                               WorkerDispatcherRegistrySharedPtr workers, uint32_t worker,
+                               uint32_t owner_worker, OwnerPoolCb owner_pool)
+    : dispatcher_(dispatcher), host_(std::move(host)), workers_(std::move(workers)),
+      worker_(worker), owner_worker_(owner_worker), owner_pool_(std::move(owner_pool)) {
+  ASSERT(worker_ != owner_worker_);
+}
+
+SharedConnPool::~SharedConnPool() {
+  while (!streams_.empty()) {
+    streams_.front()->onPoolDestroyed();
+  }
+}
+
+absl::optional<uint32_t> SharedConnPool::ownerWorker(const Upstream::Host& host, uint32_t worker,
+                                                     uint32_t workers, uint32_t owners) {
+  ASSERT(worker < workers);
+  owners = std::max<uint32_t>(1, std::min(owners, workers));
+  const uint32_t first_owner = HashUtil::xxHash64(host.address()->asStringView()) % workers;
+  if ((worker + workers - first_owner) % workers < owners) {
+    return absl::nullopt;
+  }
+  // Spread the other workers over the owners.
+  return (first_owner + worker % owners) % workers;
+}
+
+void SharedConnPool::drainConnections(Envoy::ConnectionPool::DrainBehavior) {
+  // The connections belong to the owner worker, which drains its own pools. This pool only needs
+  // to report when it becomes idle.
+  if (isIdle()) {
+    for (const IdleCb& cb : idle_callbacks_) {
+      cb();
+    }
+  }
+}
+
+ConnectionPool::Cancellable* SharedConnPool::newStream(Http::ResponseDecoder& response_decoder,
+                                                       ConnectionPool::Callbacks& callbacks,
+                                                       const Instance::StreamOptions& options) {
+  auto stream = std::make_shared<ProxyStream>(*this, response_decoder, callbacks);
+  streams_.push_front(stream);
+  stream->entry_ = streams_.begin();
+  host_->cluster().stats().upstream_rq_shared_pool_handoff_.inc();
+
+  if (!workers_->post(owner_worker_,
+                      [stream, options]() -> void { stream->onOwnerNewStream(options); })) {
+    ENVOY_LOG(debug, "owner worker {} of host {} is gone", owner_worker_, host_->hostname());
+    stream->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+    callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                            "owner worker unavailable", host_);
+    return nullptr;
+  }
+  return stream.get();
+}
+
+void SharedConnPool::onStreamDone(ProxyStream& stream) {
+  streams_.erase(stream.entry_);
+  if (isIdle()) {
+    for (const IdleCb& cb : idle_callbacks_) {
+      cb();
+    }
+  }
+}
+
+SharedConnPool::ProxyStream::ProxyStream(SharedConnPool& parent, ResponseDecoder& decoder,
+                                         ConnectionPool::Callbacks& callbacks)
+    : workers_(parent.workers_), worker_(parent.worker_), owner_worker_(parent.owner_worker_),
+      owner_pool_(parent.owner_pool_), host_(parent.host_), parent_(&parent),
+      time_source_(parent.dispatcher_.timeSource()), decoder_(decoder), callbacks_(callbacks),
+      ready_(false), done_(false), remote_end_stream_(false), owner_done_(false),
+      owner_local_end_stream_(false), owner_remote_end_stream_(false) {}
+
+void SharedConnPool::ProxyStream::postToRequester(std::function<void(ProxyStream&)> cb) {
+  workers_->post(worker_, [self = shared_from_this(), cb = std::move(cb)]() -> void {
+    if (!self->done_) {
+      cb(*self);
+    }
+  });
+}
+
+void SharedConnPool::ProxyStream::postToOwner(std::function<void(ProxyStream&)> cb) {
+  workers_->post(owner_worker_, [self = shared_from_this(), cb = std::move(cb)]() -> void {
+    if (!self->owner_done_) {
+      cb(*self);
+    }
+  });
+}
+
+void SharedConnPool::ProxyStream::remove() {
+  if (done_) {
+    return;
+  }
+  done_ = true;
+  if (parent_ != nullptr) {
+    SharedConnPool* parent = parent_;
+    parent_ = nullptr;
+    // This may destroy the last reference to the stream held on this worker.
+    ProxyStreamSharedPtr self = shared_from_this();
+    parent->onStreamDone(*this);
+  }
+}
+
+void SharedConnPool::ProxyStream::maybeRemove() {
+  if (local_end_stream_ && remote_end_stream_) {
+    remove();
+  }
+}
+
+void SharedConnPool::ProxyStream::onPoolDestroyed() {
+  ProxyStreamSharedPtr self = shared_from_this();
+  parent_->streams_.erase(entry_);
+  parent_ = nullptr;
+  done_ = true;
+  postToOwner([](ProxyStream& stream) -> void {
+    if (stream.owner_cancellable_ != nullptr) {
+      stream.owner_cancellable_->cancel(Envoy::ConnectionPool::CancelPolicy::Default);
+      stream.releaseOwner();
+    } else if (stream.owner_encoder_ != nullptr) {
+      stream.owner_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+    }
+  });
+  if (ready_) {
+    runResetCallbacks(StreamResetReason::ConnectionTermination);
+  } else {
+    callbacks_.onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                             "pool destroyed", host_);
+  }
+}
+
+void SharedConnPool::ProxyStream::cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) {
+  ASSERT(!ready_);
+  postToOwner([cancel_policy](ProxyStream& stream) -> void {
+    if (stream.owner_cancellable_ != nullptr) {
+      stream.owner_cancellable_->cancel(cancel_policy);
+      stream.releaseOwner();
+    } else if (stream.owner_encoder_ != nullptr) {
+      // The stream became ready while the cancellation was in flight.
+      stream.owner_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+    }
+  });
+  remove();
+}
+
+Status SharedConnPool::ProxyStream::encodeHeaders(const RequestHeaderMap& headers,
+                                                  bool end_stream) {
+  local_end_stream_ = end_stream;
+  std::shared_ptr<RequestHeaderMap> copy = createHeaderMap<RequestHeaderMapImpl>(headers);
+  postToOwner([copy, end_stream](ProxyStream& stream) -> void {
+    stream.owner_local_end_stream_ = end_stream;
+    const Status status = stream.owner_encoder_->encodeHeaders(*copy, end_stream);
+    if (!status.ok()) {
+      stream.owner_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+      return;
+    }
+    stream.maybeReleaseOwner();
+  });
+  maybeRemove();
+  return okStatus();
+}
+
+void SharedConnPool::ProxyStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  local_end_stream_ = end_stream;
+  auto copy = std::make_shared<Buffer::OwnedImpl>(data);
+  data.drain(data.length());
+  postToOwner([copy, end_stream](ProxyStream& stream) -> void {
+    stream.owner_local_end_stream_ = end_stream;
+    stream.owner_encoder_->encodeData(*copy, end_stream);
+    stream.maybeReleaseOwner();
+  });
+  maybeRemove();
+}
+
+void SharedConnPool::ProxyStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  local_end_stream_ = true;
+  std::shared_ptr<RequestTrailerMap> copy = createHeaderMap<RequestTrailerMapImpl>(trailers);
+  postToOwner([copy](ProxyStream& stream) -> void {
+    stream.owner_local_end_stream_ = true;
+    stream.owner_encoder_->encodeTrailers(*copy);
+    stream.maybeReleaseOwner();
+  });
+  maybeRemove();
+}
+
+void SharedConnPool::ProxyStream::encodeMetadata(const MetadataMapVector& metadata_map_vector) {
+  auto copy = std::make_shared<MetadataMapVector>();
+  for (const MetadataMapPtr& metadata_map : metadata_map_vector) {
+    copy->push_back(std::make_unique<MetadataMap>(*metadata_map));
+  }
+  postToOwner(
+      [copy](ProxyStream& stream) -> void { stream.owner_encoder_->encodeMetadata(*copy); });
+}
+
+void SharedConnPool::ProxyStream::resetStream(StreamResetReason reason) {
+  if (done_) {
+    return;
+  }
+  postToOwner([reason](ProxyStream& stream) -> void {
+    stream.owner_encoder_->getStream().resetStream(reason);
+  });
+  ProxyStreamSharedPtr self = shared_from_this();
+  remove();
+  runResetCallbacks(reason);
+}
+
+void SharedConnPool::ProxyStream::readDisable(bool disable) {
+  postToOwner([disable](ProxyStream& stream) -> void {
+    stream.owner_encoder_->getStream().readDisable(disable);
+  });
+}
+
+void SharedConnPool::ProxyStream::setFlushTimeout(std::chrono::milliseconds timeout) {
+  postToOwner([timeout](ProxyStream& stream) -> void {
+    stream.owner_encoder_->getStream().setFlushTimeout(timeout);
+  });
+}
+
+void SharedConnPool::ProxyStream::onOwnerNewStream(const Instance::StreamOptions& options) {
+  ConnectionPool::Instance* pool = owner_pool_();
+  if (pool == nullptr) {
+    owner_done_ = true;
+    postToRequester([](ProxyStream& stream) -> void {
+      stream.remove();
+      stream.callbacks_.onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                                      "no owner pool", stream.host_);
+    });
+    return;
+  }
+
+  // Keep the stream alive for as long as the owner pool or its stream reference it.
+  owner_self_ = shared_from_this();
+  ConnectionPool::Cancellable* cancellable = pool->newStream(*this, *this, options);
+  if (cancellable != nullptr) {
+    owner_cancellable_ = cancellable;
+  }
+}
+
+void SharedConnPool::ProxyStream::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                                absl::string_view transport_failure_reason,
+                                                Upstream::HostDescriptionConstSharedPtr) {
+  postToRequester([reason, details = std::string(transport_failure_reason)](
+                      ProxyStream& stream) -> void {
+    stream.remove();
+    stream.callbacks_.onPoolFailure(reason, details, stream.host_);
+  });
+  releaseOwner();
+}
+
+void SharedConnPool::ProxyStream::onPoolReady(RequestEncoder& encoder,
+                                              Upstream::HostDescriptionConstSharedPtr,
+                                              const StreamInfo::StreamInfo& info,
+                                              absl::optional<Http::Protocol> protocol) {
+  owner_cancellable_ = nullptr;
+  owner_encoder_ = &encoder;
+  encoder.getStream().addCallbacks(*this);
+
+  // Snapshot what the requesting worker needs from the connection, its state is only accessible
+  // on this worker.
+  const Network::ConnectionInfoProvider& provider = info.downstreamAddressProvider();
+  auto connection_info = std::make_shared<Network::ConnectionInfoSetterImpl>(
+      encoder.getStream().connectionLocalAddress(), provider.remoteAddress());
+  if (provider.connectionID().has_value()) {
+    connection_info->setConnectionID(provider.connectionID().value());
+  }
+  absl::optional<StreamInfo::UpstreamTiming> timing;
+  uint64_t num_streams = 0;
+  if (info.upstreamInfo().has_value()) {
+    timing = info.upstreamInfo()->upstreamTiming();
+    num_streams = info.upstreamInfo()->upstreamNumStreams();
+  }
+  const uint32_t buffer_limit = encoder.getStream().bufferLimit();
+
+  postToRequester([connection_info, timing, num_streams, buffer_limit,
+                   protocol](ProxyStream& stream) -> void {
+    stream.connection_info_ = std::make_unique<StreamInfo::StreamInfoImpl>(
+        protocol.value_or(Protocol::Http2), stream.time_source_, connection_info);
+    if (timing.has_value()) {
+      auto upstream_info = std::make_shared<StreamInfo::UpstreamInfoImpl>();
+      upstream_info->upstreamTiming() = timing.value();
+      upstream_info->setUpstreamNumStreams(num_streams);
+      stream.connection_info_->setUpstreamInfo(upstream_info);
+    }
+    stream.buffer_limit_ = buffer_limit;
+    stream.ready_ = true;
+    stream.callbacks_.onPoolReady(stream, stream.host_, *stream.connection_info_, protocol);
+  });
+}
+
+void SharedConnPool::ProxyStream::decode1xxHeaders(ResponseHeaderMapPtr&& headers) {
+  std::shared_ptr<ResponseHeaderMapPtr> holder =
+      std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToRequester([holder](ProxyStream& stream) -> void {
+    stream.decoder_.decode1xxHeaders(std::move(*holder));
+  });
+}
+
+void SharedConnPool::ProxyStream::decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) {
+  owner_remote_end_stream_ = end_stream;
+  std::shared_ptr<ResponseHeaderMapPtr> holder =
+      std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToRequester([holder, end_stream](ProxyStream& stream) -> void {
+    stream.remote_end_stream_ = end_stream;
+    ProxyStreamSharedPtr self = stream.shared_from_this();
+    stream.decoder_.decodeHeaders(std::move(*holder), end_stream);
+    stream.maybeRemove();
+  });
+  maybeReleaseOwner();
+}
+
+void SharedConnPool::ProxyStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  owner_remote_end_stream_ = end_stream;
+  auto copy = std::make_shared<Buffer::OwnedImpl>(data);
+  postToRequester([copy, end_stream](ProxyStream& stream) -> void {
+    stream.remote_end_stream_ = end_stream;
+    ProxyStreamSharedPtr self = stream.shared_from_this();
+    stream.decoder_.decodeData(*copy, end_stream);
+    stream.maybeRemove();
+  });
+  maybeReleaseOwner();
+}
+
+void SharedConnPool::ProxyStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  owner_remote_end_stream_ = true;
+  std::shared_ptr<ResponseTrailerMapPtr> holder =
+      std::make_shared<ResponseTrailerMapPtr>(std::move(trailers));
+  postToRequester([holder](ProxyStream& stream) -> void {
+    stream.remote_end_stream_ = true;
+    ProxyStreamSharedPtr self = stream.shared_from_this();
+    stream.decoder_.decodeTrailers(std::move(*holder));
+    stream.maybeRemove();
+  });
+  maybeReleaseOwner();
+}
+
+void SharedConnPool::ProxyStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  std::shared_ptr<MetadataMapPtr> holder =
+      std::make_shared<MetadataMapPtr>(std::move(metadata_map));
+  postToRequester([holder](ProxyStream& stream) -> void {
+    stream.decoder_.decodeMetadata(std::move(*holder));
+  });
+}
+
+void SharedConnPool::ProxyStream::dumpState(std::ostream& os, int indent_level) const {
+  const char* spaces = spacesForLevel(indent_level);
+  os << spaces << "SharedConnPool::ProxyStream " << this << DUMP_MEMBER(worker_)
+     << DUMP_MEMBER(owner_worker_) << DUMP_MEMBER(owner_local_end_stream_)
+     << DUMP_MEMBER(owner_remote_end_stream_) << "\n";
+}
+
+void SharedConnPool::ProxyStream::onResetStream(StreamResetReason reason, absl::string_view) {
+  postToRequester([reason](ProxyStream& stream) -> void {
+    ProxyStreamSharedPtr self = stream.shared_from_this();
+    stream.remove();
+    stream.runResetCallbacks(reason);
+  });
+  releaseOwner();
+}
+
+void SharedConnPool::ProxyStream::onAboveWriteBufferHighWatermark() {
+  postToRequester([](ProxyStream& stream) -> void { stream.runHighWatermarkCallbacks(); });
+}
+
+void SharedConnPool::ProxyStream::onBelowWriteBufferLowWatermark() {
+  postToRequester([](ProxyStream& stream) -> void { stream.runLowWatermarkCallbacks(); });
+}
+
+void SharedConnPool::ProxyStream::maybeReleaseOwner() {
+  if (owner_local_end_stream_ && owner_remote_end_stream_) {
+    releaseOwner();
+  }
+}
+
+void SharedConnPool::ProxyStream::releaseOwner() {
+  owner_done_ = true;
+  owner_cancellable_ = nullptr;
+  if (owner_encoder_ != nullptr) {
+    owner_encoder_->getStream().removeCallbacks(*this);
+    owner_encoder_ = nullptr;
+  }
+  // The owner pool may still be calling into the stream, release it from the event loop.
+  workers_->post(owner_worker_, [self = std::move(owner_self_)]() -> void {});
+}
+
+} // namespace Http
+} // namespace Envoy
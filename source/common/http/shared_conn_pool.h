@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/codec.h"
+#include "envoy/http/conn_pool.h"
+#include "envoy/upstream/upstream.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/http/codec_helper.h"
+#include "source/common/stream_info/stream_info_impl.h"
+
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * Thread safe registry of the dispatchers of the worker threads, used to hand off work between
+ * workers. A worker keeps its index for its whole lifetime; posting to a worker which has been
+ * unregistered fails.
+ */
+class WorkerDispatcherRegistry {
+public:
+  /**
+   * @param workers supplies the number of worker threads configured.
+   */
+  explicit WorkerDispatcherRegistry(uint32_t workers) : workers_(workers) {}
+
+  uint32_t registerWorker(Event::Dispatcher& dispatcher);
+  void unregisterWorker(uint32_t index);
+
+  /**
+   * Posts a callback to the dispatcher of a worker.
+   * @return false if the worker is not (or no longer) registered. The callback is then dropped.
+   */
+  bool post(uint32_t index, Event::PostCb callback);
+
+  /**
+   * @return the number of worker threads configured. The workers register asynchronously, so
+   *         this is the count all the workers agree on.
+   */
+  uint32_t workers() const { return workers_; }
+
+  /**
+   * @return whether all the configured workers registered so far, including the ones which have
+   *         since been unregistered. Until then, the index of a worker may not be final.
+   */
+  bool allRegistered() const;
+
+private:
+  const uint32_t workers_;
+  mutable absl::Mutex mutex_;
+  std::vector<Event::Dispatcher*> dispatchers_ ABSL_GUARDED_BY(mutex_);
+};
+
+using WorkerDispatcherRegistrySharedPtr = std::shared_ptr<WorkerDispatcherRegistry>;
+
+/**
+ * An HTTP/2 connection pool which does not own any connection: its streams are handed off to the
+ * pool of the worker owning the connections to the host, and all stream events are relayed between
+ * the two workers. Headers, bodies and metadata are copied when crossing threads.
+ */
+class SharedConnPool : public ConnectionPool::Instance,
+                       protected Logger::Loggable<Logger::Id::pool> {
+public:
+  // Returns the pool of the owner worker for the host. Called on the owner worker, may return
+  // nullptr if the host can not be served there.
+  using OwnerPoolCb = std::function<ConnectionPool::Instance*()>;
+
+  SharedConnPool(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+                 WorkerDispatcherRegistrySharedPtr workers, uint32_t worker, uint32_t owner_worker,
+                 OwnerPoolCb owner_pool);
+  ~SharedConnPool() override;
+
+  /**
+   * Returns the worker owning the connections to a host for streams created on a given worker.
+   * @param host supplies the upstream host.
+   * @param worker supplies the index of the worker creating streams.
+   * @param workers supplies the number of workers.
+   * @param owners supplies the number of workers owning connections to each host.
+   * @return the index of the owner worker, or absl::nullopt if the worker owns connections to the
+   *         host itself.
+   */
+  static absl::optional<uint32_t> ownerWorker(const Upstream::Host& host, uint32_t worker,
+                                              uint32_t workers, uint32_t owners);
+
+  // ConnectionPool::Instance
+  void addIdleCallback(IdleCb cb) override { idle_callbacks_.push_back(cb); }
+  bool isIdle() const override { return streams_.empty(); }
+  void drainConnections(Envoy::ConnectionPool::DrainBehavior drain_behavior) override;
+  Upstream::HostDescriptionConstSharedPtr host() const override { return host_; }
+  bool maybePreconnect(float) override { return false; }
+  bool hasActiveConnections() const override { return !streams_.empty(); }
+  ConnectionPool::Cancellable* newStream(Http::ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks,
+                                         const Instance::StreamOptions& options) override;
+  absl::string_view protocolDescription() const override { return "HTTP/2 (shared)"; }
+
+private:
+  class ProxyStream;
+  using ProxyStreamSharedPtr = std::shared_ptr<ProxyStream>;
+
+  /**
+   * A stream relayed to the owner worker. The object is shared between the two workers: the
+   * requesting worker holds it while the stream is in the pool, and the owner worker holds it
+   * while the stream of the owner pool references it. Members are only accessed on the worker
+   * named in their comment.
+   */
+  class ProxyStream : public std::enable_shared_from_this<ProxyStream>,
+                      public ConnectionPool::Cancellable,
+                      public RequestEncoder,
+                      public Stream,
+                      public StreamCallbackHelper,
+                      public ResponseDecoder,
+                      public StreamCallbacks,
+                      public ConnectionPool::Callbacks {
+  public:
+    ProxyStream(SharedConnPool& parent, ResponseDecoder& decoder,
+                ConnectionPool::Callbacks& callbacks);
+
+    // Requesting worker.
+    void onPoolDestroyed();
+
+    // ConnectionPool::Cancellable, requesting worker.
+    void cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) override;
+
+    // RequestEncoder, requesting worker.
+    Status encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
+    void encodeData(Buffer::Instance& data, bool end_stream) override;
+    void encodeTrailers(const RequestTrailerMap& trailers) override;
+    void encodeMetadata(const MetadataMapVector& metadata_map_vector) override;
+    void enableTcpTunneling() override {}
+    Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+    Stream& getStream() override { return *this; }
+
+    // Stream, requesting worker.
+    void addCallbacks(StreamCallbacks& callbacks) override { addCallbacksHelper(callbacks); }
+    void removeCallbacks(StreamCallbacks& callbacks) override { removeCallbacksHelper(callbacks); }
+    void resetStream(StreamResetReason reason) override;
+    void readDisable(bool disable) override;
+    uint32_t bufferLimit() const override { return buffer_limit_; }
+    const Network::Address::InstanceConstSharedPtr& connectionLocalAddress() override {
+      return connection_info_->downstreamAddressProvider().localAddress();
+    }
+    void setFlushTimeout(std::chrono::milliseconds timeout) override;
+    // Accounts are per worker, the buffers of the owner worker are not charged.
+    void setAccount(Buffer::BufferMemoryAccountSharedPtr) override {}
+    const StreamInfo::BytesMeterSharedPtr& bytesMeter() override { return bytes_meter_; }
+
+    // ResponseDecoder, owner worker.
+    void decode1xxHeaders(ResponseHeaderMapPtr&& headers) override;
+    void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) override;
+    void decodeData(Buffer::Instance& data, bool end_stream) override;
+    void decodeTrailers(ResponseTrailerMapPtr&& trailers) override;
+    void decodeMetadata(MetadataMapPtr&& metadata_map) override;
+    void dumpState(std::ostream& os, int indent_level) const override;
+
+    // StreamCallbacks, owner worker.
+    void onResetStream(StreamResetReason reason, absl::string_view) override;
+    void onAboveWriteBufferHighWatermark() override;
+    void onBelowWriteBufferLowWatermark() override;
+
+    // ConnectionPool::Callbacks, owner worker.
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       absl::string_view transport_failure_reason,
+                       Upstream::HostDescriptionConstSharedPtr host) override;
+    void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host,
+                     const StreamInfo::StreamInfo& info,
+                     absl::optional<Http::Protocol> protocol) override;
+
+    // Owner worker.
+    void onOwnerNewStream(const Instance::StreamOptions& options);
+
+    std::list<ProxyStreamSharedPtr>::iterator entry_;
+
+  private:
+    void postToRequester(std::function<void(ProxyStream&)> cb);
+    void postToOwner(std::function<void(ProxyStream&)> cb);
+    // Requesting worker. Removes the stream from the pool once both directions are complete.
+    void maybeRemove();
+    void remove();
+    // Owner worker.
+    void maybeReleaseOwner();
+    void releaseOwner();
+
+    const WorkerDispatcherRegistrySharedPtr workers_;
+    const uint32_t worker_;
+    const uint32_t owner_worker_;
+    const OwnerPoolCb owner_pool_;
+    const Upstream::HostDescriptionConstSharedPtr host_;
+
+    // Requesting worker.
+    SharedConnPool* parent_;
+    TimeSource& time_source_;
+    ResponseDecoder& decoder_;
+    ConnectionPool::Callbacks& callbacks_;
+    std::unique_ptr<StreamInfo::StreamInfoImpl> connection_info_;
+    StreamInfo::BytesMeterSharedPtr bytes_meter_{std::make_shared<StreamInfo::BytesMeter>()};
+    uint32_t buffer_limit_{};
+    bool ready_ : 1;
+    bool done_ : 1;
+    bool remote_end_stream_ : 1;
+
+    // Owner worker.
+    ProxyStreamSharedPtr owner_self_;
+    ConnectionPool::Cancellable* owner_cancellable_{};
+    RequestEncoder* owner_encoder_{};
+    bool owner_done_ : 1;
+    bool owner_local_end_stream_ : 1;
+    bool owner_remote_end_stream_ : 1;
+  };
+
+  void onStreamDone(ProxyStream& stream);
+
+  Event::Dispatcher& dispatcher_;
+  const Upstream::HostConstSharedPtr host_;
+  const WorkerDispatcherRegistrySharedPtr workers_;
+  const uint32_t worker_;
+  const uint32_t owner_worker_;
+  const OwnerPoolCb owner_pool_;
+  std::list<ProxyStreamSharedPtr> streams_;
+  std::list<IdleCb> idle_callbacks_;
+};
+
+} // namespace Http
+} // namespace Envoy
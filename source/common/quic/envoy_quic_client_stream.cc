@@ -59,7 +59,8 @@ Http::Status EnvoyQuicClientStream::encodeHeaders(const Http::RequestHeaderMap&
   }
   {
     IncrementalBytesSentTracker tracker(*this, *mutableBytesMeter(), true);
-    WriteHeaders(std::move(spdy_headers), end_stream, nullptr);
+    recordSentHeaderBlock(headers.byteSize(),
+                          WriteHeaders(std::move(spdy_headers), end_stream, nullptr));
   }
 
   if (local_end_stream_) {
@@ -112,7 +113,8 @@ void EnvoyQuicClientStream::encodeTrailers(const Http::RequestTrailerMap& traile
 
   {
     IncrementalBytesSentTracker tracker(*this, *mutableBytesMeter(), true);
-    WriteTrailers(envoyHeadersToSpdyHeaderBlock(trailers), nullptr);
+    recordSentHeaderBlock(trailers.byteSize(),
+                          WriteTrailers(envoyHeadersToSpdyHeaderBlock(trailers), nullptr));
   }
 
   onLocalEndStream();
@@ -145,6 +147,7 @@ void EnvoyQuicClientStream::switchStreamBlockState() {
 void EnvoyQuicClientStream::OnInitialHeadersComplete(bool fin, size_t frame_len,
                                                      const quic::QuicHeaderList& header_list) {
   mutableBytesMeter()->addHeaderBytesReceived(frame_len);
+  recordReceivedHeaderBlock(header_list, frame_len);
   if (read_side_closed()) {
     return;
   }
@@ -259,6 +262,7 @@ void EnvoyQuicClientStream::OnBodyAvailable() {
 void EnvoyQuicClientStream::OnTrailingHeadersComplete(bool fin, size_t frame_len,
                                                       const quic::QuicHeaderList& header_list) {
   mutableBytesMeter()->addHeaderBytesReceived(frame_len);
+  recordReceivedHeaderBlock(header_list, frame_len);
   if (read_side_closed()) {
     return;
   }
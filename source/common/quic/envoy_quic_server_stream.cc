@@ -50,7 +50,9 @@ void EnvoyQuicServerStream::encodeHeaders(const Http::ResponseHeaderMap& headers
   SendBufferMonitor::ScopedWatermarkBufferUpdater updater(this, this);
   {
     IncrementalBytesSentTracker tracker(*this, *mutableBytesMeter(), true);
-    WriteHeaders(envoyHeadersToSpdyHeaderBlock(headers), end_stream, nullptr);
+    const size_t block_bytes =
+        WriteHeaders(envoyHeadersToSpdyHeaderBlock(headers), end_stream, nullptr);
+    recordSentHeaderBlock(headers.byteSize(), block_bytes);
   }
 
   if (local_end_stream_) {
@@ -102,7 +104,8 @@ void EnvoyQuicServerStream::encodeTrailers(const Http::ResponseTrailerMap& trail
 
   {
     IncrementalBytesSentTracker tracker(*this, *mutableBytesMeter(), true);
-    WriteTrailers(envoyHeadersToSpdyHeaderBlock(trailers), nullptr);
+    recordSentHeaderBlock(trailers.byteSize(),
+                          WriteTrailers(envoyHeadersToSpdyHeaderBlock(trailers), nullptr));
   }
   onLocalEndStream();
 }
@@ -146,6 +149,7 @@ void EnvoyQuicServerStream::switchStreamBlockState() {
 void EnvoyQuicServerStream::OnInitialHeadersComplete(bool fin, size_t frame_len,
                                                      const quic::QuicHeaderList& header_list) {
   mutableBytesMeter()->addHeaderBytesReceived(frame_len);
+  recordReceivedHeaderBlock(header_list, frame_len);
   // TODO(danzh) Fix in QUICHE. If the stream has been reset in the call stack,
   // OnInitialHeadersComplete() shouldn't be called.
   if (read_side_closed()) {
@@ -242,6 +246,7 @@ void EnvoyQuicServerStream::OnBodyAvailable() {
 void EnvoyQuicServerStream::OnTrailingHeadersComplete(bool fin, size_t frame_len,
                                                       const quic::QuicHeaderList& header_list) {
   mutableBytesMeter()->addHeaderBytesReceived(frame_len);
+  recordReceivedHeaderBlock(header_list, frame_len);
   if (read_side_closed()) {
     return;
   }
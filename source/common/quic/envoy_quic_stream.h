@@ -155,6 +155,16 @@ protected:
 
   StreamInfo::BytesMeterSharedPtr& mutableBytesMeter() { return bytes_meter_; }
 
+  // Records the uncompressed size of a header block along with the size of its QPACK encoding.
+  void recordSentHeaderBlock(uint64_t header_bytes, uint64_t block_bytes) {
+    stats_.tx_header_bytes_.add(header_bytes);
+    stats_.tx_header_block_bytes_.add(block_bytes);
+  }
+  void recordReceivedHeaderBlock(const quic::QuicHeaderList& header_list, uint64_t block_bytes) {
+    stats_.rx_header_bytes_.add(header_list.uncompressed_header_bytes());
+    stats_.rx_header_block_bytes_.add(block_bytes);
+  }
+
   // True once end of stream is propagated to Envoy. Envoy doesn't expect to be
   // notified more than once about end of stream. So once this is true, no need
   // to set it in the callback to Envoy stream any more.
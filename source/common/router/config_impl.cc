@@ -206,7 +206,16 @@ std::string SslRedirector::newPath(const Http::RequestHeaderMap& headers) const
 HedgePolicyImpl::HedgePolicyImpl(const envoy::config::route::v3::HedgePolicy& hedge_policy)
     : initial_requests_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(hedge_policy, initial_requests, 1)),
       additional_request_chance_(hedge_policy.additional_request_chance()),
-      hedge_on_per_try_timeout_(hedge_policy.hedge_on_per_try_timeout()) {}
+      hedge_on_per_try_timeout_(hedge_policy.hedge_on_per_try_timeout()) {
+  if (hedge_policy.has_latency_based_hedging()) {
+    const auto& latency_hedging = hedge_policy.latency_based_hedging();
+    latency_hedging_ = LatencyHedgingConfig{
+        PROTOBUF_PERCENT_TO_DOUBLE_OR_DEFAULT(latency_hedging, latency_percentile, 95.0),
+        std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(latency_hedging, min_delay, 0)),
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(latency_hedging, min_samples, 100),
+        PROTOBUF_PERCENT_TO_DOUBLE_OR_DEFAULT(latency_hedging, budget_percent, 10.0)};
+  }
+}
 
 HedgePolicyImpl::HedgePolicyImpl() : initial_requests_(1), hedge_on_per_try_timeout_(false) {}
 
@@ -389,6 +398,7 @@ ShadowPolicyImpl::ShadowPolicyImpl(const RequestMirrorPolicy& config) {
     default_value_.set_denominator(envoy::type::v3::FractionalPercent::HUNDRED);
   }
   trace_sampled_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, trace_sampled, true);
+  stream_body_ = config.stream_body();
 }
 
 DecoratorImpl::DecoratorImpl(const envoy::config::route::v3::Decorator& decorator)
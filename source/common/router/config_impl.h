@@ -375,12 +375,14 @@ public:
   const std::string& runtimeKey() const override { return runtime_key_; }
   const envoy::type::v3::FractionalPercent& defaultValue() const override { return default_value_; }
   bool traceSampled() const override { return trace_sampled_; }
+  bool streamBody() const override { return stream_body_; }
 
 private:
   std::string cluster_;
   std::string runtime_key_;
   envoy::type::v3::FractionalPercent default_value_;
   bool trace_sampled_;
+  bool stream_body_;
 };
 
 /**
@@ -398,11 +400,15 @@ public:
     return additional_request_chance_;
   }
   bool hedgeOnPerTryTimeout() const override { return hedge_on_per_try_timeout_; }
+  const absl::optional<LatencyHedgingConfig>& latencyHedging() const override {
+    return latency_hedging_;
+  }
 
 private:
   const uint32_t initial_requests_;
   const envoy::type::v3::FractionalPercent additional_request_chance_;
   const bool hedge_on_per_try_timeout_;
+  absl::optional<LatencyHedgingConfig> latency_hedging_;
 };
 
 /**
@@ -370,6 +370,12 @@ RetryStatus RetryStateImpl::shouldHedgeRetryPerTryTimeout(DoRetryCallback callba
   return shouldRetry(RetryState::RetryDecision::RetryWithBackoff, callback);
 }
 
+RetryStatus RetryStateImpl::shouldHedgeRetryLatency(DoRetryCallback callback) {
+  // Latency based hedges are sent right away: backing off would delay the hedged request past the
+  // latency it is meant to cut.
+  return shouldRetry(RetryState::RetryDecision::RetryImmediately, callback);
+}
+
 RetryState::RetryDecision
 RetryStateImpl::wouldRetryFromHeaders(const Http::ResponseHeaderMap& response_headers,
                                       const Http::RequestHeaderMap& original_request,
@@ -65,6 +65,7 @@ public:
   RetryStatus shouldRetryReset(Http::StreamResetReason reset_reason, Http3Used http3_used,
                                DoRetryResetCallback callback) override;
   RetryStatus shouldHedgeRetryPerTryTimeout(DoRetryCallback callback) override;
+  RetryStatus shouldHedgeRetryLatency(DoRetryCallback callback) override;
 
   void onHostAttempted(Upstream::HostDescriptionConstSharedPtr host) override {
     std::for_each(retry_host_predicates_.begin(), retry_host_predicates_.end(),
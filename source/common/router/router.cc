@@ -669,6 +669,9 @@ Http::FilterHeadersStatus Filter::decodeHeaders(Http::RequestHeaderMap& headers,
       active_shadow_policies_.push_back(std::cref(policy_ref));
     }
   }
+  if (!end_stream) {
+    maybeStartStreamingShadows();
+  }
 
   ENVOY_STREAM_LOG(debug, "router decoding headers:\n{}", *callbacks_, headers);
 
@@ -749,6 +752,7 @@ Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_strea
     retry_state_.reset();
     buffering = false;
     active_shadow_policies_.clear();
+    request_body_.clear();
     request_buffer_overflowed_ = true;
 
     // If we had to abandon buffering and there's no request in progress, abort the request and
@@ -768,22 +772,36 @@ Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_strea
   // already.
   ASSERT(buffering || !upstream_requests_.empty());
 
-  if (buffering) {
-    // If we are going to buffer for retries or shadowing, we need to make a copy before encoding
-    // since it's all moves from here on.
-    if (!upstream_requests_.empty()) {
-      Buffer::OwnedImpl copy(data);
-      upstream_requests_.front()->encodeData(copy, end_stream);
+  if (!buffering && shadow_streams_.empty()) {
+    upstream_requests_.front()->encodeData(data, end_stream);
+  } else {
+    // The data goes to several streams. Rather than copying it for each of them since it's all
+    // moves from here on, move it into an immutable chunk and hand out fragments of it.
+    const SharedBodyChunkConstSharedPtr chunk = SharedBodyChunk::create(data);
+    for (auto& shadow_stream : shadow_streams_) {
+      Buffer::OwnedImpl shadow_data;
+      chunk->addTo(shadow_data);
+      shadow_stream->sendData(shadow_data, end_stream);
     }
+    if (buffering) {
+      if (!upstream_requests_.empty()) {
+        Buffer::OwnedImpl upstream_data;
+        chunk->addTo(upstream_data);
+        upstream_requests_.front()->encodeData(upstream_data, end_stream);
+      }
 
-    // If we are potentially going to retry or shadow this request we need to buffer.
-    // This will not cause the connection manager to 413 because before we hit the
-    // buffer limit we give up on retries and buffering. We must buffer using addDecodedData()
-    // so that all buffered data is available by the time we do request complete processing and
-    // potentially shadow.
-    callbacks_->addDecodedData(data, true);
-  } else {
-    upstream_requests_.front()->encodeData(data, end_stream);
+      // If we are potentially going to retry or shadow this request we need to buffer.
+      // This will not cause the connection manager to 413 because before we hit the
+      // buffer limit we give up on retries and buffering. We must buffer using addDecodedData()
+      // so that all buffered data is available by the time we do request complete processing and
+      // potentially shadow.
+      request_body_.add(chunk);
+      chunk->addTo(data);
+      callbacks_->addDecodedData(data, true);
+    } else {
+      chunk->addTo(data);
+      upstream_requests_.front()->encodeData(data, end_stream);
+    }
   }
 
   if (end_stream) {
@@ -806,6 +824,9 @@ Http::FilterTrailersStatus Filter::decodeTrailers(Http::RequestTrailerMap& trail
   for (auto& upstream_request : upstream_requests_) {
     upstream_request->encodeTrailers(trailers);
   }
+  for (auto& shadow_stream : shadow_streams_) {
+    shadow_stream->sendTrailers(trailers);
+  }
   onRequestComplete();
   return Http::FilterTrailersStatus::StopIteration;
 }
@@ -844,6 +865,16 @@ void Filter::cleanup() {
   }
 }
 
+void Filter::addBufferedBody(Buffer::Instance& buffer) const {
+  const Buffer::Instance& buffered_body = *callbacks_->decodingBuffer();
+  if (request_body_.length() == buffered_body.length()) {
+    request_body_.addTo(buffer);
+  } else {
+    // Part of the buffered body did not go through decodeData(), fall back to copying it.
+    buffer.add(buffered_body);
+  }
+}
+
 void Filter::maybeDoShadowing() {
   for (const auto& shadow_policy_wrapper : active_shadow_policies_) {
     const auto& shadow_policy = shadow_policy_wrapper.get();
@@ -852,7 +883,7 @@ void Filter::maybeDoShadowing() {
     Http::RequestMessagePtr request(new Http::RequestMessageImpl(
         Http::createHeaderMap<Http::RequestHeaderMapImpl>(*downstream_headers_)));
     if (callbacks_->decodingBuffer()) {
-      request->body().add(*callbacks_->decodingBuffer());
+      addBufferedBody(request->body());
     }
     if (downstream_trailers_) {
       request->trailers(Http::createHeaderMap<Http::RequestTrailerMapImpl>(*downstream_trailers_));
@@ -867,10 +898,35 @@ void Filter::maybeDoShadowing() {
   }
 }
 
+void Filter::maybeStartStreamingShadows() {
+  // Streamed shadows start along with the upstream request and do not need the request body to be
+  // buffered, which only the remaining shadow policies do.
+  std::vector<std::reference_wrapper<const ShadowPolicy>> buffered_shadow_policies;
+  for (const auto& shadow_policy_wrapper : active_shadow_policies_) {
+    const auto& shadow_policy = shadow_policy_wrapper.get();
+    if (!shadow_policy.streamBody()) {
+      buffered_shadow_policies.push_back(shadow_policy_wrapper);
+      continue;
+    }
+
+    ASSERT(!shadow_policy.cluster().empty());
+    auto options = Http::AsyncClient::StreamOptions().setTimeout(timeout_.global_timeout_);
+    ShadowStreamPtr shadow_stream = config_.shadowWriter().streamingShadow(
+        shadow_policy.cluster(),
+        Http::createHeaderMap<Http::RequestHeaderMapImpl>(*downstream_headers_), options);
+    if (shadow_stream != nullptr) {
+      shadow_streams_.push_back(std::move(shadow_stream));
+    }
+  }
+  active_shadow_policies_ = std::move(buffered_shadow_policies);
+}
+
 void Filter::onRequestComplete() {
   // This should be called exactly once, when the downstream request has been received in full.
   ASSERT(!downstream_end_stream_);
   downstream_end_stream_ = true;
+  // The streamed shadows have been sent the whole request and complete on their own.
+  shadow_streams_.clear();
   Event::Dispatcher& dispatcher = callbacks_->dispatcher();
   downstream_request_complete_time_ = dispatcher.timeSource().monotonicTime();
 
@@ -896,6 +952,8 @@ void Filter::onRequestComplete() {
 void Filter::onDestroy() {
   // Reset any in-flight upstream requests.
   resetAll();
+  // Reset the streamed shadows which have not been sent the whole request.
+  shadow_streams_.clear();
   cleanup();
 }
 
@@ -964,7 +1022,7 @@ void Filter::onSoftPerTryTimeout(UpstreamRequest& upstream_request) {
           // Without any knowledge about what's going on in the connection pool, retry the request
           // with the safest settings which is no early data but keep using or not using alt-svc as
           // before. In this way, QUIC won't be falsely marked as broken.
-          doRetry(/*can_send_early_data*/ false, can_use_http3);
+          doRetry(/*can_send_early_data*/ false, can_use_http3, /*latency_hedge*/ false);
         });
 
     if (retry_status == RetryStatus::Yes) {
@@ -986,6 +1044,38 @@ void Filter::onSoftPerTryTimeout(UpstreamRequest& upstream_request) {
   }
 }
 
+// Called when an upstream request takes longer than the configured percentile of the recent
+// latency of the cluster (latency_based_hedging enabled).
+void Filter::onLatencyHedgeTimeout(UpstreamRequest& upstream_request) {
+  if (downstream_response_started_ || !retry_state_ || upstream_request.retried()) {
+    return;
+  }
+
+  // The budget is checked before the retry policy, which counts the hedge as a retry, but is only
+  // charged once the retry policy accepts the hedge. Workers hedging at the same time may overrun
+  // it slightly.
+  const LatencyHedgingConfig& latency_hedging = *route_entry_->hedgePolicy().latencyHedging();
+  Upstream::ResponseLatencyTracker& latency_tracker = cluster_->responseLatencyTracker();
+  if (!latency_tracker.hedgeBudgetAvailable(latency_hedging.budget_percent_)) {
+    cluster_->stats().upstream_rq_latency_hedge_budget_exceeded_.inc();
+    return;
+  }
+
+  const RetryStatus retry_status = retry_state_->shouldHedgeRetryLatency(
+      [this, can_use_http3 = upstream_request.upstreamStreamOptions().can_use_http3_]() -> void {
+        doRetry(/*can_send_early_data*/ false, can_use_http3, /*latency_hedge*/ true);
+      });
+  if (retry_status == RetryStatus::Yes) {
+    latency_tracker.recordHedge();
+    runRetryOptionsPredicates(upstream_request);
+    pending_retries_++;
+    // The original request keeps going: the first good response wins and the other requests are
+    // reset in resetOtherUpstreams().
+    upstream_request.retried(true);
+    cluster_->stats().upstream_rq_latency_hedge_.inc();
+  }
+}
+
 void Filter::onPerTryIdleTimeout(UpstreamRequest& upstream_request) {
   onPerTryTimeoutCommon(upstream_request, cluster_->stats().upstream_rq_per_try_idle_timeout_,
                         StreamInfo::ResponseCodeDetails::get().UpstreamPerTryIdleTimeout);
@@ -1021,6 +1111,13 @@ void Filter::onPerTryTimeoutCommon(UpstreamRequest& upstream_request, Stats::Cou
 
   // Remove this upstream request from the list now that we're done with it.
   upstream_request.removeFromList(upstream_requests_);
+
+  // If a latency hedge or the request it hedged is still in flight, it might see an upstream
+  // response, so don't return anything downstream.
+  if (numRequestsAwaitingHeaders() > 0 || pending_retries_ > 0) {
+    return;
+  }
+
   onUpstreamTimeoutAbort(StreamInfo::ResponseFlag::UpstreamRequestTimeout, response_code_details);
 }
 
@@ -1137,7 +1234,8 @@ bool Filter::maybeRetryReset(Http::StreamResetReason reset_reason,
         // This retry might be because of ConnectionFailure of 0-RTT handshake. In this case, though
         // the original request is retried with the same can_send_early_data setting, it will not be
         // sent as early data by the underlying connection pool grid.
-        doRetry(can_send_early_data, disable_http3 ? false : can_use_http3);
+        doRetry(can_send_early_data, disable_http3 ? false : can_use_http3,
+                /*latency_hedge*/ false);
       });
   if (retry_status == RetryStatus::Yes) {
     runRetryOptionsPredicates(upstream_request);
@@ -1373,7 +1471,8 @@ void Filter::onUpstreamHeaders(uint64_t response_code, Http::ResponseHeaderMapPt
           [this, can_use_http3 = upstream_request.upstreamStreamOptions().can_use_http3_,
            had_early_data = upstream_request.upstreamStreamOptions().can_send_early_data_](
               bool disable_early_data) -> void {
-            doRetry((disable_early_data ? false : had_early_data), can_use_http3);
+            doRetry((disable_early_data ? false : had_early_data), can_use_http3,
+                    /*latency_hedge*/ false);
           });
       if (retry_status == RetryStatus::Yes) {
         runRetryOptionsPredicates(upstream_request);
@@ -1474,6 +1573,9 @@ void Filter::onUpstreamHeaders(uint64_t response_code, Http::ResponseHeaderMapPt
   final_upstream_request_ = &upstream_request;
   // Make sure that for request hedging, we end up with the correct final upstream info.
   callbacks_->streamInfo().setUpstreamInfo(final_upstream_request_->streamInfo().upstreamInfo());
+  if (upstream_request.latencyHedge()) {
+    cluster_->stats().upstream_rq_latency_hedge_won_.inc();
+  }
   resetOtherUpstreams(upstream_request);
   if (end_stream) {
     onUpstreamComplete(upstream_request);
@@ -1745,7 +1847,7 @@ void Filter::runRetryOptionsPredicates(UpstreamRequest& retriable_request) {
   }
 }
 
-void Filter::doRetry(bool can_send_early_data, bool can_use_http3) {
+void Filter::doRetry(bool can_send_early_data, bool can_use_http3, bool latency_hedge) {
   ENVOY_STREAM_LOG(debug, "performing retry", *callbacks_);
 
   is_retry_ = true;
@@ -1759,7 +1861,9 @@ void Filter::doRetry(bool can_send_early_data, bool can_use_http3) {
   std::unique_ptr<GenericConnPool> generic_conn_pool;
   if (cluster != nullptr) {
     cluster_ = cluster->info();
+    selecting_latency_hedge_host_ = latency_hedge;
     generic_conn_pool = createConnPool(*cluster);
+    selecting_latency_hedge_host_ = false;
   }
 
   if (!generic_conn_pool) {
@@ -1769,6 +1873,7 @@ void Filter::doRetry(bool can_send_early_data, bool can_use_http3) {
   }
   UpstreamRequestPtr upstream_request = std::make_unique<UpstreamRequest>(
       *this, std::move(generic_conn_pool), can_send_early_data, can_use_http3);
+  upstream_request->latencyHedge(latency_hedge);
 
   if (include_attempt_count_in_request_) {
     downstream_headers_->setEnvoyAttemptCount(attempt_count_);
@@ -1802,9 +1907,10 @@ void Filter::doRetry(bool can_send_early_data, bool can_use_http3) {
   // sure we don't encodeData on the wrong request.
   if (!upstream_requests_.empty() && (upstream_requests_.front().get() == upstream_request_tmp)) {
     if (callbacks_->decodingBuffer()) {
-      // If we are doing a retry we need to make a copy.
-      Buffer::OwnedImpl copy(*callbacks_->decodingBuffer());
-      upstream_requests_.front()->encodeData(copy, !downstream_trailers_ && downstream_end_stream_);
+      // If we are doing a retry it gets its own view of the buffered body.
+      Buffer::OwnedImpl body;
+      addBufferedBody(body);
+      upstream_requests_.front()->encodeData(body, !downstream_trailers_ && downstream_end_stream_);
     }
 
     if (downstream_trailers_) {
@@ -1813,6 +1919,12 @@ void Filter::doRetry(bool can_send_early_data, bool can_use_http3) {
   }
 }
 
+bool Filter::hasUpstreamRequestToHost(const Upstream::Host& host) const {
+  return std::any_of(
+      upstream_requests_.begin(), upstream_requests_.end(),
+      [&host](const auto& req) -> bool { return req->upstreamHost().get() == &host; });
+}
+
 uint32_t Filter::numRequestsAwaitingHeaders() {
   return std::count_if(upstream_requests_.begin(), upstream_requests_.end(),
                        [](const auto& req) -> bool { return req->awaitingHeaders(); });
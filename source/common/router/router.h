@@ -33,6 +33,7 @@
 #include "source/common/http/utility.h"
 #include "source/common/router/config_impl.h"
 #include "source/common/router/context_impl.h"
+#include "source/common/router/shared_body.h"
 #include "source/common/router/upstream_request.h"
 #include "source/common/stats/symbol_table.h"
 #include "source/common/stream_info/stream_info_impl.h"
@@ -291,6 +292,7 @@ public:
   virtual void onUpstreamHostSelected(Upstream::HostDescriptionConstSharedPtr host) PURE;
   virtual void onPerTryTimeout(UpstreamRequest& upstream_request) PURE;
   virtual void onPerTryIdleTimeout(UpstreamRequest& upstream_request) PURE;
+  virtual void onLatencyHedgeTimeout(UpstreamRequest& upstream_request) PURE;
   virtual void onStreamMaxDurationReached(UpstreamRequest& upstream_request) PURE;
 
   virtual Http::StreamDecoderFilterCallbacks* callbacks() PURE;
@@ -321,7 +323,7 @@ public:
   Filter(FilterConfig& config)
       : config_(config), final_upstream_request_(nullptr), downstream_1xx_headers_encoded_(false),
         downstream_response_started_(false), downstream_end_stream_(false), is_retry_(false),
-        request_buffer_overflowed_(false) {}
+        request_buffer_overflowed_(false), selecting_latency_hedge_host_(false) {}
 
   ~Filter() override;
 
@@ -393,6 +395,10 @@ public:
     }
 
     ASSERT(retry_state_);
+    // Latency based hedges are meant to go to a host other than the slow one.
+    if (selecting_latency_hedge_host_ && hasUpstreamRequestToHost(host)) {
+      return true;
+    }
     return retry_state_->shouldSelectAnotherHost(host);
   }
 
@@ -474,6 +480,7 @@ public:
   void onUpstreamHostSelected(Upstream::HostDescriptionConstSharedPtr host) override;
   void onPerTryTimeout(UpstreamRequest& upstream_request) override;
   void onPerTryIdleTimeout(UpstreamRequest& upstream_request) override;
+  void onLatencyHedgeTimeout(UpstreamRequest& upstream_request) override;
   void onStreamMaxDurationReached(UpstreamRequest& upstream_request) override;
   Http::StreamDecoderFilterCallbacks* callbacks() override { return callbacks_; }
   Upstream::ClusterInfoConstSharedPtr cluster() override { return cluster_; }
@@ -526,7 +533,10 @@ private:
   createConnPool(Upstream::ThreadLocalCluster& thread_local_cluster);
   UpstreamRequestPtr createUpstreamRequest();
 
+  // Adds the buffered request body to a buffer for a retry or a shadow.
+  void addBufferedBody(Buffer::Instance& buffer) const;
   void maybeDoShadowing();
+  void maybeStartStreamingShadows();
   bool maybeRetryReset(Http::StreamResetReason reset_reason, UpstreamRequest& upstream_request);
   uint32_t numRequestsAwaitingHeaders();
   void onGlobalTimeout();
@@ -555,7 +565,8 @@ private:
                                                 uint64_t status_code);
   void updateOutlierDetection(Upstream::Outlier::Result result, UpstreamRequest& upstream_request,
                               absl::optional<uint64_t> code);
-  void doRetry(bool can_send_early_data, bool can_use_http3);
+  void doRetry(bool can_send_early_data, bool can_use_http3, bool latency_hedge);
+  bool hasUpstreamRequestToHost(const Upstream::Host& host) const;
   void runRetryOptionsPredicates(UpstreamRequest& retriable_request);
   // Called immediately after a non-5xx header is received from upstream, performs stats accounting
   // and handle difference between gRPC and non-gRPC requests.
@@ -589,6 +600,10 @@ private:
   MetadataMatchCriteriaConstPtr metadata_match_;
   std::function<void(Http::ResponseHeaderMap&)> modify_headers_;
   std::vector<std::reference_wrapper<const ShadowPolicy>> active_shadow_policies_{};
+  // Shadows of the request which are sent the body as it is received.
+  std::vector<ShadowStreamPtr> shadow_streams_;
+  // The buffered request body, shared with the retries and shadows.
+  SharedBody request_body_;
   // The stream lifetime configured by request header.
   absl::optional<std::chrono::milliseconds> dynamic_max_stream_duration_;
   // list of cookies to add to upstream headers
@@ -601,6 +616,8 @@ private:
   bool include_attempt_count_in_request_ : 1;
   bool request_buffer_overflowed_ : 1;
   bool conn_pool_new_stream_with_early_data_and_http3_ : 1;
+  // True while choosing the host of a latency based hedge.
+  bool selecting_latency_hedge_host_ : 1;
   uint32_t attempt_count_{1};
   uint32_t pending_retries_{0};
 
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "source/common/common/assert.h"
+#include "source/common/http/header_map_impl.h"
 #include "source/common/http/headers.h"
 
 #include "absl/strings/str_join.h"
@@ -11,27 +12,146 @@
 namespace Envoy {
 namespace Router {
 
-void ShadowWriterImpl::shadow(const std::string& cluster, Http::RequestMessagePtr&& request,
-                              const Http::AsyncClient::RequestOptions& options) {
+namespace {
+
+/**
+ * The async client stream of a streamed shadow request. It owns itself until the stream completes
+ * or is reset, and may outlive the ShadowStream handed to the router.
+ */
+class ActiveShadowStream : public Http::AsyncClient::StreamCallbacks {
+public:
+  ActiveShadowStream(Http::RequestHeaderMapPtr&& headers) : headers_(std::move(headers)) {}
+
+  // The stream may fail, complete or be reset inline, which deletes this object and clears the
+  // handle.
+  void start(Http::AsyncClient& client, const Http::AsyncClient::StreamOptions& options,
+             ActiveShadowStream*& handle) {
+    handle_ = &handle;
+    stream_ = client.start(*this, options);
+    if (stream_ == nullptr) {
+      destroy();
+      return;
+    }
+    stream_->sendHeaders(*headers_, false);
+  }
+
+  void sendData(Buffer::Instance& data, bool end_stream) {
+    local_complete_ = end_stream;
+    stream_->sendData(data, end_stream);
+  }
+
+  void sendTrailers(const Http::RequestTrailerMap& trailers) {
+    local_complete_ = true;
+    trailers_ = Http::createHeaderMap<Http::RequestTrailerMapImpl>(trailers);
+    stream_->sendTrailers(*trailers_);
+  }
+
+  // Called when the router no longer streams the request.
+  void detach() {
+    handle_ = nullptr;
+    if (!local_complete_) {
+      // Do not let a partial request go through. This deletes this object.
+      stream_->reset();
+    }
+  }
+
+  // Http::AsyncClient::StreamCallbacks
+  void onHeaders(Http::ResponseHeaderMapPtr&&, bool) override {}
+  void onData(Buffer::Instance&, bool) override {}
+  void onTrailers(Http::ResponseTrailerMapPtr&&) override {}
+  void onComplete() override { destroy(); }
+  void onReset() override { destroy(); }
+
+private:
+  void destroy() {
+    if (handle_ != nullptr) {
+      *handle_ = nullptr;
+    }
+    delete this;
+  }
+
+  // The headers and trailers must outlive the stream.
+  Http::RequestHeaderMapPtr headers_;
+  Http::RequestTrailerMapPtr trailers_;
+  Http::AsyncClient::Stream* stream_{};
+  ActiveShadowStream** handle_{};
+  bool local_complete_{};
+};
+
+class ShadowStreamImpl : public ShadowStream {
+public:
+  ~ShadowStreamImpl() override {
+    if (active_ != nullptr) {
+      active_->detach();
+    }
+  }
+
+  // Router::ShadowStream
+  void sendData(Buffer::Instance& data, bool end_stream) override {
+    if (active_ != nullptr) {
+      active_->sendData(data, end_stream);
+    } else {
+      data.drain(data.length());
+    }
+  }
+  void sendTrailers(const Http::RequestTrailerMap& trailers) override {
+    if (active_ != nullptr) {
+      active_->sendTrailers(trailers);
+    }
+  }
+
+  // Cleared when the shadow stream completes or is reset before the request has been sent.
+  ActiveShadowStream* active_{};
+};
+
+} // namespace
+
+Upstream::ThreadLocalCluster* ShadowWriterImpl::prepareShadow(const std::string& cluster,
+                                                              Http::RequestHeaderMap& headers) {
   // It's possible that the cluster specified in the route configuration no longer exists due
   // to a CDS removal. Check that it still exists before shadowing.
   // TODO(mattklein123): Optimally we would have a stat but for now just fix the crashing issue.
   const auto thread_local_cluster = cm_.getThreadLocalCluster(cluster);
   if (thread_local_cluster == nullptr) {
     ENVOY_LOG(debug, "shadow cluster '{}' does not exist", cluster);
-    return;
+    return nullptr;
   }
 
-  ASSERT(!request->headers().getHostValue().empty());
+  ASSERT(!headers.getHostValue().empty());
   // Switch authority to add a shadow postfix. This allows upstream logging to make more sense.
-  auto parts = StringUtil::splitToken(request->headers().getHostValue(), ":");
+  auto parts = StringUtil::splitToken(headers.getHostValue(), ":");
   ASSERT(!parts.empty() && parts.size() <= 2);
-  request->headers().setHost(parts.size() == 2
-                                 ? absl::StrJoin(parts, "-shadow:")
-                                 : absl::StrCat(request->headers().getHostValue(), "-shadow"));
+  headers.setHost(parts.size() == 2 ? absl::StrJoin(parts, "-shadow:")
+                                    : absl::StrCat(headers.getHostValue(), "-shadow"));
+  return thread_local_cluster;
+}
+
+void ShadowWriterImpl::shadow(const std::string& cluster, Http::RequestMessagePtr&& request,
+                              const Http::AsyncClient::RequestOptions& options) {
+  const auto thread_local_cluster = prepareShadow(cluster, request->headers());
+  if (thread_local_cluster == nullptr) {
+    return;
+  }
   // This is basically fire and forget. We don't handle cancelling.
   thread_local_cluster->httpAsyncClient().send(std::move(request), *this, options);
 }
 
+ShadowStreamPtr ShadowWriterImpl::streamingShadow(const std::string& cluster,
+                                                  Http::RequestHeaderMapPtr&& headers,
+                                                  const Http::AsyncClient::StreamOptions& options) {
+  const auto thread_local_cluster = prepareShadow(cluster, *headers);
+  if (thread_local_cluster == nullptr) {
+    return nullptr;
+  }
+  auto shadow_stream = std::make_unique<ShadowStreamImpl>();
+  shadow_stream->active_ = new ActiveShadowStream(std::move(headers));
+  shadow_stream->active_->start(thread_local_cluster->httpAsyncClient(), options,
+                                shadow_stream->active_);
+  if (shadow_stream->active_ == nullptr) {
+    return nullptr;
+  }
+  return shadow_stream;
+}
+
 } // namespace Router
 } // namespace Envoy
@@ -22,6 +22,8 @@ public:
   // Router::ShadowWriter
   void shadow(const std::string& cluster, Http::RequestMessagePtr&& request,
               const Http::AsyncClient::RequestOptions& options) override;
+  ShadowStreamPtr streamingShadow(const std::string& cluster, Http::RequestHeaderMapPtr&& headers,
+                                  const Http::AsyncClient::StreamOptions& options) override;
 
   // Http::AsyncClient::Callbacks
   void onSuccess(const Http::AsyncClient::Request&, Http::ResponseMessagePtr&&) override {}
@@ -30,6 +32,11 @@ public:
                                     const Http::ResponseHeaderMap*) override {}
 
 private:
+  // Returns the cluster to shadow to after adding a shadow postfix to the authority of a request,
+  // or nullptr if the cluster does not exist.
+  Upstream::ThreadLocalCluster* prepareShadow(const std::string& cluster,
+                                              Http::RequestHeaderMap& headers);
+
   Upstream::ClusterManager& cm_;
 };
 
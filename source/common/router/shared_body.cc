@@ -0,0 +1,42 @@
+#include "source/common/router/shared_body.h"
+
+namespace Envoy {
+namespace Router {
+
+SharedBodyChunkConstSharedPtr SharedBodyChunk::create(Buffer::Instance& data) {
+  std::shared_ptr<SharedBodyChunk> chunk(new SharedBodyChunk());
+  chunk->data_.move(data);
+  return chunk;
+}
+
+void SharedBodyChunk::addTo(Buffer::Instance& buffer) const {
+  for (const Buffer::RawSlice& slice : data_.getRawSlices()) {
+    // Each fragment holds a reference to the chunk, which is released when the buffer drains it.
+    auto* fragment = new Buffer::BufferFragmentImpl(
+        slice.mem_, slice.len_,
+        [chunk = shared_from_this()](const void*, size_t,
+                                     const Buffer::BufferFragmentImpl* fragment) {
+          delete fragment;
+        });
+    buffer.addBufferFragment(*fragment);
+  }
+}
+
+void SharedBody::add(SharedBodyChunkConstSharedPtr chunk) {
+  length_ += chunk->length();
+  chunks_.push_back(std::move(chunk));
+}
+
+void SharedBody::addTo(Buffer::Instance& buffer) const {
+  for (const auto& chunk : chunks_) {
+    chunk->addTo(buffer);
+  }
+}
+
+void SharedBody::clear() {
+  chunks_.clear();
+  length_ = 0;
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+
+#include "source/common/buffer/buffer_impl.h"
+
+namespace Envoy {
+namespace Router {
+
+class SharedBodyChunk;
+using SharedBodyChunkConstSharedPtr = std::shared_ptr<const SharedBodyChunk>;
+
+/**
+ * An immutable piece of a request body shared by several upstream streams. Buffers get the data
+ * as fragments referencing the chunk instead of copies, and the chunk is freed once the last of
+ * these fragments has been drained.
+ */
+class SharedBodyChunk : public std::enable_shared_from_this<SharedBodyChunk> {
+public:
+  /**
+   * Creates a chunk by moving data into it.
+   * @param data supplies the data, which is drained.
+   */
+  static SharedBodyChunkConstSharedPtr create(Buffer::Instance& data);
+
+  /**
+   * Adds fragments referencing the chunk to a buffer.
+   * @param buffer supplies the buffer to add to.
+   */
+  void addTo(Buffer::Instance& buffer) const;
+
+  uint64_t length() const { return data_.length(); }
+
+private:
+  SharedBodyChunk() = default;
+
+  Buffer::OwnedImpl data_;
+};
+
+/**
+ * A request body made of shared chunks, which retries and shadows add to their own buffers
+ * without copying it.
+ */
+class SharedBody {
+public:
+  void add(SharedBodyChunkConstSharedPtr chunk);
+
+  /**
+   * Adds fragments referencing the whole body to a buffer.
+   * @param buffer supplies the buffer to add to.
+   */
+  void addTo(Buffer::Instance& buffer) const;
+
+  void clear();
+  uint64_t length() const { return length_; }
+
+private:
+  std::vector<SharedBodyChunkConstSharedPtr> chunks_;
+  uint64_t length_{};
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -48,8 +48,8 @@ UpstreamRequest::UpstreamRequest(RouterFilterInterface& parent,
       stream_info_(parent_.callbacks()->dispatcher().timeSource(), nullptr),
       start_time_(parent_.callbacks()->dispatcher().timeSource().monotonicTime()),
       calling_encode_headers_(false), upstream_canary_(false), decode_complete_(false),
-      encode_complete_(false), encode_trailers_(false), retried_(false), awaiting_headers_(true),
-      outlier_detection_timeout_recorded_(false),
+      encode_complete_(false), encode_trailers_(false), retried_(false), latency_hedge_(false),
+      awaiting_headers_(true), outlier_detection_timeout_recorded_(false),
       create_per_try_timeout_on_request_complete_(false), paused_for_connect_(false),
       record_timeout_budget_(parent_.cluster()->timeoutBudgetStats().has_value()),
       cleaned_up_(false), had_upstream_(false),
@@ -95,6 +95,9 @@ void UpstreamRequest::cleanUp() {
     // Allows for testing.
     per_try_idle_timeout_->disableTimer();
   }
+  if (latency_hedge_timer_ != nullptr) {
+    latency_hedge_timer_->disableTimer();
+  }
   if (max_stream_duration_timer_ != nullptr) {
     max_stream_duration_timer_->disableTimer();
   }
@@ -175,6 +178,16 @@ void UpstreamRequest::decodeHeaders(Http::ResponseHeaderMapPtr&& headers, bool e
   upstreamTiming().onFirstUpstreamRxByteReceived(parent_.callbacks()->dispatcher().timeSource());
   maybeEndDecode(end_stream);
 
+  if (latency_start_time_.has_value()) {
+    if (latency_hedge_timer_ != nullptr) {
+      latency_hedge_timer_->disableTimer();
+    }
+    parent_.cluster()->responseLatencyTracker().recordLatency(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            parent_.callbacks()->dispatcher().timeSource().monotonicTime() -
+            latency_start_time_.value()));
+  }
+
   awaiting_headers_ = false;
   if (!parent_.config().upstream_logs_.empty()) {
     upstream_headers_ = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*headers);
@@ -366,6 +379,31 @@ void UpstreamRequest::setupPerTryTimeout() {
         parent_.callbacks()->dispatcher().createTimer([this]() -> void { onPerTryIdleTimeout(); });
     resetPerTryIdleTimer();
   }
+
+  const absl::optional<LatencyHedgingConfig>& latency_hedging =
+      parent_.routeEntry()->hedgePolicy().latencyHedging();
+  if (latency_hedging.has_value()) {
+    Event::Dispatcher& dispatcher = parent_.callbacks()->dispatcher();
+    latency_start_time_ = dispatcher.timeSource().monotonicTime();
+    // Until the cluster has enough samples, requests are only used to learn its latency.
+    const absl::optional<std::chrono::microseconds> latency =
+        parent_.cluster()->responseLatencyTracker().latencyPercentile(
+            latency_hedging->latency_percentile_, latency_hedging->min_samples_);
+    if (latency.has_value()) {
+      ASSERT(!latency_hedge_timer_);
+      latency_hedge_timer_ = dispatcher.createTimer([this]() -> void { onLatencyHedgeTimeout(); });
+      latency_hedge_timer_->enableHRTimer(
+          std::max<std::chrono::microseconds>(latency.value(), latency_hedging->min_delay_));
+    }
+  }
+}
+
+void UpstreamRequest::onLatencyHedgeTimeout() {
+  // Like the per try timeout, hedging is pointless once the response has started downstream.
+  if (!parent_.downstreamResponseStarted() && awaiting_headers_) {
+    ENVOY_STREAM_LOG(debug, "upstream latency hedge timeout", *parent_.callbacks());
+    parent_.onLatencyHedgeTimeout(*this);
+  }
 }
 
 void UpstreamRequest::onPerTryIdleTimeout() {
@@ -116,6 +116,8 @@ public:
   bool outlierDetectionTimeoutRecorded() { return outlier_detection_timeout_recorded_; }
   void retried(bool value) { retried_ = value; }
   bool retried() { return retried_; }
+  void latencyHedge(bool value) { latency_hedge_ = value; }
+  bool latencyHedge() const { return latency_hedge_; }
   bool grpcRqSuccessDeferred() { return grpc_rq_success_deferred_; }
   void grpcRqSuccessDeferred(bool deferred) { grpc_rq_success_deferred_ = deferred; }
   void upstreamCanary(bool value) { upstream_canary_ = value; }
@@ -147,12 +149,16 @@ private:
   void resetPerTryIdleTimer();
   void onPerTryTimeout();
   void onPerTryIdleTimeout();
+  void onLatencyHedgeTimeout();
 
   RouterFilterInterface& parent_;
   std::unique_ptr<GenericConnPool> conn_pool_;
   bool grpc_rq_success_deferred_;
   Event::TimerPtr per_try_timeout_;
   Event::TimerPtr per_try_idle_timeout_;
+  Event::TimerPtr latency_hedge_timer_;
+  // Set if latency based hedging is enabled, once the per try timeout has been set up.
+  absl::optional<MonotonicTime> latency_start_time_;
   std::unique_ptr<GenericUpstream> upstream_;
   absl::optional<Http::StreamResetReason> deferred_reset_reason_;
   Buffer::InstancePtr buffered_request_body_;
@@ -178,6 +184,8 @@ private:
   bool encode_complete_ : 1;
   bool encode_trailers_ : 1;
   bool retried_ : 1;
+  // True if this request was sent as a latency based hedge.
+  bool latency_hedge_ : 1;
   bool awaiting_headers_ : 1;
   bool outlier_detection_timeout_recorded_ : 1;
   // Tracks whether we deferred a per try timeout because the downstream request
@@ -20,6 +20,7 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/enum_to_int.h"
 #include "source/common/common/fmt.h"
+#include "source/common/common/thread.h"
 #include "source/common/common/utility.h"
 #include "source/common/config/custom_config_validators_impl.h"
 #include "source/common/config/new_grpc_mux_impl.h"
@@ -281,8 +282,9 @@ ClusterManagerImpl::ClusterManagerImpl(
     ProtobufMessage::ValidationContext& validation_context, Api::Api& api,
     Http::Context& http_context, Grpc::Context& grpc_context, Router::Context& router_context,
     const Server::Instance& server)
-    : factory_(factory), runtime_(runtime), stats_(stats), tls_(tls),
-      random_(api.randomGenerator()),
+    : factory_(factory), runtime_(runtime), stats_(stats),
+      shared_pool_workers_(std::make_shared<Http::WorkerDispatcherRegistry>(admin.concurrency())),
+      tls_(tls), random_(api.randomGenerator()),
       bind_config_(bootstrap.cluster_manager().upstream_bind_config()), local_info_(local_info),
       cm_stats_(generateStats(stats)),
       init_helper_(*this, [this](ClusterManagerCluster& cluster) { onClusterInit(cluster); }),
@@ -1332,6 +1334,10 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl
     ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
     const absl::optional<LocalClusterParams>& local_cluster_params)
     : parent_(parent), thread_local_dispatcher_(dispatcher), cdm_(dispatcher.name(), *this) {
+  if (!Thread::MainThread::isMainOrTestThread()) {
+    worker_index_ = parent_.shared_pool_workers_->registerWorker(dispatcher);
+  }
+
   // If local cluster is defined then we need to initialize it first.
   if (local_cluster_params.has_value()) {
     const auto& local_cluster_name = local_cluster_params->info_->name();
@@ -1349,6 +1355,9 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
   // member update callback registered with the local cluster.
   ENVOY_LOG(debug, "shutting down thread local cluster manager");
   destroying_ = true;
+  if (worker_index_.has_value()) {
+    parent_.shared_pool_workers_->unregisterWorker(worker_index_.value());
+  }
   host_http_conn_pool_map_.clear();
   host_tcp_conn_pool_map_.clear();
   ASSERT(host_tcp_conn_map_.empty());
@@ -1663,8 +1672,6 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
     hash_key.push_back(uint8_t(protocol));
   }
 
-  absl::optional<envoy::config::core::v3::AlternateProtocolsCacheOptions>
-      alternate_protocol_options = host->cluster().alternateProtocolsCacheOptions();
   Network::Socket::OptionsSharedPtr upstream_options(std::make_shared<Network::Socket::Options>());
   if (context) {
     // Inherit socket options from downstream connection, if set.
@@ -1693,17 +1700,58 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
     context->downstreamConnection()->hashKey(hash_key);
   }
 
+  return httpConnPoolForHost(
+      host, priority, upstream_protocols, hash_key,
+      !upstream_options->empty() ? upstream_options : nullptr,
+      have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr);
+}
+
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ownedHttpConnPool(
+    const HostConstSharedPtr& host, ResourcePriority priority) {
+  const std::vector<Http::Protocol> upstream_protocols{Http::Protocol::Http2};
+  if (parent_.sharedHttpConnPoolOwner(*host, upstream_protocols).has_value()) {
+    // This worker does not consider itself an owner of the host, which should not happen as all
+    // the workers pick the owners from the same count. Do not hand the stream off again.
+    return nullptr;
+  }
+  return httpConnPoolForHost(host, priority, upstream_protocols,
+                             {uint8_t(Http::Protocol::Http2)}, nullptr, nullptr);
+}
+
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolForHost(
+    const HostConstSharedPtr& host, ResourcePriority priority,
+    const std::vector<Http::Protocol>& upstream_protocols, const std::vector<uint8_t>& hash_key,
+    const Network::Socket::OptionsSharedPtr& upstream_options,
+    const Network::TransportSocketOptionsConstSharedPtr& transport_socket_options) {
   ConnPoolsContainer& container = *parent_.getHttpConnPoolsContainer(host, true);
 
   // Note: to simplify this, we assume that the factory is only called in the scope of this
   // function. Otherwise, we'd need to capture a few of these variables by value.
   ConnPoolsContainer::ConnPools::PoolOptRef pool =
       container.pools_->getPool(priority, hash_key, [&]() {
-        auto pool = parent_.parent_.factory_.allocateConnPool(
-            parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
-            alternate_protocol_options, !upstream_options->empty() ? upstream_options : nullptr,
-            have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr,
-            parent_.parent_.time_source_, parent_.cluster_manager_state_, quic_info_);
+        Http::ConnectionPool::InstancePtr pool;
+        const absl::optional<uint32_t> owner_worker =
+            upstream_options == nullptr && transport_socket_options == nullptr
+                ? parent_.sharedHttpConnPoolOwner(*host, upstream_protocols)
+                : absl::nullopt;
+        if (owner_worker.has_value()) {
+          pool = std::make_unique<Http::SharedConnPool>(
+              parent_.thread_local_dispatcher_, host, parent_.parent_.shared_pool_workers_,
+              parent_.worker_index_.value(), owner_worker.value(),
+              [&cluster_manager = parent_.parent_, host,
+               priority]() -> Http::ConnectionPool::Instance* {
+                OptRef<ThreadLocalClusterManagerImpl> owner = cluster_manager.tls_.get();
+                return owner.has_value() ? owner->ownedHttpConnPool(host, priority) : nullptr;
+              });
+        } else {
+          pool = parent_.parent_.factory_.allocateConnPool(
+              parent_.thread_local_dispatcher_, host, priority, upstream_protocols,
+              host->cluster().alternateProtocolsCacheOptions(), upstream_options,
+              transport_socket_options, parent_.parent_.time_source_,
+              parent_.cluster_manager_state_, quic_info_);
+        }
 
         pool->addIdleCallback([&parent = parent_, host, priority, hash_key]() {
           parent.httpConnPoolIsIdle(host, priority, hash_key);
@@ -1719,6 +1767,36 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::httpConnPoolImp
   }
 }
 
+absl::optional<uint32_t>
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::sharedHttpConnPoolOwner(
+    const Host& host, const std::vector<Http::Protocol>& upstream_protocols) const {
+  const absl::optional<uint32_t> owner_workers = host.cluster().sharedHttp2PoolOwnerWorkers();
+  const Http::WorkerDispatcherRegistry& workers = *parent_.shared_pool_workers_;
+  if (!owner_workers.has_value() || !worker_index_.has_value() ||
+      host.cluster().connectionPoolPerDownstreamConnection() ||
+      upstream_protocols != std::vector<Http::Protocol>{Http::Protocol::Http2}) {
+    return absl::nullopt;
+  }
+  // The owners are picked from the configured number of workers, so that all the workers agree on
+  // them. Streams are not handed off before all the workers registered, as the owner may not
+  // exist yet.
+  if (worker_index_.value() >= workers.workers() || !workers.allRegistered()) {
+    return absl::nullopt;
+  }
+  return Http::SharedConnPool::ownerWorker(host, worker_index_.value(), workers.workers(),
+                                           owner_workers.value());
+}
+
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ownedHttpConnPool(
+    const HostConstSharedPtr& host, ResourcePriority priority) {
+  auto entry = thread_local_clusters_.find(host->cluster().name());
+  if (entry == thread_local_clusters_.end()) {
+    return nullptr;
+  }
+  return entry->second->ownedHttpConnPool(host, priority);
+}
+
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::httpConnPoolIsIdle(
     HostConstSharedPtr host, ResourcePriority priority, const std::vector<uint8_t>& hash_key) {
   if (destroying_) {
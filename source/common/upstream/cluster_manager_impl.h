@@ -32,6 +32,7 @@
 #include "source/common/http/async_client_impl.h"
 #include "source/common/http/http_server_properties_cache_impl.h"
 #include "source/common/http/http_server_properties_cache_manager_impl.h"
+#include "source/common/http/shared_conn_pool.h"
 #include "source/common/quic/quic_stat_names.h"
 #include "source/common/upstream/cluster_discovery_manager.h"
 #include "source/common/upstream/load_stats_reporter.h"
@@ -514,12 +515,21 @@ private:
       void drainConnPools();
       // Drain all clients in connection pools for all hosts.
       void drainAllConnPools(DrainConnectionsHostPredicate predicate);
+      // Returns the HTTP/2 pool serving the streams handed off by other workers to this worker.
+      Http::ConnectionPool::Instance* ownedHttpConnPool(const HostConstSharedPtr& host,
+                                                        ResourcePriority priority);
 
     private:
       Http::ConnectionPool::Instance*
       httpConnPoolImpl(ResourcePriority priority,
                        absl::optional<Http::Protocol> downstream_protocol,
                        LoadBalancerContext* context, bool peek);
+      Http::ConnectionPool::Instance* httpConnPoolForHost(
+          const HostConstSharedPtr& host, ResourcePriority priority,
+          const std::vector<Http::Protocol>& upstream_protocols,
+          const std::vector<uint8_t>& hash_key,
+          const Network::Socket::OptionsSharedPtr& upstream_options,
+          const Network::TransportSocketOptionsConstSharedPtr& transport_socket_options);
 
       Tcp::ConnectionPool::Instance* tcpConnPoolImpl(ResourcePriority priority,
                                                      LoadBalancerContext* context, bool peek);
@@ -573,6 +583,13 @@ private:
 
     ConnPoolsContainer* getHttpConnPoolsContainer(const HostConstSharedPtr& host,
                                                   bool allocate = false);
+    // Returns the worker owning the HTTP/2 connections to the host if the streams of this worker
+    // are to be handed off to it, see Http::SharedConnPool.
+    absl::optional<uint32_t>
+    sharedHttpConnPoolOwner(const Host& host,
+                            const std::vector<Http::Protocol>& upstream_protocols) const;
+    Http::ConnectionPool::Instance* ownedHttpConnPool(const HostConstSharedPtr& host,
+                                                      ResourcePriority priority);
 
     // Upstream::ClusterLifecycleCallbackHandler
     ClusterUpdateCallbacksHandlePtr addClusterUpdateCallbacks(ClusterUpdateCallbacks& cb) override;
@@ -592,6 +609,8 @@ private:
     std::list<Envoy::Upstream::ClusterUpdateCallbacks*> update_callbacks_;
     const PrioritySet* local_priority_set_{};
     bool destroying_{};
+    // The index of this worker in the shared pool worker registry. Not set on the main thread.
+    absl::optional<uint32_t> worker_index_;
     ClusterDiscoveryManager cdm_;
   };
 
@@ -724,6 +743,8 @@ private:
   ClusterManagerFactory& factory_;
   Runtime::Loader& runtime_;
   Stats::Store& stats_;
+  // Dispatchers of the workers, used to hand off streams to shared HTTP/2 connection pools.
+  const Http::WorkerDispatcherRegistrySharedPtr shared_pool_workers_;
   ThreadLocal::TypedSlot<ThreadLocalClusterManagerImpl> tls_;
   // Contains information about ongoing on-demand cluster discoveries.
   ClusterCreationsMap pending_cluster_creations_;
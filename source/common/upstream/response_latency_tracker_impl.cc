@@ -0,0 +1,94 @@
+#include "source/common/upstream/response_latency_tracker_impl.h"
+
+#include <algorithm>
+
+#include "absl/numeric/bits.h"
+
+namespace Envoy {
+namespace Upstream {
+
+uint32_t ResponseLatencyTrackerImpl::bucketIndex(uint64_t micros) {
+  if (micros < SubBuckets) {
+    return micros;
+  }
+  // The position of the highest set bit selects the power of two, the next SubBucketBits bits
+  // select the bucket within it.
+  const uint32_t exponent = absl::bit_width(micros) - 1;
+  const uint32_t sub_bucket = (micros >> (exponent - SubBucketBits)) & (SubBuckets - 1);
+  return std::min<uint32_t>(SubBuckets * (exponent - SubBucketBits + 1) + sub_bucket,
+                            NumBuckets - 1);
+}
+
+uint64_t ResponseLatencyTrackerImpl::bucketUpperBound(uint32_t index) {
+  if (index < SubBuckets) {
+    return index + 1;
+  }
+  const uint32_t exponent = index / SubBuckets + SubBucketBits - 1;
+  const uint64_t sub_bucket = index % SubBuckets;
+  return (SubBuckets + sub_bucket + 1) << (exponent - SubBucketBits);
+}
+
+void ResponseLatencyTrackerImpl::recordLatency(std::chrono::microseconds latency) {
+  buckets_[bucketIndex(std::max<int64_t>(latency.count(), 0))].fetch_add(
+      1, std::memory_order_relaxed);
+  if (samples_.fetch_add(1, std::memory_order_relaxed) + 1 >= DecaySamples) {
+    decay();
+  }
+}
+
+absl::optional<std::chrono::microseconds>
+ResponseLatencyTrackerImpl::latencyPercentile(double percentile, uint64_t min_samples) const {
+  if (samples_.load(std::memory_order_relaxed) < std::max<uint64_t>(min_samples, 1)) {
+    return absl::nullopt;
+  }
+
+  std::array<uint32_t, NumBuckets> counts;
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < NumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return absl::nullopt;
+  }
+
+  const double target = total * std::clamp(percentile, 0.0, 100.0) / 100;
+  uint64_t cumulative = 0;
+  for (uint32_t i = 0; i < NumBuckets; ++i) {
+    cumulative += counts[i];
+    if (cumulative > 0 && cumulative >= target) {
+      return std::chrono::microseconds(bucketUpperBound(i));
+    }
+  }
+  return std::chrono::microseconds(bucketUpperBound(NumBuckets - 1));
+}
+
+bool ResponseLatencyTrackerImpl::hedgeBudgetAvailable(double budget_percent) const {
+  const double max_hedges = samples_.load(std::memory_order_relaxed) * budget_percent / 100;
+  return hedges_.load(std::memory_order_relaxed) + 1 <= max_hedges;
+}
+
+void ResponseLatencyTrackerImpl::recordHedge() {
+  hedges_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ResponseLatencyTrackerImpl::decay() {
+  bool expected = false;
+  if (!decaying_.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+    // Another thread is already halving the counters.
+    return;
+  }
+
+  uint64_t samples = 0;
+  for (auto& bucket : buckets_) {
+    const uint32_t halved = bucket.load(std::memory_order_relaxed) / 2;
+    bucket.store(halved, std::memory_order_relaxed);
+    samples += halved;
+  }
+  samples_.store(samples, std::memory_order_relaxed);
+  hedges_.store(hedges_.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+  decaying_.store(false, std::memory_order_release);
+}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "envoy/upstream/upstream.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Implementation of ResponseLatencyTracker based on a log-linear histogram of atomic counters:
+ * each power of two of microseconds is split in 4 buckets, which bounds the error of the
+ * percentiles to 25%. All the counters are halved once the histogram holds DecaySamples samples.
+ * Concurrent updates during a decay may be lost, which is fine for an approximation.
+ */
+class ResponseLatencyTrackerImpl : public ResponseLatencyTracker {
+public:
+  static constexpr uint64_t DecaySamples = 2048;
+  static constexpr uint32_t NumBuckets = 96;
+
+  // Upstream::ResponseLatencyTracker
+  void recordLatency(std::chrono::microseconds latency) override;
+  absl::optional<std::chrono::microseconds> latencyPercentile(double percentile,
+                                                              uint64_t min_samples) const override;
+  bool hedgeBudgetAvailable(double budget_percent) const override;
+  void recordHedge() override;
+
+  /**
+   * @return the index of the bucket holding a latency in microseconds.
+   */
+  static uint32_t bucketIndex(uint64_t micros);
+
+  /**
+   * @return the exclusive upper bound in microseconds of the latencies held by a bucket.
+   */
+  static uint64_t bucketUpperBound(uint32_t index);
+
+private:
+  static constexpr uint32_t SubBucketBits = 2;
+  static constexpr uint32_t SubBuckets = 1 << SubBucketBits;
+
+  void decay();
+
+  std::array<std::atomic<uint32_t>, NumBuckets> buckets_{};
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> hedges_{0};
+  std::atomic<bool> decaying_{false};
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -213,6 +213,17 @@ HostVector filterHosts(const absl::node_hash_set<HostSharedPtr>& hosts,
   return net_hosts;
 }
 
+absl::optional<AdaptivePreconnectConfig> adaptivePreconnectConfig(
+    const envoy::config::cluster::v3::Cluster::PreconnectPolicy& policy) {
+  if (!policy.has_adaptive_preconnect()) {
+    return absl::nullopt;
+  }
+  const auto& adaptive = policy.adaptive_preconnect();
+  return AdaptivePreconnectConfig{
+      std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(adaptive, decay_time, 10000)),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(adaptive, burst_factor, 1.0)};
+}
+
 } // namespace
 
 // TODO(pianiststickman): this implementation takes a lock on the hot path and puts a copy of the
@@ -811,6 +822,7 @@ ClusterInfoImpl::ClusterInfoImpl(
           config.preconnect_policy(), per_upstream_preconnect_ratio, 1.0)),
       peekahead_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.preconnect_policy(),
                                                        predictive_preconnect_ratio, 0)),
+      adaptive_preconnect_(adaptivePreconnectConfig(config.preconnect_policy())),
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
       socket_matcher_(std::move(socket_matcher)), stats_scope_(std::move(stats_scope)),
@@ -845,6 +857,11 @@ ClusterInfoImpl::ClusterInfoImpl(
       drain_connections_on_host_removal_(config.ignore_health_on_host_removal()),
       connection_pool_per_downstream_connection_(
           config.connection_pool_per_downstream_connection()),
+      shared_http2_pool_owner_workers_(
+          config.has_shared_http2_connection_pool()
+              ? absl::make_optional<uint32_t>(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+                    config.shared_http2_connection_pool(), owner_workers, 1))
+              : absl::nullopt),
       warm_hosts_(!config.health_checks().empty() &&
                   common_lb_config_.ignore_new_hosts_until_first_hc()),
       set_local_interface_name_on_upstream_connections_(
@@ -53,6 +53,7 @@
 #include "source/common/upstream/load_balancer_impl.h"
 #include "source/common/upstream/outlier_detection_impl.h"
 #include "source/common/upstream/resource_manager_impl.h"
+#include "source/common/upstream/response_latency_tracker_impl.h"
 #include "source/common/upstream/transport_socket_match_impl.h"
 #include "source/extensions/upstreams/http/config.h"
 #include "source/server/transport_socket_config_impl.h"
@@ -641,6 +642,9 @@ public:
   }
   float perUpstreamPreconnectRatio() const override { return per_upstream_preconnect_ratio_; }
   float peekaheadRatio() const override { return peekahead_ratio_; }
+  const absl::optional<AdaptivePreconnectConfig>& adaptivePreconnect() const override {
+    return adaptive_preconnect_;
+  }
   uint32_t perConnectionBufferLimitBytes() const override {
     return per_connection_buffer_limit_bytes_;
   }
@@ -735,6 +739,12 @@ public:
   bool connectionPoolPerDownstreamConnection() const override {
     return connection_pool_per_downstream_connection_;
   }
+  absl::optional<uint32_t> sharedHttp2PoolOwnerWorkers() const override {
+    return shared_http2_pool_owner_workers_;
+  }
+  ResponseLatencyTracker& responseLatencyTracker() const override {
+    return response_latency_tracker_;
+  }
   bool warmHosts() const override { return warm_hosts_; }
   bool setLocalInterfaceNameOnUpstreamConnections() const override {
     return set_local_interface_name_on_upstream_connections_;
@@ -802,6 +812,7 @@ private:
   absl::optional<std::chrono::milliseconds> max_connection_duration_;
   const float per_upstream_preconnect_ratio_;
   const float peekahead_ratio_;
+  const absl::optional<AdaptivePreconnectConfig> adaptive_preconnect_;
   const uint32_t per_connection_buffer_limit_bytes_;
   TransportSocketMatcherPtr socket_matcher_;
   Stats::ScopeSharedPtr stats_scope_;
@@ -831,6 +842,8 @@ private:
   const Network::ConnectionSocket::OptionsSharedPtr cluster_socket_options_;
   const bool drain_connections_on_host_removal_;
   const bool connection_pool_per_downstream_connection_;
+  const absl::optional<uint32_t> shared_http2_pool_owner_workers_;
+  mutable ResponseLatencyTrackerImpl response_latency_tracker_;
   const bool warm_hosts_;
   const bool set_local_interface_name_on_upstream_connections_;
   const absl::optional<envoy::config::core::v3::UpstreamHttpProtocolOptions>
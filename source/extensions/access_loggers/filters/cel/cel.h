@@ -26,7 +26,7 @@ public:
 
 private:
   const google::api::expr::v1alpha1::Expr parsed_expr_;
-  Extensions::Filters::Common::Expr::ExpressionPtr compiled_expr_;
+  Extensions::Filters::Common::Expr::ConditionPtr compiled_expr_;
 };
 
 } // namespace CEL
@@ -28,6 +28,7 @@
 #include "source/common/http/utility.h"
 #include "source/common/tracing/http_tracer_impl.h"
 #include "source/extensions/common/wasm/plugin.h"
+#include "source/extensions/common/wasm/shared_data.h"
 #include "source/extensions/common/wasm/wasm.h"
 #include "source/extensions/filters/common/expr/context.h"
 
@@ -777,22 +778,19 @@ WasmResult Context::getHeaderMapValue(WasmHeaderMapType type, std::string_view k
   return WasmResult::Ok;
 }
 
-Pairs headerMapToPairs(const Http::HeaderMap* map) {
+WasmResult Context::getHeaderMapPairs(WasmHeaderMapType type, Pairs* result) {
+  // The pairs are views of the map, and are copied into the VM in a single buffer.
+  result->clear();
+  const Http::HeaderMap* map = getConstMap(type);
   if (!map) {
-    return {};
+    return WasmResult::Ok;
   }
-  Pairs pairs;
-  pairs.reserve(map->size());
-  map->iterate([&pairs](const Http::HeaderEntry& header) -> Http::HeaderMap::Iterate {
-    pairs.push_back(std::make_pair(toStdStringView(header.key().getStringView()),
-                                   toStdStringView(header.value().getStringView())));
+  result->reserve(map->size());
+  map->iterate([result](const Http::HeaderEntry& header) -> Http::HeaderMap::Iterate {
+    result->emplace_back(toStdStringView(header.key().getStringView()),
+                         toStdStringView(header.value().getStringView()));
     return Http::HeaderMap::Iterate::Continue;
   });
-  return pairs;
-}
-
-WasmResult Context::getHeaderMapPairs(WasmHeaderMapType type, Pairs* result) {
-  *result = headerMapToPairs(getConstMap(type));
   return WasmResult::Ok;
 }
 
@@ -801,18 +799,10 @@ WasmResult Context::setHeaderMapPairs(WasmHeaderMapType type, const Pairs& pairs
   if (!map) {
     return WasmResult::BadArgument;
   }
-  std::vector<std::string> keys;
-  map->iterate([&keys](const Http::HeaderEntry& header) -> Http::HeaderMap::Iterate {
-    keys.push_back(std::string(header.key().getStringView()));
-    return Http::HeaderMap::Iterate::Continue;
-  });
-  for (auto& k : keys) {
-    const Http::LowerCaseString lower_key{k};
-    map->remove(lower_key);
-  }
+  // Replace the whole map at once rather than removing its headers one name at a time.
+  map->clear();
   for (auto& p : pairs) {
-    const Http::LowerCaseString lower_key{std::string(p.first)};
-    map->addCopy(lower_key, std::string(p.second));
+    map->addCopy(Http::LowerCaseString(toAbslStringView(p.first)), toAbslStringView(p.second));
   }
   if (type == WasmHeaderMapType::RequestHeaders && decoder_callbacks_) {
     decoder_callbacks_->clearRouteCache();
@@ -1147,6 +1137,17 @@ WasmResult Context::setProperty(std::string_view path, std::string_view value) {
   return WasmResult::Ok;
 }
 
+WasmResult Context::getSharedData(std::string_view key,
+                                  std::pair<std::string, uint32_t /* cas */>* data) {
+  return SharedData::instance().get(toAbslStringView(wasm()->vm_id()), toAbslStringView(key),
+                                    data);
+}
+
+WasmResult Context::setSharedData(std::string_view key, std::string_view value, uint32_t cas) {
+  return SharedData::instance().set(toAbslStringView(wasm()->vm_id()), toAbslStringView(key),
+                                    toAbslStringView(value), cas);
+}
+
 WasmResult
 Context::declareProperty(std::string_view path,
                          Filters::Common::Expr::CelStatePrototypeConstPtr state_prototype) {
@@ -209,6 +209,11 @@ public:
   WasmResult declareProperty(std::string_view path,
                              Filters::Common::Expr::CelStatePrototypeConstPtr state_prototype);
 
+  // Shared Data
+  WasmResult getSharedData(std::string_view key,
+                           std::pair<std::string, uint32_t /* cas */>* data) override;
+  WasmResult setSharedData(std::string_view key, std::string_view value, uint32_t cas) override;
+
   // Continue
   WasmResult continueStream(WasmStreamType stream_type) override;
   WasmResult closeStream(WasmStreamType stream_type) override;
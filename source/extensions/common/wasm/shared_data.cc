@@ -0,0 +1,74 @@
+#include "source/extensions/common/wasm/shared_data.h"
+
+#include "source/common/common/macros.h"
+
+#include "absl/hash/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace Wasm {
+
+WasmResult SharedData::get(absl::string_view vm_id, absl::string_view key,
+                           std::pair<std::string, uint32_t>* data) const {
+  const Shard& vm_shard = shards_[shardIndex(vm_id, key)];
+  absl::ReaderMutexLock lock(&vm_shard.mutex_);
+  const auto vm_it = vm_shard.data_.find(vm_id);
+  if (vm_it == vm_shard.data_.end()) {
+    return WasmResult::NotFound;
+  }
+  const auto it = vm_it->second.find(key);
+  if (it == vm_it->second.end()) {
+    return WasmResult::NotFound;
+  }
+  *data = it->second;
+  return WasmResult::Ok;
+}
+
+WasmResult SharedData::set(absl::string_view vm_id, absl::string_view key, absl::string_view value,
+                           uint32_t cas) {
+  Shard& vm_shard = shards_[shardIndex(vm_id, key)];
+  absl::MutexLock lock(&vm_shard.mutex_);
+  Entry& entry = vm_shard.data_[vm_id][key];
+  // A key without a value has version 0, and is set whatever the cas.
+  if (cas != 0 && entry.second != 0 && cas != entry.second) {
+    return WasmResult::CasMismatch;
+  }
+  entry.first.assign(value.data(), value.size());
+  entry.second = vm_shard.next_cas_++;
+  if (vm_shard.next_cas_ == 0) {
+    vm_shard.next_cas_ = 1;
+  }
+  return WasmResult::Ok;
+}
+
+void SharedData::addVm(absl::string_view vm_id) {
+  absl::MutexLock lock(&vms_mutex_);
+  vms_[vm_id]++;
+}
+
+void SharedData::removeVm(absl::string_view vm_id) {
+  // The data is deleted while holding the lock of the VM ids, so that it is not deleted after a
+  // new VM with the same id is added.
+  absl::MutexLock lock(&vms_mutex_);
+  const auto it = vms_.find(vm_id);
+  if (it == vms_.end() || --it->second > 0) {
+    return;
+  }
+  vms_.erase(it);
+  for (Shard& vm_shard : shards_) {
+    absl::MutexLock shard_lock(&vm_shard.mutex_);
+    vm_shard.data_.erase(vm_id);
+  }
+}
+
+SharedData& SharedData::instance() { MUTABLE_CONSTRUCT_ON_FIRST_USE(SharedData); }
+
+size_t SharedData::shardIndex(absl::string_view vm_id, absl::string_view key) {
+  return absl::Hash<std::pair<absl::string_view, absl::string_view>>()({vm_id, key}) % NumShards;
+}
+
+} // namespace Wasm
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
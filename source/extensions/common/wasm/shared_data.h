@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "include/proxy-wasm/wasm.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace Wasm {
+
+using proxy_wasm::WasmResult;
+
+/**
+ * The shared data of the Wasm VMs, by VM id. The keys are spread over shards with their own
+ * reader-writer lock, so that VMs reading or writing different keys do not contend, and reads of
+ * the same key proceed in parallel.
+ *
+ * Every value has a version, the "cas" of the Proxy-Wasm ABI, which changes each time the value is
+ * set. A value set with a non-zero cas is only replaced if its version is still that cas. The data
+ * of a VM id is deleted once the last VM with that id is destroyed.
+ */
+class SharedData {
+public:
+  static constexpr size_t NumShards = 64;
+
+  /**
+   * Gets a value and its version.
+   * @return WasmResult::NotFound if the key has no value.
+   */
+  WasmResult get(absl::string_view vm_id, absl::string_view key,
+                 std::pair<std::string, uint32_t>* data) const;
+
+  /**
+   * Sets a value.
+   * @param cas supplies the version the value must have to be replaced, or 0 to replace it
+   *        unconditionally.
+   * @return WasmResult::CasMismatch if the value has a version other than a non-zero cas.
+   */
+  WasmResult set(absl::string_view vm_id, absl::string_view key, absl::string_view value,
+                 uint32_t cas);
+
+  /**
+   * Registers the creation of a VM with an id.
+   */
+  void addVm(absl::string_view vm_id);
+
+  /**
+   * Registers the destruction of a VM with an id. The data of the VM id is deleted when no VM with
+   * the id remains.
+   */
+  void removeVm(absl::string_view vm_id);
+
+  /**
+   * @return the shared data of the process.
+   */
+  static SharedData& instance();
+
+private:
+  using Entry = std::pair<std::string, uint32_t>;
+
+  struct Shard {
+    mutable absl::Mutex mutex_;
+    // Values by VM id and key.
+    absl::flat_hash_map<std::string, absl::flat_hash_map<std::string, Entry>>
+        data_ ABSL_GUARDED_BY(mutex_);
+    uint32_t next_cas_ ABSL_GUARDED_BY(mutex_){1};
+  };
+
+  static size_t shardIndex(absl::string_view vm_id, absl::string_view key);
+
+  std::array<Shard, NumShards> shards_;
+  absl::Mutex vms_mutex_;
+  absl::flat_hash_map<std::string, uint32_t> vms_ ABSL_GUARDED_BY(vms_mutex_);
+};
+
+} // namespace Wasm
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
@@ -280,6 +280,12 @@ EXTENSIONS = {
 
     "envoy.tls.cert_validator.spiffe":                  "//source/extensions/transport_sockets/tls/cert_validator/spiffe:config",
 
+    #
+    # TLS private key providers
+    #
+
+    "envoy.tls.key_providers.thread_pool":              "//source/extensions/private_key_providers/thread_pool:config",
+
     #
     # HTTP header formatters
     #
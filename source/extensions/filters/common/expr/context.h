@@ -155,7 +155,7 @@ convertHeaderEntry(Protobuf::Arena& arena,
 
 template <class T> class HeadersWrapper : public google::api::expr::runtime::CelMap {
 public:
-  HeadersWrapper(Protobuf::Arena& arena, const T* value) : arena_(arena), value_(value) {}
+  HeadersWrapper(Protobuf::Arena& arena, const T* value) : arena_(&arena), value_(value) {}
   absl::optional<CelValue> operator[](CelValue key) const override {
     if (value_ == nullptr || !key.IsString()) {
       return {};
@@ -166,7 +166,7 @@ public:
       return {};
     }
     return convertHeaderEntry(
-        arena_, Http::HeaderUtility::getAllOfHeaderAsString(*value_, Http::LowerCaseString(str)));
+        *arena_, Http::HeaderUtility::getAllOfHeaderAsString(*value_, Http::LowerCaseString(str)));
   }
   int size() const override { return ListKeys()->size(); }
   bool empty() const override { return value_ == nullptr ? true : value_->empty(); }
@@ -184,14 +184,14 @@ public:
     for (const auto& key : keys) {
       values.push_back(CelValue::CreateStringView(key));
     }
-    return Protobuf::Arena::Create<google::api::expr::runtime::ContainerBackedListImpl>(&arena_,
+    return Protobuf::Arena::Create<google::api::expr::runtime::ContainerBackedListImpl>(arena_,
                                                                                         values);
   }
 
 private:
   friend class RequestWrapper;
   friend class ResponseWrapper;
-  Protobuf::Arena& arena_;
+  Protobuf::Arena* arena_;
   const T* value_;
 };
 
@@ -222,8 +222,14 @@ public:
     return &WrapperFields::get().Request;
   }
 
+  // Binds the wrapper of a reused activation to the arena and the headers of an evaluation.
+  void bind(Protobuf::Arena& arena, const Http::RequestHeaderMap* headers) {
+    headers_.arena_ = &arena;
+    headers_.value_ = headers;
+  }
+
 private:
-  const HeadersWrapper<Http::RequestHeaderMap> headers_;
+  HeadersWrapper<Http::RequestHeaderMap> headers_;
   const StreamInfo::StreamInfo& info_;
 };
 
@@ -237,9 +243,19 @@ public:
     return &WrapperFields::get().Response;
   }
 
+  // Binds the wrapper of a reused activation to the arena, the headers and the trailers of an
+  // evaluation.
+  void bind(Protobuf::Arena& arena, const Http::ResponseHeaderMap* headers,
+            const Http::ResponseTrailerMap* trailers) {
+    headers_.arena_ = &arena;
+    headers_.value_ = headers;
+    trailers_.arena_ = &arena;
+    trailers_.value_ = trailers;
+  }
+
 private:
-  const HeadersWrapper<Http::ResponseHeaderMap> headers_;
-  const HeadersWrapper<Http::ResponseTrailerMap> trailers_;
+  HeadersWrapper<Http::ResponseHeaderMap> headers_;
+  HeadersWrapper<Http::ResponseTrailerMap> trailers_;
   const StreamInfo::StreamInfo& info_;
 };
 
@@ -2,6 +2,9 @@
 
 #include "envoy/common/exception.h"
 
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+
 #include "eval/public/builtin_func_registrar.h"
 #include "eval/public/cel_expr_builder_factory.h"
 
@@ -31,6 +34,63 @@ ActivationPtr createActivation(Protobuf::Arena& arena, const StreamInfo::StreamI
   return activation;
 }
 
+StreamActivation::StreamActivation(const StreamInfo::StreamInfo& info) : info_(info) {}
+
+const std::string& StreamActivation::key() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "envoy.filters.common.expr.activation");
+}
+
+const StreamActivation* StreamActivation::getOrCreate(StreamInfo::StreamInfo& info) {
+  if (info.filterState()->lifeSpan() > StreamInfo::FilterState::LifeSpan::Request) {
+    return nullptr;
+  }
+  const StreamActivation* activation = get(info);
+  if (activation == nullptr) {
+    auto created = std::make_shared<StreamActivation>(info);
+    activation = created.get();
+    // The activation refers to the stream info of the request, so it is not carried over to the
+    // stream recreated by an internal redirect.
+    info.filterState()->setData(key(), std::move(created),
+                                StreamInfo::FilterState::StateType::ReadOnly,
+                                StreamInfo::FilterState::LifeSpan::FilterChain);
+  }
+  return activation;
+}
+
+const StreamActivation* StreamActivation::get(const StreamInfo::StreamInfo& info) {
+  const auto* activation = info.filterState().getDataReadOnly<StreamActivation>(key());
+  return activation != nullptr && &activation->info_ == &info ? activation : nullptr;
+}
+
+const Activation& StreamActivation::bind(Protobuf::Arena& arena,
+                                         const Http::RequestHeaderMap* request_headers,
+                                         const Http::ResponseHeaderMap* response_headers,
+                                         const Http::ResponseTrailerMap* response_trailers) const {
+  if (request_ == nullptr) {
+    auto request = std::make_unique<RequestWrapper>(arena, request_headers, info_);
+    request_ = request.get();
+    auto response =
+        std::make_unique<ResponseWrapper>(arena, response_headers, response_trailers, info_);
+    response_ = response.get();
+    activation_.InsertValueProducer(Request, std::move(request));
+    activation_.InsertValueProducer(Response, std::move(response));
+    activation_.InsertValueProducer(Connection, std::make_unique<ConnectionWrapper>(info_));
+    activation_.InsertValueProducer(Upstream, std::make_unique<UpstreamWrapper>(info_));
+    activation_.InsertValueProducer(Source, std::make_unique<PeerWrapper>(info_, false));
+    activation_.InsertValueProducer(Destination, std::make_unique<PeerWrapper>(info_, true));
+    activation_.InsertValueProducer(Metadata,
+                                    std::make_unique<MetadataProducer>(info_.dynamicMetadata()));
+    activation_.InsertValueProducer(FilterState,
+                                    std::make_unique<FilterStateWrapper>(info_.filterState()));
+    return activation_;
+  }
+  request_->bind(arena, request_headers);
+  response_->bind(arena, response_headers, response_trailers);
+  // The values produced by the previous evaluation refer to its arena.
+  activation_.ClearCachedValues();
+  return activation_;
+}
+
 BuilderPtr createBuilder(Protobuf::Arena* arena) {
   google::api::expr::runtime::InterpreterOptions options;
 
@@ -68,14 +128,35 @@ ExpressionPtr createExpression(Builder& builder, const google::api::expr::v1alph
   return std::move(cel_expression_status.value());
 }
 
+namespace {
+
+// Returns the activation reused by the request if there is one, or a new activation held by
+// owned_activation.
+const Activation& activationFor(Protobuf::Arena& arena, ActivationPtr& owned_activation,
+                                const StreamInfo::StreamInfo& info,
+                                const Http::RequestHeaderMap* request_headers,
+                                const Http::ResponseHeaderMap* response_headers,
+                                const Http::ResponseTrailerMap* response_trailers) {
+  const StreamActivation* stream_activation = StreamActivation::get(info);
+  if (stream_activation != nullptr) {
+    return stream_activation->bind(arena, request_headers, response_headers, response_trailers);
+  }
+  owned_activation =
+      createActivation(arena, info, request_headers, response_headers, response_trailers);
+  return *owned_activation;
+}
+
+} // namespace
+
 absl::optional<CelValue> evaluate(const Expression& expr, Protobuf::Arena& arena,
                                   const StreamInfo::StreamInfo& info,
                                   const Http::RequestHeaderMap* request_headers,
                                   const Http::ResponseHeaderMap* response_headers,
                                   const Http::ResponseTrailerMap* response_trailers) {
-  auto activation =
-      createActivation(arena, info, request_headers, response_headers, response_trailers);
-  auto eval_status = expr.Evaluate(*activation, &arena);
+  ActivationPtr owned_activation;
+  const Activation& activation = activationFor(arena, owned_activation, info, request_headers,
+                                               response_headers, response_trailers);
+  auto eval_status = expr.Evaluate(activation, &arena);
   if (!eval_status.ok()) {
     return {};
   }
@@ -94,6 +175,221 @@ bool matches(const Expression& expr, const StreamInfo::StreamInfo& info,
   return result.IsBool() ? result.BoolOrDie() : false;
 }
 
+// A node of the tree of a condition evaluated without the interpreter.
+struct Condition::Node {
+  enum class Type { Constant, And, Or, Not, Equal, NotEqual };
+
+  Type type_;
+  // Value of a constant.
+  bool constant_{};
+  // Identifier, fields and map keys of the attribute of a comparison.
+  std::vector<std::string> attribute_;
+  // String constant of a comparison.
+  std::string value_;
+  // Operands of a logical operator.
+  std::vector<Node> operands_;
+};
+
+namespace {
+
+using Node = Condition::Node;
+using ExprProto = google::api::expr::v1alpha1::Expr;
+
+enum class Result { True, False, Unknown };
+
+bool isStringConstant(const ExprProto& expr) {
+  return expr.const_expr().constant_kind_case() ==
+         google::api::expr::v1alpha1::Constant::kStringValue;
+}
+
+Node constantNode(bool value) {
+  Node node{Node::Type::Constant};
+  node.constant_ = value;
+  return node;
+}
+
+// Returns the path of an attribute, e.g. {"request", "headers", "x-foo"} for
+// request.headers['x-foo'].
+bool compileAttribute(const ExprProto& expr, std::vector<std::string>& attribute) {
+  switch (expr.expr_kind_case()) {
+  case ExprProto::kIdentExpr:
+    attribute.push_back(expr.ident_expr().name());
+    return true;
+  case ExprProto::kSelectExpr:
+    if (expr.select_expr().test_only() ||
+        !compileAttribute(expr.select_expr().operand(), attribute)) {
+      return false;
+    }
+    attribute.push_back(expr.select_expr().field());
+    return true;
+  case ExprProto::kCallExpr: {
+    const auto& call = expr.call_expr();
+    if (call.function() != "_[_]" || call.has_target() || call.args_size() != 2 ||
+        !isStringConstant(call.args(1)) ||
+        !compileAttribute(call.args(0), attribute)) {
+      return false;
+    }
+    attribute.push_back(call.args(1).const_expr().string_value());
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+absl::optional<Node> compileNode(const ExprProto& expr) {
+  if (expr.const_expr().constant_kind_case() == google::api::expr::v1alpha1::Constant::kBoolValue) {
+    return constantNode(expr.const_expr().bool_value());
+  }
+  if (!expr.has_call_expr() || expr.call_expr().has_target()) {
+    return absl::nullopt;
+  }
+
+  const auto& call = expr.call_expr();
+  if (call.function() == "!_" && call.args_size() == 1) {
+    auto operand = compileNode(call.args(0));
+    if (!operand.has_value()) {
+      return absl::nullopt;
+    }
+    if (operand->type_ == Node::Type::Constant) {
+      return constantNode(!operand->constant_);
+    }
+    Node node{Node::Type::Not};
+    node.operands_.push_back(std::move(operand.value()));
+    return node;
+  }
+
+  if ((call.function() == "_&&_" || call.function() == "_||_") && call.args_size() == 2) {
+    const bool is_and = call.function() == "_&&_";
+    auto left = compileNode(call.args(0));
+    auto right = compileNode(call.args(1));
+    if (!left.has_value() || !right.has_value()) {
+      return absl::nullopt;
+    }
+    // A constant operand either decides the result, even if the other operand fails to evaluate,
+    // or leaves it to the other operand.
+    for (const Node* operand : {&left.value(), &right.value()}) {
+      if (operand->type_ == Node::Type::Constant && operand->constant_ != is_and) {
+        return constantNode(!is_and);
+      }
+    }
+    if (left->type_ == Node::Type::Constant) {
+      return right;
+    }
+    if (right->type_ == Node::Type::Constant) {
+      return left;
+    }
+    Node node{is_and ? Node::Type::And : Node::Type::Or};
+    node.operands_.push_back(std::move(left.value()));
+    node.operands_.push_back(std::move(right.value()));
+    return node;
+  }
+
+  if ((call.function() == "_==_" || call.function() == "_!=_") && call.args_size() == 2) {
+    Node node{call.function() == "_==_" ? Node::Type::Equal : Node::Type::NotEqual};
+    const ExprProto* attribute = &call.args(0);
+    const ExprProto* value = &call.args(1);
+    if (isStringConstant(*attribute)) {
+      std::swap(attribute, value);
+    }
+    if (!isStringConstant(*value) ||
+        !compileAttribute(*attribute, node.attribute_)) {
+      return absl::nullopt;
+    }
+    node.value_ = value->const_expr().string_value();
+    return node;
+  }
+  return absl::nullopt;
+}
+
+// Returns Unknown if the result depends on an attribute which is missing or is not a string, to
+// leave the evaluation and the handling of errors to the interpreter.
+Result evaluateNode(const Node& node, const Activation& activation, Protobuf::Arena& arena) {
+  switch (node.type_) {
+  case Node::Type::Constant:
+    return node.constant_ ? Result::True : Result::False;
+  case Node::Type::Not: {
+    const Result result = evaluateNode(node.operands_[0], activation, arena);
+    if (result == Result::Unknown) {
+      return Result::Unknown;
+    }
+    return result == Result::True ? Result::False : Result::True;
+  }
+  case Node::Type::And:
+  case Node::Type::Or: {
+    // The operand which decides the result of the operator short-circuits the evaluation.
+    const Result decisive = node.type_ == Node::Type::And ? Result::False : Result::True;
+    bool unknown = false;
+    for (const Node& operand : node.operands_) {
+      const Result result = evaluateNode(operand, activation, arena);
+      if (result == decisive) {
+        return decisive;
+      }
+      unknown |= result == Result::Unknown;
+    }
+    if (unknown) {
+      return Result::Unknown;
+    }
+    return decisive == Result::False ? Result::True : Result::False;
+  }
+  case Node::Type::Equal:
+  case Node::Type::NotEqual: {
+    absl::optional<CelValue> value = activation.FindValue(node.attribute_[0], &arena);
+    for (size_t i = 1; i < node.attribute_.size() && value.has_value(); i++) {
+      if (!value->IsMap()) {
+        return Result::Unknown;
+      }
+      value = (*value->MapOrDie())[CelValue::CreateStringView(node.attribute_[i])];
+    }
+    if (!value.has_value() || !value->IsString()) {
+      return Result::Unknown;
+    }
+    const bool equal = value->StringOrDie().value() == node.value_;
+    return equal == (node.type_ == Node::Type::Equal) ? Result::True : Result::False;
+  }
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+} // namespace
+
+Condition::Condition(Builder& builder, const google::api::expr::v1alpha1::Expr& expr)
+    : expr_(createExpression(builder, expr)) {
+  auto root = compileNode(expr);
+  if (root.has_value()) {
+    root_ = std::make_unique<const Node>(std::move(root.value()));
+  }
+}
+
+Condition::~Condition() = default;
+
+bool Condition::matches(const StreamInfo::StreamInfo& info,
+                        const Http::RequestHeaderMap* request_headers,
+                        const Http::ResponseHeaderMap* response_headers,
+                        const Http::ResponseTrailerMap* response_trailers) const {
+  Protobuf::Arena arena;
+  ActivationPtr owned_activation;
+  const Activation& activation = activationFor(arena, owned_activation, info, request_headers,
+                                               response_headers, response_trailers);
+  if (root_ != nullptr) {
+    const Result result = evaluateNode(*root_, activation, arena);
+    if (result != Result::Unknown) {
+      return result == Result::True;
+    }
+  }
+
+  auto eval_status = expr_->Evaluate(activation, &arena);
+  if (!eval_status.ok()) {
+    return false;
+  }
+  const CelValue result = eval_status.value();
+  return result.IsBool() ? result.BoolOrDie() : false;
+}
+
+ConditionPtr createCondition(Builder& builder, const google::api::expr::v1alpha1::Expr& expr) {
+  return std::make_unique<Condition>(builder, expr);
+}
+
 std::string print(CelValue value) {
   switch (value.type()) {
   case CelValue::Type::kBool:
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "envoy/stream_info/filter_state.h"
 #include "envoy/stream_info/stream_info.h"
 
 #include "source/common/http/headers.h"
@@ -30,6 +31,38 @@ ActivationPtr createActivation(Protobuf::Arena& arena, const StreamInfo::StreamI
                                const Http::ResponseHeaderMap* response_headers,
                                const Http::ResponseTrailerMap* response_trailers);
 
+// Activation reused by the expressions evaluated on a request, stored in its filter state. The
+// value producers are created once and bound to the arena and the headers of each evaluation. The
+// values they produce refer to the arena of an evaluation, so they are produced again by each one.
+class StreamActivation : public StreamInfo::FilterState::Object {
+public:
+  explicit StreamActivation(const StreamInfo::StreamInfo& info);
+
+  static const std::string& key();
+
+  // Returns the activation reused by the expressions evaluated on a request, creating it if
+  // needed. Returns nullptr for the stream info of a connection, which has no request.
+  static const StreamActivation* getOrCreate(StreamInfo::StreamInfo& info);
+
+  // Returns the activation reused by the expressions evaluated on a request, or nullptr if none
+  // was created.
+  static const StreamActivation* get(const StreamInfo::StreamInfo& info);
+
+  // Binds the activation to the arena and the headers of an evaluation. The returned activation is
+  // valid until the next call.
+  const Activation& bind(Protobuf::Arena& arena, const Http::RequestHeaderMap* request_headers,
+                         const Http::ResponseHeaderMap* response_headers,
+                         const Http::ResponseTrailerMap* response_trailers) const;
+
+private:
+  // The filter state of a request inherits the objects of its connection.
+  const StreamInfo::StreamInfo& info_;
+  mutable Activation activation_;
+  // Owned by the activation, created by the first evaluation.
+  mutable RequestWrapper* request_{};
+  mutable ResponseWrapper* response_{};
+};
+
 // Creates an expression builder. The optional arena is used to enable constant folding
 // for intermediate evaluation results.
 // Throws an exception if fails to construct an expression builder.
@@ -52,6 +85,38 @@ absl::optional<CelValue> evaluate(const Expression& expr, Protobuf::Arena& arena
 bool matches(const Expression& expr, const StreamInfo::StreamInfo& info,
              const Http::RequestHeaderMap& headers);
 
+// A boolean expression. Conjunctions, disjunctions and negations of comparisons of attributes with
+// string constants are evaluated directly against the attributes, falling back to the interpreter
+// when an attribute is missing or is not a string. Constant boolean sub-expressions are folded.
+class Condition {
+public:
+  // Throws an exception if fails to construct a runtime expression.
+  Condition(Builder& builder, const google::api::expr::v1alpha1::Expr& expr);
+  ~Condition();
+
+  // Returns true if the condition evaluates to "true", false if it evaluates to anything else or
+  // fails to evaluate.
+  bool matches(const StreamInfo::StreamInfo& info, const Http::RequestHeaderMap* request_headers,
+               const Http::ResponseHeaderMap* response_headers,
+               const Http::ResponseTrailerMap* response_trailers) const;
+
+  // Returns whether the condition is evaluated without the interpreter when its attributes are
+  // strings.
+  bool shortCircuited() const { return root_ != nullptr; }
+
+  struct Node;
+
+private:
+  ExpressionPtr expr_;
+  std::unique_ptr<const Node> root_;
+};
+
+using ConditionPtr = std::unique_ptr<Condition>;
+
+// Creates a condition from a protobuf representation.
+// Throws an exception if fails to construct a runtime expression.
+ConditionPtr createCondition(Builder& builder, const google::api::expr::v1alpha1::Expr& expr);
+
 // Returns a string for a CelValue.
 std::string print(CelValue value);
 
@@ -48,20 +48,47 @@ void Coroutine::resume(int num_args, const std::function<void()>& yield_callback
   }
 }
 
+namespace {
+
+int writeBytecode(lua_State*, const void* chunk, size_t size, void* bytecode) {
+  static_cast<std::string*>(bytecode)->append(static_cast<const char*>(chunk), size);
+  return 0;
+}
+
+} // namespace
+
 ThreadLocalState::ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls)
     : tls_slot_(ThreadLocal::TypedSlot<LuaThreadLocal>::makeUnique(tls)) {
 
-  // First verify that the supplied code can be parsed.
+  // First verify that the supplied code can be parsed. The code may be source or precompiled
+  // bytecode, which can contain null characters.
   CSmartPtr<lua_State, lua_close> state(luaL_newstate());
   RELEASE_ASSERT(state.get() != nullptr, "unable to create new Lua state object");
   luaL_openlibs(state.get());
 
-  if (0 != luaL_dostring(state.get(), code.c_str())) {
+  const char* chunk_name = isBytecode(code) ? "=(bytecode)" : code.c_str();
+  if (0 != luaL_loadbuffer(state.get(), code.data(), code.size(), chunk_name)) {
+    throw LuaException(fmt::format("script load error: {}", lua_tostring(state.get(), -1)));
+  }
+
+  // Compile the code once so that the workers load bytecode rather than parsing the source.
+  std::string bytecode;
+  lua_pushvalue(state.get(), -1);
+  lua_dump(state.get(), writeBytecode, &bytecode);
+  lua_pop(state.get(), 1);
+
+  if (0 != lua_pcall(state.get(), 0, LUA_MULTRET, 0)) {
     throw LuaException(fmt::format("script load error: {}", lua_tostring(state.get(), -1)));
   }
 
   // Now initialize on all threads.
-  tls_slot_->set([code](Event::Dispatcher&) { return std::make_shared<LuaThreadLocal>(code); });
+  tls_slot_->set(
+      [bytecode](Event::Dispatcher&) { return std::make_shared<LuaThreadLocal>(bytecode); });
+}
+
+bool ThreadLocalState::isBytecode(absl::string_view code) {
+  // Both Lua and LuaJIT bytecode start with the escape character, which source cannot.
+  return !code.empty() && code[0] == LUA_SIGNATURE[0];
 }
 
 int ThreadLocalState::getGlobalRef(uint64_t slot) {
@@ -94,12 +121,15 @@ CoroutinePtr ThreadLocalState::createCoroutine() {
   return std::make_unique<Coroutine>(std::make_pair(lua_newthread(state), state));
 }
 
-ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& code)
+ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& bytecode)
     : state_(luaL_newstate()) {
 
   RELEASE_ASSERT(state_.get() != nullptr, "unable to create new Lua state object");
   luaL_openlibs(state_.get());
-  int rc = luaL_dostring(state_.get(), code.c_str());
+  int rc = luaL_loadbuffer(state_.get(), bytecode.data(), bytecode.size(), "=(bytecode)");
+  if (rc == 0) {
+    rc = lua_pcall(state_.get(), 0, LUA_MULTRET, 0);
+  }
   ASSERT(rc == 0);
 }
 
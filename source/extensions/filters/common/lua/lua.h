@@ -11,6 +11,8 @@
 #include "source/common/common/c_smart_ptr.h"
 #include "source/common/common/logger.h"
 
+#include "absl/strings/string_view.h"
+
 #include "lua.hpp"
 
 namespace Envoy {
@@ -389,8 +391,19 @@ using InitializerList = std::vector<Initializer>;
  */
 class ThreadLocalState : Logger::Loggable<Logger::Id::lua> {
 public:
+  /**
+   * @param code supplies the script, either as source or as bytecode precompiled for the Lua
+   *        runtime Envoy is built with. The script is compiled once and every worker loads the
+   *        resulting bytecode.
+   * @param tls supplies the slot allocator of the worker states.
+   */
   ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls);
 
+  /**
+   * @return whether a script is precompiled bytecode rather than source.
+   */
+  static bool isBytecode(absl::string_view code);
+
   /**
    * @return CoroutinePtr a new coroutine.
    */
@@ -436,7 +449,7 @@ public:
 
 private:
   struct LuaThreadLocal : public ThreadLocal::ThreadLocalObject {
-    LuaThreadLocal(const std::string& code);
+    LuaThreadLocal(const std::string& bytecode);
 
     CSmartPtr<lua_State, lua_close> state_;
     std::vector<int> global_slots_;
@@ -0,0 +1,255 @@
+#include "source/extensions/filters/common/ratelimit/quota_lease.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "source/common/protobuf/utility.h"
+#include "source/common/tracing/null_span_impl.h"
+
+#include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+QuotaLeases::QuotaLeases(const envoy::extensions::common::ratelimit::v3::QuotaLease& config,
+                         const Grpc::RawAsyncClientSharedPtr& async_client,
+                         const absl::optional<std::chrono::milliseconds>& timeout,
+                         TimeSource& time_source, const QuotaLeaseStats& stats)
+    : block_size_(config.block_size()),
+      period_(PROTOBUF_GET_MS_OR_DEFAULT(config, period, 1000)),
+      min_requests_per_period_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, min_requests_per_period, block_size_)),
+      async_client_(async_client), timeout_(timeout),
+      service_method_(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+          "envoy.service.ratelimit.v3.RateLimitService.ShouldRateLimit")),
+      time_source_(time_source), stats_(stats),
+      next_removal_(time_source_.monotonicTime() + period_) {}
+
+bool QuotaLeases::consume(const std::string& domain,
+                          const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (now >= next_removal_) {
+    removeIdleLeases(now);
+    request_counts_.clear();
+    next_removal_ = now + period_;
+  }
+
+  // Every descriptor of the request counts towards its lease, even if the request is then sent to
+  // the rate limit service.
+  absl::InlinedVector<Lease*, 4> request_leases;
+  bool leased = true;
+  for (const Envoy::RateLimit::Descriptor& descriptor : descriptors) {
+    const uint64_t descriptor_hash = hash(domain, descriptor);
+    auto it = leases_.find(descriptor_hash);
+    if (it == leases_.end()) {
+      // A descriptor only gets a lease once it received enough requests to ask for one.
+      const uint32_t requests = request_counts_.add(descriptor_hash);
+      if (requests < min_requests_per_period_) {
+        leased = false;
+        continue;
+      }
+      it = leases_
+               .emplace(descriptor_hash,
+                        std::make_unique<Lease>(*this, domain, descriptor, now, requests - 1))
+               .first;
+    } else if (!it->second->matches(domain, descriptor)) {
+      // Another descriptor with the same hash has the lease, this one is left to the service.
+      leased = false;
+      continue;
+    }
+    it->second->onRequest(now);
+    request_leases.push_back(it->second.get());
+  }
+  if (!leased) {
+    return false;
+  }
+
+  // The hits already taken are not given back if a descriptor has no leased hit left: the rate
+  // limit service charged them anyway, so this only errs on the side of the limit.
+  for (Lease* lease : request_leases) {
+    if (!lease->consume()) {
+      return false;
+    }
+  }
+  stats_.leased_request_.inc();
+  return true;
+}
+
+uint64_t QuotaLeases::hash(const std::string& domain,
+                           const Envoy::RateLimit::Descriptor& descriptor) {
+  if (!descriptor.limit_) {
+    return absl::HashOf(domain, descriptor.entries_);
+  }
+  return absl::HashOf(domain, descriptor.entries_, descriptor.limit_->requests_per_unit_,
+                      static_cast<int>(descriptor.limit_->unit_));
+}
+
+void QuotaLeases::removeIdleLeases(MonotonicTime now) {
+  for (auto it = leases_.begin(); it != leases_.end();) {
+    if (it->second->idle(now)) {
+      leases_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+uint32_t QuotaLeases::RequestCounts::add(uint64_t hash) {
+  uint32_t& low = counts_[0][static_cast<uint32_t>(hash) % Width];
+  uint32_t& high = counts_[1][static_cast<uint32_t>(hash >> 32) % Width];
+  return std::min(++low, ++high);
+}
+
+void QuotaLeases::RequestCounts::clear() {
+  for (auto& row : counts_) {
+    row.fill(0);
+  }
+}
+
+QuotaLeases::Lease::Lease(QuotaLeases& parent, const std::string& domain,
+                          const Envoy::RateLimit::Descriptor& descriptor, MonotonicTime now,
+                          uint32_t requests)
+    : parent_(parent), domain_(domain), descriptor_(descriptor), period_start_(now),
+      requests_(requests) {}
+
+QuotaLeases::Lease::~Lease() {
+  if (request_ != nullptr) {
+    request_->cancel();
+  }
+}
+
+bool QuotaLeases::Lease::matches(const std::string& domain,
+                                 const Envoy::RateLimit::Descriptor& descriptor) const {
+  if (domain != domain_ || descriptor.entries_ != descriptor_.entries_ ||
+      descriptor.limit_.has_value() != descriptor_.limit_.has_value()) {
+    return false;
+  }
+  return !descriptor.limit_ ||
+         (descriptor.limit_->requests_per_unit_ == descriptor_.limit_->requests_per_unit_ &&
+          descriptor.limit_->unit_ == descriptor_.limit_->unit_);
+}
+
+void QuotaLeases::Lease::onRequest(MonotonicTime now) {
+  if (now - period_start_ >= parent_.period_) {
+    // The lease is renewed if the descriptor received enough requests in the period that just
+    // ended, and dropped otherwise.
+    const bool renew = requests_ >= parent_.min_requests_per_period_ &&
+                       now - period_start_ < 2 * parent_.period_;
+    period_start_ = now;
+    requests_ = 0;
+    denied_ = false;
+    if (pacing_ != nullptr) {
+      if (renew) {
+        sendRequest();
+      } else {
+        // The hits left are charged anyway, they are given up with the lease.
+        pacing_.reset();
+        leased_hits_ = 0;
+      }
+    }
+  }
+
+  requests_++;
+  if (pacing_ == nullptr && !denied_ && requests_ >= parent_.min_requests_per_period_) {
+    sendRequest();
+  }
+}
+
+bool QuotaLeases::Lease::consume() {
+  if (leased_hits_ == 0 || pacing_->consume(1, false) == 0) {
+    return false;
+  }
+  leased_hits_--;
+  return true;
+}
+
+bool QuotaLeases::Lease::idle(MonotonicTime now) const {
+  return request_ == nullptr && now - period_start_ >= 2 * parent_.period_;
+}
+
+void QuotaLeases::Lease::sendRequest() {
+  if (request_ != nullptr) {
+    return;
+  }
+  envoy::service::ratelimit::v3::RateLimitRequest request;
+  GrpcClientImpl::createRequest(request, domain_, {descriptor_});
+  request.set_hits_addend(parent_.block_size_);
+  // The request may fail inline, in which case it returns nullptr after calling onFailure().
+  request_ = parent_.async_client_->send(
+      parent_.service_method_, request, *this, Tracing::NullSpan::instance(),
+      Http::AsyncClient::RequestOptions().setTimeout(parent_.timeout_));
+}
+
+void QuotaLeases::Lease::onSuccess(
+    std::unique_ptr<envoy::service::ratelimit::v3::RateLimitResponse>&& response, Tracing::Span&) {
+  request_ = nullptr;
+  if (response->overall_code() != envoy::service::ratelimit::v3::RateLimitResponse::OK) {
+    // The hits left from the previous grants were charged, and can still be spent.
+    parent_.stats_.lease_denied_.inc();
+    denied_ = true;
+    return;
+  }
+
+  parent_.stats_.lease_granted_.inc();
+  if (pacing_ == nullptr) {
+    const double period_seconds = std::chrono::duration<double>(parent_.period_).count();
+    pacing_ = std::make_unique<TokenBucketImpl>(parent_.block_size_, parent_.time_source_,
+                                                parent_.block_size_ / period_seconds);
+  }
+  if (leased_hits_ == 0) {
+    // The bucket kept filling while no hit was left. It starts empty again so that the new hits
+    // are spent over the period rather than in a burst.
+    pacing_->maybeReset(0);
+  }
+  leased_hits_ += parent_.block_size_;
+}
+
+void QuotaLeases::Lease::onFailure(Grpc::Status::GrpcStatus status, const std::string& message,
+                                   Tracing::Span&) {
+  ENVOY_LOG_TO_LOGGER(Logger::Registry::getLog(Logger::Id::filter), debug,
+                      "rate limit quota lease fail, status={} msg={}", status, message);
+  request_ = nullptr;
+  parent_.stats_.lease_error_.inc();
+  denied_ = true;
+}
+
+void QuotaLeaseClient::limit(RequestCallbacks& callbacks, const std::string& domain,
+                             const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+                             Tracing::Span& parent_span,
+                             const StreamInfo::StreamInfo& stream_info) {
+  if (leases_.consume(domain, descriptors)) {
+    callbacks.complete(LimitStatus::OK, nullptr, nullptr, nullptr, EMPTY_STRING, nullptr);
+    return;
+  }
+  client_->limit(callbacks, domain, descriptors, parent_span, stream_info);
+}
+
+QuotaLeaseConfig::QuotaLeaseConfig(
+    const envoy::extensions::common::ratelimit::v3::QuotaLease& config,
+    const envoy::config::core::v3::GrpcService& grpc_service,
+    const std::chrono::milliseconds timeout, Server::Configuration::FactoryContext& context)
+    : tls_slot_(ThreadLocal::TypedSlot<QuotaLeases>::makeUnique(context.threadLocal())) {
+  const QuotaLeaseStats stats{ALL_QUOTA_LEASE_STATS(
+      POOL_COUNTER_PREFIX(context.scope(), "ratelimit.quota_lease."))};
+  tls_slot_->set([config, grpc_service, timeout, stats,
+                  &context](Event::Dispatcher& dispatcher) -> std::shared_ptr<QuotaLeases> {
+    return std::make_shared<QuotaLeases>(
+        config,
+        context.clusterManager().grpcAsyncClientManager().getOrCreateRawAsyncClient(
+            grpc_service, context.scope(), true, Grpc::CacheOption::CacheWhenRuntimeEnabled),
+        timeout, dispatcher.timeSource(), stats);
+  });
+}
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
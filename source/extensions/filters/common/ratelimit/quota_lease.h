@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/config/core/v3/grpc_service.pb.h"
+#include "envoy/extensions/common/ratelimit/v3/ratelimit.pb.h"
+#include "envoy/ratelimit/ratelimit.h"
+#include "envoy/server/filter_config.h"
+#include "envoy/service/ratelimit/v3/rls.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "source/common/common/token_bucket_impl.h"
+#include "source/common/grpc/typed_async_client.h"
+#include "source/extensions/filters/common/ratelimit/ratelimit_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+
+/**
+ * All quota lease stats. @see stats_macros.h
+ */
+#define ALL_QUOTA_LEASE_STATS(COUNTER)                                                             \
+  COUNTER(lease_denied)                                                                            \
+  COUNTER(lease_error)                                                                             \
+  COUNTER(lease_granted)                                                                           \
+  COUNTER(leased_request)
+
+/**
+ * Struct definition for all quota lease stats. @see stats_macros.h
+ */
+struct QuotaLeaseStats {
+  ALL_QUOTA_LEASE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * The quota of the rate limit service leased by a worker, by descriptor. A descriptor which
+ * receives enough requests within a period gets a lease: a block of hits charged to the rate limit
+ * service by a single request, which are then spent by the requests of the worker at the pace of a
+ * token bucket filled at a steady rate over the period. The requests of the other descriptors are
+ * only counted in a fixed amount of memory, so that many rarely used descriptors cost nothing.
+ */
+class QuotaLeases : public ThreadLocal::ThreadLocalObject {
+public:
+  QuotaLeases(const envoy::extensions::common::ratelimit::v3::QuotaLease& config,
+              const Grpc::RawAsyncClientSharedPtr& async_client,
+              const absl::optional<std::chrono::milliseconds>& timeout, TimeSource& time_source,
+              const QuotaLeaseStats& stats);
+
+  /**
+   * Records a request, and takes a leased hit of each of its descriptors.
+   * @return whether all the descriptors of the request had a leased hit. Otherwise the request
+   *         must be sent to the rate limit service.
+   */
+  bool consume(const std::string& domain,
+               const std::vector<Envoy::RateLimit::Descriptor>& descriptors);
+
+  /**
+   * @return the number of descriptors with a lease, or about to get one, on the worker.
+   */
+  size_t size() const { return leases_.size(); }
+
+private:
+  class Lease : public RateLimitAsyncCallbacks {
+  public:
+    // The requests are those the descriptor already received in the period.
+    Lease(QuotaLeases& parent, const std::string& domain,
+          const Envoy::RateLimit::Descriptor& descriptor, MonotonicTime now, uint32_t requests);
+    ~Lease() override;
+
+    // Whether the lease is the one of the descriptor, rather than of another with the same hash.
+    bool matches(const std::string& domain, const Envoy::RateLimit::Descriptor& descriptor) const;
+    // Counts a request, and acquires, renews or drops the lease as needed.
+    void onRequest(MonotonicTime now);
+    // Takes a leased hit.
+    bool consume();
+    // Whether the descriptor received no request for a period, and has no request in flight.
+    bool idle(MonotonicTime now) const;
+
+    // Grpc::AsyncRequestCallbacks
+    void onCreateInitialMetadata(Http::RequestHeaderMap&) override {}
+    void onSuccess(std::unique_ptr<envoy::service::ratelimit::v3::RateLimitResponse>&& response,
+                   Tracing::Span& span) override;
+    void onFailure(Grpc::Status::GrpcStatus status, const std::string& message,
+                   Tracing::Span& span) override;
+
+  private:
+    void sendRequest();
+
+    QuotaLeases& parent_;
+    const std::string domain_;
+    const Envoy::RateLimit::Descriptor descriptor_;
+    MonotonicTime period_start_;
+    uint32_t requests_{};
+    // Set when the rate limit service refused a lease, until the end of the period.
+    bool denied_{};
+    // The hits granted by the rate limit service which are not spent yet.
+    uint64_t leased_hits_{};
+    // Paces the spending of the leased hits over the period, if the descriptor has a lease.
+    std::unique_ptr<TokenBucketImpl> pacing_;
+    Grpc::AsyncRequest* request_{};
+  };
+
+  using LeasePtr = std::unique_ptr<Lease>;
+
+  // Counts the requests of the descriptors without a lease in a count-min sketch, which may
+  // overestimate the count of a descriptor but never underestimates it.
+  class RequestCounts {
+  public:
+    // Counts a request, and returns the estimated requests of the descriptor since the last clear.
+    uint32_t add(uint64_t hash);
+    void clear();
+
+  private:
+    static constexpr size_t Width = 1024;
+    // One row per half of the hash of the descriptor.
+    std::array<std::array<uint32_t, Width>, 2> counts_{};
+  };
+
+  static uint64_t hash(const std::string& domain, const Envoy::RateLimit::Descriptor& descriptor);
+  void removeIdleLeases(MonotonicTime now);
+
+  const uint32_t block_size_;
+  const std::chrono::milliseconds period_;
+  const uint32_t min_requests_per_period_;
+  Grpc::AsyncClient<envoy::service::ratelimit::v3::RateLimitRequest,
+                    envoy::service::ratelimit::v3::RateLimitResponse>
+      async_client_;
+  const absl::optional<std::chrono::milliseconds> timeout_;
+  const Protobuf::MethodDescriptor& service_method_;
+  TimeSource& time_source_;
+  const QuotaLeaseStats stats_;
+  absl::flat_hash_map<uint64_t, LeasePtr> leases_;
+  RequestCounts request_counts_;
+  MonotonicTime next_removal_;
+};
+
+/**
+ * A client which allows the requests within the quota leased by the worker, and sends the other
+ * requests to the rate limit service through the wrapped client.
+ */
+class QuotaLeaseClient : public Client {
+public:
+  QuotaLeaseClient(ClientPtr&& client, QuotaLeases& leases)
+      : client_(std::move(client)), leases_(leases) {}
+
+  // Filters::Common::RateLimit::Client
+  void cancel() override { client_->cancel(); }
+  void limit(RequestCallbacks& callbacks, const std::string& domain,
+             const std::vector<Envoy::RateLimit::Descriptor>& descriptors,
+             Tracing::Span& parent_span, const StreamInfo::StreamInfo& stream_info) override;
+
+private:
+  const ClientPtr client_;
+  QuotaLeases& leases_;
+};
+
+/**
+ * The quota leases of all the workers, for a filter configuration.
+ */
+class QuotaLeaseConfig {
+public:
+  QuotaLeaseConfig(const envoy::extensions::common::ratelimit::v3::QuotaLease& config,
+                   const envoy::config::core::v3::GrpcService& grpc_service,
+                   const std::chrono::milliseconds timeout,
+                   Server::Configuration::FactoryContext& context);
+
+  /**
+   * Wraps a rate limit client so that it uses the quota leased by the current worker.
+   */
+  ClientPtr wrap(ClientPtr&& client) {
+    return std::make_unique<QuotaLeaseClient>(std::move(client), **tls_slot_);
+  }
+
+private:
+  ThreadLocal::TypedSlotPtr<QuotaLeases> tls_slot_;
+};
+
+using QuotaLeaseConfigSharedPtr = std::shared_ptr<QuotaLeaseConfig>;
+
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,385 @@
+#include "source/extensions/filters/common/rbac/compiled_policies.h"
+
+#include <algorithm>
+
+#include "source/common/http/path_utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+namespace {
+
+using envoy::config::rbac::v3::Permission;
+using envoy::config::rbac::v3::Principal;
+
+// Identifies a leaf rule, so that identical rules are compiled once.
+std::string leafKey(absl::string_view kind, const Protobuf::Message& rule) {
+  Protobuf::TextFormat::Printer printer;
+  printer.SetUseFieldNumber(true);
+  printer.SetSingleLineMode(true);
+  std::string text;
+  printer.PrintToString(rule, &text);
+  return absl::StrCat(kind, ":", text);
+}
+
+absl::optional<std::string> exactPath(const envoy::type::matcher::v3::PathMatcher& matcher) {
+  if (matcher.has_path() &&
+      matcher.path().match_pattern_case() ==
+          envoy::type::matcher::v3::StringMatcher::MatchPatternCase::kExact &&
+      !matcher.path().ignore_case()) {
+    return matcher.path().exact();
+  }
+  return absl::nullopt;
+}
+
+} // namespace
+
+CompiledPolicies::CompiledPolicies(
+    const Protobuf::Map<std::string, envoy::config::rbac::v3::Policy>& policies,
+    Expr::Builder* builder, ProtobufMessage::ValidationVisitor& validation_visitor) {
+  // The iteration order of protobuf maps is unspecified, the policies are evaluated in name order.
+  std::vector<const std::string*> names;
+  names.reserve(policies.size());
+  for (const auto& policy : policies) {
+    names.push_back(&policy.first);
+  }
+  std::sort(names.begin(), names.end(),
+            [](const std::string* a, const std::string* b) { return *a < *b; });
+
+  std::array<IpRanges, 4> ip_ranges;
+  for (const std::string* name : names) {
+    const envoy::config::rbac::v3::Policy& config = policies.at(*name);
+    auto policy = std::make_unique<Policy>(*name, config);
+
+    Rule permissions{Rule::Type::Or, nullptr, {}};
+    for (const auto& permission : config.permissions()) {
+      permissions.children_.push_back(compile(permission, validation_visitor));
+    }
+    policy->permissions_ = addRule(std::move(permissions));
+    Rule principals{Rule::Type::Or, nullptr, {}};
+    for (const auto& principal : config.principals()) {
+      principals.children_.push_back(compile(principal));
+    }
+    policy->principals_ = addRule(std::move(principals));
+    if (config.has_condition()) {
+      policy->expr_ = Expr::createCondition(*builder, policy->condition_);
+    }
+
+    index(policies_.size(), config, ip_ranges);
+    policies_.push_back(std::move(policy));
+  }
+
+  for (size_t type = 0; type < ip_ranges.size(); ++type) {
+    if (!ip_ranges[type].empty()) {
+      ip_index_[type] = std::make_unique<Network::LcTrie::LcTrie<uint32_t>>(ip_ranges[type]);
+    }
+  }
+  rule_ids_.clear();
+}
+
+const std::string* CompiledPolicies::firstMatch(const Network::Connection& connection,
+                                                const Envoy::Http::RequestHeaderMap& headers,
+                                                const StreamInfo::StreamInfo& info) const {
+  // The policies the request may match: those not indexed and those indexed by an attribute of
+  // the request.
+  std::vector<uint32_t> candidates(unindexed_);
+  if (!path_index_.empty() && headers.Path() != nullptr) {
+    const auto it =
+        path_index_.find(Http::PathUtil::removeQueryAndFragment(headers.getPathValue()));
+    if (it != path_index_.end()) {
+      candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+  }
+  if (!port_index_.empty()) {
+    const auto& address = info.downstreamAddressProvider().localAddress();
+    if (address != nullptr && address->ip() != nullptr) {
+      const auto it = port_index_.find(address->ip()->port());
+      if (it != port_index_.end()) {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+      }
+    }
+  }
+  for (size_t type = 0; type < ip_index_.size(); ++type) {
+    if (ip_index_[type] == nullptr) {
+      continue;
+    }
+    const auto& address = IPMatcher::address(static_cast<IPMatcher::Type>(type), connection, info);
+    if (address != nullptr && address->ip() != nullptr) {
+      const std::vector<uint32_t> policies = ip_index_[type]->getData(address);
+      candidates.insert(candidates.end(), policies.begin(), policies.end());
+    }
+  }
+  if (candidates.size() != unindexed_.size()) {
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  }
+
+  std::vector<RuleResult> results(rules_.size(), RuleResult::Unknown);
+  for (const uint32_t candidate : candidates) {
+    const Policy& policy = *policies_[candidate];
+    if (evaluate(policy.permissions_, connection, headers, info, results) &&
+        evaluate(policy.principals_, connection, headers, info, results) &&
+        (policy.expr_ == nullptr || policy.expr_->matches(info, &headers, nullptr, nullptr))) {
+      return &policy.name_;
+    }
+  }
+  return nullptr;
+}
+
+uint32_t CompiledPolicies::compile(const Permission& permission,
+                                   ProtobufMessage::ValidationVisitor& validation_visitor) {
+  Rule rule{Rule::Type::Leaf, nullptr, {}};
+  switch (permission.rule_case()) {
+  case Permission::RuleCase::kAndRules:
+    rule.type_ = Rule::Type::And;
+    for (const auto& child : permission.and_rules().rules()) {
+      rule.children_.push_back(compile(child, validation_visitor));
+    }
+    return addRule(std::move(rule));
+  case Permission::RuleCase::kOrRules:
+    rule.type_ = Rule::Type::Or;
+    for (const auto& child : permission.or_rules().rules()) {
+      rule.children_.push_back(compile(child, validation_visitor));
+    }
+    return addRule(std::move(rule));
+  case Permission::RuleCase::kNotRule:
+    rule.type_ = Rule::Type::Not;
+    rule.children_.push_back(compile(permission.not_rule(), validation_visitor));
+    return addRule(std::move(rule));
+  default:
+    return addLeaf(leafKey("permission", permission), [&permission, &validation_visitor]() {
+      return Matcher::create(permission, validation_visitor);
+    });
+  }
+}
+
+uint32_t CompiledPolicies::compile(const Principal& principal) {
+  Rule rule{Rule::Type::Leaf, nullptr, {}};
+  switch (principal.identifier_case()) {
+  case Principal::IdentifierCase::kAndIds:
+    rule.type_ = Rule::Type::And;
+    for (const auto& child : principal.and_ids().ids()) {
+      rule.children_.push_back(compile(child));
+    }
+    return addRule(std::move(rule));
+  case Principal::IdentifierCase::kOrIds:
+    rule.type_ = Rule::Type::Or;
+    for (const auto& child : principal.or_ids().ids()) {
+      rule.children_.push_back(compile(child));
+    }
+    return addRule(std::move(rule));
+  case Principal::IdentifierCase::kNotId:
+    rule.type_ = Rule::Type::Not;
+    rule.children_.push_back(compile(principal.not_id()));
+    return addRule(std::move(rule));
+  default:
+    return addLeaf(leafKey("principal", principal),
+                   [&principal]() { return Matcher::create(principal); });
+  }
+}
+
+uint32_t CompiledPolicies::addRule(Rule&& rule) {
+  ASSERT(rule.type_ != Rule::Type::Leaf);
+  // The children are already deduplicated, so identical rules have identical children.
+  std::string key = absl::StrCat(static_cast<int>(rule.type_), ":",
+                                 absl::StrJoin(rule.children_, ","));
+  const auto [it, inserted] = rule_ids_.try_emplace(std::move(key), rules_.size());
+  if (inserted) {
+    rules_.push_back(std::move(rule));
+  }
+  return it->second;
+}
+
+uint32_t CompiledPolicies::addLeaf(std::string&& key,
+                                   const std::function<MatcherConstSharedPtr()>& create) {
+  const auto [it, inserted] = rule_ids_.try_emplace(std::move(key), rules_.size());
+  if (inserted) {
+    rules_.push_back(Rule{Rule::Type::Leaf, create(), {}});
+  }
+  return it->second;
+}
+
+absl::optional<CompiledPolicies::Requirement>
+CompiledPolicies::requirement(const Permission& permission) {
+  Requirement required;
+  switch (permission.rule_case()) {
+  case Permission::RuleCase::kAndRules:
+    return allRequirement(permission.and_rules().rules());
+  case Permission::RuleCase::kOrRules:
+    return anyRequirement(permission.or_rules().rules());
+  case Permission::RuleCase::kUrlPath: {
+    auto path = exactPath(permission.url_path());
+    if (!path.has_value()) {
+      return absl::nullopt;
+    }
+    required.type_ = Requirement::Type::Path;
+    required.paths_.push_back(std::move(path.value()));
+    return required;
+  }
+  case Permission::RuleCase::kDestinationPort:
+    required.type_ = Requirement::Type::Port;
+    required.ports_.push_back(permission.destination_port());
+    return required;
+  case Permission::RuleCase::kDestinationIp: {
+    auto range = Network::Address::CidrRange::create(permission.destination_ip());
+    if (!range.isValid()) {
+      return absl::nullopt;
+    }
+    required.type_ = Requirement::Type::Ip;
+    required.ip_type_ = IPMatcher::Type::DownstreamLocal;
+    required.ranges_.push_back(std::move(range));
+    return required;
+  }
+  default:
+    return absl::nullopt;
+  }
+}
+
+absl::optional<CompiledPolicies::Requirement>
+CompiledPolicies::requirement(const Principal& principal) {
+  Requirement required;
+  switch (principal.identifier_case()) {
+  case Principal::IdentifierCase::kAndIds:
+    return allRequirement(principal.and_ids().ids());
+  case Principal::IdentifierCase::kOrIds:
+    return anyRequirement(principal.or_ids().ids());
+  case Principal::IdentifierCase::kUrlPath: {
+    auto path = exactPath(principal.url_path());
+    if (!path.has_value()) {
+      return absl::nullopt;
+    }
+    required.type_ = Requirement::Type::Path;
+    required.paths_.push_back(std::move(path.value()));
+    return required;
+  }
+  case Principal::IdentifierCase::kSourceIp:
+  case Principal::IdentifierCase::kDirectRemoteIp:
+  case Principal::IdentifierCase::kRemoteIp: {
+    const auto& cidr = principal.has_source_ip()        ? principal.source_ip()
+                       : principal.has_direct_remote_ip() ? principal.direct_remote_ip()
+                                                          : principal.remote_ip();
+    auto range = Network::Address::CidrRange::create(cidr);
+    if (!range.isValid()) {
+      return absl::nullopt;
+    }
+    required.type_ = Requirement::Type::Ip;
+    required.ip_type_ = principal.has_source_ip()          ? IPMatcher::Type::ConnectionRemote
+                        : principal.has_direct_remote_ip() ? IPMatcher::Type::DownstreamDirectRemote
+                                                           : IPMatcher::Type::DownstreamRemote;
+    required.ranges_.push_back(std::move(range));
+    return required;
+  }
+  default:
+    return absl::nullopt;
+  }
+}
+
+// A request matching any of the rules must satisfy the requirement of one of them, so the rules
+// have a requirement only if all of them have one, of the same type.
+template <class T>
+absl::optional<CompiledPolicies::Requirement>
+CompiledPolicies::anyRequirement(const Protobuf::RepeatedPtrField<T>& rules) {
+  absl::optional<Requirement> merged;
+  for (const auto& rule : rules) {
+    absl::optional<Requirement> required = requirement(rule);
+    if (!required.has_value()) {
+      return absl::nullopt;
+    }
+    if (!merged.has_value()) {
+      merged = std::move(required);
+      continue;
+    }
+    if (merged->type_ != required->type_ || merged->ip_type_ != required->ip_type_) {
+      return absl::nullopt;
+    }
+    merged->paths_.insert(merged->paths_.end(), required->paths_.begin(), required->paths_.end());
+    merged->ports_.insert(merged->ports_.end(), required->ports_.begin(), required->ports_.end());
+    merged->ranges_.insert(merged->ranges_.end(), required->ranges_.begin(),
+                           required->ranges_.end());
+  }
+  return merged;
+}
+
+// A request matching all the rules satisfies the requirement of each of them, any one will do.
+template <class T>
+absl::optional<CompiledPolicies::Requirement>
+CompiledPolicies::allRequirement(const Protobuf::RepeatedPtrField<T>& rules) {
+  for (const auto& rule : rules) {
+    absl::optional<Requirement> required = requirement(rule);
+    if (required.has_value()) {
+      return required;
+    }
+  }
+  return absl::nullopt;
+}
+
+void CompiledPolicies::index(uint32_t policy, const envoy::config::rbac::v3::Policy& config,
+                             std::array<IpRanges, 4>& ip_ranges) {
+  absl::optional<Requirement> required = anyRequirement(config.permissions());
+  if (!required.has_value()) {
+    required = anyRequirement(config.principals());
+  }
+  if (!required.has_value()) {
+    unindexed_.push_back(policy);
+    return;
+  }
+
+  switch (required->type_) {
+  case Requirement::Type::Path:
+    for (const std::string& path : required->paths_) {
+      path_index_[path].push_back(policy);
+    }
+    break;
+  case Requirement::Type::Port:
+    for (const uint32_t port : required->ports_) {
+      port_index_[port].push_back(policy);
+    }
+    break;
+  case Requirement::Type::Ip:
+    ip_ranges[required->ip_type_].emplace_back(policy, std::move(required->ranges_));
+    break;
+  }
+}
+
+bool CompiledPolicies::evaluate(uint32_t rule_id, const Network::Connection& connection,
+                                const Envoy::Http::RequestHeaderMap& headers,
+                                const StreamInfo::StreamInfo& info,
+                                std::vector<RuleResult>& results) const {
+  if (results[rule_id] != RuleResult::Unknown) {
+    return results[rule_id] == RuleResult::Matched;
+  }
+
+  const Rule& rule = rules_[rule_id];
+  const auto evaluate_child = [&](uint32_t child) {
+    return evaluate(child, connection, headers, info, results);
+  };
+  bool matched = false;
+  switch (rule.type_) {
+  case Rule::Type::Leaf:
+    matched = rule.matcher_->matches(connection, headers, info);
+    break;
+  case Rule::Type::And:
+    matched = std::all_of(rule.children_.begin(), rule.children_.end(), evaluate_child);
+    break;
+  case Rule::Type::Or:
+    matched = std::any_of(rule.children_.begin(), rule.children_.end(), evaluate_child);
+    break;
+  case Rule::Type::Not:
+    matched = !evaluate_child(rule.children_[0]);
+    break;
+  }
+  results[rule_id] = matched ? RuleResult::Matched : RuleResult::NotMatched;
+  return matched;
+}
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
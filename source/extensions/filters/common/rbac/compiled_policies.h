@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/rbac/v3/rbac.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/network/connection.h"
+#include "envoy/stream_info/stream_info.h"
+
+#include "source/common/network/lc_trie.h"
+#include "source/extensions/filters/common/expr/evaluator.h"
+#include "source/extensions/filters/common/rbac/matchers.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+/**
+ * The policies of an RBAC engine compiled for evaluation. Identical permission and principal rules
+ * are shared by all the policies using them and evaluated at most once per request. The policies
+ * requiring an exact path, a destination port or an IP range are indexed by it, so that only the
+ * policies a request may match are evaluated. The first matching policy is the same as when
+ * evaluating all the policies in the order of their names.
+ */
+class CompiledPolicies : NonCopyable {
+public:
+  CompiledPolicies(const Protobuf::Map<std::string, envoy::config::rbac::v3::Policy>& policies,
+                   Expr::Builder* builder, ProtobufMessage::ValidationVisitor& validation_visitor);
+
+  /**
+   * @return the name of the first policy, in name order, matching the request, or nullptr if no
+   *         policy matches.
+   */
+  const std::string* firstMatch(const Network::Connection& connection,
+                                const Envoy::Http::RequestHeaderMap& headers,
+                                const StreamInfo::StreamInfo& info) const;
+
+  /**
+   * @return the number of distinct rules of all the policies.
+   */
+  size_t rules() const { return rules_.size(); }
+
+  /**
+   * @return the number of policies which are not indexed, and are evaluated for every request.
+   */
+  size_t unindexedPolicies() const { return unindexed_.size(); }
+
+private:
+  // A rule shared by all the permissions or principals using it. Leaves are evaluated by a
+  // matcher, the other rules combine the results of their children.
+  struct Rule {
+    enum class Type { Leaf, And, Or, Not };
+
+    Type type_;
+    MatcherConstSharedPtr matcher_;
+    std::vector<uint32_t> children_;
+  };
+
+  struct Policy {
+    Policy(const std::string& name, const envoy::config::rbac::v3::Policy& policy)
+        : name_(name), condition_(policy.condition()) {}
+
+    const std::string name_;
+    uint32_t permissions_{};
+    uint32_t principals_{};
+    const google::api::expr::v1alpha1::Expr condition_;
+    Expr::ConditionPtr expr_;
+  };
+
+  // A condition a request must satisfy to match a permission or principal.
+  struct Requirement {
+    enum class Type { Path, Port, Ip };
+
+    Type type_;
+    IPMatcher::Type ip_type_{};
+    std::vector<std::string> paths_;
+    std::vector<uint32_t> ports_;
+    std::vector<Network::Address::CidrRange> ranges_;
+  };
+
+  enum class RuleResult : uint8_t { Unknown, Matched, NotMatched };
+
+  uint32_t compile(const envoy::config::rbac::v3::Permission& permission,
+                   ProtobufMessage::ValidationVisitor& validation_visitor);
+  uint32_t compile(const envoy::config::rbac::v3::Principal& principal);
+  uint32_t addRule(Rule&& rule);
+  uint32_t addLeaf(std::string&& key, const std::function<MatcherConstSharedPtr()>& create);
+
+  static absl::optional<Requirement>
+  requirement(const envoy::config::rbac::v3::Permission& permission);
+  static absl::optional<Requirement>
+  requirement(const envoy::config::rbac::v3::Principal& principal);
+  template <class T>
+  static absl::optional<Requirement> anyRequirement(const Protobuf::RepeatedPtrField<T>& rules);
+  template <class T>
+  static absl::optional<Requirement> allRequirement(const Protobuf::RepeatedPtrField<T>& rules);
+  using IpRanges = std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>>;
+  void index(uint32_t policy, const envoy::config::rbac::v3::Policy& config,
+             std::array<IpRanges, 4>& ip_ranges);
+
+  bool evaluate(uint32_t rule, const Network::Connection& connection,
+                const Envoy::Http::RequestHeaderMap& headers, const StreamInfo::StreamInfo& info,
+                std::vector<RuleResult>& results) const;
+
+  std::vector<Rule> rules_;
+  // Only used while compiling the policies.
+  absl::flat_hash_map<std::string, uint32_t> rule_ids_;
+  // The policies, in name order.
+  std::vector<std::unique_ptr<Policy>> policies_;
+  absl::flat_hash_map<std::string, std::vector<uint32_t>> path_index_;
+  absl::flat_hash_map<uint32_t, std::vector<uint32_t>> port_index_;
+  // Indexed by IPMatcher::Type.
+  std::array<std::unique_ptr<Network::LcTrie::LcTrie<uint32_t>>, 4> ip_index_;
+  std::vector<uint32_t> unindexed_;
+};
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -22,10 +22,8 @@ RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     }
   }
 
-  for (const auto& policy : rules.policies()) {
-    policies_.emplace(policy.first, std::make_unique<PolicyMatcher>(policy.second, builder_.get(),
-                                                                    validation_visitor));
-  }
+  policies_ =
+      std::make_unique<CompiledPolicies>(rules.policies(), builder_.get(), validation_visitor);
 }
 
 bool RoleBasedAccessControlEngineImpl::handleAction(const Network::Connection& connection,
@@ -39,6 +37,10 @@ bool RoleBasedAccessControlEngineImpl::handleAction(const Network::Connection& c
                                                     const Envoy::Http::RequestHeaderMap& headers,
                                                     StreamInfo::StreamInfo& info,
                                                     std::string* effective_policy_id) const {
+  if (builder_ != nullptr) {
+    // The conditions of the policies reuse the value producers of the request.
+    Expr::StreamActivation::getOrCreate(info);
+  }
   bool matched = checkPolicyMatch(connection, info, headers, effective_policy_id);
 
   switch (action_) {
@@ -65,19 +67,14 @@ bool RoleBasedAccessControlEngineImpl::handleAction(const Network::Connection& c
 bool RoleBasedAccessControlEngineImpl::checkPolicyMatch(
     const Network::Connection& connection, const StreamInfo::StreamInfo& info,
     const Envoy::Http::RequestHeaderMap& headers, std::string* effective_policy_id) const {
-  bool matched = false;
-
-  for (const auto& policy : policies_) {
-    if (policy.second->matches(connection, headers, info)) {
-      matched = true;
-      if (effective_policy_id != nullptr) {
-        *effective_policy_id = policy.first;
-      }
-      break;
-    }
+  const std::string* policy = policies_->firstMatch(connection, headers, info);
+  if (policy == nullptr) {
+    return false;
   }
-
-  return matched;
+  if (effective_policy_id != nullptr) {
+    *effective_policy_id = *policy;
+  }
+  return true;
 }
 
 } // namespace RBAC
@@ -146,22 +146,23 @@ bool HeaderMatcher::matches(const Network::Connection&,
 
 bool IPMatcher::matches(const Network::Connection& connection, const Envoy::Http::RequestHeaderMap&,
                         const StreamInfo::StreamInfo& info) const {
-  Envoy::Network::Address::InstanceConstSharedPtr ip;
-  switch (type_) {
+  return range_.isInRange(*address(type_, connection, info).get());
+}
+
+const Envoy::Network::Address::InstanceConstSharedPtr&
+IPMatcher::address(Type type, const Network::Connection& connection,
+                   const StreamInfo::StreamInfo& info) {
+  switch (type) {
   case ConnectionRemote:
-    ip = connection.connectionInfoProvider().remoteAddress();
-    break;
+    return connection.connectionInfoProvider().remoteAddress();
   case DownstreamLocal:
-    ip = info.downstreamAddressProvider().localAddress();
-    break;
+    return info.downstreamAddressProvider().localAddress();
   case DownstreamDirectRemote:
-    ip = info.downstreamAddressProvider().directRemoteAddress();
-    break;
+    return info.downstreamAddressProvider().directRemoteAddress();
   case DownstreamRemote:
-    ip = info.downstreamAddressProvider().remoteAddress();
-    break;
+    return info.downstreamAddressProvider().remoteAddress();
   }
-  return range_.isInRange(*ip.get());
+  PANIC_DUE_TO_CORRUPT_ENUM;
 }
 
 bool PortMatcher::matches(const Network::Connection&, const Envoy::Http::RequestHeaderMap&,
@@ -233,14 +234,6 @@ bool MetadataMatcher::matches(const Network::Connection&, const Envoy::Http::Req
   return matcher_.match(info.dynamicMetadata());
 }
 
-bool PolicyMatcher::matches(const Network::Connection& connection,
-                            const Envoy::Http::RequestHeaderMap& headers,
-                            const StreamInfo::StreamInfo& info) const {
-  return permissions_.matches(connection, headers, info) &&
-         principals_.matches(connection, headers, info) &&
-         (expr_ == nullptr ? true : Expr::matches(*expr_, info, headers));
-}
-
 bool RequestedServerNameMatcher::matches(const Network::Connection& connection,
                                          const Envoy::Http::RequestHeaderMap&,
                                          const StreamInfo::StreamInfo&) const {
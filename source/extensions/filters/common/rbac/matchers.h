@@ -7,13 +7,14 @@
 #include "envoy/config/route/v3/route_components.pb.h"
 #include "envoy/http/header_map.h"
 #include "envoy/network/connection.h"
+#include "envoy/protobuf/message_validator.h"
+#include "envoy/stream_info/stream_info.h"
 #include "envoy/type/matcher/v3/path.pb.h"
 #include "envoy/type/matcher/v3/string.pb.h"
 
 #include "source/common/common/matchers.h"
 #include "source/common/http/header_utility.h"
 #include "source/common/network/cidr_range.h"
-#include "source/extensions/filters/common/expr/evaluator.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -150,6 +151,12 @@ public:
   bool matches(const Network::Connection& connection, const Envoy::Http::RequestHeaderMap& headers,
                const StreamInfo::StreamInfo& info) const override;
 
+  /**
+   * @return the address of the connection a matcher of a type is applied to.
+   */
+  static const Network::Address::InstanceConstSharedPtr&
+  address(Type type, const Network::Connection& connection, const StreamInfo::StreamInfo& info);
+
 private:
   const Network::Address::CidrRange range_;
   const Type type_;
@@ -202,32 +209,6 @@ private:
       matcher_;
 };
 
-/**
- * Matches a Policy which is a collection of permission and principal matchers. If any action
- * matches a permission, the principals are then checked for a match.
- * The condition is a conjunction clause.
- */
-class PolicyMatcher : public Matcher, NonCopyable {
-public:
-  PolicyMatcher(const envoy::config::rbac::v3::Policy& policy, Expr::Builder* builder,
-                ProtobufMessage::ValidationVisitor& validation_visitor)
-      : permissions_(policy.permissions(), validation_visitor), principals_(policy.principals()),
-        condition_(policy.condition()) {
-    if (policy.has_condition()) {
-      expr_ = Expr::createExpression(*builder, condition_);
-    }
-  }
-
-  bool matches(const Network::Connection& connection, const Envoy::Http::RequestHeaderMap& headers,
-               const StreamInfo::StreamInfo&) const override;
-
-private:
-  const OrMatcher permissions_;
-  const OrMatcher principals_;
-  const google::api::expr::v1alpha1::Expr condition_;
-  Expr::ExpressionPtr expr_;
-};
-
 class MetadataMatcher : public Matcher {
 public:
   MetadataMatcher(const Envoy::Matchers::MetadataMatcher& matcher) : matcher_(matcher) {}
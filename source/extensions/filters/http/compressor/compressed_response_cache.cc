@@ -0,0 +1,312 @@
+#include "source/extensions/filters/http/compressor/compressed_response_cache.h"
+
+#include "envoy/http/codes.h"
+#include "envoy/registry/registry.h"
+#include "envoy/type/matcher/v3/string.pb.h"
+
+#include "source/common/common/enum_to_int.h"
+#include "source/common/common/hash.h"
+#include "source/common/config/utility.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+namespace {
+
+// Default maximum total size of the compressed responses held in memory.
+constexpr uint64_t DefaultMaxCacheBytes = 64 * 1024 * 1024;
+
+// Default maximum size of a compressed response.
+constexpr uint32_t DefaultMaxEntryBytes = 1024 * 1024;
+
+class InMemoryLookup : public CompressedResponseLookup {
+public:
+  InMemoryLookup(std::string&& key, CompressedResponseConstSharedPtr&& response)
+      : key_(std::move(key)), response_(std::move(response)) {}
+
+  // CompressedResponseLookup
+  bool completed() const override { return true; }
+  CompressedResponseConstSharedPtr response() const override { return response_; }
+  void onDestroy() override {}
+
+  const std::string& key() const { return key_; }
+
+private:
+  const std::string key_;
+  const CompressedResponseConstSharedPtr response_;
+};
+
+// Looks up a compressed response in an HttpCache. As in the cache filter, the callbacks of the
+// cache are posted to the worker thread, and hold a weak reference to the lookup which may be gone
+// by the time they run.
+class HttpCacheLookup : public CompressedResponseLookup,
+                        public std::enable_shared_from_this<HttpCacheLookup> {
+public:
+  HttpCacheLookup(Cache::LookupContextPtr&& lookup_context, const std::string& encoding,
+                  Event::Dispatcher& dispatcher, uint32_t max_entry_bytes)
+      : lookup_context_(std::move(lookup_context)), encoding_(encoding), dispatcher_(dispatcher),
+        max_entry_bytes_(max_entry_bytes) {}
+
+  void getHeaders() {
+    std::weak_ptr<HttpCacheLookup> self = weak_from_this();
+    lookup_context_->getHeaders(
+        [self, &dispatcher = dispatcher_](Cache::LookupResult&& result) {
+          // The lambda passed to dispatcher.post() must be copyable, hence the headers are
+          // captured as a raw pointer and wrapped back in a unique_ptr when it runs.
+          dispatcher.post([self, status = result.cache_entry_status_,
+                           headers_raw_ptr = result.headers_.release(),
+                           content_length = result.content_length_]() {
+            Http::ResponseHeaderMapPtr headers = absl::WrapUnique(headers_raw_ptr);
+            if (std::shared_ptr<HttpCacheLookup> lookup = self.lock()) {
+              lookup->onHeaders(status, std::move(headers), content_length);
+            }
+          });
+        });
+  }
+
+  // CompressedResponseLookup
+  bool completed() const override { return completed_; }
+  CompressedResponseConstSharedPtr response() const override { return response_; }
+  void onDestroy() override {
+    if (lookup_context_ != nullptr) {
+      lookup_context_->onDestroy();
+    }
+    if (insert_context_ != nullptr) {
+      insert_context_->onDestroy();
+    }
+  }
+
+  const std::string& encoding() const { return encoding_; }
+  Cache::LookupContextPtr takeLookupContext() { return std::move(lookup_context_); }
+  void setInsertContext(Cache::InsertContextPtr&& insert_context) {
+    insert_context_ = std::move(insert_context);
+  }
+
+private:
+  void onHeaders(Cache::CacheEntryStatus status, Http::ResponseHeaderMapPtr&& headers,
+                 uint64_t content_length) {
+    // The responses are stored with "cache-control: no-cache": instead of being validated with the
+    // upstream, their entity tag is checked against the one of the upstream response.
+    if ((status != Cache::CacheEntryStatus::Ok &&
+         status != Cache::CacheEntryStatus::RequiresValidation) ||
+        headers == nullptr || content_length == 0 || content_length > max_entry_bytes_) {
+      completed_ = true;
+      return;
+    }
+    const auto etag = headers->get(Http::CustomHeaders::get().Etag);
+    if (etag.empty()) {
+      completed_ = true;
+      return;
+    }
+    etag_ = std::string(etag[0]->value().getStringView());
+    content_length_ = content_length;
+    getBody();
+  }
+
+  void getBody() {
+    std::weak_ptr<HttpCacheLookup> self = weak_from_this();
+    lookup_context_->getBody(
+        Cache::AdjustedByteRange(body_.length(), content_length_),
+        [self, &dispatcher = dispatcher_](Buffer::InstancePtr&& body) {
+          dispatcher.post([self, body_raw_ptr = body.release()]() {
+            Buffer::InstancePtr body = absl::WrapUnique(body_raw_ptr);
+            if (std::shared_ptr<HttpCacheLookup> lookup = self.lock()) {
+              lookup->onBody(std::move(body));
+            }
+          });
+        });
+  }
+
+  void onBody(Buffer::InstancePtr&& body) {
+    if (body == nullptr) {
+      completed_ = true;
+      return;
+    }
+    body_.move(*body);
+    if (body_.length() < content_length_) {
+      getBody();
+      return;
+    }
+    response_ = std::make_shared<const CompressedResponse>(
+        CompressedResponse{std::move(etag_), body_.toString()});
+    body_.drain(body_.length());
+    completed_ = true;
+  }
+
+  Cache::LookupContextPtr lookup_context_;
+  Cache::InsertContextPtr insert_context_;
+  const std::string encoding_;
+  Event::Dispatcher& dispatcher_;
+  const uint32_t max_entry_bytes_;
+  std::string etag_;
+  uint64_t content_length_{};
+  Buffer::OwnedImpl body_;
+  CompressedResponseConstSharedPtr response_;
+  bool completed_{};
+};
+
+// Allows the compressed responses stored in an HttpCache to vary on the Accept-Encoding header.
+Protobuf::RepeatedPtrField<envoy::type::matcher::v3::StringMatcher> acceptEncodingAllowList() {
+  Protobuf::RepeatedPtrField<envoy::type::matcher::v3::StringMatcher> allow_list;
+  allow_list.Add()->set_exact(Http::CustomHeaders::get().VaryValues.AcceptEncoding);
+  return allow_list;
+}
+
+} // namespace
+
+uint64_t CacheableUrls::hash(const Http::RequestHeaderMap& request_headers) {
+  absl::string_view url[] = {request_headers.getSchemeValue(), request_headers.getHostValue(),
+                             request_headers.getPathValue()};
+  const uint64_t hash = HashUtil::xxHash64(url);
+  return hash != 0 ? hash : 1;
+}
+
+CompressedResponseLookupSharedPtr
+InMemoryCompressedResponseCache::lookup(const Http::RequestHeaderMap& request_headers,
+                                        const std::string& encoding,
+                                        Http::StreamDecoderFilterCallbacks&) {
+  std::string key = absl::StrCat(request_headers.getSchemeValue(), "://",
+                                 request_headers.getHostValue(), request_headers.getPathValue(),
+                                 "\n", encoding);
+  CompressedResponseConstSharedPtr response;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      response = it->second->second;
+    }
+  }
+  return std::make_shared<InMemoryLookup>(std::move(key), std::move(response));
+}
+
+void InMemoryCompressedResponseCache::insert(CompressedResponseLookup& lookup,
+                                             CompressedResponseConstSharedPtr response,
+                                             Http::StreamEncoderFilterCallbacks&) {
+  const uint64_t size = response->body_.size();
+  if (size > max_cache_bytes_) {
+    return;
+  }
+  const std::string& key = static_cast<InMemoryLookup&>(lookup).key();
+
+  absl::MutexLock lock(&mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    cache_bytes_ -= it->second->second->body_.size();
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.emplace_front(key, std::move(response));
+  index_.emplace(key, entries_.begin());
+  cache_bytes_ += size;
+
+  while (cache_bytes_ > max_cache_bytes_) {
+    const Entry& last = entries_.back();
+    cache_bytes_ -= last.second->body_.size();
+    index_.erase(last.first);
+    entries_.pop_back();
+  }
+}
+
+uint64_t InMemoryCompressedResponseCache::cacheBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return cache_bytes_;
+}
+
+size_t InMemoryCompressedResponseCache::size() const {
+  absl::MutexLock lock(&mutex_);
+  return entries_.size();
+}
+
+HttpCacheCompressedResponseCache::HttpCacheCompressedResponseCache(
+    std::shared_ptr<Cache::HttpCache> http_cache, TimeSource& time_source,
+    uint32_t max_entry_bytes)
+    : http_cache_(std::move(http_cache)), time_source_(time_source),
+      max_entry_bytes_(max_entry_bytes), vary_allow_list_(acceptEncodingAllowList()) {}
+
+CompressedResponseLookupSharedPtr
+HttpCacheCompressedResponseCache::lookup(const Http::RequestHeaderMap& request_headers,
+                                         const std::string& encoding,
+                                         Http::StreamDecoderFilterCallbacks& callbacks) {
+  // The compressed response is looked up as the response to a GET request for the same URL,
+  // accepting only the content encoding of the compressor.
+  auto headers = Http::RequestHeaderMapImpl::create();
+  headers->setMethod(Http::Headers::get().MethodValues.Get);
+  headers->setScheme(request_headers.getSchemeValue() == Http::Headers::get().SchemeValues.Https
+                         ? Http::Headers::get().SchemeValues.Https
+                         : Http::Headers::get().SchemeValues.Http);
+  headers->setHost(request_headers.getHostValue());
+  headers->setPath(request_headers.getPathValue());
+  headers->setCopy(Http::CustomHeaders::get().AcceptEncoding, encoding);
+
+  Cache::LookupRequest lookup_request(*headers, time_source_.systemTime(), vary_allow_list_);
+  auto lookup = std::make_shared<HttpCacheLookup>(
+      http_cache_->makeLookupContext(std::move(lookup_request), callbacks), encoding,
+      callbacks.dispatcher(), max_entry_bytes_);
+  lookup->getHeaders();
+  return lookup;
+}
+
+void HttpCacheCompressedResponseCache::insert(CompressedResponseLookup& lookup,
+                                              CompressedResponseConstSharedPtr response,
+                                              Http::StreamEncoderFilterCallbacks& callbacks) {
+  auto& http_cache_lookup = static_cast<HttpCacheLookup&>(lookup);
+  Cache::LookupContextPtr lookup_context = http_cache_lookup.takeLookupContext();
+  if (lookup_context == nullptr) {
+    return;
+  }
+
+  auto headers = Http::ResponseHeaderMapImpl::create();
+  headers->setStatus(enumToInt(Http::Code::OK));
+  headers->setContentLength(response->body_.size());
+  headers->setCopy(Http::CustomHeaders::get().ContentEncoding, http_cache_lookup.encoding());
+  headers->setCopy(Http::CustomHeaders::get().Etag, response->etag_);
+  headers->setCopy(Http::CustomHeaders::get().Vary,
+                   Http::CustomHeaders::get().VaryValues.AcceptEncoding);
+  headers->setCopy(Http::CustomHeaders::get().CacheControl,
+                   Http::CustomHeaders::get().CacheControlValues.NoCache);
+
+  Cache::InsertContextPtr insert_context =
+      http_cache_->makeInsertContext(std::move(lookup_context), callbacks);
+  insert_context->insertHeaders(*headers, Cache::ResponseMetadata{time_source_.systemTime()},
+                                false);
+  Buffer::OwnedImpl body(response->body_);
+  insert_context->insertBody(body, [](bool) {}, true);
+  http_cache_lookup.setInsertContext(std::move(insert_context));
+}
+
+CompressedResponseCacheSharedPtr createCompressedResponseCache(
+    const envoy::extensions::filters::http::compressor::v3::Compressor::CompressedResponseCache&
+        config,
+    Server::Configuration::FactoryContext& context) {
+  const uint32_t max_entry_bytes =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entry_bytes, DefaultMaxEntryBytes);
+  if (!config.has_http_cache()) {
+    return std::make_shared<InMemoryCompressedResponseCache>(
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_cache_bytes, DefaultMaxCacheBytes),
+        max_entry_bytes);
+  }
+
+  const std::string type{
+      TypeUtil::typeUrlToDescriptorFullName(config.http_cache().typed_config().type_url())};
+  Cache::HttpCacheFactory* const http_cache_factory =
+      Registry::FactoryRegistry<Cache::HttpCacheFactory>::getFactoryByType(type);
+  if (http_cache_factory == nullptr) {
+    throw EnvoyException(
+        fmt::format("Didn't find a registered implementation for type: '{}'", type));
+  }
+  return std::make_shared<HttpCacheCompressedResponseCache>(
+      http_cache_factory->getCache(config.http_cache(), context), context.timeSource(),
+      max_entry_bytes);
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
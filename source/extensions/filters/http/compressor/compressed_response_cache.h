@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/http/header_map.h"
+#include "envoy/server/factory_context.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/extensions/filters/http/cache/http_cache.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * A response body compressed with one content encoding, along with the strong entity tag of the
+ * uncompressed response it was produced from.
+ */
+struct CompressedResponse {
+  std::string etag_;
+  std::string body_;
+};
+
+using CompressedResponseConstSharedPtr = std::shared_ptr<const CompressedResponse>;
+
+/**
+ * The lookup of the compressed variant of the response to a request.
+ */
+class CompressedResponseLookup {
+public:
+  virtual ~CompressedResponseLookup() = default;
+
+  /**
+   * @return whether the lookup has completed. A lookup which has not completed when the response
+   *         arrives is treated as a miss, and the compressed response is not inserted.
+   */
+  virtual bool completed() const PURE;
+
+  /**
+   * @return the compressed response found, or nullptr if there was none or the lookup has not
+   *         completed. The entity tag of the response must be checked before using it.
+   */
+  virtual CompressedResponseConstSharedPtr response() const PURE;
+
+  /**
+   * Called before the filter is destroyed. Cancels any outstanding asynchronous operation.
+   */
+  virtual void onDestroy() PURE;
+};
+
+using CompressedResponseLookupSharedPtr = std::shared_ptr<CompressedResponseLookup>;
+
+/**
+ * Cache of compressed responses shared by the workers, keyed by the URL of the request and the
+ * content encoding.
+ */
+class CompressedResponseCache {
+public:
+  virtual ~CompressedResponseCache() = default;
+
+  /**
+   * Starts the lookup of the compressed variant of the response to a request. The lookup may
+   * complete asynchronously, on the worker thread of the request.
+   * @param request_headers the headers of the request, with a host and a path.
+   * @param encoding the content encoding of the compressed variant.
+   * @param callbacks the callbacks of the filter looking up the compressed variant.
+   */
+  virtual CompressedResponseLookupSharedPtr
+  lookup(const Http::RequestHeaderMap& request_headers, const std::string& encoding,
+         Http::StreamDecoderFilterCallbacks& callbacks) PURE;
+
+  /**
+   * Stores the compressed variant of the response to the request of a completed lookup.
+   */
+  virtual void insert(CompressedResponseLookup& lookup, CompressedResponseConstSharedPtr response,
+                      Http::StreamEncoderFilterCallbacks& callbacks) PURE;
+
+  /**
+   * @return the maximum size of a compressed body stored in the cache.
+   */
+  virtual uint32_t maxEntryBytes() const PURE;
+};
+
+using CompressedResponseCacheSharedPtr = std::shared_ptr<CompressedResponseCache>;
+
+/**
+ * The URLs which received a 200 response with a strong entity tag, the only ones looked up in the
+ * cache of compressed responses. The URLs are tracked by hash in a fixed size table shared by the
+ * workers: a URL is forgotten when another one takes its slot, and URLs sharing a hash at worst
+ * cost a needless lookup.
+ */
+class CacheableUrls {
+public:
+  /**
+   * @return the hash of the URL of a request, with a host and a path. Never 0.
+   */
+  static uint64_t hash(const Http::RequestHeaderMap& request_headers);
+
+  void insert(uint64_t hash) {
+    slots_[hash % slots_.size()].store(hash, std::memory_order_relaxed);
+  }
+  bool contains(uint64_t hash) const {
+    return slots_[hash % slots_.size()].load(std::memory_order_relaxed) == hash;
+  }
+
+private:
+  // 0 marks an empty slot.
+  std::array<std::atomic<uint64_t>, 4096> slots_{};
+};
+
+/**
+ * Compressed responses held in memory, evicted in least recently used order once their total size
+ * exceeds a limit.
+ */
+class InMemoryCompressedResponseCache : public CompressedResponseCache {
+public:
+  InMemoryCompressedResponseCache(uint64_t max_cache_bytes, uint32_t max_entry_bytes)
+      : max_cache_bytes_(max_cache_bytes), max_entry_bytes_(max_entry_bytes) {}
+
+  // CompressedResponseCache
+  CompressedResponseLookupSharedPtr lookup(const Http::RequestHeaderMap& request_headers,
+                                           const std::string& encoding,
+                                           Http::StreamDecoderFilterCallbacks& callbacks) override;
+  void insert(CompressedResponseLookup& lookup, CompressedResponseConstSharedPtr response,
+              Http::StreamEncoderFilterCallbacks& callbacks) override;
+  uint32_t maxEntryBytes() const override { return max_entry_bytes_; }
+
+  uint64_t cacheBytes() const;
+  size_t size() const;
+
+private:
+  using Entry = std::pair<std::string, CompressedResponseConstSharedPtr>;
+
+  const uint64_t max_cache_bytes_;
+  const uint32_t max_entry_bytes_;
+  mutable absl::Mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::list<Entry>::iterator> index_ ABSL_GUARDED_BY(mutex_);
+  uint64_t cache_bytes_ ABSL_GUARDED_BY(mutex_){};
+};
+
+/**
+ * Compressed responses stored in an HttpCache, as responses to the URL of the request varied on
+ * the Accept-Encoding header.
+ */
+class HttpCacheCompressedResponseCache : public CompressedResponseCache {
+public:
+  HttpCacheCompressedResponseCache(std::shared_ptr<Cache::HttpCache> http_cache,
+                                   TimeSource& time_source, uint32_t max_entry_bytes);
+
+  // CompressedResponseCache
+  CompressedResponseLookupSharedPtr lookup(const Http::RequestHeaderMap& request_headers,
+                                           const std::string& encoding,
+                                           Http::StreamDecoderFilterCallbacks& callbacks) override;
+  void insert(CompressedResponseLookup& lookup, CompressedResponseConstSharedPtr response,
+              Http::StreamEncoderFilterCallbacks& callbacks) override;
+  uint32_t maxEntryBytes() const override { return max_entry_bytes_; }
+
+private:
+  const std::shared_ptr<Cache::HttpCache> http_cache_;
+  TimeSource& time_source_;
+  const uint32_t max_entry_bytes_;
+  const Cache::VaryAllowList vary_allow_list_;
+};
+
+/**
+ * Creates the cache of compressed responses configured for a compressor filter.
+ */
+CompressedResponseCacheSharedPtr createCompressedResponseCache(
+    const envoy::extensions::filters::http::compressor::v3::Compressor::CompressedResponseCache&
+        config,
+    Server::Configuration::FactoryContext& context);
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,9 +1,14 @@
 #include "source/extensions/filters/http/compressor/compressor_filter.h"
 
+#include "envoy/http/codes.h"
+
 #include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/enum_to_int.h"
 #include "source/common/http/header_map_impl.h"
 #include "source/common/http/utility.h"
 
+#include "absl/strings/match.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -55,6 +60,24 @@ void compressAndUpdateStats(const Compression::Compressor::CompressorPtr& compre
   stats.total_compressed_bytes_.add(data.length());
 }
 
+// Weak entity tags are preserved on compressed responses, strong ones are removed as they require
+// the responses to be byte for byte identical.
+bool isStrongEtag(absl::string_view etag) {
+  return etag.length() > 2 && !((etag[0] == 'w' || etag[0] == 'W') && etag[1] == '/');
+}
+
+// The cache of compressed responses is keyed by URL and content encoding only, so responses
+// varying on other request headers are not cached.
+bool variesOnOtherHeaders(const Http::ResponseHeaderMap& headers) {
+  const absl::string_view vary = headers.getInlineValue(vary_handle.handle());
+  for (absl::string_view value : StringUtil::splitToken(vary, ",", false, true)) {
+    if (!absl::EqualsIgnoreCase(value, Http::CustomHeaders::get().VaryValues.AcceptEncoding)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 } // namespace
 
 CompressorFilterConfig::DirectionConfig::DirectionConfig(
@@ -70,14 +93,17 @@ CompressorFilterConfig::DirectionConfig::DirectionConfig(
 CompressorFilterConfig::CompressorFilterConfig(
     const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
     const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-    Compression::Compressor::CompressorFactoryPtr compressor_factory)
+    Compression::Compressor::CompressorFactoryPtr compressor_factory,
+    CompressedResponseCacheSharedPtr response_cache)
     : common_stats_prefix_(fmt::format("{}compressor.{}.{}", stats_prefix,
                                        proto_config.compressor_library().name(),
                                        compressor_factory->statsPrefix())),
       request_direction_config_(proto_config, common_stats_prefix_, scope, runtime),
       response_direction_config_(proto_config, common_stats_prefix_, scope, runtime),
       content_encoding_(compressor_factory->contentEncoding()),
-      compressor_factory_(std::move(compressor_factory)) {}
+      compressor_factory_(std::move(compressor_factory)),
+      response_cache_(std::move(response_cache)),
+      cacheable_urls_(response_cache_ != nullptr ? std::make_unique<CacheableUrls>() : nullptr) {}
 
 StringUtil::CaseUnorderedSet CompressorFilterConfig::DirectionConfig::contentTypeSet(
     const Protobuf::RepeatedPtrField<std::string>& types) {
@@ -149,6 +175,12 @@ Envoy::Compression::Compressor::CompressorPtr CompressorFilterConfig::makeCompre
 CompressorFilter::CompressorFilter(const CompressorFilterConfigSharedPtr config)
     : config_(std::move(config)) {}
 
+void CompressorFilter::onDestroy() {
+  if (response_cache_lookup_ != nullptr) {
+    response_cache_lookup_->onDestroy();
+  }
+}
+
 Http::FilterHeadersStatus CompressorFilter::decodeHeaders(Http::RequestHeaderMap& headers,
                                                           bool end_stream) {
   const Http::HeaderEntry* accept_encoding = headers.getInline(accept_encoding_handle.handle());
@@ -159,6 +191,10 @@ Http::FilterHeadersStatus CompressorFilter::decodeHeaders(Http::RequestHeaderMap
   }
 
   const auto& response_config = config_->responseDirectionConfig();
+  if (response_config.compressionEnabled() && accept_encoding_ != nullptr &&
+      config_->responseCache() != nullptr) {
+    startResponseCacheLookup(headers);
+  }
   if (response_config.compressionEnabled() && response_config.removeAcceptEncodingHeader()) {
     headers.removeInline(accept_encoding_handle.handle());
   }
@@ -238,12 +274,17 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
       isEtagAllowed(headers) && !headers.getInline(response_content_encoding_handle.handle());
   if (!end_stream && isAcceptEncodingAllowed(isEnabledAndContentLengthBigEnough, headers) &&
       isCompressible && isTransferEncodingAllowed(headers)) {
+    useResponseCache(headers);
     sanitizeEtagHeader(headers);
     headers.removeContentLength();
     headers.setInline(response_content_encoding_handle.handle(), config_->contentEncoding());
     config.stats().compressed_.inc();
-    // Finally instantiate the compressor.
-    response_compressor_ = config_->makeCompressor();
+    if (cached_response_ != nullptr) {
+      headers.setContentLength(cached_response_->body_.size());
+    } else {
+      // Finally instantiate the compressor.
+      response_compressor_ = config_->makeCompressor();
+    }
   } else {
     config.stats().not_compressed_.inc();
   }
@@ -259,21 +300,29 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
 }
 
 Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool end_stream) {
-  if (response_compressor_ != nullptr) {
+  if (cached_response_ != nullptr) {
+    serveCachedResponse(data, end_stream);
+  } else if (response_compressor_ != nullptr) {
     compressAndUpdateStats(response_compressor_, config_->responseDirectionConfig().stats(), data,
                            end_stream);
+    cacheCompressedData(data, end_stream);
   }
   return Http::FilterDataStatus::Continue;
 }
 
 Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTrailerMap&) {
-  if (response_compressor_ != nullptr) {
+  if (cached_response_ != nullptr) {
+    Buffer::OwnedImpl empty_buffer;
+    serveCachedResponse(empty_buffer, true);
+    encoder_callbacks_->addEncodedData(empty_buffer, true);
+  } else if (response_compressor_ != nullptr) {
     Buffer::OwnedImpl empty_buffer;
     // The presence of trailers means the stream is ended, but encodeData()
     // is never called with end_stream=true, thus let the compression library know
     // that the stream is ended.
     compressAndUpdateStats(response_compressor_, config_->responseDirectionConfig().stats(),
                            empty_buffer, true);
+    cacheCompressedData(empty_buffer, true);
     encoder_callbacks_->addEncodedData(empty_buffer, true);
   }
   return Http::FilterTrailersStatus::Continue;
@@ -575,11 +624,97 @@ void CompressorFilter::insertVaryHeader(Http::ResponseHeaderMap& headers) {
 // the strong ones when disable_on_etag_header is false. Envoy does NOT re-write entity tags.
 void CompressorFilter::sanitizeEtagHeader(Http::ResponseHeaderMap& headers) {
   const Http::HeaderEntry* etag = headers.getInline(etag_handle.handle());
-  if (etag != nullptr) {
-    absl::string_view value(etag->value().getStringView());
-    if (value.length() > 2 && !((value[0] == 'w' || value[0] == 'W') && value[1] == '/')) {
-      headers.removeInline(etag_handle.handle());
-    }
+  if (etag != nullptr && isStrongEtag(etag->value().getStringView())) {
+    headers.removeInline(etag_handle.handle());
+  }
+}
+
+void CompressorFilter::startResponseCacheLookup(const Http::RequestHeaderMap& headers) {
+  if (headers.Host() == nullptr || headers.Path() == nullptr ||
+      headers.getMethodValue() != Http::Headers::get().MethodValues.Get) {
+    return;
+  }
+  url_hash_ = CacheableUrls::hash(headers);
+  // The lookups are limited to the URLs which received a response with a strong entity tag.
+  if (!config_->cacheableUrls().contains(url_hash_)) {
+    return;
+  }
+  // The lookup starts with the request so that a cache completing it asynchronously does so
+  // while the request is proxied upstream.
+  response_cache_lookup_ =
+      config_->responseCache()->lookup(headers, config_->contentEncoding(), *decoder_callbacks_);
+}
+
+// A compressed response is cached along with the strong entity tag of the uncompressed response.
+// The next responses with the same entity tag have identical bodies, and are served the cached
+// response instead of being compressed again.
+void CompressorFilter::useResponseCache(const Http::ResponseHeaderMap& headers) {
+  if (url_hash_ == 0) {
+    return;
+  }
+  const absl::string_view etag = headers.getInlineValue(etag_handle.handle());
+  if (Http::Utility::getResponseStatus(headers) != enumToInt(Http::Code::OK) ||
+      !isStrongEtag(etag) || variesOnOtherHeaders(headers)) {
+    return;
+  }
+  if (response_cache_lookup_ == nullptr) {
+    // The next requests for the URL look up the cache.
+    config_->cacheableUrls().insert(url_hash_);
+    return;
+  }
+
+  const ResponseCompressorStats& stats = config_->responseDirectionConfig().responseStats();
+  CompressedResponseConstSharedPtr response = response_cache_lookup_->response();
+  if (response != nullptr && response->etag_ == etag) {
+    stats.response_cache_hit_.inc();
+    cached_response_ = std::move(response);
+    return;
+  }
+  stats.response_cache_miss_.inc();
+  // A lookup which has not completed yet can't be used to insert the compressed response.
+  if (response_cache_lookup_->completed()) {
+    response_to_cache_ = std::make_unique<Buffer::OwnedImpl>();
+    response_etag_ = std::string(etag);
+  }
+}
+
+void CompressorFilter::serveCachedResponse(Buffer::Instance& data, bool end_stream) {
+  const CompressorStats& stats = config_->responseDirectionConfig().stats();
+  stats.total_uncompressed_bytes_.add(data.length());
+  data.drain(data.length());
+  if (!end_stream) {
+    return;
+  }
+  // The cached body is referenced rather than copied, the fragment keeps it alive until it is
+  // written out.
+  const std::string& body = cached_response_->body_;
+  auto* fragment = new Buffer::BufferFragmentImpl(
+      body.data(), body.size(),
+      [response = cached_response_](const void*, size_t,
+                                    const Buffer::BufferFragmentImpl* fragment) {
+        delete fragment;
+      });
+  data.addBufferFragment(*fragment);
+  stats.total_compressed_bytes_.add(body.size());
+}
+
+void CompressorFilter::cacheCompressedData(const Buffer::Instance& data, bool end_stream) {
+  if (response_to_cache_ == nullptr) {
+    return;
+  }
+  if (response_to_cache_->length() + data.length() > config_->responseCache()->maxEntryBytes()) {
+    response_to_cache_.reset();
+    return;
+  }
+  response_to_cache_->add(data);
+  if (end_stream) {
+    config_->responseCache()->insert(
+        *response_cache_lookup_,
+        std::make_shared<const CompressedResponse>(
+            CompressedResponse{std::move(response_etag_), response_to_cache_->toString()}),
+        *encoder_callbacks_);
+    response_to_cache_.reset();
+    config_->responseDirectionConfig().responseStats().response_cache_insert_.inc();
   }
 }
 
@@ -7,6 +7,7 @@
 #include "source/common/protobuf/protobuf.h"
 #include "source/common/runtime/runtime_protos.h"
 #include "source/extensions/filters/http/common/pass_through_filter.h"
+#include "source/extensions/filters/http/compressor/compressed_response_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -37,6 +38,10 @@ namespace Compressor {
  *
  * "header_gzip" is specific to the gzip filter and is deprecated since it duplicates
  * "header_compressor_used".
+ *
+ * "response_cache_hit" and "response_cache_miss" count the compressed responses served from, and
+ * not found in, the cache of compressed responses. "response_cache_insert" counts the compressed
+ * responses stored in it.
  */
 #define RESPONSE_COMPRESSOR_STATS(COUNTER)                                                         \
   COUNTER(no_accept_header)                                                                        \
@@ -45,7 +50,10 @@ namespace Compressor {
   COUNTER(header_compressor_overshadowed)                                                          \
   COUNTER(header_wildcard)                                                                         \
   COUNTER(header_not_valid)                                                                        \
-  COUNTER(not_compressed_etag)
+  COUNTER(not_compressed_etag)                                                                     \
+  COUNTER(response_cache_hit)                                                                      \
+  COUNTER(response_cache_miss)                                                                     \
+  COUNTER(response_cache_insert)
 
 /**
  * Struct definitions for compressor stats. @see stats_macros.h
@@ -140,13 +148,18 @@ public:
   CompressorFilterConfig(
       const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
       const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory);
+      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory,
+      CompressedResponseCacheSharedPtr response_cache = nullptr);
 
   Envoy::Compression::Compressor::CompressorPtr makeCompressor();
 
   const std::string contentEncoding() const { return content_encoding_; };
   const RequestDirectionConfig& requestDirectionConfig() { return request_direction_config_; }
   const ResponseDirectionConfig& responseDirectionConfig() { return response_direction_config_; }
+  // The cache of compressed responses, nullptr if not configured.
+  CompressedResponseCache* responseCache() const { return response_cache_.get(); }
+  // The URLs looked up in the cache of compressed responses, if configured.
+  CacheableUrls& cacheableUrls() { return *cacheable_urls_; }
 
 private:
   const std::string common_stats_prefix_;
@@ -155,6 +168,8 @@ private:
 
   const std::string content_encoding_;
   const Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory_;
+  const CompressedResponseCacheSharedPtr response_cache_;
+  const std::unique_ptr<CacheableUrls> cacheable_urls_;
 };
 using CompressorFilterConfigSharedPtr = std::shared_ptr<CompressorFilterConfig>;
 
@@ -165,6 +180,9 @@ class CompressorFilter : public Http::PassThroughFilter {
 public:
   explicit CompressorFilter(const CompressorFilterConfigSharedPtr config);
 
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
   // Http::StreamDecoderFilter
   Http::FilterHeadersStatus decodeHeaders(Http::RequestHeaderMap& headers,
                                           bool end_stream) override;
@@ -187,6 +205,11 @@ private:
   void sanitizeEtagHeader(Http::ResponseHeaderMap& headers);
   void insertVaryHeader(Http::ResponseHeaderMap& headers);
 
+  void startResponseCacheLookup(const Http::RequestHeaderMap& headers);
+  void useResponseCache(const Http::ResponseHeaderMap& headers);
+  void serveCachedResponse(Buffer::Instance& data, bool end_stream);
+  void cacheCompressedData(const Buffer::Instance& data, bool end_stream);
+
   class EncodingDecision : public StreamInfo::FilterState::Object {
   public:
     enum class HeaderStat { NotValid, Identity, Wildcard, ValidCompressor };
@@ -207,6 +230,14 @@ private:
   Envoy::Compression::Compressor::CompressorPtr request_compressor_;
   const CompressorFilterConfigSharedPtr config_;
   std::unique_ptr<std::string> accept_encoding_;
+  // The hash of the URL of a GET request, when the cache of compressed responses is configured.
+  uint64_t url_hash_{};
+  CompressedResponseLookupSharedPtr response_cache_lookup_;
+  // The compressed response served instead of compressing the response body.
+  CompressedResponseConstSharedPtr cached_response_;
+  // The compressed response body to insert in the cache, and its entity tag.
+  std::unique_ptr<Buffer::OwnedImpl> response_to_cache_;
+  std::string response_etag_;
 };
 
 } // namespace Compressor
@@ -27,9 +27,14 @@ Http::FilterFactoryCb CompressorFilterFactory::createFilterFactoryFromProtoTyped
       *config_factory);
   Compression::Compressor::CompressorFactoryPtr compressor_factory =
       config_factory->createCompressorFactoryFromProto(*message, context);
-  CompressorFilterConfigSharedPtr config =
-      std::make_shared<CompressorFilterConfig>(proto_config, stats_prefix, context.scope(),
-                                               context.runtime(), std::move(compressor_factory));
+  CompressedResponseCacheSharedPtr response_cache;
+  if (proto_config.response_direction_config().has_compressed_response_cache()) {
+    response_cache = createCompressedResponseCache(
+        proto_config.response_direction_config().compressed_response_cache(), context);
+  }
+  CompressorFilterConfigSharedPtr config = std::make_shared<CompressorFilterConfig>(
+      proto_config, stats_prefix, context.scope(), context.runtime(),
+      std::move(compressor_factory), std::move(response_cache));
   return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<CompressorFilter>(config));
   };
@@ -0,0 +1,266 @@
+#include "source/extensions/filters/http/ext_authz/decision_cache.h"
+
+#include <algorithm>
+
+#include "source/common/common/regex.h"
+#include "source/common/http/path_utility.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/hash/hash.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+namespace {
+
+// Appends a length prefixed value to a cache key, so that the boundaries between values are
+// unambiguous.
+void appendKeyValue(std::string& key, absl::string_view value) {
+  absl::StrAppend(&key, value.size(), ":", value);
+}
+
+void appendMissingKeyValue(std::string& key) { key.push_back('-'); }
+
+// The same identity as the principal of the source peer sent to the authorization server.
+absl::string_view peerIdentity(const Ssl::ConnectionInfo& ssl) {
+  const auto uri_sans = ssl.uriSanPeerCertificate();
+  if (!uri_sans.empty()) {
+    return uri_sans[0];
+  }
+  const auto dns_sans = ssl.dnsSansPeerCertificate();
+  if (!dns_sans.empty()) {
+    return dns_sans[0];
+  }
+  return ssl.subjectPeerCertificate();
+}
+
+uint64_t headersSize(const Http::HeaderVector& headers) {
+  uint64_t size = 0;
+  for (const auto& header : headers) {
+    size += header.first.get().size() + header.second.size();
+  }
+  return size;
+}
+
+} // namespace
+
+DecisionCache::DecisionCache(
+    const envoy::extensions::filters::http::ext_authz::v3::DecisionCache& config)
+    : default_ttl_(config.has_default_ttl()
+                       ? absl::optional<std::chrono::milliseconds>(
+                             DurationUtil::durationToMilliseconds(config.default_ttl()))
+                       : absl::nullopt),
+      ttl_metadata_key_(config.ttl_metadata_key()),
+      cache_denied_responses_(config.cache_denied_responses()),
+      max_shard_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_cache_bytes,
+                                                       DefaultMaxCacheBytes) /
+                       NumShards) {
+  using KeyAttributeProto =
+      envoy::extensions::filters::http::ext_authz::v3::DecisionCache::KeyAttribute;
+  for (const auto& attribute : config.key_attributes()) {
+    KeyAttribute& key_attribute = key_attributes_.emplace_back();
+    switch (attribute.attribute_specifier_case()) {
+    case KeyAttributeProto::AttributeSpecifierCase::kRequestHeader:
+      key_attribute.type_ = KeyAttribute::Type::RequestHeader;
+      key_attribute.header_.emplace(attribute.request_header());
+      break;
+    case KeyAttributeProto::AttributeSpecifierCase::kPath:
+      key_attribute.type_ = KeyAttribute::Type::Path;
+      if (attribute.path().has_rewrite()) {
+        key_attribute.path_rewrite_ =
+            Regex::Utility::parseRegex(attribute.path().rewrite().pattern());
+        key_attribute.path_substitution_ = attribute.path().rewrite().substitution();
+      }
+      break;
+    case KeyAttributeProto::AttributeSpecifierCase::kRequestedServerName:
+      key_attribute.type_ = KeyAttribute::Type::RequestedServerName;
+      break;
+    case KeyAttributeProto::AttributeSpecifierCase::kPeerIdentity:
+      key_attribute.type_ = KeyAttribute::Type::PeerIdentity;
+      break;
+    case KeyAttributeProto::AttributeSpecifierCase::ATTRIBUTE_SPECIFIER_NOT_SET:
+      PANIC_DUE_TO_PROTO_UNSET;
+    }
+  }
+}
+
+std::string
+DecisionCache::key(const Http::RequestHeaderMap& headers, const StreamInfo::StreamInfo& stream_info,
+                   const Protobuf::Map<std::string, std::string>& context_extensions) const {
+  std::string key;
+  for (const auto& attribute : key_attributes_) {
+    switch (attribute.type_) {
+    case KeyAttribute::Type::RequestHeader: {
+      const auto values = headers.get(*attribute.header_);
+      absl::StrAppend(&key, values.size(), "#");
+      for (size_t i = 0; i < values.size(); ++i) {
+        appendKeyValue(key, values[i]->value().getStringView());
+      }
+      break;
+    }
+    case KeyAttribute::Type::Path: {
+      if (headers.Path() == nullptr) {
+        appendMissingKeyValue(key);
+        break;
+      }
+      const absl::string_view path = Http::PathUtil::removeQueryAndFragment(headers.getPathValue());
+      if (attribute.path_rewrite_ != nullptr) {
+        appendKeyValue(key,
+                       attribute.path_rewrite_->replaceAll(path, attribute.path_substitution_));
+      } else {
+        appendKeyValue(key, path);
+      }
+      break;
+    }
+    case KeyAttribute::Type::RequestedServerName:
+      appendKeyValue(key, stream_info.downstreamAddressProvider().requestedServerName());
+      break;
+    case KeyAttribute::Type::PeerIdentity: {
+      const auto ssl = stream_info.downstreamAddressProvider().sslConnection();
+      if (ssl == nullptr || !ssl->peerCertificatePresented()) {
+        appendMissingKeyValue(key);
+        break;
+      }
+      appendKeyValue(key, peerIdentity(*ssl));
+      break;
+    }
+    }
+  }
+
+  // The iteration order of protobuf maps is unspecified, sort the context extensions to get a
+  // stable key.
+  std::vector<std::pair<absl::string_view, absl::string_view>> extensions(
+      context_extensions.begin(), context_extensions.end());
+  std::sort(extensions.begin(), extensions.end());
+  absl::StrAppend(&key, extensions.size(), "#");
+  for (const auto& [name, value] : extensions) {
+    appendKeyValue(key, name);
+    appendKeyValue(key, value);
+  }
+  return key;
+}
+
+Filters::Common::ExtAuthz::ResponsePtr DecisionCache::lookup(const std::string& key,
+                                                             MonotonicTime now) {
+  Shard& key_shard = shard(key);
+  absl::MutexLock lock(&key_shard.mutex_);
+  const auto it = key_shard.index_.find(key);
+  if (it == key_shard.index_.end()) {
+    return nullptr;
+  }
+  if (it->second->expiry_ <= now) {
+    remove(key_shard, it->second);
+    return nullptr;
+  }
+  // Move the entry to the front of the LRU list.
+  key_shard.entries_.splice(key_shard.entries_.begin(), key_shard.entries_, it->second);
+  return std::make_unique<Filters::Common::ExtAuthz::Response>(it->second->response_);
+}
+
+uint64_t DecisionCache::insert(const std::string& key,
+                               const Filters::Common::ExtAuthz::Response& response,
+                               MonotonicTime now) {
+  const auto decision_ttl = ttl(response);
+  if (!decision_ttl.has_value()) {
+    return 0;
+  }
+  const uint64_t size = entrySize(key, response);
+  if (size > max_shard_bytes_) {
+    return 0;
+  }
+
+  Shard& key_shard = shard(key);
+  absl::MutexLock lock(&key_shard.mutex_);
+  if (const auto it = key_shard.index_.find(key); it != key_shard.index_.end()) {
+    // Another request with the same key completed first.
+    remove(key_shard, it->second);
+  }
+
+  uint64_t evictions = 0;
+  while (key_shard.size_ + size > max_shard_bytes_) {
+    const bool expired = key_shard.entries_.back().expiry_ <= now;
+    remove(key_shard, std::prev(key_shard.entries_.end()));
+    if (!expired) {
+      ++evictions;
+    }
+  }
+
+  key_shard.entries_.push_front(Entry{key, response, now + decision_ttl.value(), size});
+  key_shard.index_.emplace(key_shard.entries_.front().key_, key_shard.entries_.begin());
+  key_shard.size_ += size;
+  return evictions;
+}
+
+absl::optional<std::chrono::milliseconds>
+DecisionCache::ttl(const Filters::Common::ExtAuthz::Response& response) const {
+  using Filters::Common::ExtAuthz::CheckStatus;
+  if (response.status == CheckStatus::Error ||
+      (response.status == CheckStatus::Denied && !cache_denied_responses_)) {
+    return absl::nullopt;
+  }
+
+  absl::optional<std::chrono::milliseconds> decision_ttl = default_ttl_;
+  if (!ttl_metadata_key_.empty()) {
+    const auto& fields = response.dynamic_metadata.fields();
+    if (const auto it = fields.find(ttl_metadata_key_); it != fields.end()) {
+      double seconds;
+      if (it->second.kind_case() == ProtobufWkt::Value::kNumberValue) {
+        seconds = it->second.number_value();
+      } else if (it->second.kind_case() != ProtobufWkt::Value::kStringValue ||
+                 !absl::SimpleAtod(it->second.string_value(), &seconds)) {
+        // A malformed time to live is not trusted, the decision is not cached.
+        return absl::nullopt;
+      }
+      // Reject NaN as well.
+      if (!(seconds >= 0)) {
+        return absl::nullopt;
+      }
+      decision_ttl = std::chrono::milliseconds(
+          static_cast<int64_t>(std::min(seconds, static_cast<double>(INT32_MAX)) * 1000));
+    }
+  }
+
+  if (!decision_ttl.has_value() || decision_ttl->count() <= 0) {
+    return absl::nullopt;
+  }
+  return decision_ttl;
+}
+
+uint64_t DecisionCache::entrySize(const std::string& key,
+                                  const Filters::Common::ExtAuthz::Response& response) {
+  uint64_t size = sizeof(Entry) + 2 * key.size() + response.body.size() +
+                  response.dynamic_metadata.ByteSizeLong() +
+                  headersSize(response.headers_to_append) + headersSize(response.headers_to_set) +
+                  headersSize(response.headers_to_add) +
+                  headersSize(response.response_headers_to_add) +
+                  headersSize(response.response_headers_to_set);
+  for (const auto& header : response.headers_to_remove) {
+    size += header.get().size();
+  }
+  for (const auto& [name, value] : response.query_parameters_to_set) {
+    size += name.size() + value.size();
+  }
+  for (const auto& name : response.query_parameters_to_remove) {
+    size += name.size();
+  }
+  return size;
+}
+
+DecisionCache::Shard& DecisionCache::shard(const std::string& key) {
+  return shards_[absl::Hash<std::string>()(key) % NumShards];
+}
+
+void DecisionCache::remove(Shard& shard, EntryList::iterator entry) {
+  shard.size_ -= entry->size_;
+  shard.index_.erase(entry->key_);
+  shard.entries_.erase(entry);
+}
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/regex.h"
+#include "envoy/common/time.h"
+#include "envoy/extensions/filters/http/ext_authz/v3/ext_authz.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stream_info/stream_info.h"
+
+#include "source/common/protobuf/protobuf.h"
+#include "source/extensions/filters/common/ext_authz/ext_authz.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+/**
+ * Cache of the decisions of the authorization server, shared by all the workers. The entries are
+ * spread over a fixed number of shards, each holding a mutex protected LRU list, so that workers
+ * rarely contend on the same lock. Expired entries are removed when they are looked up or evicted.
+ */
+class DecisionCache {
+public:
+  static constexpr uint32_t NumShards = 16;
+  static constexpr uint64_t DefaultMaxCacheBytes = 8 * 1024 * 1024;
+
+  explicit DecisionCache(
+      const envoy::extensions::filters::http::ext_authz::v3::DecisionCache& config);
+
+  /**
+   * Builds the cache key of a request from the configured key attributes and the context
+   * extensions of the route.
+   */
+  std::string key(const Http::RequestHeaderMap& headers, const StreamInfo::StreamInfo& stream_info,
+                  const Protobuf::Map<std::string, std::string>& context_extensions) const;
+
+  /**
+   * @return a copy of the decision cached for a key, or nullptr if there is none or it expired.
+   */
+  Filters::Common::ExtAuthz::ResponsePtr lookup(const std::string& key, MonotonicTime now);
+
+  /**
+   * Caches a decision of the authorization server, if its status and time to live allow it.
+   * @return the number of decisions evicted to make room for it.
+   */
+  uint64_t insert(const std::string& key, const Filters::Common::ExtAuthz::Response& response,
+                  MonotonicTime now);
+
+  /**
+   * @return the time to live of a decision, or absl::nullopt if it must not be cached.
+   */
+  absl::optional<std::chrono::milliseconds>
+  ttl(const Filters::Common::ExtAuthz::Response& response) const;
+
+  /**
+   * @return the approximate number of bytes used by a cached decision.
+   */
+  static uint64_t entrySize(const std::string& key,
+                            const Filters::Common::ExtAuthz::Response& response);
+
+private:
+  struct KeyAttribute {
+    enum class Type { RequestHeader, Path, RequestedServerName, PeerIdentity };
+
+    Type type_;
+    absl::optional<Http::LowerCaseString> header_;
+    Regex::CompiledMatcherPtr path_rewrite_;
+    std::string path_substitution_;
+  };
+
+  struct Entry {
+    std::string key_;
+    Filters::Common::ExtAuthz::Response response_;
+    MonotonicTime expiry_;
+    uint64_t size_;
+  };
+  using EntryList = std::list<Entry>;
+
+  struct Shard {
+    absl::Mutex mutex_;
+    EntryList entries_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<absl::string_view, EntryList::iterator> index_ ABSL_GUARDED_BY(mutex_);
+    uint64_t size_ ABSL_GUARDED_BY(mutex_){};
+  };
+
+  Shard& shard(const std::string& key);
+  static void remove(Shard& shard, EntryList::iterator entry)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  std::vector<KeyAttribute> key_attributes_;
+  const absl::optional<std::chrono::milliseconds> default_ttl_;
+  const std::string ttl_metadata_key_;
+  const bool cache_denied_responses_;
+  const uint64_t max_shard_bytes_;
+  std::array<Shard, NumShards> shards_;
+};
+
+using DecisionCacheSharedPtr = std::shared_ptr<DecisionCache>;
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
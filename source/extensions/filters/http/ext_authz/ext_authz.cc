@@ -43,6 +43,30 @@ void Filter::initiateCall(const Http::RequestHeaderMap& headers,
     context_extensions = maybe_merged_per_route_config.value().takeContextExtensions();
   }
 
+  if (DecisionCache* cache = config_->decisionCache(); cache != nullptr) {
+    cache_key_ = cache->key(headers, decoder_callbacks_->streamInfo(), context_extensions);
+    auto response =
+        cache->lookup(*cache_key_, decoder_callbacks_->dispatcher().timeSource().monotonicTime());
+    if (response != nullptr) {
+      ENVOY_STREAM_LOG(trace, "ext_authz filter found the decision in the cache",
+                       *decoder_callbacks_);
+      stats_.cache_hit_.inc();
+      // The ok and denied cluster stats count the decisions of the authorization server, so
+      // cluster_ is left unset and the hit is counted on its own.
+      if (Upstream::ClusterInfoConstSharedPtr cluster = decoder_callbacks_->clusterInfo();
+          cluster != nullptr) {
+        config_->incCounter(cluster->statsScope(), config_->ext_authz_cache_hit_);
+      }
+      cache_key_.reset();
+      filter_return_ = FilterReturn::StopDecoding;
+      initiating_call_ = true;
+      onComplete(std::move(response));
+      initiating_call_ = false;
+      return;
+    }
+    stats_.cache_miss_.inc();
+  }
+
   envoy::config::core::v3::Metadata metadata_context;
 
   // If metadata_context_namespaces is specified, pass matching filter metadata to the ext_authz
@@ -227,6 +251,12 @@ void Filter::onComplete(Filters::Common::ExtAuthz::ResponsePtr&& response) {
   using Filters::Common::ExtAuthz::CheckStatus;
   Stats::StatName empty_stat_name;
 
+  if (cache_key_.has_value()) {
+    stats_.cache_eviction_.add(config_->decisionCache()->insert(
+        *cache_key_, *response, decoder_callbacks_->dispatcher().timeSource().monotonicTime()));
+    cache_key_.reset();
+  }
+
   if (!response->dynamic_metadata.fields().empty()) {
     // Add duration of call to dynamic metadata if applicable
     if (start_time_.has_value() && response->status == CheckStatus::OK) {
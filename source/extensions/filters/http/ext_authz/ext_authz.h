@@ -22,6 +22,7 @@
 #include "source/extensions/filters/common/ext_authz/ext_authz.h"
 #include "source/extensions/filters/common/ext_authz/ext_authz_grpc_impl.h"
 #include "source/extensions/filters/common/ext_authz/ext_authz_http_impl.h"
+#include "source/extensions/filters/http/ext_authz/decision_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -37,7 +38,10 @@ namespace ExtAuthz {
   COUNTER(denied)                                                                                  \
   COUNTER(error)                                                                                   \
   COUNTER(disabled)                                                                                \
-  COUNTER(failure_mode_allowed)
+  COUNTER(failure_mode_allowed)                                                                    \
+  COUNTER(cache_hit)                                                                               \
+  COUNTER(cache_miss)                                                                              \
+  COUNTER(cache_eviction)
 
 /**
  * Wrapper struct for ext_authz filter stats. @see stats_macros.h
@@ -81,12 +85,20 @@ public:
         typed_metadata_context_namespaces_(config.typed_metadata_context_namespaces().begin(),
                                            config.typed_metadata_context_namespaces().end()),
         include_peer_certificate_(config.include_peer_certificate()),
+        decision_cache_(config.has_decision_cache()
+                            ? std::make_shared<DecisionCache>(config.decision_cache())
+                            : nullptr),
         stats_(generateStats(stats_prefix, config.stat_prefix(), scope)),
         ext_authz_ok_(pool_.add(createPoolStatName(config.stat_prefix(), "ok"))),
         ext_authz_denied_(pool_.add(createPoolStatName(config.stat_prefix(), "denied"))),
         ext_authz_error_(pool_.add(createPoolStatName(config.stat_prefix(), "error"))),
         ext_authz_failure_mode_allowed_(
-            pool_.add(createPoolStatName(config.stat_prefix(), "failure_mode_allowed"))) {
+            pool_.add(createPoolStatName(config.stat_prefix(), "failure_mode_allowed"))),
+        ext_authz_cache_hit_(pool_.add(createPoolStatName(config.stat_prefix(), "cache_hit"))) {
+    if (decision_cache_ != nullptr && withRequestBody()) {
+      // The request body is not part of the cache key.
+      throw EnvoyException("ext_authz: decision_cache can not be used with with_request_body");
+    }
     auto labels_key_it =
         bootstrap.node().metadata().fields().find(config.bootstrap_metadata_labels_key());
     if (labels_key_it != bootstrap.node().metadata().fields().end()) {
@@ -142,6 +154,11 @@ public:
   bool includePeerCertificate() const { return include_peer_certificate_; }
   const LabelsMap& destinationLabels() const { return destination_labels_; }
 
+  /**
+   * @return the cache of the decisions of the authorization server, or nullptr if not configured.
+   */
+  DecisionCache* decisionCache() const { return decision_cache_.get(); }
+
 private:
   static Http::Code toErrorCode(uint64_t status) {
     const auto code = static_cast<Http::Code>(status);
@@ -189,6 +206,7 @@ private:
   const std::vector<std::string> typed_metadata_context_namespaces_;
 
   const bool include_peer_certificate_;
+  const DecisionCacheSharedPtr decision_cache_;
 
   // The stats for the filter.
   ExtAuthzFilterStats stats_;
@@ -200,6 +218,7 @@ public:
   const Stats::StatName ext_authz_denied_;
   const Stats::StatName ext_authz_error_;
   const Stats::StatName ext_authz_failure_mode_allowed_;
+  const Stats::StatName ext_authz_cache_hit_;
 };
 
 using FilterConfigSharedPtr = std::shared_ptr<FilterConfig>;
@@ -319,6 +338,9 @@ private:
   bool buffer_data_{};
   bool skip_check_{false};
   envoy::service::auth::v3::CheckRequest check_request_{};
+  // The key under which the decision of the authorization server is cached, when the decision
+  // cache is configured and the request missed it.
+  absl::optional<std::string> cache_key_;
 };
 
 } // namespace ExtAuthz
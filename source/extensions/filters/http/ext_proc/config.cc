@@ -2,6 +2,7 @@
 
 #include "source/extensions/filters/http/ext_proc/client_impl.h"
 #include "source/extensions/filters/http/ext_proc/ext_proc.h"
+#include "source/extensions/filters/http/ext_proc/multiplexed_client_impl.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -16,6 +17,28 @@ Http::FilterFactoryCb ExternalProcessingFilterConfig::createFilterFactoryFromPro
   const auto filter_config = std::make_shared<FilterConfig>(
       proto_config, std::chrono::milliseconds(message_timeout_ms), context.scope(), stats_prefix);
 
+  if (proto_config.has_stream_multiplexing()) {
+    // Each worker multiplexes its HTTP streams over its own gRPC streams.
+    const MultiplexingConfig multiplexing_config(proto_config.stream_multiplexing());
+    const std::string final_prefix =
+        absl::StrCat(stats_prefix, "ext_proc.", proto_config.stat_prefix());
+    const ExtProcMultiplexingStats multiplexing_stats{
+        ALL_EXT_PROC_MULTIPLEXING_STATS(POOL_COUNTER_PREFIX(context.scope(), final_prefix))};
+    std::shared_ptr<ThreadLocal::TypedSlot<MultiplexedStreamPool>> pools =
+        ThreadLocal::TypedSlot<MultiplexedStreamPool>::makeUnique(context.threadLocal());
+    pools->set([multiplexing_config, multiplexing_stats, &context](Event::Dispatcher& dispatcher) {
+      return std::make_shared<MultiplexedStreamPool>(
+          context.clusterManager().grpcAsyncClientManager(), context.scope(), dispatcher,
+          multiplexing_config, multiplexing_stats);
+    });
+
+    return [filter_config, pools, grpc_service = proto_config.grpc_service()](
+               Http::FilterChainFactoryCallbacks& callbacks) {
+      callbacks.addStreamFilter(Http::StreamFilterSharedPtr{std::make_shared<Filter>(
+          filter_config, std::make_unique<MultiplexedClientImpl>(**pools), grpc_service)});
+    };
+  }
+
   return [filter_config, grpc_service = proto_config.grpc_service(),
           &context](Http::FilterChainFactoryCallbacks& callbacks) {
     auto client = std::make_unique<ExternalProcessorClientImpl>(
@@ -136,6 +136,11 @@ FilterHeadersStatus Filter::onHeaders(ProcessorState& state,
   auto* headers_req = state.mutableHeaders(req);
   MutationUtils::headersToProto(headers, *headers_req->mutable_headers());
   headers_req->set_end_of_stream(end_stream);
+  if (config_->asyncMode()) {
+    ENVOY_LOG(debug, "Sending headers message asynchronously");
+    sendAsync(std::move(req));
+    return FilterHeadersStatus::Continue;
+  }
   state.setCallbackState(ProcessorState::CallbackState::HeadersCallback);
   state.startMessageTimer(std::bind(&Filter::onMessageTimeout, this), config_->messageTimeout());
   ENVOY_LOG(debug, "Sending headers message");
@@ -175,6 +180,18 @@ FilterDataStatus Filter::onData(ProcessorState& state, Buffer::Instance& data, b
     ENVOY_LOG(trace, "Continuing (processing complete)");
     return FilterDataStatus::Continue;
   }
+  if (config_->asyncMode()) {
+    // The external processor only observes the body, so each chunk is sent as it arrives.
+    if (state.bodyMode() != ProcessingMode::NONE && openStream() == StreamOpenState::Ok) {
+      ENVOY_LOG(debug, "Sending a body chunk of {} bytes asynchronously", data.length());
+      ProcessingRequest req;
+      auto* body_req = state.mutableBody(req);
+      body_req->set_end_of_stream(end_stream);
+      body_req->set_body(data.toString());
+      sendAsync(std::move(req));
+    }
+    return FilterDataStatus::Continue;
+  }
   bool just_added_trailers = false;
   Http::HeaderMap* new_trailers = nullptr;
   if (end_stream && state.sendTrailers()) {
@@ -405,6 +422,15 @@ FilterTrailersStatus Filter::onTrailers(ProcessorState& state, Http::HeaderMap&
     ENVOY_LOG(trace, "trailers: Continue");
     return FilterTrailersStatus::Continue;
   }
+  if (config_->asyncMode()) {
+    if (state.sendTrailers() && openStream() == StreamOpenState::Ok) {
+      ENVOY_LOG(debug, "Sending trailers message asynchronously");
+      ProcessingRequest req;
+      MutationUtils::headersToProto(trailers, *state.mutableTrailers(req)->mutable_trailers());
+      sendAsync(std::move(req));
+    }
+    return FilterTrailersStatus::Continue;
+  }
 
   bool body_delivered = state.completeBodyAvailable();
   state.setCompleteBodyAvailable(true);
@@ -508,12 +534,24 @@ void Filter::sendTrailers(ProcessorState& state, const Http::HeaderMap& trailers
   stats_.stream_msgs_sent_.inc();
 }
 
+void Filter::sendAsync(ProcessingRequest&& req) {
+  req.set_async_mode(true);
+  stream_->send(std::move(req), false);
+  stats_.stream_msgs_sent_.inc();
+}
+
 void Filter::onReceiveMessage(std::unique_ptr<ProcessingResponse>&& r) {
   if (processing_complete_) {
     ENVOY_LOG(debug, "Ignoring stream message received after processing complete");
     // Ignore additional messages after we decided we were done with the stream
     return;
   }
+  if (config_->asyncMode()) {
+    // Nothing was waiting for a response.
+    ENVOY_LOG(debug, "Ignoring stream message received in async mode");
+    stats_.spurious_msgs_received_.inc();
+    return;
+  }
 
   auto response = std::move(r);
 
@@ -602,7 +640,11 @@ void Filter::onGrpcError(Grpc::Status::GrpcStatus status) {
     return;
   }
 
-  if (config_->failureModeAllow()) {
+  if (config_->asyncMode()) {
+    // The HTTP stream never waited for the external processor, so it is not affected.
+    onGrpcClose();
+
+  } else if (config_->failureModeAllow()) {
     // Ignore this and treat as a successful close
     onGrpcClose();
     stats_.failure_mode_allowed_.inc();
@@ -44,12 +44,15 @@ public:
   FilterConfig(const envoy::extensions::filters::http::ext_proc::v3::ExternalProcessor& config,
                const std::chrono::milliseconds message_timeout, Stats::Scope& scope,
                const std::string& stats_prefix)
-      : failure_mode_allow_(config.failure_mode_allow()), message_timeout_(message_timeout),
+      : failure_mode_allow_(config.failure_mode_allow()), async_mode_(config.async_mode()),
+        message_timeout_(message_timeout),
         stats_(generateStats(stats_prefix, config.stat_prefix(), scope)),
         processing_mode_(config.processing_mode()), mutation_checker_(config.mutation_rules()) {}
 
   bool failureModeAllow() const { return failure_mode_allow_; }
 
+  bool asyncMode() const { return async_mode_; }
+
   const std::chrono::milliseconds& messageTimeout() const { return message_timeout_; }
 
   const ExtProcFilterStats& stats() const { return stats_; }
@@ -70,6 +73,7 @@ private:
   }
 
   const bool failure_mode_allow_;
+  const bool async_mode_;
   const std::chrono::milliseconds message_timeout_;
 
   ExtProcFilterStats stats_;
@@ -161,6 +165,9 @@ public:
 
   void sendTrailers(ProcessorState& state, const Http::HeaderMap& trailers);
 
+  // Sends a message in async mode, without waiting for a response.
+  void sendAsync(envoy::service::ext_proc::v3::ProcessingRequest&& req);
+
 private:
   void mergePerRouteConfig();
   StreamOpenState openStream();
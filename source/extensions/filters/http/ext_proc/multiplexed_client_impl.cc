@@ -0,0 +1,250 @@
+#include "source/extensions/filters/http/ext_proc/multiplexed_client_impl.h"
+
+#include <algorithm>
+
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExternalProcessing {
+
+using envoy::service::ext_proc::v3::ProcessingRequest;
+using envoy::service::ext_proc::v3::ProcessingResponse;
+
+static constexpr char kMultiplexedMethod[] =
+    "envoy.service.ext_proc.v3.ExternalProcessor.ProcessMultiplexed";
+
+MultiplexingConfig::MultiplexingConfig(
+    const envoy::extensions::filters::http::ext_proc::v3::StreamMultiplexing& config)
+    : max_grpc_streams_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_grpc_streams, 1)),
+      batch_window_(PROTOBUF_GET_MS_OR_DEFAULT(config, batch_window, 0)),
+      max_batch_size_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_batch_size, DefaultMaxBatchSize)) {}
+
+MultiplexedStreamPool::MultiplexedStreamPool(Grpc::AsyncClientManager& client_manager,
+                                             Stats::Scope& scope, Event::Dispatcher& dispatcher,
+                                             const MultiplexingConfig& config,
+                                             const ExtProcMultiplexingStats& stats)
+    : client_manager_(client_manager), scope_(scope), dispatcher_(dispatcher), config_(config),
+      stats_(stats) {}
+
+MultiplexedStreamPool::~MultiplexedStreamPool() {
+  for (auto& [hash, service] : services_) {
+    for (auto& stream : service.streams_) {
+      stream->resetStream();
+    }
+  }
+}
+
+ExternalProcessorStreamPtr
+MultiplexedStreamPool::start(ExternalProcessorCallbacks& callbacks,
+                             const envoy::config::core::v3::GrpcService& grpc_service) {
+  const uint64_t hash = MessageUtil::hash(grpc_service);
+  ServiceStreams& service = services_[hash];
+  if (service.streams_.size() < config_.max_grpc_streams_) {
+    ENVOY_LOG(debug, "Opening shared gRPC stream to external processor");
+    Grpc::AsyncClient<MultiplexedProcessingRequest, MultiplexedProcessingResponse> client(
+        client_manager_.getOrCreateRawAsyncClient(grpc_service, scope_, true,
+                                                  Grpc::CacheOption::AlwaysCache));
+    auto stream = std::make_unique<SharedStream>(*this, hash, std::move(client));
+    stats_.multiplexed_grpc_streams_started_.inc();
+    if (!stream->start()) {
+      ENVOY_LOG(debug, "Failed to open shared gRPC stream to external processor");
+      if (service.streams_.empty()) {
+        services_.erase(hash);
+      }
+      auto failed = std::make_unique<MultiplexedStream>(nullptr, 0, callbacks);
+      callbacks.onGrpcError(Grpc::Status::WellKnownGrpcStatus::Unavailable);
+      return failed;
+    }
+    service.streams_.push_back(std::move(stream));
+    return service.streams_.back()->attach(callbacks);
+  }
+
+  SharedStream& stream = *service.streams_[service.next_++ % service.streams_.size()];
+  return stream.attach(callbacks);
+}
+
+size_t MultiplexedStreamPool::grpcStreams() const {
+  size_t streams = 0;
+  for (const auto& [hash, service] : services_) {
+    streams += service.streams_.size();
+  }
+  return streams;
+}
+
+void MultiplexedStreamPool::removeStream(SharedStream& stream) {
+  const auto service = services_.find(stream.serviceHash());
+  ASSERT(service != services_.end());
+  auto& streams = service->second.streams_;
+  const auto it = std::find_if(streams.begin(), streams.end(),
+                               [&stream](const SharedStreamPtr& s) { return s.get() == &stream; });
+  ASSERT(it != streams.end());
+  // The stream may still be running callbacks.
+  dispatcher_.deferredDelete(std::move(*it));
+  streams.erase(it);
+  if (streams.empty()) {
+    services_.erase(service);
+  }
+}
+
+void MultiplexedStreamPool::MultiplexedStream::send(ProcessingRequest&& request, bool end_stream) {
+  if (parent_ == nullptr) {
+    return;
+  }
+  parent_->send(id_, std::move(request), end_stream);
+  if (end_stream) {
+    parent_ = nullptr;
+  }
+}
+
+bool MultiplexedStreamPool::MultiplexedStream::close() {
+  if (parent_ == nullptr) {
+    return false;
+  }
+  parent_->detach(id_);
+  parent_ = nullptr;
+  return true;
+}
+
+MultiplexedStreamPool::SharedStream::SharedStream(
+    MultiplexedStreamPool& parent, uint64_t service_hash,
+    Grpc::AsyncClient<MultiplexedProcessingRequest, MultiplexedProcessingResponse>&& client)
+    : parent_(parent), client_(std::move(client)),
+      batch_timer_(parent.dispatcher_.createTimer([this]() { flush(); })),
+      service_hash_(service_hash) {}
+
+MultiplexedStreamPool::SharedStream::~SharedStream() {
+  for (auto& [id, stream] : streams_) {
+    stream->parent_ = nullptr;
+  }
+}
+
+bool MultiplexedStreamPool::SharedStream::start() {
+  const auto* descriptor =
+      Protobuf::DescriptorPool::generated_pool()->FindMethodByName(kMultiplexedMethod);
+  starting_ = true;
+  stream_ = client_.start(*descriptor, *this, Http::AsyncClient::StreamOptions());
+  starting_ = false;
+  return stream_ != nullptr && !closed_;
+}
+
+std::unique_ptr<MultiplexedStreamPool::MultiplexedStream>
+MultiplexedStreamPool::SharedStream::attach(ExternalProcessorCallbacks& callbacks) {
+  const uint64_t id = next_id_++;
+  auto stream = std::make_unique<MultiplexedStream>(this, id, callbacks);
+  streams_.emplace(id, stream.get());
+  return stream;
+}
+
+void MultiplexedStreamPool::SharedStream::send(uint64_t id, ProcessingRequest&& request,
+                                               bool end_stream) {
+  // Only headers wait for other messages, bodies and trailers may already be delayed by
+  // buffering and are sent right away.
+  const bool batchable = request.has_request_headers() || request.has_response_headers();
+  auto* entry = batch_.add_entries();
+  entry->set_stream_id(id);
+  *entry->mutable_request() = std::move(request);
+  if (end_stream) {
+    entry->set_end_of_stream(true);
+    streams_.erase(id);
+  }
+  maybeFlush(!batchable);
+}
+
+void MultiplexedStreamPool::SharedStream::detach(uint64_t id) {
+  streams_.erase(id);
+  if (closed_) {
+    return;
+  }
+  auto* entry = batch_.add_entries();
+  entry->set_stream_id(id);
+  entry->set_end_of_stream(true);
+  maybeFlush(false);
+}
+
+void MultiplexedStreamPool::SharedStream::resetStream() {
+  if (!closed_) {
+    closed_ = true;
+    batch_timer_->disableTimer();
+    stream_.resetStream();
+  }
+}
+
+void MultiplexedStreamPool::SharedStream::maybeFlush(bool flush_now) {
+  if (flush_now || parent_.config_.batch_window_.count() == 0 ||
+      static_cast<uint32_t>(batch_.entries_size()) >= parent_.config_.max_batch_size_) {
+    flush();
+  } else if (!batch_timer_->enabled()) {
+    batch_timer_->enableTimer(parent_.config_.batch_window_);
+  }
+}
+
+void MultiplexedStreamPool::SharedStream::flush() {
+  batch_timer_->disableTimer();
+  if (closed_ || batch_.entries().empty()) {
+    return;
+  }
+  ENVOY_LOG(trace, "Sending a batch of {} messages on shared gRPC stream", batch_.entries_size());
+  stream_.sendMessage(batch_, false);
+  batch_.Clear();
+  parent_.stats_.multiplexed_batches_sent_.inc();
+}
+
+void MultiplexedStreamPool::SharedStream::onReceiveMessage(
+    std::unique_ptr<MultiplexedProcessingResponse>&& message) {
+  for (auto& entry : *message->mutable_entries()) {
+    const auto it = streams_.find(entry.stream_id());
+    if (it == streams_.end()) {
+      // The HTTP stream is already complete.
+      continue;
+    }
+    // The callbacks may close the HTTP stream, so it is looked up again for every entry.
+    ExternalProcessorCallbacks& callbacks = it->second->callbacks_;
+    if (entry.has_response()) {
+      callbacks.onReceiveMessage(
+          std::make_unique<ProcessingResponse>(std::move(*entry.mutable_response())));
+    }
+    if (entry.end_of_stream()) {
+      if (const auto ended = streams_.find(entry.stream_id()); ended != streams_.end()) {
+        ended->second->parent_ = nullptr;
+        streams_.erase(ended);
+        callbacks.onGrpcClose();
+      }
+    }
+  }
+}
+
+void MultiplexedStreamPool::SharedStream::onRemoteClose(Grpc::Status::GrpcStatus status,
+                                                        const std::string& message) {
+  ENVOY_LOG(debug, "Shared gRPC stream closed remotely with status {}: {}", status, message);
+  closed_ = true;
+  batch_timer_->disableTimer();
+  if (starting_) {
+    // The stream failed to open, start() reports it.
+    return;
+  }
+
+  std::vector<ExternalProcessorCallbacks*> callbacks;
+  callbacks.reserve(streams_.size());
+  for (auto& [id, stream] : streams_) {
+    stream->parent_ = nullptr;
+    callbacks.push_back(&stream->callbacks_);
+  }
+  streams_.clear();
+  parent_.removeStream(*this);
+
+  for (ExternalProcessorCallbacks* stream_callbacks : callbacks) {
+    if (status == Grpc::Status::Ok) {
+      stream_callbacks->onGrpcClose();
+    } else {
+      stream_callbacks->onGrpcError(status);
+    }
+  }
+}
+
+} // namespace ExternalProcessing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/config/core/v3/grpc_service.pb.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/extensions/filters/http/ext_proc/v3/ext_proc.pb.h"
+#include "envoy/grpc/async_client_manager.h"
+#include "envoy/service/ext_proc/v3/external_processor.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local_object.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/grpc/typed_async_client.h"
+#include "source/extensions/filters/http/ext_proc/client.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExternalProcessing {
+
+#define ALL_EXT_PROC_MULTIPLEXING_STATS(COUNTER)                                                   \
+  COUNTER(multiplexed_grpc_streams_started)                                                        \
+  COUNTER(multiplexed_batches_sent)
+
+struct ExtProcMultiplexingStats {
+  ALL_EXT_PROC_MULTIPLEXING_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Settings of the multiplexing of HTTP streams over shared gRPC streams.
+ */
+struct MultiplexingConfig {
+  static constexpr uint32_t DefaultMaxBatchSize = 64;
+
+  explicit MultiplexingConfig(
+      const envoy::extensions::filters::http::ext_proc::v3::StreamMultiplexing& config);
+
+  const uint32_t max_grpc_streams_;
+  const std::chrono::milliseconds batch_window_;
+  const uint32_t max_batch_size_;
+};
+
+/**
+ * The gRPC streams a worker shares between its HTTP streams, for each external processor. An HTTP
+ * stream is assigned one of them when it starts, round robin, and keeps it for its lifetime.
+ * Messages are sent in batches of MultiplexedProcessingRequest, headers waiting for up to the
+ * batch window for other messages to join them.
+ */
+class MultiplexedStreamPool : public ThreadLocal::ThreadLocalObject,
+                              public Logger::Loggable<Logger::Id::ext_proc> {
+public:
+  MultiplexedStreamPool(Grpc::AsyncClientManager& client_manager, Stats::Scope& scope,
+                        Event::Dispatcher& dispatcher, const MultiplexingConfig& config,
+                        const ExtProcMultiplexingStats& stats);
+  ~MultiplexedStreamPool() override;
+
+  /**
+   * Starts a multiplexed HTTP stream on one of the shared gRPC streams to an external processor,
+   * opening a new gRPC stream if needed. If no gRPC stream can be opened, onGrpcError() is called
+   * inline and the returned stream is already closed.
+   */
+  ExternalProcessorStreamPtr start(ExternalProcessorCallbacks& callbacks,
+                                   const envoy::config::core::v3::GrpcService& grpc_service);
+
+  /**
+   * @return the number of gRPC streams currently open to all the external processors.
+   */
+  size_t grpcStreams() const;
+
+private:
+  class SharedStream;
+
+  // An HTTP stream multiplexed on a shared gRPC stream.
+  class MultiplexedStream : public ExternalProcessorStream {
+  public:
+    MultiplexedStream(SharedStream* parent, uint64_t id, ExternalProcessorCallbacks& callbacks)
+        : parent_(parent), id_(id), callbacks_(callbacks) {}
+    ~MultiplexedStream() override { close(); }
+
+    // ExternalProcessorStream
+    void send(envoy::service::ext_proc::v3::ProcessingRequest&& request,
+              bool end_stream) override;
+    bool close() override;
+
+  private:
+    friend class SharedStream;
+
+    // Cleared once the HTTP stream is detached from the gRPC stream.
+    SharedStream* parent_;
+    const uint64_t id_;
+    ExternalProcessorCallbacks& callbacks_;
+  };
+
+  using MultiplexedProcessingRequest = envoy::service::ext_proc::v3::MultiplexedProcessingRequest;
+  using MultiplexedProcessingResponse =
+      envoy::service::ext_proc::v3::MultiplexedProcessingResponse;
+
+  // A long-lived gRPC stream carrying the messages of many HTTP streams.
+  class SharedStream : public Grpc::AsyncStreamCallbacks<MultiplexedProcessingResponse>,
+                       public Event::DeferredDeletable,
+                       public Logger::Loggable<Logger::Id::ext_proc> {
+  public:
+    SharedStream(MultiplexedStreamPool& parent, uint64_t service_hash,
+                 Grpc::AsyncClient<MultiplexedProcessingRequest, MultiplexedProcessingResponse>&&
+                     client);
+    ~SharedStream() override;
+
+    // Returns false if the gRPC stream could not be opened.
+    bool start();
+    std::unique_ptr<MultiplexedStream> attach(ExternalProcessorCallbacks& callbacks);
+    void send(uint64_t id, envoy::service::ext_proc::v3::ProcessingRequest&& request,
+              bool end_stream);
+    void detach(uint64_t id);
+    void resetStream();
+    uint64_t serviceHash() const { return service_hash_; }
+
+    // Grpc::AsyncStreamCallbacks
+    void onReceiveMessage(std::unique_ptr<MultiplexedProcessingResponse>&& message) override;
+    void onCreateInitialMetadata(Http::RequestHeaderMap&) override {}
+    void onReceiveInitialMetadata(Http::ResponseHeaderMapPtr&&) override {}
+    void onReceiveTrailingMetadata(Http::ResponseTrailerMapPtr&&) override {}
+    void onRemoteClose(Grpc::Status::GrpcStatus status, const std::string& message) override;
+
+  private:
+    void maybeFlush(bool flush_now);
+    void flush();
+
+    MultiplexedStreamPool& parent_;
+    Grpc::AsyncClient<MultiplexedProcessingRequest, MultiplexedProcessingResponse> client_;
+    Grpc::AsyncStream<MultiplexedProcessingRequest> stream_;
+    const Event::TimerPtr batch_timer_;
+    MultiplexedProcessingRequest batch_;
+    absl::flat_hash_map<uint64_t, MultiplexedStream*> streams_;
+    uint64_t next_id_{};
+    bool starting_{};
+    bool closed_{};
+    const uint64_t service_hash_;
+  };
+
+  using SharedStreamPtr = std::unique_ptr<SharedStream>;
+
+  // The gRPC streams to an external processor.
+  struct ServiceStreams {
+    std::vector<SharedStreamPtr> streams_;
+    uint32_t next_{};
+  };
+
+  void removeStream(SharedStream& stream);
+
+  Grpc::AsyncClientManager& client_manager_;
+  Stats::Scope& scope_;
+  Event::Dispatcher& dispatcher_;
+  const MultiplexingConfig config_;
+  ExtProcMultiplexingStats stats_;
+  // Keyed by the hash of the gRPC service configuration.
+  absl::flat_hash_map<uint64_t, ServiceStreams> services_;
+};
+
+using MultiplexedStreamPoolSharedPtr = std::shared_ptr<MultiplexedStreamPool>;
+
+/**
+ * A client starting multiplexed HTTP streams on the pool of the worker.
+ */
+class MultiplexedClientImpl : public ExternalProcessorClient {
+public:
+  explicit MultiplexedClientImpl(MultiplexedStreamPool& pool) : pool_(pool) {}
+
+  ExternalProcessorStreamPtr start(ExternalProcessorCallbacks& callbacks,
+                                   const envoy::config::core::v3::GrpcService& grpc_service,
+                                   const StreamInfo::StreamInfo&) override {
+    return pool_.start(callbacks, grpc_service);
+  }
+
+private:
+  MultiplexedStreamPool& pool_;
+};
+
+} // namespace ExternalProcessing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
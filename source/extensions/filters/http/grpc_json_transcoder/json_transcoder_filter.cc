@@ -1,5 +1,6 @@
 #include "source/extensions/filters/http/grpc_json_transcoder/json_transcoder_filter.h"
 
+#include <limits>
 #include <memory>
 #include <unordered_set>
 
@@ -18,6 +19,7 @@
 #include "source/common/runtime/runtime_features.h"
 #include "source/extensions/filters/http/grpc_json_transcoder/http_body_utils.h"
 
+#include "absl/strings/numbers.h"
 #include "google/api/annotations.pb.h"
 #include "google/api/http.pb.h"
 #include "google/api/httpbody.pb.h"
@@ -489,6 +491,9 @@ Http::FilterHeadersStatus JsonTranscoderFilter::decodeHeaders(Http::RequestHeade
     if (checkIfTranscoderFailed(RcDetails::get().GrpcTranscodeFailed)) {
       return Http::FilterHeadersStatus::StopIteration;
     }
+    if (!end_stream) {
+      maybeStartStreamingHttpBodyRequest(headers);
+    }
   }
 
   headers.removeContentLength();
@@ -530,7 +535,11 @@ Http::FilterDataStatus JsonTranscoderFilter::decodeData(Buffer::Instance& data,
     return Http::FilterDataStatus::Continue;
   }
 
-  if (method_->request_type_is_http_body_) {
+  if (http_body_request_bytes_remaining_.has_value()) {
+    if (!streamHttpBodyRequestData(data, end_stream)) {
+      return Http::FilterDataStatus::StopIterationNoBuffer;
+    }
+  } else if (method_->request_type_is_http_body_) {
     request_data_.move(data);
     if (decoderBufferLimitReached(request_data_.length())) {
       return Http::FilterDataStatus::StopIterationNoBuffer;
@@ -540,7 +549,7 @@ Http::FilterDataStatus JsonTranscoderFilter::decodeData(Buffer::Instance& data,
     if (end_stream || method_->descriptor_->client_streaming()) {
       maybeSendHttpBodyRequestMessage();
     } else {
-      // TODO(euroelessar): Avoid buffering if content length is already known.
+      // The length of the message is only known once the whole body is received.
       return Http::FilterDataStatus::StopIterationAndBuffer;
     }
   } else {
@@ -569,7 +578,12 @@ Http::FilterTrailersStatus JsonTranscoderFilter::decodeTrailers(Http::RequestTra
     return Http::FilterTrailersStatus::Continue;
   }
 
-  if (method_->request_type_is_http_body_) {
+  if (http_body_request_bytes_remaining_.has_value()) {
+    if (http_body_request_bytes_remaining_.value() != 0) {
+      rejectStreamedHttpBodyRequest();
+      return Http::FilterTrailersStatus::StopIteration;
+    }
+  } else if (method_->request_type_is_http_body_) {
     maybeSendHttpBodyRequestMessage();
   } else {
     request_in_.finish();
@@ -635,6 +649,12 @@ Http::FilterDataStatus JsonTranscoderFilter::encodeData(Buffer::Instance& data,
 
   if (method_->response_type_is_http_body_) {
     bool frame_processed = buildResponseFromHttpBodyOutput(*response_headers_, data);
+    // The decoder holds on to the partial frame of a message until it is complete, out of sight
+    // of the watermarks and buffer limit of the filter manager, so bound the size of the message
+    // it may buffer. This applies to unary responses as well as to streamed ones.
+    if (decoder_.hasBufferedData() && encoderBufferLimitReached(decoder_.length())) {
+      return Http::FilterDataStatus::StopIterationNoBuffer;
+    }
     if (!method_->descriptor_->server_streaming()) {
       return Http::FilterDataStatus::StopIterationAndBuffer;
     }
@@ -788,6 +808,58 @@ void JsonTranscoderFilter::maybeSendHttpBodyRequestMessage() {
   first_request_sent_ = true;
 }
 
+void JsonTranscoderFilter::maybeStartStreamingHttpBodyRequest(
+    const Http::RequestHeaderMap& headers) {
+  uint64_t content_length;
+  if (method_->descriptor_->client_streaming() || headers.ContentLength() == nullptr ||
+      !absl::SimpleAtoi(headers.getContentLengthValue(), &content_length) ||
+      content_length == 0) {
+    return;
+  }
+
+  // The body is sent as the content of the HttpBody field of a single message, whose envelope and
+  // gRPC frame header are written ahead of the first chunk of the body.
+  Buffer::OwnedImpl envelope;
+  HttpBodyUtils::appendHttpBodyEnvelope(envelope, method_->request_body_field_path, content_type_,
+                                        content_length);
+  const uint64_t message_length =
+      initial_request_data_.length() + envelope.length() + content_length;
+  if (message_length > std::numeric_limits<uint32_t>::max()) {
+    // Too large for a single gRPC message, left to the buffer limit to reject.
+    return;
+  }
+  http_body_request_prefix_.move(initial_request_data_);
+  http_body_request_prefix_.move(envelope);
+  content_type_.clear();
+  Envoy::Grpc::Encoder().prependFrameHeader(Envoy::Grpc::GRPC_FH_DEFAULT,
+                                            http_body_request_prefix_, message_length);
+  http_body_request_bytes_remaining_ = content_length;
+}
+
+bool JsonTranscoderFilter::streamHttpBodyRequestData(Buffer::Instance& data, bool end_stream) {
+  uint64_t& remaining = http_body_request_bytes_remaining_.value();
+  if (data.length() > remaining || (end_stream && data.length() < remaining)) {
+    rejectStreamedHttpBodyRequest();
+    return false;
+  }
+  remaining -= data.length();
+
+  if (!first_request_sent_) {
+    data.prepend(http_body_request_prefix_);
+    first_request_sent_ = true;
+  }
+  return true;
+}
+
+void JsonTranscoderFilter::rejectStreamedHttpBodyRequest() {
+  ENVOY_LOG(debug, "Request rejected because its body does not match its content length");
+  error_ = true;
+  decoder_callbacks_->sendLocalReply(
+      Http::Code::BadRequest, "Request body does not match its content length.", nullptr,
+      absl::nullopt,
+      absl::StrCat(RcDetails::get().GrpcTranscodeFailed, "{content_length_mismatch}"));
+}
+
 bool JsonTranscoderFilter::buildResponseFromHttpBodyOutput(
     Http::ResponseHeaderMap& response_headers, Buffer::Instance& data) {
   std::vector<Grpc::Frame> frames;
@@ -12,6 +12,7 @@
 #include "source/common/protobuf/protobuf.h"
 #include "source/extensions/filters/http/grpc_json_transcoder/transcoder_input_stream_impl.h"
 
+#include "absl/types/optional.h"
 #include "google/api/http.pb.h"
 #include "grpc_transcoding/path_matcher.h"
 #include "grpc_transcoding/request_message_translator.h"
@@ -172,6 +173,16 @@ private:
   bool checkIfTranscoderFailed(const std::string& details);
   bool readToBuffer(Protobuf::io::ZeroCopyInputStream& stream, Buffer::Instance& data);
   void maybeSendHttpBodyRequestMessage();
+  /**
+   * Streams the body of a unary HttpBody request with a known content length upstream as it is
+   * received, rather than buffering it until the end of the request.
+   */
+  void maybeStartStreamingHttpBodyRequest(const Http::RequestHeaderMap& headers);
+  /**
+   * Returns false if the request was rejected because its body exceeds its content length.
+   */
+  bool streamHttpBodyRequestData(Buffer::Instance& data, bool end_stream);
+  void rejectStreamedHttpBodyRequest();
   /**
    * Builds response from HttpBody protobuf.
    * Returns true if at least one gRPC frame has processed.
@@ -203,6 +214,10 @@ private:
   Buffer::OwnedImpl initial_request_data_;
   Buffer::OwnedImpl request_data_;
   bool first_request_sent_{false};
+  // Set when the body of the request is streamed upstream, see
+  // maybeStartStreamingHttpBodyRequest().
+  absl::optional<uint64_t> http_body_request_bytes_remaining_;
+  Buffer::OwnedImpl http_body_request_prefix_;
   std::string content_type_;
 
   bool error_{false};
@@ -28,21 +28,31 @@ namespace {
  */
 class AuthenticatorImpl : public Logger::Loggable<Logger::Id::jwt>,
                           public Authenticator,
-                          public Common::JwksFetcher::JwksReceiver {
+                          public Common::JwksFetcher::JwksReceiver,
+                          public VerificationCallbacks {
 public:
   AuthenticatorImpl(const CheckAudience* check_audience,
                     const absl::optional<std::string>& provider, bool allow_failed,
                     bool allow_missing, JwksCache& jwks_cache,
                     Upstream::ClusterManager& cluster_manager,
-                    CreateJwksFetcherCb create_jwks_fetcher_cb, TimeSource& time_source)
+                    CreateJwksFetcherCb create_jwks_fetcher_cb, TimeSource& time_source,
+                    VerificationThreadPool* verification_pool)
       : jwks_cache_(jwks_cache), cm_(cluster_manager),
         create_jwks_fetcher_cb_(create_jwks_fetcher_cb), check_audience_(check_audience),
         provider_(provider), is_allow_failed_(allow_failed), is_allow_missing_(allow_missing),
-        time_source_(time_source) {}
+        time_source_(time_source), verification_pool_(verification_pool) {}
+
+  ~AuthenticatorImpl() override {
+    if (verification_ != nullptr) {
+      verification_->cancel();
+    }
+  }
 
   // Following functions are for JwksFetcher::JwksReceiver interface
   void onJwksSuccess(google::jwt_verify::JwksPtr&& jwks) override;
   void onJwksError(Failure reason) override;
+  // Following function is for VerificationCallbacks interface.
+  void onVerificationComplete(VerificationOperation& operation) override;
   // Following functions are for Authenticator interface.
   void verify(Http::HeaderMap& headers, Tracing::Span& parent_span,
               std::vector<JwtLocationConstPtr>&& tokens,
@@ -59,6 +69,9 @@ private:
   // Verify with a specific public key.
   void verifyKey();
 
+  // Handle the result of the signature verification.
+  void onKeyVerified(const Status& status);
+
   // Handle Good Jwt either Cache JWT or verified public key.
   void handleGoodJwt(bool cache_hit);
 
@@ -103,6 +116,10 @@ private:
   const bool is_allow_missing_;
   TimeSource& time_source_;
   ::google::jwt_verify::Jwt* jwt_{};
+  // The pool verifying the signatures, if they are not verified inline.
+  VerificationThreadPool* const verification_pool_;
+  // The signature verification running on the pool.
+  VerificationOperationSharedPtr verification_;
 };
 
 std::string AuthenticatorImpl::name() const {
@@ -256,13 +273,47 @@ void AuthenticatorImpl::onDestroy() {
   if (fetcher_) {
     fetcher_->cancel();
   }
+  if (verification_ != nullptr) {
+    verification_->cancel();
+    verification_ = nullptr;
+  }
 }
 
 // Verify with a specific public key.
 void AuthenticatorImpl::verifyKey() {
-  const Status status =
-      ::google::jwt_verify::verifyJwtWithoutTimeChecking(*jwt_, *jwks_data_->getJwksObj());
+  if (verification_pool_ == nullptr) {
+    onKeyVerified(
+        ::google::jwt_verify::verifyJwtWithoutTimeChecking(*jwt_, *jwks_data_->getJwksObj()));
+    return;
+  }
+
+  // The operation owns the JWT and a reference to the JWKS until the signature is verified, as
+  // the request or the JWKS may go away meanwhile.
+  ASSERT(jwt_ == owned_jwt_.get());
+  verification_ = std::make_shared<VerificationOperation>(
+      verification_pool_->dispatcher(), std::move(owned_jwt_), jwks_data_->getSharedJwksObj());
+  verification_->callbacks_ = this;
+  if (verification_pool_->enqueue(verification_)) {
+    jwks_cache_.stats().signature_verification_offloaded_.inc();
+    return;
+  }
+
+  // The pool is saturated, verify on the worker thread instead of growing the queue without
+  // bounds.
+  jwks_cache_.stats().signature_verification_overflow_.inc();
+  verification_->run();
+  onVerificationComplete(*verification_);
+}
+
+void AuthenticatorImpl::onVerificationComplete(VerificationOperation& operation) {
+  ASSERT(&operation == verification_.get());
+  owned_jwt_ = std::move(operation.jwt_);
+  const Status status = operation.status_;
+  verification_ = nullptr;
+  onKeyVerified(status);
+}
 
+void AuthenticatorImpl::onKeyVerified(const Status& status) {
   if (status != Status::Ok) {
     doneWithStatus(status);
     return;
@@ -342,10 +393,11 @@ AuthenticatorPtr Authenticator::create(const CheckAudience* check_audience,
                                        bool allow_failed, bool allow_missing, JwksCache& jwks_cache,
                                        Upstream::ClusterManager& cluster_manager,
                                        CreateJwksFetcherCb create_jwks_fetcher_cb,
-                                       TimeSource& time_source) {
+                                       TimeSource& time_source,
+                                       VerificationThreadPool* verification_pool) {
   return std::make_unique<AuthenticatorImpl>(check_audience, provider, allow_failed, allow_missing,
                                              jwks_cache, cluster_manager, create_jwks_fetcher_cb,
-                                             time_source);
+                                             time_source, verification_pool);
 }
 
 } // namespace JwtAuthn
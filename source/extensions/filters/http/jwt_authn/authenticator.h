@@ -5,6 +5,7 @@
 #include "source/extensions/filters/http/jwt_authn/extractor.h"
 #include "source/extensions/filters/http/jwt_authn/jwks_cache.h"
 #include "source/extensions/filters/http/jwt_authn/jwt_cache.h"
+#include "source/extensions/filters/http/jwt_authn/verification_pool.h"
 
 #include "jwt_verify_lib/check_audience.h"
 #include "jwt_verify_lib/status.h"
@@ -39,13 +40,15 @@ public:
   // Called when the object is about to be destroyed.
   virtual void onDestroy() PURE;
 
-  // Authenticator factory function.
+  // Authenticator factory function. Signatures are verified on the verification pool if any,
+  // otherwise inline.
   static AuthenticatorPtr create(const ::google::jwt_verify::CheckAudience* check_audience,
                                  const absl::optional<std::string>& provider, bool allow_failed,
                                  bool allow_missing, JwksCache& jwks_cache,
                                  Upstream::ClusterManager& cluster_manager,
                                  CreateJwksFetcherCb create_jwks_fetcher_cb,
-                                 TimeSource& time_source);
+                                 TimeSource& time_source,
+                                 VerificationThreadPool* verification_pool = nullptr);
 };
 
 /**
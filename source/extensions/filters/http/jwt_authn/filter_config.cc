@@ -20,6 +20,11 @@ FilterConfigImpl::FilterConfigImpl(
   ENVOY_LOG(debug, "Loaded JwtAuthConfig: {}", proto_config_.DebugString());
 
   jwks_cache_ = JwksCache::create(proto_config_, context, Common::JwksFetcher::create, stats_);
+  if (proto_config_.has_verification_thread_pool()) {
+    verification_pool_ = std::make_unique<VerificationThreadPool>(
+        proto_config_.verification_thread_pool(), context.api().threadFactory(),
+        context.threadLocal());
+  }
 
   std::vector<std::string> names;
   for (const auto& it : proto_config_.requirement_map()) {
@@ -108,7 +108,8 @@ public:
                           const absl::optional<std::string>& provider, bool allow_failed,
                           bool allow_missing) const override {
     return Authenticator::create(check_audience, provider, allow_failed, allow_missing,
-                                 getJwksCache(), cm(), Common::JwksFetcher::create, timeSource());
+                                 getJwksCache(), cm(), Common::JwksFetcher::create, timeSource(),
+                                 verification_pool_.get());
   }
 
 private:
@@ -130,6 +131,8 @@ private:
   JwtAuthnFilterStats stats_;
   // JwksCache
   JwksCachePtr jwks_cache_;
+  // The pool verifying the signatures, if not verified on the workers.
+  VerificationThreadPoolPtr verification_pool_;
   // the cluster manager object.
   Upstream::ClusterManager& cm_;
   // The list of rule matchers.
@@ -62,6 +62,9 @@ public:
     // Get the Jwks object.
     virtual const ::google::jwt_verify::Jwks* getJwksObj() const PURE;
 
+    // Get a reference to the Jwks object, to use it outside of the worker thread.
+    virtual JwksConstSharedPtr getSharedJwksObj() const PURE;
+
     // Return true if jwks object is expired.
     virtual bool isExpired() const PURE;
 
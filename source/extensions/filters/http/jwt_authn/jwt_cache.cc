@@ -2,6 +2,7 @@
 
 #include "source/common/common/assert.h"
 
+#include "absl/hash/hash.h"
 #include "simple_lru_cache/simple_lru_cache_inl.h"
 
 using ::google::simple_lru_cache::SimpleLRUCache;
@@ -19,8 +20,9 @@ constexpr int kMaxJwtSizeForCache = 4 * 1024; // 4KiB
 
 class JwtCacheImpl : public JwtCache {
 public:
-  JwtCacheImpl(bool enable_cache, const JwtCacheConfig& config, TimeSource& time_source)
-      : time_source_(time_source) {
+  JwtCacheImpl(bool enable_cache, const JwtCacheConfig& config, TimeSource& time_source,
+               SharedJwtCacheSharedPtr shared_cache)
+      : time_source_(time_source), shared_cache_(enable_cache ? std::move(shared_cache) : nullptr) {
     if (enable_cache) {
       // if cache_size is 0, it is not specified in the config, use default
       auto cache_size =
@@ -52,11 +54,23 @@ public:
         jwt_lru_cache_->remove(token);
       }
     }
+    if (shared_cache_) {
+      // The token may have been verified by another worker.
+      auto jwt = shared_cache_->lookup(token);
+      if (jwt) {
+        ::google::jwt_verify::Jwt* const found_jwt = jwt.get();
+        jwt_lru_cache_->insert(token, jwt.release(), 1);
+        return found_jwt;
+      }
+    }
     return nullptr;
   }
 
   void insert(const std::string& token, std::unique_ptr<::google::jwt_verify::Jwt>&& jwt) override {
     if (jwt_lru_cache_ && token.size() <= kMaxJwtSizeForCache) {
+      if (shared_cache_) {
+        shared_cache_->insert(token, *jwt);
+      }
       // pass the ownership of jwt to cache
       jwt_lru_cache_->insert(token, jwt.release(), 1);
     }
@@ -65,12 +79,67 @@ public:
 private:
   std::unique_ptr<SimpleLRUCache<std::string, ::google::jwt_verify::Jwt>> jwt_lru_cache_;
   TimeSource& time_source_;
+  const SharedJwtCacheSharedPtr shared_cache_;
 };
 } // namespace
 
+SharedJwtCache::SharedJwtCache(const JwtCacheConfig& config, TimeSource& time_source)
+    : time_source_(time_source) {
+  const size_t cache_size =
+      config.jwt_cache_size() == 0 ? kJwtCacheDefaultSize : config.jwt_cache_size();
+  shard_size_ = (cache_size + NumShards - 1) / NumShards;
+}
+
+SharedJwtCache::Shard& SharedJwtCache::shard(const std::string& token) {
+  return shards_[absl::Hash<std::string>()(token) % NumShards];
+}
+
+std::unique_ptr<::google::jwt_verify::Jwt> SharedJwtCache::lookup(const std::string& token) {
+  JwtConstSharedPtr jwt;
+  {
+    Shard& cache = shard(token);
+    absl::MutexLock lock(&cache.mutex_);
+    const auto it = cache.index_.find(token);
+    if (it == cache.index_.end()) {
+      return nullptr;
+    }
+    if (it->second->second->verifyTimeConstraint(DateUtil::nowToSeconds(time_source_)) ==
+        ::google::jwt_verify::Status::JwtExpired) {
+      const auto entry = it->second;
+      cache.index_.erase(it);
+      cache.entries_.erase(entry);
+      return nullptr;
+    }
+    cache.entries_.splice(cache.entries_.begin(), cache.entries_, it->second);
+    jwt = it->second->second;
+  }
+  // Copy outside of the lock, the cached JWT is never modified.
+  return std::make_unique<::google::jwt_verify::Jwt>(*jwt);
+}
+
+void SharedJwtCache::insert(const std::string& token, const ::google::jwt_verify::Jwt& jwt) {
+  if (token.size() > kMaxJwtSizeForCache) {
+    return;
+  }
+  auto copy = std::make_shared<const ::google::jwt_verify::Jwt>(jwt);
+  Shard& cache = shard(token);
+  absl::MutexLock lock(&cache.mutex_);
+  if (cache.index_.contains(token)) {
+    // Another worker verified the same token.
+    return;
+  }
+  cache.entries_.emplace_front(token, std::move(copy));
+  cache.index_.emplace(cache.entries_.front().first, cache.entries_.begin());
+  if (cache.entries_.size() > shard_size_) {
+    cache.index_.erase(cache.entries_.back().first);
+    cache.entries_.pop_back();
+  }
+}
+
 JwtCachePtr JwtCache::create(bool enable_cache, const JwtCacheConfig& config,
-                             TimeSource& time_source) {
-  return std::make_unique<JwtCacheImpl>(enable_cache, config, time_source);
+                             TimeSource& time_source, SharedJwtCacheSharedPtr shared_cache) {
+  return std::make_unique<JwtCacheImpl>(enable_cache, config, time_source,
+                                        std::move(shared_cache));
 }
 
 } // namespace JwtAuthn
@@ -1,5 +1,7 @@
 #pragma once
+#include <array>
 #include <chrono>
+#include <list>
 #include <memory>
 #include <string>
 
@@ -7,6 +9,8 @@
 
 #include "source/common/common/utility.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "jwt_verify_lib/jwt.h"
 #include "jwt_verify_lib/verify.h"
 
@@ -19,6 +23,45 @@ namespace JwtAuthn {
 
 // Cache key is the JWT string, value is parsed JWT struct.
 
+/**
+ * A cache of verified JWTs shared by all the worker threads. It is split in shards by token, each
+ * one an LRU cache with its own lock, to limit the contention between the workers. The cached JWTs
+ * are immutable, lookups return a copy for the cache of the calling worker.
+ */
+class SharedJwtCache {
+public:
+  SharedJwtCache(const JwtCacheConfig& config, TimeSource& time_source);
+
+  // Lookup a JWT token in the cache, if found return a copy of its parsed jwt struct.
+  // If no found, return nullptr.
+  std::unique_ptr<::google::jwt_verify::Jwt> lookup(const std::string& token);
+
+  // Insert a JWT token and a copy of its parsed JWT struct to the cache.
+  void insert(const std::string& token, const ::google::jwt_verify::Jwt& jwt);
+
+private:
+  using JwtConstSharedPtr = std::shared_ptr<const ::google::jwt_verify::Jwt>;
+  using Entry = std::pair<std::string, JwtConstSharedPtr>;
+
+  struct Shard {
+    absl::Mutex mutex_;
+    // The most recently used entry first.
+    std::list<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator>
+        index_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  static constexpr size_t NumShards = 16;
+
+  Shard& shard(const std::string& token);
+
+  TimeSource& time_source_;
+  size_t shard_size_;
+  std::array<Shard, NumShards> shards_;
+};
+
+using SharedJwtCacheSharedPtr = std::shared_ptr<SharedJwtCache>;
+
 class JwtCache;
 using JwtCachePtr = std::unique_ptr<JwtCache>;
 
@@ -35,9 +78,11 @@ public:
   virtual void insert(const std::string& token,
                       std::unique_ptr<::google::jwt_verify::Jwt>&& jwt) PURE;
 
-  // JwtCache factory function.
+  // JwtCache factory function. The shared cache, if any, is looked up on misses and gets a copy
+  // of the inserted JWTs.
   static JwtCachePtr create(bool enable_cache, const JwtCacheConfig& config,
-                            TimeSource& time_source);
+                            TimeSource& time_source,
+                            SharedJwtCacheSharedPtr shared_cache = nullptr);
 };
 
 } // namespace JwtAuthn
@@ -0,0 +1,110 @@
+#include "source/extensions/filters/http/jwt_authn/verification_pool.h"
+
+#include "source/common/protobuf/utility.h"
+
+#include "jwt_verify_lib/verify.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+VerificationOperation::VerificationOperation(Event::Dispatcher& dispatcher,
+                                             std::unique_ptr<::google::jwt_verify::Jwt>&& jwt,
+                                             JwksConstSharedPtr jwks)
+    : jwt_(std::move(jwt)), jwks_(std::move(jwks)), dispatcher_(dispatcher) {}
+
+void VerificationOperation::run() {
+  status_ = ::google::jwt_verify::verifyJwtWithoutTimeChecking(*jwt_, *jwks_);
+}
+
+void VerificationOperation::postCompletion() {
+  absl::MutexLock lock(&mutex_);
+  if (cancelled_) {
+    return;
+  }
+  dispatcher_.post([operation = shared_from_this()]() {
+    // The request may have gone away after the completion was posted.
+    if (operation->callbacks_ != nullptr) {
+      operation->callbacks_->onVerificationComplete(*operation);
+    }
+  });
+}
+
+void VerificationOperation::cancel() {
+  absl::MutexLock lock(&mutex_);
+  cancelled_ = true;
+  callbacks_ = nullptr;
+}
+
+VerificationThreadPool::VerificationThreadPool(
+    const envoy::extensions::filters::http::jwt_authn::v3::JwtVerificationThreadPool& config,
+    Thread::ThreadFactory& thread_factory, ThreadLocal::SlotAllocator& tls)
+    : tls_(tls) {
+  if (config.has_max_pending_verifications()) {
+    max_pending_operations_ = config.max_pending_verifications().value();
+  }
+  tls_.set([](Event::Dispatcher& dispatcher) {
+    return std::make_shared<ThreadLocalDispatcher>(dispatcher);
+  });
+  threads_.reserve(config.thread_count());
+  for (uint32_t i = 0; i < config.thread_count(); ++i) {
+    threads_.push_back(thread_factory.createThread([this]() -> void { threadRoutine(); },
+                                                   Thread::Options{"JwtVerifyPool"}));
+  }
+}
+
+VerificationThreadPool::~VerificationThreadPool() {
+  {
+    Thread::LockGuard lock(mutex_);
+    exit_ = true;
+  }
+  queue_event_.notifyAll();
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+  // Operations still queued are dropped. The pool is only destroyed with the filter config, once
+  // no request uses it.
+}
+
+bool VerificationThreadPool::enqueue(VerificationOperationSharedPtr operation) {
+  {
+    Thread::LockGuard lock(mutex_);
+    if (max_pending_operations_.has_value() &&
+        pending_operations_ >= max_pending_operations_.value()) {
+      return false;
+    }
+    queue_.push_back(std::move(operation));
+    pending_operations_++;
+  }
+  queue_event_.notifyOne();
+  return true;
+}
+
+void VerificationThreadPool::threadRoutine() {
+  while (true) {
+    VerificationOperationSharedPtr operation;
+    {
+      Thread::LockGuard lock(mutex_);
+      while (queue_.empty() && !exit_) {
+        queue_event_.wait(mutex_);
+      }
+      if (exit_) {
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    operation->run();
+    operation->postCompletion();
+
+    Thread::LockGuard lock(mutex_);
+    pending_operations_--;
+  }
+}
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/filters/http/jwt_authn/v3/config.pb.h"
+#include "envoy/thread/thread.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/common/thread.h"
+#include "source/extensions/filters/http/jwt_authn/jwks_cache.h"
+
+#include "absl/synchronization/mutex.h"
+#include "jwt_verify_lib/jwt.h"
+#include "jwt_verify_lib/status.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+class VerificationOperation;
+
+/**
+ * Callbacks of the worker thread waiting for a signature verification.
+ */
+class VerificationCallbacks {
+public:
+  virtual ~VerificationCallbacks() = default;
+
+  /**
+   * Called on the worker thread once the signature is verified.
+   */
+  virtual void onVerificationComplete(VerificationOperation& operation) PURE;
+};
+
+/**
+ * The verification of the signature of a JWT. The JWT is owned by the operation while it runs on
+ * one of the pool threads, the result is picked up by the worker thread which created it.
+ */
+class VerificationOperation : public std::enable_shared_from_this<VerificationOperation> {
+public:
+  VerificationOperation(Event::Dispatcher& dispatcher,
+                        std::unique_ptr<::google::jwt_verify::Jwt>&& jwt, JwksConstSharedPtr jwks);
+
+  /**
+   * Verifies the signature. Called on a pool thread, or on the worker thread if the pool is full.
+   */
+  void run();
+
+  /**
+   * Posts the completion to the worker thread which started the operation, unless the operation
+   * has been cancelled. Called by the pool thread once run() has returned.
+   */
+  void postCompletion();
+
+  /**
+   * Cancels the completion. Called on the worker thread when the request goes away. Once this
+   * returns no completion is posted.
+   */
+  void cancel();
+
+  std::unique_ptr<::google::jwt_verify::Jwt> jwt_;
+  const JwksConstSharedPtr jwks_;
+  ::google::jwt_verify::Status status_{::google::jwt_verify::Status::Ok};
+
+  // Only accessed on the worker thread.
+  VerificationCallbacks* callbacks_{};
+
+private:
+  Event::Dispatcher& dispatcher_;
+  absl::Mutex mutex_;
+  bool cancelled_ ABSL_GUARDED_BY(mutex_){};
+};
+
+using VerificationOperationSharedPtr = std::shared_ptr<VerificationOperation>;
+
+/**
+ * Pool of threads verifying the signatures of JWTs for the worker threads. Completions are posted
+ * back to the dispatcher of the worker thread which queued the operation.
+ */
+class VerificationThreadPool : public Logger::Loggable<Logger::Id::jwt> {
+public:
+  VerificationThreadPool(
+      const envoy::extensions::filters::http::jwt_authn::v3::JwtVerificationThreadPool& config,
+      Thread::ThreadFactory& thread_factory, ThreadLocal::SlotAllocator& tls);
+  ~VerificationThreadPool();
+
+  /**
+   * @return the dispatcher of the calling worker thread, to which the completions of the
+   *         operations it queues are posted.
+   */
+  Event::Dispatcher& dispatcher() { return tls_->dispatcher_; }
+
+  /**
+   * Queues an operation.
+   * @return false if the pool already holds the maximum number of pending operations. The caller
+   *         is then expected to run the operation itself.
+   */
+  bool enqueue(VerificationOperationSharedPtr operation);
+
+private:
+  struct ThreadLocalDispatcher : public ThreadLocal::ThreadLocalObject {
+    explicit ThreadLocalDispatcher(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+    Event::Dispatcher& dispatcher_;
+  };
+
+  void threadRoutine();
+
+  ThreadLocal::TypedSlot<ThreadLocalDispatcher> tls_;
+  absl::optional<uint32_t> max_pending_operations_;
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar queue_event_;
+  std::deque<VerificationOperationSharedPtr> queue_ ABSL_GUARDED_BY(mutex_);
+  // Operations which are queued or running.
+  uint32_t pending_operations_ ABSL_GUARDED_BY(mutex_){};
+  bool exit_ ABSL_GUARDED_BY(mutex_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+using VerificationThreadPoolPtr = std::unique_ptr<VerificationThreadPool>;
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
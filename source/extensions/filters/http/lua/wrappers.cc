@@ -64,6 +64,22 @@ int HeaderMapWrapper::luaGetAtIndex(lua_State* state) {
   return 0;
 }
 
+int HeaderMapWrapper::luaGetMany(lua_State* state) {
+  const int num_keys = lua_gettop(state) - 1;
+  luaL_checkstack(state, num_keys, "too many header names");
+  for (int i = 0; i < num_keys; i++) {
+    absl::string_view key = Filters::Common::Lua::getStringViewFromLuaString(state, i + 2);
+    const Http::HeaderUtility::GetAllOfHeaderAsStringResult value =
+        Http::HeaderUtility::getAllOfHeaderAsString(headers_, Http::LowerCaseString(key));
+    if (value.result().has_value()) {
+      lua_pushlstring(state, value.result().value().data(), value.result().value().length());
+    } else {
+      lua_pushnil(state);
+    }
+  }
+  return num_keys;
+}
+
 int HeaderMapWrapper::luaGetNumValues(lua_State* state) {
   absl::string_view key = Filters::Common::Lua::getStringViewFromLuaString(state, 2);
   const Http::HeaderMap::GetResult header_value = headers_.get(Http::LowerCaseString(key));
@@ -108,6 +124,28 @@ int HeaderMapWrapper::luaRemove(lua_State* state) {
   return 0;
 }
 
+int HeaderMapWrapper::luaToTable(lua_State* state) {
+  lua_createtable(state, 0, headers_.size());
+  headers_.iterate([state](const Http::HeaderEntry& header) -> Http::HeaderMap::Iterate {
+    const absl::string_view key = header.key().getStringView();
+    const absl::string_view value = header.value().getStringView();
+    lua_pushlstring(state, key.data(), key.length());
+    lua_pushvalue(state, -1);
+    lua_rawget(state, -3);
+    if (lua_isnil(state, -1)) {
+      lua_pop(state, 1);
+      lua_pushlstring(state, value.data(), value.length());
+    } else {
+      lua_pushliteral(state, ",");
+      lua_pushlstring(state, value.data(), value.length());
+      lua_concat(state, 3);
+    }
+    lua_rawset(state, -3);
+    return Http::HeaderMap::Iterate::Continue;
+  });
+  return 1;
+}
+
 void HeaderMapWrapper::checkModifiable(lua_State* state) {
   if (iterator_.get() != nullptr) {
     luaL_error(state, "header map cannot be modified while iterating");
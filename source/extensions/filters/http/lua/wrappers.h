@@ -47,9 +47,11 @@ public:
     return {{"add", static_luaAdd},
             {"get", static_luaGet},
             {"getAtIndex", static_luaGetAtIndex},
+            {"getMany", static_luaGetMany},
             {"getNumValues", static_luaGetNumValues},
             {"remove", static_luaRemove},
             {"replace", static_luaReplace},
+            {"toTable", static_luaToTable},
             {"__pairs", static_luaPairs}};
   }
 
@@ -77,6 +79,13 @@ private:
    */
   DECLARE_LUA_FUNCTION(HeaderMapWrapper, luaGetAtIndex);
 
+  /**
+   * Get the values of several headers from the map in a single call.
+   * @param 1..N (string): header names.
+   * @return one string value or nil per header name, in order.
+   */
+  DECLARE_LUA_FUNCTION(HeaderMapWrapper, luaGetMany);
+
   /**
    * Get the header value size from the map.
    * @param 1 (string): header name.
@@ -105,6 +114,14 @@ private:
    */
   DECLARE_LUA_FUNCTION(HeaderMapWrapper, luaReplace);
 
+  /**
+   * Copy all the headers of the map into a table in a single call. Unlike pairs(), the table does
+   * not prevent modifying the map.
+   * @return table mapping header names to values. The values of a header present more than once
+   *         are joined with a comma, as with get().
+   */
+  DECLARE_LUA_FUNCTION(HeaderMapWrapper, luaToTable);
+
   void checkModifiable(lua_State* state);
 
   // Envoy::Lua::BaseLuaObject
@@ -9,6 +9,7 @@
 
 #include "source/common/config/utility.h"
 #include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/common/ratelimit/quota_lease.h"
 #include "source/extensions/filters/common/ratelimit/ratelimit_impl.h"
 #include "source/extensions/filters/http/ratelimit/ratelimit.h"
 
@@ -28,11 +29,20 @@ Http::FilterFactoryCb RateLimitFilterConfig::createFilterFactoryFromProtoTyped(
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, timeout, 20));
 
   Config::Utility::checkTransportVersion(proto_config.rate_limit_service());
-  return [proto_config, &context, timeout,
-          filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(std::make_shared<Filter>(
-        filter_config, Filters::Common::RateLimit::rateLimitClient(
-                           context, proto_config.rate_limit_service().grpc_service(), timeout)));
+  Filters::Common::RateLimit::QuotaLeaseConfigSharedPtr quota_lease;
+  if (proto_config.has_quota_lease()) {
+    quota_lease = std::make_shared<Filters::Common::RateLimit::QuotaLeaseConfig>(
+        proto_config.quota_lease(), proto_config.rate_limit_service().grpc_service(), timeout,
+        context);
+  }
+  return [proto_config, &context, timeout, filter_config,
+          quota_lease](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    Filters::Common::RateLimit::ClientPtr client = Filters::Common::RateLimit::rateLimitClient(
+        context, proto_config.rate_limit_service().grpc_service(), timeout);
+    if (quota_lease != nullptr) {
+      client = quota_lease->wrap(std::move(client));
+    }
+    callbacks.addStreamFilter(std::make_shared<Filter>(filter_config, std::move(client)));
   };
 }
 
@@ -42,15 +42,12 @@
 #include "source/common/quic/codec_impl.h"
 #endif
 
-#include "source/extensions/filters/http/common/pass_through_filter.h"
-
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
 namespace HttpConnectionManager {
 namespace {
 
-using FilterFactoriesList = std::list<Http::FilterFactoryCb>;
 using FilterFactoryMap = std::map<std::string, HttpConnectionManagerConfig::FilterConfig>;
 
 HttpConnectionManagerConfig::UpgradeMap::const_iterator
@@ -84,16 +81,6 @@ std::unique_ptr<Http::InternalAddressConfig> createInternalAddressConfig(
   return std::make_unique<Http::DefaultInternalAddressConfig>();
 }
 
-class MissingConfigFilter : public Http::PassThroughDecoderFilter {
-public:
-  Http::FilterHeadersStatus decodeHeaders(Http::RequestHeaderMap&, bool) override {
-    decoder_callbacks_->streamInfo().setResponseFlag(StreamInfo::ResponseFlag::NoFilterConfigFound);
-    decoder_callbacks_->sendLocalReply(Http::Code::InternalServerError, EMPTY_STRING, nullptr,
-                                       absl::nullopt, EMPTY_STRING);
-    return Http::FilterHeadersStatus::StopIteration;
-  }
-};
-
 envoy::extensions::filters::network::http_connection_manager::v3::HttpConnectionManager::
     PathWithEscapedSlashesAction
     getPathWithEscapedSlashesActionRuntimeOverride(Server::Configuration::FactoryContext& context) {
@@ -586,6 +573,7 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
   if (!status.ok()) {
     throw EnvoyException(std::string(status.message()));
   }
+  filter_chain_template_ = std::make_unique<FilterChainTemplate>(filter_factories_);
 
   for (const auto& upgrade_config : config.upgrade_configs()) {
     const std::string& name = upgrade_config.upgrade_type();
@@ -609,12 +597,12 @@ HttpConnectionManagerConfig::HttpConnectionManagerConfig(
         throw EnvoyException(std::string(status.message()));
       }
 
-      upgrade_filter_factories_.emplace(
-          std::make_pair(name, FilterConfig{std::move(factories), enabled}));
+      auto filter_chain_template = std::make_unique<FilterChainTemplate>(*factories);
+      upgrade_filter_factories_.emplace(std::make_pair(
+          name, FilterConfig{std::move(factories), std::move(filter_chain_template), enabled}));
     } else {
-      std::unique_ptr<FilterFactoriesList> factories(nullptr);
       upgrade_filter_factories_.emplace(
-          std::make_pair(name, FilterConfig{std::move(factories), enabled}));
+          std::make_pair(name, FilterConfig{nullptr, nullptr, enabled}));
     }
   }
 }
@@ -724,30 +712,8 @@ HttpConnectionManagerConfig::createCodec(Network::Connection& connection,
   PANIC_DUE_TO_CORRUPT_ENUM;
 }
 
-void HttpConnectionManagerConfig::createFilterChainForFactories(
-    Http::FilterChainFactoryCallbacks& callbacks, const FilterFactoriesList& filter_factories) {
-  bool added_missing_config_filter = false;
-  for (const auto& filter_config_provider : filter_factories) {
-    auto config = filter_config_provider->config();
-    if (config.has_value()) {
-      config.value()(callbacks);
-      continue;
-    }
-
-    // If a filter config is missing after warming, inject a local reply with status 500.
-    if (!added_missing_config_filter) {
-      ENVOY_LOG(trace, "Missing filter config for a provider {}", filter_config_provider->name());
-      callbacks.addStreamDecoderFilter(
-          Http::StreamDecoderFilterSharedPtr{std::make_shared<MissingConfigFilter>()});
-      added_missing_config_filter = true;
-    } else {
-      ENVOY_LOG(trace, "Provider {} missing a filter config", filter_config_provider->name());
-    }
-  }
-}
-
 void HttpConnectionManagerConfig::createFilterChain(Http::FilterChainFactoryCallbacks& callbacks) {
-  createFilterChainForFactories(callbacks, filter_factories_);
+  filter_chain_template_->instantiate(callbacks);
 }
 
 bool HttpConnectionManagerConfig::createUpgradeFilterChain(
@@ -773,12 +739,12 @@ bool HttpConnectionManagerConfig::createUpgradeFilterChain(
     // or neither is configured for this upgrade.
     return false;
   }
-  FilterFactoriesList* filters_to_use = &filter_factories_;
-  if (it != upgrade_filter_factories_.end() && it->second.filter_factories != nullptr) {
-    filters_to_use = it->second.filter_factories.get();
+  const FilterChainTemplate* template_to_use = filter_chain_template_.get();
+  if (it != upgrade_filter_factories_.end() && it->second.filter_chain_template != nullptr) {
+    template_to_use = it->second.filter_chain_template.get();
   }
 
-  createFilterChainForFactories(callbacks, *filters_to_use);
+  template_to_use->instantiate(callbacks);
   return true;
 }
 
@@ -33,6 +33,7 @@
 #include "source/common/tracing/http_tracer_impl.h"
 #include "source/extensions/filters/network/common/factory_base.h"
 #include "source/extensions/filters/network/http_connection_manager/dependency_manager.h"
+#include "source/extensions/filters/network/http_connection_manager/filter_chain_template.h"
 #include "source/extensions/filters/network/well_known_names.h"
 
 namespace Envoy {
@@ -133,9 +134,9 @@ public:
 
   // Http::FilterChainFactory
   void createFilterChain(Http::FilterChainFactoryCallbacks& callbacks) override;
-  using FilterFactoriesList = std::list<Filter::FilterConfigProviderPtr<Http::FilterFactoryCb>>;
   struct FilterConfig {
     std::unique_ptr<FilterFactoriesList> filter_factories;
+    FilterChainTemplatePtr filter_chain_template;
     bool allow_upgrade;
   };
   bool createUpgradeFilterChain(absl::string_view upgrade_type,
@@ -246,8 +247,6 @@ private:
                              FilterFactoriesList& filter_factories,
                              const std::string& filter_chain_type,
                              bool last_filter_in_current_config);
-  void createFilterChainForFactories(Http::FilterChainFactoryCallbacks& callbacks,
-                                     const FilterFactoriesList& filter_factories);
 
   /**
    * Determines what tracing provider to use for a given
@@ -260,6 +259,7 @@ private:
   Http::RequestIDExtensionSharedPtr request_id_extension_;
   Server::Configuration::FactoryContext& context_;
   FilterFactoriesList filter_factories_;
+  FilterChainTemplatePtr filter_chain_template_;
   std::map<std::string, FilterConfig> upgrade_filter_factories_;
   std::list<AccessLog::InstanceSharedPtr> access_logs_;
   const std::string stats_prefix_;
@@ -0,0 +1,69 @@
+#include "source/extensions/filters/network/http_connection_manager/filter_chain_template.h"
+
+#include "source/common/common/assert.h"
+#include "source/extensions/filters/http/common/pass_through_filter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace HttpConnectionManager {
+
+namespace {
+
+class MissingConfigFilter : public Http::PassThroughDecoderFilter {
+public:
+  Http::FilterHeadersStatus decodeHeaders(Http::RequestHeaderMap&, bool) override {
+    decoder_callbacks_->streamInfo().setResponseFlag(StreamInfo::ResponseFlag::NoFilterConfigFound);
+    decoder_callbacks_->sendLocalReply(Http::Code::InternalServerError, EMPTY_STRING, nullptr,
+                                       absl::nullopt, EMPTY_STRING);
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+};
+
+} // namespace
+
+FilterChainTemplate::FilterChainTemplate(const FilterFactoriesList& filter_factories) {
+  entries_.reserve(filter_factories.size());
+  for (const auto& filter_config_provider : filter_factories) {
+    if (dynamic_cast<Filter::DynamicFilterConfigProvider<Http::FilterFactoryCb>*>(
+            filter_config_provider.get()) != nullptr) {
+      entries_.push_back({nullptr, filter_config_provider.get()});
+      continue;
+    }
+    // Static providers always hold a config.
+    auto config = filter_config_provider->config();
+    ASSERT(config.has_value());
+    entries_.push_back({config.value(), nullptr});
+  }
+}
+
+void FilterChainTemplate::instantiate(Http::FilterChainFactoryCallbacks& callbacks) const {
+  bool added_missing_config_filter = false;
+  for (const Entry& entry : entries_) {
+    if (entry.provider_ == nullptr) {
+      entry.factory_(callbacks);
+      continue;
+    }
+
+    auto config = entry.provider_->config();
+    if (config.has_value()) {
+      config.value()(callbacks);
+      continue;
+    }
+
+    // If a filter config is missing after warming, inject a local reply with status 500.
+    if (!added_missing_config_filter) {
+      ENVOY_LOG(trace, "Missing filter config for a provider {}", entry.provider_->name());
+      callbacks.addStreamDecoderFilter(
+          Http::StreamDecoderFilterSharedPtr{std::make_shared<MissingConfigFilter>()});
+      added_missing_config_filter = true;
+    } else {
+      ENVOY_LOG(trace, "Provider {} missing a filter config", entry.provider_->name());
+    }
+  }
+}
+
+} // namespace HttpConnectionManager
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
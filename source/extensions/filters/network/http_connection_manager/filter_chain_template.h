@@ -0,0 +1,56 @@
+#pragma once
+
+#include <list>
+#include <vector>
+
+#include "envoy/filter/config_provider_manager.h"
+#include "envoy/http/filter.h"
+
+#include "source/common/common/logger.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace HttpConnectionManager {
+
+using FilterFactoriesList = std::list<Filter::FilterConfigProviderPtr<Http::FilterFactoryCb>>;
+
+/**
+ * Flattened form of an HTTP filter chain, computed once when the connection manager is configured
+ * so that creating the filters of a stream is a walk over a vector. The factories of filters
+ * configured inline never change and are resolved up front. Filters configured through discovery
+ * keep their provider, whose current config is looked up for every stream.
+ */
+class FilterChainTemplate : Logger::Loggable<Logger::Id::config> {
+public:
+  /**
+   * @param filter_factories the providers of the filters, in configuration order. The providers
+   *        must outlive the template.
+   */
+  explicit FilterChainTemplate(const FilterFactoriesList& filter_factories);
+
+  /**
+   * Adds the filters of the chain to a stream. If a filter configured through discovery has no
+   * config, a filter answering with a 500 local reply is added in its place.
+   */
+  void instantiate(Http::FilterChainFactoryCallbacks& callbacks) const;
+
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct Entry {
+    // Set for filters configured inline.
+    Http::FilterFactoryCb factory_;
+    // Set for filters configured through discovery.
+    Filter::FilterConfigProvider<Http::FilterFactoryCb>* provider_{};
+  };
+
+  std::vector<Entry> entries_;
+};
+
+using FilterChainTemplatePtr = std::unique_ptr<const FilterChainTemplate>;
+
+} // namespace HttpConnectionManager
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,350 @@
+#include "source/extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+#include "source/common/config/datasource.h"
+#include "source/common/protobuf/utility.h"
+
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+namespace {
+
+bool sign(EVP_PKEY* pkey, uint16_t signature_algorithm, const std::vector<uint8_t>& in,
+          std::vector<uint8_t>& out) {
+  if (SSL_get_signature_algorithm_key_type(signature_algorithm) != EVP_PKEY_id(pkey)) {
+    return false;
+  }
+
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pctx = nullptr;
+  if (!EVP_DigestSignInit(ctx.get(), &pctx, SSL_get_signature_algorithm_digest(signature_algorithm),
+                          nullptr, pkey)) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm)) {
+    // The salt length is the digest length, as required by TLS.
+    if (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+        !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1)) {
+      return false;
+    }
+  }
+
+  size_t out_len = 0;
+  if (!EVP_DigestSign(ctx.get(), nullptr, &out_len, in.data(), in.size())) {
+    return false;
+  }
+  out.resize(out_len);
+  if (!EVP_DigestSign(ctx.get(), out.data(), &out_len, in.data(), in.size())) {
+    return false;
+  }
+  out.resize(out_len);
+  return true;
+}
+
+bool decrypt(EVP_PKEY* pkey, const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey);
+  if (rsa == nullptr) {
+    return false;
+  }
+
+  size_t out_len = 0;
+  out.resize(RSA_size(rsa));
+  if (!RSA_decrypt(rsa, &out_len, out.data(), out.size(), in.data(), in.size(), RSA_NO_PADDING)) {
+    return false;
+  }
+  out.resize(out_len);
+  return true;
+}
+
+ThreadPoolPrivateKeyConnection* getConnection(SSL* ssl) {
+  return static_cast<ThreadPoolPrivateKeyConnection*>(
+      SSL_get_ex_data(ssl, ThreadPoolPrivateKeyMethodProvider::connectionIndex()));
+}
+
+ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                        uint16_t signature_algorithm, const uint8_t* in,
+                                        size_t in_len) {
+  ThreadPoolPrivateKeyConnection* ops = getConnection(ssl);
+  if (ops == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return ops->start(PrivateKeyOperation::Type::Sign, signature_algorithm, in, in_len, out, out_len,
+                    max_out);
+}
+
+ssl_private_key_result_t privateKeyDecrypt(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                           const uint8_t* in, size_t in_len) {
+  ThreadPoolPrivateKeyConnection* ops = getConnection(ssl);
+  if (ops == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return ops->start(PrivateKeyOperation::Type::Decrypt, 0, in, in_len, out, out_len, max_out);
+}
+
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                            size_t max_out) {
+  ThreadPoolPrivateKeyConnection* ops = getConnection(ssl);
+  if (ops == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return ops->complete(out, out_len, max_out);
+}
+
+int createIndex() {
+  int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+  return index;
+}
+
+} // namespace
+
+PrivateKeyOperation::PrivateKeyOperation(Type type, Event::Dispatcher& dispatcher,
+                                         bssl::UniquePtr<EVP_PKEY> pkey,
+                                         uint16_t signature_algorithm, const uint8_t* in,
+                                         size_t in_len)
+    : type_(type), pkey_(std::move(pkey)), signature_algorithm_(signature_algorithm),
+      in_(in, in + in_len), dispatcher_(dispatcher) {}
+
+void PrivateKeyOperation::run() {
+  const bool ok = type_ == Type::Sign ? sign(pkey_.get(), signature_algorithm_, in_, out_)
+                                      : decrypt(pkey_.get(), in_, out_);
+  status_ = ok ? OperationStatus::Success : OperationStatus::Failure;
+}
+
+void PrivateKeyOperation::postCompletion() {
+  absl::MutexLock lock(&mutex_);
+  if (cancelled_) {
+    return;
+  }
+  dispatcher_.post([operation = shared_from_this()]() {
+    // The connection may have been unregistered after the completion was posted.
+    if (operation->connection_ != nullptr) {
+      operation->connection_->onOperationComplete();
+    }
+  });
+}
+
+void PrivateKeyOperation::cancel() {
+  absl::MutexLock lock(&mutex_);
+  cancelled_ = true;
+  connection_ = nullptr;
+}
+
+PrivateKeyThreadPool::PrivateKeyThreadPool(Thread::ThreadFactory& thread_factory,
+                                           uint32_t thread_count,
+                                           absl::optional<uint32_t> max_pending_operations,
+                                           ThreadPoolPrivateKeyStats& stats)
+    : stats_(stats), max_pending_operations_(max_pending_operations) {
+  threads_.reserve(thread_count);
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    threads_.push_back(thread_factory.createThread([this]() -> void { threadRoutine(); },
+                                                   Thread::Options{"PrivateKeyPool"}));
+  }
+}
+
+PrivateKeyThreadPool::~PrivateKeyThreadPool() {
+  {
+    Thread::LockGuard lock(mutex_);
+    exit_ = true;
+  }
+  queue_event_.notifyAll();
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+  // Operations still queued are dropped. Their connections never resume the handshake, which is
+  // fine as the provider is only destroyed once the owning TLS context is gone.
+  Thread::LockGuard lock(mutex_);
+  stats_.pending_operations_.sub(queue_.size());
+}
+
+bool PrivateKeyThreadPool::enqueue(PrivateKeyOperationSharedPtr operation) {
+  {
+    Thread::LockGuard lock(mutex_);
+    if (max_pending_operations_.has_value() &&
+        pending_operations_ >= max_pending_operations_.value()) {
+      return false;
+    }
+    queue_.push_back(std::move(operation));
+    pending_operations_++;
+    stats_.queue_depth_.recordValue(queue_.size());
+  }
+  stats_.pending_operations_.inc();
+  queue_event_.notifyOne();
+  return true;
+}
+
+void PrivateKeyThreadPool::threadRoutine() {
+  while (true) {
+    PrivateKeyOperationSharedPtr operation;
+    {
+      Thread::LockGuard lock(mutex_);
+      while (queue_.empty() && !exit_) {
+        queue_event_.wait(mutex_);
+      }
+      if (exit_) {
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    operation->run();
+    operation->postCompletion();
+
+    {
+      Thread::LockGuard lock(mutex_);
+      pending_operations_--;
+    }
+    stats_.pending_operations_.dec();
+  }
+}
+
+ThreadPoolPrivateKeyConnection::ThreadPoolPrivateKeyConnection(
+    Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher,
+    bssl::UniquePtr<EVP_PKEY> pkey, PrivateKeyThreadPool& pool, ThreadPoolPrivateKeyStats& stats)
+    : cb_(cb), dispatcher_(dispatcher), pkey_(std::move(pkey)), pool_(pool), stats_(stats) {}
+
+ThreadPoolPrivateKeyConnection::~ThreadPoolPrivateKeyConnection() {
+  if (operation_ != nullptr) {
+    operation_->cancel();
+  }
+}
+
+ssl_private_key_result_t
+ThreadPoolPrivateKeyConnection::start(PrivateKeyOperation::Type type, uint16_t signature_algorithm,
+                                      const uint8_t* in, size_t in_len, uint8_t* out,
+                                      size_t* out_len, size_t max_out) {
+  if (operation_ != nullptr) {
+    operation_->cancel();
+  }
+  operation_ = std::make_shared<PrivateKeyOperation>(type, dispatcher_, bssl::UpRef(pkey_),
+                                                     signature_algorithm, in, in_len);
+  operation_->connection_ = this;
+
+  if (pool_.enqueue(operation_)) {
+    stats_.offloaded_.inc();
+    return ssl_private_key_retry;
+  }
+
+  // The pool is saturated, perform the operation on the worker thread instead of growing the
+  // queue without bounds.
+  stats_.overflow_.inc();
+  operation_->run();
+  return copyResult(out, out_len, max_out);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyConnection::complete(uint8_t* out, size_t* out_len,
+                                                                  size_t max_out) {
+  if (operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (operation_->status_ == OperationStatus::Pending) {
+    return ssl_private_key_retry;
+  }
+  return copyResult(out, out_len, max_out);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyConnection::copyResult(uint8_t* out, size_t* out_len,
+                                                                    size_t max_out) {
+  PrivateKeyOperationSharedPtr operation = std::move(operation_);
+  operation->connection_ = nullptr;
+  if (operation->status_ != OperationStatus::Success || operation->out_.size() > max_out) {
+    stats_.failed_.inc();
+    return ssl_private_key_failure;
+  }
+  *out_len = operation->out_.size();
+  memcpy(out, operation->out_.data(), *out_len); // NOLINT(safe-memcpy)
+  return ssl_private_key_success;
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const envoy::extensions::private_key_providers::thread_pool::v3::
+        ThreadPoolPrivateKeyMethodConfig& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context)
+    : stats_({ALL_THREAD_POOL_PRIVATE_KEY_STATS(
+          POOL_COUNTER_PREFIX(factory_context.scope(), "thread_pool_private_key."),
+          POOL_GAUGE_PREFIX(factory_context.scope(), "thread_pool_private_key."),
+          POOL_HISTOGRAM_PREFIX(factory_context.scope(), "thread_pool_private_key."))}) {
+  std::string private_key =
+      Config::DataSource::read(config.private_key(), false, factory_context.api());
+
+  bssl::UniquePtr<BIO> bio(
+      BIO_new_mem_buf(const_cast<char*>(private_key.data()), private_key.size()));
+  bssl::UniquePtr<EVP_PKEY> pkey(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey == nullptr) {
+    throw EnvoyException("Failed to read private key.");
+  }
+  const int key_type = EVP_PKEY_id(pkey.get());
+  if (key_type != EVP_PKEY_RSA && key_type != EVP_PKEY_EC) {
+    throw EnvoyException("Not supported key type, only EC and RSA are supported.");
+  }
+  pkey_ = std::move(pkey);
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  method_->sign = privateKeySign;
+  method_->decrypt = privateKeyDecrypt;
+  method_->complete = privateKeyComplete;
+
+  const uint32_t thread_count = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      config, thread_count, std::max(1U, std::thread::hardware_concurrency()));
+  absl::optional<uint32_t> max_pending_operations;
+  if (config.has_max_pending_operations()) {
+    max_pending_operations = config.max_pending_operations().value();
+  }
+  ENVOY_LOG(debug, "Starting private key thread pool with {} threads", thread_count);
+  pool_ = std::make_unique<PrivateKeyThreadPool>(factory_context.api().threadFactory(),
+                                                 thread_count, max_pending_operations, stats_);
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  if (getConnection(ssl) != nullptr) {
+    throw EnvoyException("Not registering the thread pool provider twice for same context");
+  }
+  ThreadPoolPrivateKeyConnection* ops =
+      new ThreadPoolPrivateKeyConnection(cb, dispatcher, bssl::UpRef(pkey_), *pool_, stats_);
+  SSL_set_ex_data(ssl, ThreadPoolPrivateKeyMethodProvider::connectionIndex(), ops);
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  ThreadPoolPrivateKeyConnection* ops = getConnection(ssl);
+  SSL_set_ex_data(ssl, ThreadPoolPrivateKeyMethodProvider::connectionIndex(), nullptr);
+  delete ops;
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::checkFips() {
+  // The operations are performed by BoringSSL itself, so the provider is as compliant as the
+  // library it is linked against, provided that the key is.
+  if (EVP_PKEY_id(pkey_.get()) == EVP_PKEY_RSA) {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa != nullptr && RSA_check_fips(rsa);
+  }
+  const EC_KEY* ec_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+  return ec_key != nullptr && EC_KEY_check_fips(ec_key);
+}
+
+Ssl::BoringSslPrivateKeyMethodSharedPtr
+ThreadPoolPrivateKeyMethodProvider::getBoringSslPrivateKeyMethod() {
+  return method_;
+}
+
+int ThreadPoolPrivateKeyMethodProvider::connectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/private_key/private_key_callbacks.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/common/thread.h"
+
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+#define ALL_THREAD_POOL_PRIVATE_KEY_STATS(COUNTER, GAUGE, HISTOGRAM)                               \
+  COUNTER(offloaded)                                                                               \
+  COUNTER(overflow)                                                                                \
+  COUNTER(failed)                                                                                  \
+  GAUGE(pending_operations, Accumulate)                                                            \
+  HISTOGRAM(queue_depth, Unspecified)
+
+/**
+ * Wrapper struct for thread pool private key provider stats. @see stats_macros.h
+ */
+struct ThreadPoolPrivateKeyStats {
+  ALL_THREAD_POOL_PRIVATE_KEY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                                    GENERATE_HISTOGRAM_STRUCT)
+};
+
+class ThreadPoolPrivateKeyConnection;
+
+enum class OperationStatus { Pending, Success, Failure };
+
+/**
+ * A single sign or decrypt operation. The input is copied at creation, the operation is then run
+ * on one of the pool threads and the result is picked up by the worker thread which created it.
+ */
+class PrivateKeyOperation : public std::enable_shared_from_this<PrivateKeyOperation> {
+public:
+  enum class Type { Sign, Decrypt };
+
+  PrivateKeyOperation(Type type, Event::Dispatcher& dispatcher, bssl::UniquePtr<EVP_PKEY> pkey,
+                      uint16_t signature_algorithm, const uint8_t* in, size_t in_len);
+
+  /**
+   * Performs the operation. Called on a pool thread, or on the worker thread if the pool is full.
+   */
+  void run();
+
+  /**
+   * Posts the completion to the worker thread which started the operation, unless the operation
+   * has been cancelled. Called by the pool thread once run() has returned.
+   */
+  void postCompletion();
+
+  /**
+   * Cancels the completion. Called on the worker thread when the owning connection goes away. Once
+   * this returns no completion is posted, so the dispatcher may be destroyed afterwards.
+   */
+  void cancel();
+
+  const Type type_;
+  const bssl::UniquePtr<EVP_PKEY> pkey_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> in_;
+  std::vector<uint8_t> out_;
+  // Written by the thread running the operation once out_ is set. The worker thread may poll it
+  // before the completion is delivered, if the handshake is driven by another event.
+  std::atomic<OperationStatus> status_{OperationStatus::Pending};
+
+  // Only accessed on the worker thread.
+  ThreadPoolPrivateKeyConnection* connection_{};
+
+private:
+  Event::Dispatcher& dispatcher_;
+  absl::Mutex mutex_;
+  bool cancelled_ ABSL_GUARDED_BY(mutex_){};
+};
+
+using PrivateKeyOperationSharedPtr = std::shared_ptr<PrivateKeyOperation>;
+
+/**
+ * Pool of threads running private key operations queued by the worker threads. Completions are
+ * posted back to the dispatcher of the worker thread which queued the operation.
+ */
+class PrivateKeyThreadPool : public Logger::Loggable<Logger::Id::connection> {
+public:
+  PrivateKeyThreadPool(Thread::ThreadFactory& thread_factory, uint32_t thread_count,
+                       absl::optional<uint32_t> max_pending_operations,
+                       ThreadPoolPrivateKeyStats& stats);
+  ~PrivateKeyThreadPool();
+
+  /**
+   * Queues an operation.
+   * @return false if the pool already holds the maximum number of pending operations. The caller
+   *         is then expected to run the operation itself.
+   */
+  bool enqueue(PrivateKeyOperationSharedPtr operation);
+
+private:
+  void threadRoutine();
+
+  ThreadPoolPrivateKeyStats& stats_;
+  const absl::optional<uint32_t> max_pending_operations_;
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar queue_event_;
+  std::deque<PrivateKeyOperationSharedPtr> queue_ ABSL_GUARDED_BY(mutex_);
+  // Operations which are queued or running.
+  uint32_t pending_operations_ ABSL_GUARDED_BY(mutex_){};
+  bool exit_ ABSL_GUARDED_BY(mutex_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+/**
+ * Per-SSL connection state, attached to the SSL object while registered.
+ */
+class ThreadPoolPrivateKeyConnection {
+public:
+  ThreadPoolPrivateKeyConnection(Ssl::PrivateKeyConnectionCallbacks& cb,
+                                 Event::Dispatcher& dispatcher, bssl::UniquePtr<EVP_PKEY> pkey,
+                                 PrivateKeyThreadPool& pool, ThreadPoolPrivateKeyStats& stats);
+  ~ThreadPoolPrivateKeyConnection();
+
+  /**
+   * Starts an operation, offloading it to the pool if possible.
+   * @return ssl_private_key_retry if the operation was offloaded, or the result of the operation
+   *         if it had to be run inline.
+   */
+  ssl_private_key_result_t start(PrivateKeyOperation::Type type, uint16_t signature_algorithm,
+                                 const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_len,
+                                 size_t max_out);
+  ssl_private_key_result_t complete(uint8_t* out, size_t* out_len, size_t max_out);
+
+  void onOperationComplete() { cb_.onPrivateKeyMethodComplete(); }
+
+private:
+  ssl_private_key_result_t copyResult(uint8_t* out, size_t* out_len, size_t max_out);
+
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  PrivateKeyThreadPool& pool_;
+  ThreadPoolPrivateKeyStats& stats_;
+  PrivateKeyOperationSharedPtr operation_;
+};
+
+/**
+ * Private key method provider running the private key operations on a dedicated thread pool.
+ */
+class ThreadPoolPrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider,
+                                           public Logger::Loggable<Logger::Id::connection> {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::extensions::private_key_providers::thread_pool::v3::
+          ThreadPoolPrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context);
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override;
+
+  static int connectionIndex();
+
+private:
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_{};
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  ThreadPoolPrivateKeyStats stats_;
+  std::unique_ptr<PrivateKeyThreadPool> pool_;
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
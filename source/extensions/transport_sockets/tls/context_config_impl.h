@@ -167,6 +167,7 @@ public:
   bool disableStatelessSessionResumption() const override {
     return disable_stateless_session_resumption_;
   }
+  uint32_t maxStatefulSessions() const override { return max_stateful_sessions_; }
 
 private:
   static const unsigned DEFAULT_MIN_VERSION;
@@ -190,6 +191,7 @@ private:
 
   absl::optional<std::chrono::seconds> session_timeout_;
   const bool disable_stateless_session_resumption_;
+  const uint32_t max_stateful_sessions_;
 };
 
 } // namespace Tls
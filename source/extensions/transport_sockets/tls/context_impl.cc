@@ -25,7 +25,8 @@
 #include "source/extensions/transport_sockets/tls/stats.h"
 #include "source/extensions/transport_sockets/tls/utility.h"
 
-#include "absl/container/node_hash_set.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 #include "openssl/evp.h"
@@ -63,6 +64,27 @@ void logSslErrorChain() {
   }
 }
 
+// Returns the names a server certificate is selected for: its DNS SANs, or its subject CN if it has
+// none. A certificate with neither is returned a single empty name.
+std::vector<std::string> serverNamesFromCertificate(X509& cert) {
+  std::vector<std::string> names = Utility::getSubjectAltNames(cert, GEN_DNS);
+  if (names.empty()) {
+    X509_NAME* subject = X509_get_subject_name(&cert);
+    const int cn_index = X509_NAME_get_index_by_NID(subject, NID_commonName, -1);
+    if (cn_index >= 0) {
+      const ASN1_STRING* cn = X509_NAME_ENTRY_get_data(X509_NAME_get_entry(subject, cn_index));
+      names.emplace_back(reinterpret_cast<const char*>(ASN1_STRING_get0_data(cn)),
+                         ASN1_STRING_length(cn));
+    } else {
+      names.emplace_back();
+    }
+  }
+  for (std::string& name : names) {
+    absl::AsciiStrToLower(&name);
+  }
+  return names;
+}
+
 } // namespace
 
 int ContextImpl::sslExtendedSocketInfoIndex() {
@@ -171,7 +193,7 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
   }
 #endif
 
-  absl::node_hash_set<int> cert_pkey_ids;
+  absl::flat_hash_set<std::pair<std::string, int>> cert_names_and_types;
   if (!capabilities_.provides_certificates) {
     for (uint32_t i = 0; i < tls_certificates.size(); ++i) {
       auto& ctx = tls_contexts_[i];
@@ -196,7 +218,14 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
 
       bssl::UniquePtr<EVP_PKEY> public_key(X509_get_pubkey(ctx.cert_chain_.get()));
       const int pkey_id = EVP_PKEY_id(public_key.get());
-      if (!cert_pkey_ids.insert(pkey_id).second) {
+      // Several certificates of a type may be specified as long as they serve different names,
+      // otherwise the later ones could never be selected.
+      ctx.server_names_ = serverNamesFromCertificate(*ctx.cert_chain_);
+      bool adds_server_name = false;
+      for (const std::string& name : ctx.server_names_) {
+        adds_server_name |= cert_names_and_types.emplace(name, pkey_id).second;
+      }
+      if (!adds_server_name) {
         throw EnvoyException(fmt::format("Failed to load certificate chain from {}, at most one "
                                          "certificate of a given type may be specified",
                                          ctx.cert_chain_file_path_));
@@ -712,6 +741,11 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
         });
   }
 
+  if (config.maxStatefulSessions() > 0 && !config.capabilities().handles_session_resumption) {
+    session_cache_ =
+        std::make_unique<ServerSessionCache>(config.maxStatefulSessions(), stats_, time_source_);
+  }
+
   const auto tls_certificates = config.tlsCertificates();
 
   for (uint32_t i = 0; i < tls_certificates.size(); ++i) {
@@ -754,6 +788,29 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
       SSL_CTX_set_timeout(ctx.ssl_ctx_.get(), uint32_t(timeout));
     }
 
+    if (session_cache_ != nullptr) {
+      ServerSessionCache::disableInternalCache(ctx.ssl_ctx_.get());
+      SSL_CTX_sess_set_new_cb(ctx.ssl_ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+        ContextImpl* context_impl =
+            static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+        ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(context_impl);
+        RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+        return server_context_impl->session_cache_->insert(session);
+      });
+      SSL_CTX_sess_set_get_cb(
+          ctx.ssl_ctx_.get(),
+          [](SSL* ssl, const uint8_t* id, int id_len, int* out_copy) -> SSL_SESSION* {
+            ContextImpl* context_impl =
+                static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+            ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(context_impl);
+            RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+            // The returned session already carries the reference handed to BoringSSL.
+            *out_copy = 0;
+            return server_context_impl->session_cache_->lookup(
+                absl::MakeConstSpan(id, static_cast<size_t>(id_len)));
+          });
+    }
+
     int rc =
         SSL_CTX_set_session_id_context(ctx.ssl_ctx_.get(), session_id.data(), session_id.size());
     RELEASE_ASSERT(rc == 1, Utility::getLastCryptoError().value_or(""));
@@ -774,6 +831,51 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
       ctx.ocsp_response_ = std::move(response);
     }
   }
+
+  buildServerNamesIndex();
+}
+
+void ServerContextImpl::buildServerNamesIndex() {
+  all_tls_contexts_.reserve(tls_contexts_.size());
+  for (const TlsContext& ctx : tls_contexts_) {
+    all_tls_contexts_.push_back(&ctx);
+  }
+  if (tls_contexts_.size() < 2) {
+    return;
+  }
+
+  for (const TlsContext& ctx : tls_contexts_) {
+    for (const std::string& name : ctx.server_names_) {
+      if (absl::StartsWith(name, "*.")) {
+        wildcard_server_names_[name.substr(1)].push_back(&ctx);
+      } else if (!name.empty()) {
+        exact_server_names_[name].push_back(&ctx);
+      }
+    }
+  }
+  ENVOY_LOG(debug, "indexed {} certificates by {} exact and {} wildcard server names",
+            tls_contexts_.size(), exact_server_names_.size(), wildcard_server_names_.size());
+}
+
+const ServerContextImpl::TlsContextCandidates&
+ServerContextImpl::candidatesForServerName(const char* server_name) const {
+  if (server_name == nullptr || (exact_server_names_.empty() && wildcard_server_names_.empty())) {
+    return all_tls_contexts_;
+  }
+
+  const std::string name = absl::AsciiStrToLower(server_name);
+  if (auto it = exact_server_names_.find(name); it != exact_server_names_.end()) {
+    return it->second;
+  }
+  // A wildcard matches a single label only, so only the suffix starting at the first dot is
+  // looked up.
+  if (const size_t pos = name.find('.'); pos != std::string::npos) {
+    if (auto it = wildcard_server_names_.find(absl::string_view(name).substr(pos));
+        it != wildcard_server_names_.end()) {
+      return it->second;
+    }
+  }
+  return all_tls_contexts_;
 }
 
 ServerContextImpl::SessionContextID
@@ -1067,21 +1169,24 @@ enum ssl_select_cert_result_t
 ServerContextImpl::selectTlsContext(const SSL_CLIENT_HELLO* ssl_client_hello) {
   const bool client_ecdsa_capable = isClientEcdsaCapable(ssl_client_hello);
   const bool client_ocsp_capable = isClientOcspCapable(ssl_client_hello);
+  // Only the certificates serving the requested server name are considered, if any.
+  const TlsContextCandidates& candidates = candidatesForServerName(
+      SSL_get_servername(ssl_client_hello->ssl, TLSEXT_NAMETYPE_host_name));
 
   // Fallback on first certificate.
-  const TlsContext* selected_ctx = &tls_contexts_[0];
+  const TlsContext* selected_ctx = candidates[0];
   auto ocsp_staple_action = ocspStapleAction(*selected_ctx, client_ocsp_capable);
-  for (const auto& ctx : tls_contexts_) {
-    if (client_ecdsa_capable != ctx.is_ecdsa_) {
+  for (const TlsContext* ctx : candidates) {
+    if (client_ecdsa_capable != ctx->is_ecdsa_) {
       continue;
     }
 
-    auto action = ocspStapleAction(ctx, client_ocsp_capable);
+    auto action = ocspStapleAction(*ctx, client_ocsp_capable);
     if (action == OcspStapleAction::Fail) {
       continue;
     }
 
-    selected_ctx = &ctx;
+    selected_ctx = ctx;
     ocsp_staple_action = action;
     break;
   }
@@ -19,8 +19,10 @@
 #include "source/extensions/transport_sockets/tls/cert_validator/cert_validator.h"
 #include "source/extensions/transport_sockets/tls/context_manager_impl.h"
 #include "source/extensions/transport_sockets/tls/ocsp/ocsp.h"
+#include "source/extensions/transport_sockets/tls/server_session_cache.h"
 #include "source/extensions/transport_sockets/tls/stats.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
 #include "openssl/x509v3.h"
@@ -46,6 +48,9 @@ struct TlsContext {
   bool is_ecdsa_{};
   bool is_must_staple_{};
   Ssl::PrivateKeyMethodProviderSharedPtr private_key_method_provider_{};
+  // Lower case DNS names of the certificate, or its subject CN if it has no DNS SAN. Wildcard names
+  // are kept in their "*.example.com" form.
+  std::vector<std::string> server_names_;
 
   std::string getCertChainFileName() const { return cert_chain_file_path_; };
   bool isCipherEnabled(uint16_t cipher_id, uint16_t client_version);
@@ -174,6 +179,7 @@ public:
 
 private:
   using SessionContextID = std::array<uint8_t, SSL_MAX_SSL_SESSION_ID_LENGTH>;
+  using TlsContextCandidates = std::vector<const TlsContext*>;
 
   int alpnSelectCallback(const unsigned char** out, unsigned char* outlen, const unsigned char* in,
                          unsigned int inlen);
@@ -182,11 +188,22 @@ private:
   bool isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello);
   bool isClientOcspCapable(const SSL_CLIENT_HELLO* ssl_client_hello);
   OcspStapleAction ocspStapleAction(const TlsContext& ctx, bool client_ocsp_capable);
+  void buildServerNamesIndex();
+  const TlsContextCandidates& candidatesForServerName(const char* server_name) const;
 
   SessionContextID generateHashForSessionContextId(const std::vector<std::string>& server_names);
 
   const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey> session_ticket_keys_;
   const Ssl::ServerContextConfig::OcspStaplePolicy ocsp_staple_policy_;
+  // Replaces the internal session cache of BoringSSL if configured.
+  ServerSessionCachePtr session_cache_;
+  // Certificates to select from, in configuration order, for server names matching the exact
+  // names and the wildcard names (keyed by their ".example.com" suffix) of the certificates. Only
+  // populated when several certificates are configured. All the certificates are candidates for
+  // other server names.
+  absl::flat_hash_map<std::string, TlsContextCandidates> exact_server_names_;
+  absl::flat_hash_map<std::string, TlsContextCandidates> wildcard_server_names_;
+  TlsContextCandidates all_tls_contexts_;
 };
 
 } // namespace Tls
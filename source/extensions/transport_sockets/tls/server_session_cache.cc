@@ -0,0 +1,118 @@
+#include "source/extensions/transport_sockets/tls/server_session_cache.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "source/common/common/assert.h"
+
+#include "absl/hash/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+namespace {
+
+uint32_t shardCount(uint32_t max_entries) {
+  return std::max<uint32_t>(1, std::min(max_entries, ServerSessionCache::DefaultShards));
+}
+
+absl::string_view sessionId(const SSL_SESSION* session) {
+  unsigned int length = 0;
+  const uint8_t* id = SSL_SESSION_get_id(session, &length);
+  return {reinterpret_cast<const char*>(id), length};
+}
+
+} // namespace
+
+ServerSessionCache::ServerSessionCache(uint32_t max_entries, SslStats& stats,
+                                       TimeSource& time_source)
+    : stats_(stats), time_source_(time_source),
+      max_entries_per_shard_(std::max<uint32_t>(1, max_entries / shardCount(max_entries))) {
+  const uint32_t shards = shardCount(max_entries);
+  shards_.reserve(shards);
+  for (uint32_t i = 0; i < shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+ServerSessionCache::~ServerSessionCache() { stats_.session_cache_size_.sub(size()); }
+
+void ServerSessionCache::disableInternalCache(SSL_CTX* ctx) {
+  SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+}
+
+ServerSessionCache::Shard& ServerSessionCache::shardFor(absl::string_view id) {
+  return *shards_[absl::Hash<absl::string_view>()(id) % shards_.size()];
+}
+
+void ServerSessionCache::evict(Shard& shard, EntryList::iterator it) {
+  shard.index_.erase(it->id_);
+  shard.entries_.erase(it);
+  stats_.session_cache_size_.dec();
+}
+
+int ServerSessionCache::insert(SSL_SESSION* session) {
+  const absl::string_view id = sessionId(session);
+  if (id.empty()) {
+    // Sessions resumed through session tickets only are not cached.
+    return 0;
+  }
+
+  const SystemTime now = time_source_.systemTime();
+  Shard& shard = shardFor(id);
+  absl::MutexLock lock(&shard.mutex_);
+  auto existing = shard.index_.find(id);
+  if (existing != shard.index_.end()) {
+    evict(shard, existing->second);
+  }
+  while (!shard.entries_.empty() && (shard.entries_.size() >= max_entries_per_shard_ ||
+                                     shard.entries_.front().expiration_ <= now)) {
+    evict(shard, shard.entries_.begin());
+    stats_.session_cache_eviction_.inc();
+  }
+
+  shard.entries_.push_back(Entry{std::string(id), bssl::UniquePtr<SSL_SESSION>(session),
+                                 now + std::chrono::seconds(SSL_SESSION_get_timeout(session))});
+  auto it = std::prev(shard.entries_.end());
+  shard.index_.emplace(it->id_, it);
+  stats_.session_cache_size_.inc();
+  return 1;
+}
+
+SSL_SESSION* ServerSessionCache::lookup(absl::Span<const uint8_t> session_id) {
+  const absl::string_view id(reinterpret_cast<const char*>(session_id.data()), session_id.size());
+  Shard& shard = shardFor(id);
+  absl::MutexLock lock(&shard.mutex_);
+  auto found = shard.index_.find(id);
+  if (found == shard.index_.end()) {
+    stats_.session_cache_miss_.inc();
+    return nullptr;
+  }
+  if (found->second->expiration_ <= time_source_.systemTime()) {
+    evict(shard, found->second);
+    stats_.session_cache_eviction_.inc();
+    stats_.session_cache_miss_.inc();
+    return nullptr;
+  }
+
+  SSL_SESSION* session = found->second->session_.get();
+  SSL_SESSION_up_ref(session);
+  stats_.session_cache_hit_.inc();
+  return session;
+}
+
+size_t ServerSessionCache::size() const {
+  size_t size = 0;
+  for (const auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mutex_);
+    size += shard->entries_.size();
+  }
+  return size;
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
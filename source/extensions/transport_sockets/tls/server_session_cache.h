@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+
+#include "source/common/common/thread_annotations.h"
+#include "source/extensions/transport_sockets/tls/stats.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Bounded cache of server-side TLS sessions used for stateful (session ID based) resumption. It
+ * replaces the internal session cache of BoringSSL and is shared by all the workers using the
+ * owning ServerContextImpl. Sessions are spread across independently locked shards so that
+ * handshakes resuming different sessions rarely contend. Sessions are evicted once they outlive
+ * their timeout, or in insertion order when a shard is full.
+ */
+class ServerSessionCache {
+public:
+  ServerSessionCache(uint32_t max_entries, SslStats& stats, TimeSource& time_source);
+  ~ServerSessionCache();
+
+  /**
+   * Disables the internal session cache of the SSL_CTX. The new and get session callbacks must be
+   * routed to insert() and lookup() by the caller.
+   */
+  static void disableInternalCache(SSL_CTX* ctx);
+
+  /**
+   * Stores a newly established session.
+   * @param session supplies the session. The cache takes ownership only if it returns 1.
+   * @return int 1 if the session was stored, 0 otherwise.
+   */
+  int insert(SSL_SESSION* session);
+
+  /**
+   * @param session_id supplies the session ID sent by the client.
+   * @return SSL_SESSION* a new reference to the cached session, or nullptr on a miss. The caller
+   *         owns the returned reference.
+   */
+  SSL_SESSION* lookup(absl::Span<const uint8_t> session_id);
+
+  /**
+   * @return size_t the number of cached sessions.
+   */
+  size_t size() const;
+
+  // The number of shards used for caches holding at least that many sessions.
+  static constexpr uint32_t DefaultShards = 16;
+
+private:
+  struct Entry {
+    std::string id_;
+    bssl::UniquePtr<SSL_SESSION> session_;
+    SystemTime expiration_;
+  };
+  using EntryList = std::list<Entry>;
+
+  struct Shard {
+    mutable absl::Mutex mutex_;
+    // Sessions in insertion order. All sessions of a cache share the same timeout, so this is also
+    // the expiration order.
+    EntryList entries_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<absl::string_view, EntryList::iterator> index_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  Shard& shardFor(absl::string_view id);
+  void evict(Shard& shard, EntryList::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  SslStats& stats_;
+  TimeSource& time_source_;
+  const uint32_t max_entries_per_shard_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+using ServerSessionCachePtr = std::unique_ptr<ServerSessionCache>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -20,7 +20,11 @@ namespace Tls {
   COUNTER(ocsp_staple_failed)                                                                      \
   COUNTER(ocsp_staple_omitted)                                                                     \
   COUNTER(ocsp_staple_responses)                                                                   \
-  COUNTER(ocsp_staple_requests)
+  COUNTER(ocsp_staple_requests)                                                                    \
+  COUNTER(session_cache_hit)                                                                       \
+  COUNTER(session_cache_miss)                                                                      \
+  COUNTER(session_cache_eviction)                                                                  \
+  GAUGE(session_cache_size, Accumulate)
 
 /**
  * Wrapper struct for SSL stats. @see stats_macros.h
@@ -609,7 +609,9 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDestinatio
 const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName(
     const ServerNamesMap& server_names_map, const Network::ConnectionSocket& socket) const {
   ASSERT(absl::AsciiStrToLower(socket.requestedServerName()) == socket.requestedServerName());
-  const std::string server_name(socket.requestedServerName());
+  // All lookups below are heterogeneous, so probing the wildcard suffixes of a server name does not
+  // allocate.
+  const absl::string_view server_name = socket.requestedServerName();
 
   // Match on exact server name, i.e. "www.example.com" for "www.example.com".
   const auto server_name_exact_match = server_names_map.find(server_name);
@@ -620,7 +622,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
   // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
   size_t pos = server_name.find('.', 1);
   while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
+    const absl::string_view wildcard = server_name.substr(pos);
     const auto server_name_wildcard_match = server_names_map.find(wildcard);
     if (server_name_wildcard_match != server_names_map.end()) {
       return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
@@ -640,7 +642,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
 const Network::FilterChain* FilterChainManagerImpl::findFilterChainForTransportProtocol(
     const TransportProtocolsMap& transport_protocols_map,
     const Network::ConnectionSocket& socket) const {
-  const std::string transport_protocol(socket.detectedTransportProtocol());
+  const absl::string_view transport_protocol = socket.detectedTransportProtocol();
 
   // Match on exact transport protocol, e.g. "tls".
   const auto transport_protocol_match = transport_protocols_map.find(transport_protocol);
@@ -664,22 +666,27 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForApplicatio
   for (const auto& application_protocol : socket.requestedApplicationProtocols()) {
     const auto application_protocol_match = application_protocols_map.find(application_protocol);
     if (application_protocol_match != application_protocols_map.end()) {
-      return findFilterChainForDirectSourceIP(*application_protocol_match->second.second, socket);
+      return findFilterChainForDirectSourceIP(application_protocol_match->second, socket);
     }
   }
 
   // Match on a filter chain without application protocol requirements.
   const auto any_protocol_match = application_protocols_map.find(EMPTY_STRING);
   if (any_protocol_match != application_protocols_map.end()) {
-    return findFilterChainForDirectSourceIP(*any_protocol_match->second.second, socket);
+    return findFilterChainForDirectSourceIP(any_protocol_match->second, socket);
   }
 
   return nullptr;
 }
 
 const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDirectSourceIP(
-    const DirectSourceIPsTrie& direct_source_ips_trie,
+    const DirectSourceIPsPair& direct_source_ips_pair,
     const Network::ConnectionSocket& socket) const {
+  if (direct_source_ips_pair.source_independent_filter_chain != nullptr) {
+    return direct_source_ips_pair.source_independent_filter_chain;
+  }
+
+  const DirectSourceIPsTrie& direct_source_ips_trie = *direct_source_ips_pair.second;
   auto address = socket.connectionInfoProvider().directRemoteAddress();
   if (address->type() != Network::Address::Type::Ip) {
     address = fakeAddress();
@@ -762,7 +769,52 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForSourceIpAn
   return nullptr;
 }
 
+const Network::FilterChain* FilterChainManagerImpl::findSourceIndependentFilterChain(
+    const DirectSourceIPsMap& direct_source_ips_map) {
+  if (direct_source_ips_map.size() != 1) {
+    return nullptr;
+  }
+  const auto direct_source_ips_match = direct_source_ips_map.find(EMPTY_STRING);
+  if (direct_source_ips_match == direct_source_ips_map.end()) {
+    return nullptr;
+  }
+
+  const SourceTypesArray& source_types = *direct_source_ips_match->second;
+  if (!source_types[envoy::config::listener::v3::FilterChainMatch::SAME_IP_OR_LOOPBACK]
+           .first.empty() ||
+      !source_types[envoy::config::listener::v3::FilterChainMatch::EXTERNAL].first.empty()) {
+    return nullptr;
+  }
+
+  const SourceIPsMap& source_ips_map =
+      source_types[envoy::config::listener::v3::FilterChainMatch::ANY].first;
+  if (source_ips_map.size() != 1) {
+    return nullptr;
+  }
+  const auto source_ips_match = source_ips_map.find(EMPTY_STRING);
+  if (source_ips_match == source_ips_map.end()) {
+    return nullptr;
+  }
+
+  const SourcePortsMap& source_ports_map = *source_ips_match->second;
+  if (source_ports_map.size() != 1) {
+    return nullptr;
+  }
+  const auto source_ports_match = source_ports_map.find(0);
+  if (source_ports_match == source_ports_map.end()) {
+    return nullptr;
+  }
+  return source_ports_match->second.get();
+}
+
 void FilterChainManagerImpl::convertIPsToTries() {
+  // Non-IP remote addresses are matched using an IPv4 fake address, which only matches the catch-all
+  // range if IPv4 is supported. Short-circuiting the source matching is only equivalent to the
+  // trie lookup in that case.
+  const bool allow_source_independent_filter_chains =
+      Network::SocketInterfaceSingleton::get().ipFamilySupported(AF_INET);
+  uint64_t source_independent_filter_chains = 0;
+
   for (auto& [destination_port, destination_ips_pair] : destination_ports_map_) {
     UNREFERENCED_PARAMETER(destination_port);
     // These variables are used as we build up the destination CIDRs used for the trie.
@@ -783,8 +835,17 @@ void FilterChainManagerImpl::convertIPsToTries() {
           UNREFERENCED_PARAMETER(transport_protocol);
           for (auto& [application_protocol, direct_source_ips_pair] : application_protocols_map) {
             UNREFERENCED_PARAMETER(application_protocol);
-            auto& [direct_source_ips_map, direct_source_ips_trie] = direct_source_ips_pair;
+            if (allow_source_independent_filter_chains) {
+              direct_source_ips_pair.source_independent_filter_chain =
+                  findSourceIndependentFilterChain(direct_source_ips_pair.first);
+              if (direct_source_ips_pair.source_independent_filter_chain != nullptr) {
+                ++source_independent_filter_chains;
+                continue;
+              }
+            }
 
+            auto& direct_source_ips_map = direct_source_ips_pair.first;
+            auto& direct_source_ips_trie = direct_source_ips_pair.second;
             std::vector<
                 std::pair<SourceTypesArraySharedPtr, std::vector<Network::Address::CidrRange>>>
                 direct_source_ips_list;
@@ -816,6 +877,8 @@ void FilterChainManagerImpl::convertIPsToTries() {
 
     destination_ips_trie = std::make_unique<DestinationIPsTrie>(destination_ips_list, true);
   }
+  ENVOY_LOG(debug, "filter chain index has {} source independent subtrees",
+            source_independent_filter_chains);
 }
 
 Network::DrainableFilterChainSharedPtr FilterChainManagerImpl::findExistingFilterChain(
@@ -825,10 +888,10 @@ Network::DrainableFilterChainSharedPtr FilterChainManagerImpl::findExistingFilte
   if (origin == nullptr) {
     return nullptr;
   }
+  // The caller records the returned filter chain in fc_contexts_, so the (potentially large)
+  // message is only hashed once more instead of being inserted here as well.
   auto iter = origin->fc_contexts_.find(filter_chain_message);
   if (iter != origin->fc_contexts_.end()) {
-    // copy the context to this filter chain manager.
-    fc_contexts_.emplace(filter_chain_message, iter->second);
     return iter->second;
   }
   return nullptr;
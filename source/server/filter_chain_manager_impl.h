@@ -240,6 +240,8 @@ public:
 
 private:
   void convertIPsToTries();
+  static const Network::FilterChain*
+  findSourceIndependentFilterChain(const DirectSourceIPsMap& direct_source_ips_map);
   const Network::FilterChain*
   findFilterChainUsingMatcher(const Network::ConnectionSocket& socket) const;
 
@@ -268,6 +270,12 @@ private:
   struct DirectSourceIPsPair {
     DirectSourceIPsMap first;
     DirectSourceIPsTriePtr second;
+    // Set when the subtree below the application protocol does not restrict the direct source IP,
+    // source type, source IP or source port, i.e. it always resolves to this single filter chain.
+    // In that case no tries are built for the subtree and the lookup short-circuits here. This is
+    // the common shape of SNI-based filter chains and keeps both the memory footprint and the
+    // build time of large listeners proportional to the number of server names.
+    const Network::FilterChain* source_independent_filter_chain{};
   };
 
   using ApplicationProtocolsMap = absl::flat_hash_map<std::string, DirectSourceIPsPair>;
@@ -351,7 +359,7 @@ private:
   findFilterChainForApplicationProtocols(const ApplicationProtocolsMap& application_protocols_map,
                                          const Network::ConnectionSocket& socket) const;
   const Network::FilterChain*
-  findFilterChainForDirectSourceIP(const DirectSourceIPsTrie& direct_source_ips_trie,
+  findFilterChainForDirectSourceIP(const DirectSourceIPsPair& direct_source_ips_pair,
                                    const Network::ConnectionSocket& socket) const;
   const Network::FilterChain*
   findFilterChainForSourceTypes(const SourceTypesArray& source_types,
@@ -362,7 +370,8 @@ private:
                                     const Network::ConnectionSocket& socket) const;
 
   const FilterChainManagerImpl* getOriginFilterChainManager() { return origin_.value(); }
-  // Duplicate the inherent factory context if any.
+  // Find the filter chain built from an identical message in the origin filter chain manager, if
+  // any.
   Network::DrainableFilterChainSharedPtr
   findExistingFilterChain(const envoy::config::listener::v3::FilterChain& filter_chain_message);
 
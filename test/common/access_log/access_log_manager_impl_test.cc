@@ -1,4 +1,5 @@
 #include <memory>
+#include <string>
 
 #include "source/common/access_log/access_log_manager_impl.h"
 #include "source/common/filesystem/file_shared_impl.h"
@@ -11,6 +12,7 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -486,6 +488,76 @@ TEST_F(AccessLogManagerImplTest, BigDataChunkShouldBeFlushedWithoutTimer) {
   EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+TEST_F(AccessLogManagerImplTest, DropWritesBeyondMaxBufferedSize) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"});
+
+  log_file->write(std::string(AccessLogFileImpl::MAX_BUFFERED_SIZE + 1, 'a'));
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_dropped").value());
+  EXPECT_EQ(0UL, store_.counter("filesystem.write_buffered").value());
+  EXPECT_EQ(0UL,
+            store_.gauge("filesystem.write_total_buffered", Stats::Gauge::ImportMode::Accumulate)
+                .value());
+
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("test"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+
+  log_file->write("test");
+
+  {
+    Thread::LockGuard lock(file_->write_mutex_);
+    while (file_->num_writes_ != 1) {
+      file_->write_event_.wait(file_->write_mutex_);
+    }
+  }
+  waitForCounterEq("filesystem.write_completed", 1);
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_dropped").value());
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Test that the data of several writes is flushed with a single vectored write, and that the
+// flush latency is recorded by the flush timer.
+TEST_F(AccessLogManagerImplTest, FlushWritesInBatchAndRecordsLatency) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog(
+      Filesystem::FilePathAndType{Filesystem::DestinationType::File, "foo"});
+
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("prime-it");
+  waitForCounterEq("filesystem.write_completed", 1);
+  waitForGaugeEq("filesystem.write_total_buffered", 0);
+
+  std::string written;
+  EXPECT_CALL(*file_, write_(_))
+      .WillRepeatedly(Invoke([&](absl::string_view data) -> Api::IoCallSizeResult {
+        absl::StrAppend(&written, data);
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("one ");
+  log_file->write("two ");
+  log_file->write("three");
+  timer->invokeCallback();
+
+  waitForCounterEq("filesystem.write_completed", 2);
+  waitForGaugeEq("filesystem.write_total_buffered", 0);
+  EXPECT_EQ("one two three", written);
+  EXPECT_EQ(3UL, store_.counter("filesystem.write_buffered").value());
+
+  // The latency of each flush is recorded by the next timer event.
+  timer->invokeCallback();
+  EXPECT_EQ(2UL, store_.histogramValues("filesystem.flush_latency", false).size());
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
 TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
   EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
 
@@ -1,5 +1,7 @@
 #include "source/common/conn_pool/conn_pool_base.h"
 
+#include <cmath>
+
 #include "test/common/upstream/utility.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/upstream/cluster_info.h"
@@ -501,5 +503,96 @@ TEST_F(ConnPoolImplBaseTest, PoolIdleCallbackTriggeredLocalClose) {
   pool_.drainConnectionsImpl(Envoy::ConnectionPool::DrainBehavior::DrainAndDelete);
 }
 
+TEST(PreconnectDemandEstimatorTest, PredictsStreamsDuringConnect) {
+  PreconnectDemandEstimator estimator({std::chrono::seconds(10), 1.0});
+  MonotonicTime now;
+  EXPECT_EQ(0, estimator.predictedStreams(now));
+
+  // 100 streams per second for six time constants.
+  for (int i = 0; i < 6000; ++i) {
+    now += std::chrono::milliseconds(10);
+    estimator.onStreamArrival(now);
+  }
+  EXPECT_NEAR(100, estimator.arrivalRate(now), 1);
+  // Nothing is predicted until the connection establishment time is known.
+  EXPECT_EQ(0, estimator.predictedStreams(now));
+
+  estimator.onConnectionEstablished(std::chrono::milliseconds(45));
+  EXPECT_EQ(5, estimator.predictedStreams(now));
+  // The connection establishment time moves towards new samples.
+  estimator.onConnectionEstablished(std::chrono::milliseconds(145));
+  EXPECT_EQ(7, estimator.predictedStreams(now));
+
+  // The arrival rate decays during quiet periods, down to a single anticipated stream.
+  now += std::chrono::seconds(30);
+  EXPECT_NEAR(100 * std::exp(-3), estimator.arrivalRate(now), 1);
+  EXPECT_EQ(1, estimator.predictedStreams(now));
+  now += std::chrono::seconds(120);
+  EXPECT_EQ(1, estimator.predictedStreams(now));
+}
+
+TEST(PreconnectDemandEstimatorTest, BurstFactor) {
+  PreconnectDemandEstimator estimator({std::chrono::seconds(1), 3.0});
+  MonotonicTime now;
+  for (int i = 0; i < 1000; ++i) {
+    now += std::chrono::milliseconds(10);
+    estimator.onStreamArrival(now);
+  }
+  estimator.onConnectionEstablished(std::chrono::milliseconds(45));
+  EXPECT_EQ(14, estimator.predictedStreams(now));
+}
+
+// With adaptive preconnect, the pool keeps spare capacity for the streams predicted to arrive
+// while a connection is being established, and tracks whether preconnected connections are used.
+TEST_F(ConnPoolImplDispatcherBaseTest, AdaptivePreconnect) {
+  cluster_->adaptive_preconnect_ =
+      Upstream::AdaptivePreconnectConfig{std::chrono::seconds(10), 1.0};
+  NiceMock<TestConnPoolImplBase> pool(host_, Upstream::ResourcePriority::Default, *dispatcher_,
+                                      nullptr, nullptr, state_);
+  std::vector<TestActiveClient*> clients;
+  ON_CALL(pool, instantiateActiveClient).WillByDefault(Invoke([&]() -> ActiveClientPtr {
+    auto ret =
+        std::make_unique<NiceMock<TestActiveClient>>(pool, stream_limit_, concurrent_streams_);
+    clients.push_back(ret.get());
+    ret->real_host_description_ = descr_;
+    return ret;
+  }));
+  ON_CALL(pool, onPoolReady(_, _)).WillByDefault(Invoke([](ActiveClient& client, AttachContext&) {
+    TestActiveClient::incrementActiveStreams(client);
+  }));
+
+  // Nothing is predicted before the first connection is established.
+  pool.newStreamImpl(context_, /*can_send_early_data=*/false);
+  ASSERT_EQ(1, clients.size());
+  time_system_.advanceTimeWait(std::chrono::milliseconds(100));
+  EXPECT_CALL(pool, onPoolReady);
+  clients[0]->onEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(0, cluster_->stats_.upstream_cx_preconnect_.value());
+
+  // A connection is created for the pending stream, and another one for the predicted stream.
+  pool.newStreamImpl(context_, /*can_send_early_data=*/false);
+  ASSERT_EQ(3, clients.size());
+  EXPECT_EQ(1, cluster_->stats_.upstream_cx_preconnect_.value());
+  EXPECT_CALL(pool, onPoolReady);
+  clients[1]->onEvent(Network::ConnectionEvent::Connected);
+  clients[2]->onEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(ActiveClient::State::Ready, clients[2]->state());
+
+  // The next stream is served by the preconnected connection, and a new one is preconnected.
+  EXPECT_CALL(pool, onPoolReady);
+  EXPECT_EQ(nullptr, pool.newStreamImpl(context_, /*can_send_early_data=*/false));
+  EXPECT_EQ(1, cluster_->stats_.upstream_cx_preconnect_hit_.value());
+  ASSERT_EQ(4, clients.size());
+  EXPECT_EQ(2, cluster_->stats_.upstream_cx_preconnect_.value());
+
+  // Closing the unused preconnected connection is accounted as waste.
+  for (size_t i = 0; i < 3; ++i) {
+    clients[i]->active_streams_ = 0;
+    pool.onStreamClosed(*clients[i], false);
+  }
+  pool.destructAllConnections();
+  EXPECT_EQ(1, cluster_->stats_.upstream_cx_preconnect_wasted_.value());
+}
+
 } // namespace ConnectionPool
 } // namespace Envoy
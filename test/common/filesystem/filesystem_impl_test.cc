@@ -1,6 +1,7 @@
 #include <chrono>
 #include <filesystem>
 #include <string>
+#include <vector>
 
 #include "source/common/common/assert.h"
 #include "source/common/common/utility.h"
@@ -345,6 +346,24 @@ TEST_F(FileSystemImplTest, NonExistingFile) {
   EXPECT_EQ(" new data", contents);
 }
 
+TEST_F(FileSystemImplTest, Writev) {
+  const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
+  ::unlink(new_file_path.c_str());
+
+  {
+    FilePathAndType new_file_info{Filesystem::DestinationType::File, new_file_path};
+    FilePtr file = file_system_.createFile(new_file_info);
+    const Api::IoCallBoolResult open_result = file->open(DefaultFlags);
+    EXPECT_TRUE(open_result.return_value_);
+    const std::vector<absl::string_view> buffers{"new", "", " data"};
+    const Api::IoCallSizeResult result = file->writev(buffers);
+    EXPECT_EQ(8, result.return_value_);
+  }
+
+  auto contents = TestEnvironment::readFileToStringForTest(new_file_path);
+  EXPECT_EQ("new data", contents);
+}
+
 TEST_F(FileSystemImplTest, StdOut) {
   FilePathAndType file_info{Filesystem::DestinationType::Stdout, ""};
   FilePtr file = file_system_.createFile(file_info);
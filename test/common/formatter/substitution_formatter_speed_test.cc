@@ -1,5 +1,6 @@
 #include "source/common/formatter/substitution_formatter.h"
 #include "source/common/network/address_impl.h"
+#include "source/common/protobuf/utility.h"
 
 #include "test/common/stream_info/test_util.h"
 #include "test/mocks/http/mocks.h"
@@ -46,6 +47,16 @@ std::unique_ptr<Envoy::Formatter::StructFormatter> makeStructFormatter(bool type
   return std::make_unique<Envoy::Formatter::StructFormatter>(StructLogFormat, typed, false);
 }
 
+Http::TestRequestHeaderMapImpl makeRequestHeaders() {
+  return {{":method", "GET"},
+          {":authority", "www.example.com"},
+          {":path", "/api/v1/items?id=1234567890"},
+          {"x-forwarded-proto", "https"},
+          {"referer", "https://www.example.com/index.html"},
+          {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+                         "Chrome/103.0.0.0 Safari/537.36"}};
+}
+
 std::unique_ptr<Envoy::TestStreamInfo> makeStreamInfo(TimeSource& time_source) {
   auto stream_info = std::make_unique<Envoy::TestStreamInfo>(time_source);
   stream_info->downstream_connection_info_provider_->setRemoteAddress(
@@ -185,6 +196,78 @@ static void BM_TypedJsonAccessLogFormatter(benchmark::State& state) {
 }
 BENCHMARK(BM_TypedJsonAccessLogFormatter);
 
+// Formats the same JSON log lines as BM_JsonAccessLogFormatterWithHeaders, through a Struct
+// serialized to JSON by protobuf, for comparison.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_StructJsonAccessLogFormatterWithHeaders(benchmark::State& state) {
+  MockTimeSystem time_system;
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo(time_system);
+  std::unique_ptr<Envoy::Formatter::StructFormatter> struct_formatter = makeStructFormatter(false);
+
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers = makeRequestHeaders();
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    output_bytes += MessageUtil::getJsonStringFromMessageOrDie(
+                        struct_formatter->format(request_headers, response_headers,
+                                                 response_trailers, *stream_info, body),
+                        false, true)
+                        .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_StructJsonAccessLogFormatterWithHeaders);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_JsonAccessLogFormatterWithHeaders(benchmark::State& state) {
+  MockTimeSystem time_system;
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo(time_system);
+  std::unique_ptr<Envoy::Formatter::JsonFormatterImpl> json_formatter = makeJsonFormatter(false);
+
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers = makeRequestHeaders();
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    output_bytes +=
+        json_formatter
+            ->format(request_headers, response_headers, response_trailers, *stream_info, body)
+            .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_JsonAccessLogFormatterWithHeaders);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_AccessLogFormatterWithHeaders(benchmark::State& state) {
+  MockTimeSystem time_system;
+  std::unique_ptr<Envoy::TestStreamInfo> stream_info = makeStreamInfo(time_system);
+  static const char* LogFormat =
+      "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT% %START_TIME(%Y/%m/%dT%H:%M:%S%z %s)% "
+      "%REQ(:METHOD)% "
+      "%REQ(X-FORWARDED-PROTO)%://%REQ(:AUTHORITY)%%REQ(X-ENVOY-ORIGINAL-PATH?:PATH)% %PROTOCOL% "
+      "s%RESPONSE_CODE% %BYTES_SENT% %DURATION% %REQ(REFERER)% \"%REQ(USER-AGENT)%\" - - -\n";
+
+  std::unique_ptr<Envoy::Formatter::FormatterImpl> formatter =
+      std::make_unique<Envoy::Formatter::FormatterImpl>(LogFormat, false);
+
+  size_t output_bytes = 0;
+  Http::TestRequestHeaderMapImpl request_headers = makeRequestHeaders();
+  Http::TestResponseHeaderMapImpl response_headers;
+  Http::TestResponseTrailerMapImpl response_trailers;
+  std::string body;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    output_bytes +=
+        formatter->format(request_headers, response_headers, response_trailers, *stream_info, body)
+            .length();
+  }
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_AccessLogFormatterWithHeaders);
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void BM_FormatterCommandParsing(benchmark::State& state) {
   const std::string token = "Listener:namespace:key";
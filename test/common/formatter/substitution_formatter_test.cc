@@ -3259,6 +3259,95 @@ TEST(SubstitutionFormatterTest, JsonFormatterTest) {
   EXPECT_TRUE(TestUtility::jsonStringEqual(out_json, expected));
 }
 
+// The JSON formatter writes the JSON serialization of the Struct built by StructFormatter.
+TEST(SubstitutionFormatterTest, JsonFormatterMatchesStructFormatterTest) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
+  Http::TestResponseHeaderMapImpl response_header{{"second", "PUT"}};
+  Http::TestResponseTrailerMapImpl response_trailer;
+  std::string body;
+
+  envoy::config::core::v3::Metadata metadata;
+  populateMetadataTestData(metadata);
+  EXPECT_CALL(stream_info, dynamicMetadata()).WillRepeatedly(ReturnRef(metadata));
+  EXPECT_CALL(Const(stream_info), dynamicMetadata()).WillRepeatedly(ReturnRef(metadata));
+  absl::optional<Http::Protocol> protocol = Http::Protocol::Http11;
+  EXPECT_CALL(stream_info, protocol()).WillRepeatedly(Return(protocol));
+  stream_info.response_code_ = 200;
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    protocol: '%PROTOCOL%'
+    code: '%RESPONSE_CODE%'
+    missing: '%REQ(missing)%'
+    url: '%REQ(first)% %REQ(:path)%%REQ(missing)%'
+    metadata: '%DYNAMIC_METADATA(com.test)%'
+    nested:
+      plain_string: plain_string_value
+      missing: '%RESP(missing)%'
+      list:
+      - '%RESP(second)%'
+      - '%RESP(missing)%'
+      - inner:
+          missing: '%RESP(missing)%'
+  )EOF",
+                            key_mapping);
+
+  for (const bool preserve_types : {false, true}) {
+    for (const bool omit_empty_values : {false, true}) {
+      SCOPED_TRACE(fmt::format("preserve_types: {}, omit_empty_values: {}", preserve_types,
+                               omit_empty_values));
+      JsonFormatterImpl formatter(key_mapping, preserve_types, omit_empty_values);
+      StructFormatter struct_formatter(key_mapping, preserve_types, omit_empty_values);
+
+      const std::string out_json =
+          formatter.format(request_header, response_header, response_trailer, stream_info, body);
+      const std::string expected = MessageUtil::getJsonStringFromMessageOrDie(
+          struct_formatter.format(request_header, response_header, response_trailer, stream_info,
+                                  body),
+          false, true);
+      EXPECT_TRUE(TestUtility::jsonStringEqual(out_json, expected)) << out_json;
+      EXPECT_EQ('\n', out_json.back());
+    }
+  }
+}
+
+TEST(SubstitutionFormatterTest, JsonFormatterOutputTest) {
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+  Http::TestRequestHeaderMapImpl request_header{{"utf8", "h\xc3\xa9llo"}, {"invalid", "a\xff"}};
+  Http::TestResponseHeaderMapImpl response_header;
+  Http::TestResponseTrailerMapImpl response_trailer;
+  std::string body = "say \"hi\"\\\n<b>";
+  stream_info.response_code_ = 200;
+
+  ProtobufWkt::Struct key_mapping;
+  TestUtility::loadFromYaml(R"EOF(
+    a_quoted: '%LOCAL_REPLY_BODY%'
+    b_utf8: '%REQ(utf8)%'
+    c_invalid: '%REQ(invalid)%'
+    d_missing: '%REQ(missing)%'
+    e_list: ['%REQ(missing)%', '%RESPONSE_CODE%', '%REQ(missing)%']
+    "f_\"key\"": '%RESPONSE_CODE%'
+  )EOF",
+                            key_mapping);
+
+  {
+    JsonFormatterImpl formatter(key_mapping, true, true);
+    EXPECT_EQ("{\"a_quoted\":\"say \\\"hi\\\"\\\\\\n\\u003cb\\u003e\",\"b_utf8\":\"h\xc3\xa9llo\","
+              "\"c_invalid\":\"a\\ufffd\",\"e_list\":[200],\"f_\\\"key\\\"\":200}\n",
+              formatter.format(request_header, response_header, response_trailer, stream_info,
+                               body));
+  }
+  {
+    JsonFormatterImpl formatter(key_mapping, false, false);
+    EXPECT_EQ("{\"a_quoted\":\"say \\\"hi\\\"\\\\\\n\\u003cb\\u003e\",\"b_utf8\":\"h\xc3\xa9llo\","
+              "\"c_invalid\":\"a\\ufffd\",\"d_missing\":\"-\",\"e_list\":[\"-\",\"200\",\"-\"],"
+              "\"f_\\\"key\\\"\":\"200\"}\n",
+              formatter.format(request_header, response_header, response_trailer, stream_info,
+                               body));
+  }
+}
+
 TEST(SubstitutionFormatterTest, CompositeFormatterSuccess) {
   Http::TestRequestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
   Http::TestResponseHeaderMapImpl response_header{{"second", "PUT"}, {"test", "test"}};
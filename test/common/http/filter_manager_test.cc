@@ -589,6 +589,58 @@ TEST_F(FilterManagerTest, SetAndGetUpstreamOverrideHost) {
   filter_manager_->destroyFilters();
 };
 
+// Verifies that decoder filters run in configuration order, encoder filters run in reverse order,
+// and that iteration resumes after the filter which stopped it.
+TEST_F(FilterManagerTest, FilterIterationOrder) {
+  initialize();
+
+  std::shared_ptr<MockStreamFilter> filter_a(new NiceMock<MockStreamFilter>());
+  std::shared_ptr<MockStreamFilter> filter_b(new NiceMock<MockStreamFilter>());
+  std::shared_ptr<MockStreamFilter> filter_c(new NiceMock<MockStreamFilter>());
+
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillRepeatedly(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamFilter(filter_a);
+        callbacks.addStreamFilter(filter_b);
+        callbacks.addStreamFilter(filter_c);
+      }));
+  filter_manager_->createFilterChain();
+
+  RequestHeaderMapPtr request_headers{
+      new TestRequestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+  ON_CALL(filter_manager_callbacks_, requestHeaders())
+      .WillByDefault(Return(makeOptRef(*request_headers)));
+  filter_manager_->requestHeadersInitialized();
+
+  {
+    InSequence s;
+    EXPECT_CALL(*filter_a, decodeHeaders(_, true)).WillOnce(Return(FilterHeadersStatus::Continue));
+    EXPECT_CALL(*filter_b, decodeHeaders(_, true))
+        .WillOnce(Return(FilterHeadersStatus::StopIteration));
+    EXPECT_CALL(*filter_c, decodeHeaders(_, true))
+        .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  }
+  filter_manager_->decodeHeaders(*request_headers, true);
+  filter_b->decoder_callbacks_->continueDecoding();
+
+  {
+    InSequence s;
+    EXPECT_CALL(*filter_c, encodeHeaders(_, true)).WillOnce(Return(FilterHeadersStatus::Continue));
+    EXPECT_CALL(*filter_b, encodeHeaders(_, true))
+        .WillOnce(Return(FilterHeadersStatus::StopIteration));
+    EXPECT_CALL(*filter_a, encodeHeaders(_, true)).WillOnce(Return(FilterHeadersStatus::Continue));
+    EXPECT_CALL(filter_manager_callbacks_, encodeHeaders(_, true));
+  }
+  ResponseHeaderMapPtr response_headers{new TestResponseHeaderMapImpl{{":status", "200"}}};
+  filter_c->decoder_callbacks_->encodeHeaders(std::move(response_headers), true, "details");
+  filter_b->encoder_callbacks_->continueEncoding();
+
+  EXPECT_CALL(*filter_a, onDestroy());
+  EXPECT_CALL(*filter_b, onDestroy());
+  EXPECT_CALL(*filter_c, onDestroy());
+  filter_manager_->destroyFilters();
+}
+
 } // namespace
 } // namespace Http
 } // namespace Envoy
@@ -237,6 +237,10 @@ public:
         max_inbound_priority_frames_per_stream_);
     options.mutable_max_inbound_window_update_frames_per_data_frame_sent()->set_value(
         max_inbound_window_update_frames_per_data_frame_sent_);
+    options.mutable_max_coalesced_write_bytes()->set_value(max_coalesced_write_bytes_);
+    if (hpack_encoder_table_size_.has_value()) {
+      options.mutable_hpack_encoder_table_size()->set_value(hpack_encoder_table_size_.value());
+    }
   }
 
   // corruptMetadataFramePayload assumes data contains at least 10 bytes of the beginning of a
@@ -355,6 +359,17 @@ public:
     }
   }
 
+  // Sends a request with a header which is only compressed well through the dynamic table on a new
+  // stream, and returns the size of the encoded header block.
+  uint64_t sendIndexableRequest(MockResponseDecoder& response_decoder) {
+    const uint64_t sent_before = client_stats_store_.counter("http2.tx_header_block_bytes").value();
+    TestRequestHeaderMapImpl request_headers{{"x-indexable", std::string(100, 'a')}};
+    HttpTestUtility::addDefaultHeaders(request_headers);
+    EXPECT_TRUE(client_->newStream(response_decoder).encodeHeaders(request_headers, true).ok());
+    driveToCompletion();
+    return client_stats_store_.counter("http2.tx_header_block_bytes").value() - sent_before;
+  }
+
   // Only safe to call when using the wrapped nghttp2 codec implementation.
   size_t getClientDataSourcesSize() {
     return reinterpret_cast<http2::adapter::NgHttp2Adapter&>(
@@ -410,6 +425,7 @@ public:
       CommonUtility::OptionsLimits::DEFAULT_MAX_INBOUND_PRIORITY_FRAMES_PER_STREAM;
   uint32_t max_inbound_window_update_frames_per_data_frame_sent_ =
       CommonUtility::OptionsLimits::DEFAULT_MAX_INBOUND_WINDOW_UPDATE_FRAMES_PER_DATA_FRAME_SENT;
+  absl::optional<uint32_t> hpack_encoder_table_size_;
   envoy::config::core::v3::HttpProtocolOptions::HeadersWithUnderscoresAction
       headers_with_underscores_action_{envoy::config::core::v3::HttpProtocolOptions::ALLOW};
 };
@@ -547,6 +563,81 @@ TEST_P(Http2CodecImplTest, SimpleRequestResponse) {
   }
 }
 
+// Verify that the frames generated in one pass of the codec are written to the connection in a
+// single write when write coalescing is enabled.
+TEST_P(Http2CodecImplTest, CoalescedWrites) {
+  max_coalesced_write_bytes_ = 64 * 1024;
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  // The response is encoded while the server is dispatching, so that the HEADERS and DATA frames
+  // are sent in the same pass.
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true)).WillOnce(InvokeWithoutArgs([&]() -> void {
+    TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+    response_encoder_->encodeHeaders(response_headers, false);
+    Buffer::OwnedImpl response_body(std::string(1024, 'b'));
+    response_encoder_->encodeData(response_body, true);
+  }));
+  EXPECT_TRUE(request_encoder_->encodeHeaders(request_headers, true).ok());
+
+  EXPECT_CALL(server_connection_, write(_, _));
+  EXPECT_CALL(response_decoder_, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder_, decodeData(_, true));
+  driveToCompletion();
+}
+
+// Verify that coalesced frames are written once the coalescing limit is reached.
+TEST_P(Http2CodecImplTest, CoalescedWritesLimit) {
+  max_coalesced_write_bytes_ = 1;
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true)).WillOnce(InvokeWithoutArgs([&]() -> void {
+    TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+    response_encoder_->encodeHeaders(response_headers, false);
+    Buffer::OwnedImpl response_body(std::string(1024, 'b'));
+    response_encoder_->encodeData(response_body, true);
+  }));
+  EXPECT_TRUE(request_encoder_->encodeHeaders(request_headers, true).ok());
+
+  EXPECT_CALL(server_connection_, write(_, _)).Times(AtLeast(2));
+  EXPECT_CALL(response_decoder_, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder_, decodeData(_, true));
+  driveToCompletion();
+}
+
+TEST_P(Http2CodecImplTest, HeaderBlockStats) {
+  initialize();
+
+  MockResponseDecoder response_decoder1;
+  MockResponseDecoder response_decoder2;
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true)).Times(2);
+  const uint64_t first_block = sendIndexableRequest(response_decoder1);
+  const uint64_t header_bytes = client_stats_store_.counter("http2.tx_header_bytes").value();
+  EXPECT_EQ(header_bytes, server_stats_store_.counter("http2.rx_header_bytes").value());
+  EXPECT_LT(first_block, header_bytes);
+  EXPECT_EQ(first_block, server_stats_store_.counter("http2.rx_header_block_bytes").value());
+
+  // The repeated header is now encoded from the dynamic table.
+  EXPECT_LT(sendIndexableRequest(response_decoder2), first_block / 2);
+  EXPECT_EQ(2 * header_bytes, client_stats_store_.counter("http2.tx_header_bytes").value());
+}
+
+// The encoder dynamic table can be made smaller than the table advertised to the peer.
+TEST_P(Http2CodecImplTest, HpackEncoderTableSize) {
+  hpack_encoder_table_size_ = 64;
+  initialize();
+
+  MockResponseDecoder response_decoder1;
+  MockResponseDecoder response_decoder2;
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true)).Times(2);
+  const uint64_t first_block = sendIndexableRequest(response_decoder1);
+  // The header does not fit in the encoder table, so it is sent as a literal again.
+  EXPECT_GT(sendIndexableRequest(response_decoder2), first_block / 2);
+}
+
 TEST_P(Http2CodecImplTest, ShutdownNotice) {
   initialize();
   EXPECT_EQ(absl::nullopt, request_encoder_->http1StreamEncoderOptions());
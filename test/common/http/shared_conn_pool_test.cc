@@ -0,0 +1,254 @@
+#include <memory>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/shared_conn_pool.h"
+
+#include "test/common/http/common.h"
+#include "test/common/upstream/utility.h"
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/upstream/cluster_info.h"
+#include "test/test_common/utility.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+class SharedConnPoolTest : public testing::Test {
+protected:
+  SharedConnPoolTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        workers_(std::make_shared<WorkerDispatcherRegistry>(2)),
+        host_(Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:80", api_->timeSource())) {
+    // Both workers run on the test thread, hand offs between them go through the event loop.
+    workers_->registerWorker(*dispatcher_);
+    workers_->registerWorker(*dispatcher_);
+    pool_ = std::make_unique<SharedConnPool>(*dispatcher_, host_, workers_, 0, 1,
+                                             [this]() { return owner_pool_; });
+    pool_->addIdleCallback([this]() { idle_.ready(); });
+    ON_CALL(owner_encoder_.stream_, bufferLimit()).WillByDefault(Return(1024));
+  }
+
+  // Creates a stream and makes it ready on the owner worker.
+  RequestEncoder& newReadyStream() {
+    EXPECT_CALL(owner_mock_pool_, newStream(_, _, _))
+        .WillOnce(Invoke([this](ResponseDecoder& decoder, ConnectionPool::Callbacks& callbacks,
+                                const ConnectionPool::Instance::StreamOptions&) {
+          owner_decoder_ = &decoder;
+          owner_callbacks_ = &callbacks;
+          return &owner_cancellable_;
+        }));
+    EXPECT_NE(nullptr, pool_->newStream(decoder_, callbacks_, {false, true}));
+    run();
+
+    EXPECT_CALL(callbacks_.pool_ready_, ready());
+    owner_callbacks_->onPoolReady(owner_encoder_, host_, stream_info_, Protocol::Http2);
+    run();
+    return *callbacks_.outer_encoder_;
+  }
+
+  void run() { dispatcher_->run(Event::Dispatcher::RunType::NonBlock); }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  WorkerDispatcherRegistrySharedPtr workers_;
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
+  Upstream::HostSharedPtr host_;
+  NiceMock<ConnectionPool::MockInstance> owner_mock_pool_;
+  ConnectionPool::Instance* owner_pool_{&owner_mock_pool_};
+  NiceMock<Envoy::ConnectionPool::MockCancellable> owner_cancellable_;
+  NiceMock<MockRequestEncoder> owner_encoder_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  ResponseDecoder* owner_decoder_{};
+  ConnectionPool::Callbacks* owner_callbacks_{};
+  NiceMock<MockResponseDecoder> decoder_;
+  ConnPoolCallbacks callbacks_;
+  NiceMock<ReadyWatcher> idle_;
+  std::unique_ptr<SharedConnPool> pool_;
+};
+
+TEST_F(SharedConnPoolTest, OwnerWorker) {
+  // With a single worker, the worker owns the connections.
+  EXPECT_EQ(absl::nullopt, SharedConnPool::ownerWorker(*host_, 0, 1, 1));
+
+  // With as many owners as workers, every worker owns connections.
+  for (uint32_t worker = 0; worker < 4; ++worker) {
+    EXPECT_EQ(absl::nullopt, SharedConnPool::ownerWorker(*host_, worker, 4, 8));
+  }
+
+  // Otherwise the other workers are spread over the owners.
+  uint32_t owners = 0;
+  absl::flat_hash_set<uint32_t> targets;
+  for (uint32_t worker = 0; worker < 8; ++worker) {
+    const absl::optional<uint32_t> owner = SharedConnPool::ownerWorker(*host_, worker, 8, 2);
+    if (!owner.has_value()) {
+      owners++;
+      continue;
+    }
+    EXPECT_FALSE(SharedConnPool::ownerWorker(*host_, owner.value(), 8, 2).has_value());
+    targets.insert(owner.value());
+  }
+  EXPECT_EQ(2, owners);
+  EXPECT_EQ(2, targets.size());
+}
+
+TEST_F(SharedConnPoolTest, WorkersRegisterInStages) {
+  WorkerDispatcherRegistry workers(4);
+  EXPECT_EQ(4, workers.workers());
+  EXPECT_FALSE(workers.allRegistered());
+  EXPECT_EQ(0, workers.registerWorker(*dispatcher_));
+  EXPECT_EQ(1, workers.registerWorker(*dispatcher_));
+  EXPECT_FALSE(workers.allRegistered());
+  EXPECT_EQ(2, workers.registerWorker(*dispatcher_));
+  EXPECT_FALSE(workers.allRegistered());
+
+  // Once all the workers registered, every worker hands off to a worker owning the host.
+  EXPECT_EQ(3, workers.registerWorker(*dispatcher_));
+  EXPECT_TRUE(workers.allRegistered());
+  for (uint32_t worker = 0; worker < 4; ++worker) {
+    const absl::optional<uint32_t> owner =
+        SharedConnPool::ownerWorker(*host_, worker, workers.workers(), 1);
+    if (owner.has_value()) {
+      EXPECT_FALSE(
+          SharedConnPool::ownerWorker(*host_, owner.value(), workers.workers(), 1).has_value());
+    }
+  }
+
+  // Workers going away do not change the count.
+  workers.unregisterWorker(0);
+  EXPECT_TRUE(workers.allRegistered());
+  EXPECT_FALSE(workers.post(0, []() {}));
+}
+
+TEST_F(SharedConnPoolTest, RequestResponse) {
+  RequestEncoder& encoder = newReadyStream();
+  EXPECT_EQ(1, cluster_->stats_.upstream_rq_shared_pool_handoff_.value());
+  EXPECT_EQ(1024, encoder.getStream().bufferLimit());
+  EXPECT_TRUE(pool_->hasActiveConnections());
+
+  TestRequestHeaderMapImpl request_headers{{":method", "POST"}, {":path", "/"}};
+  EXPECT_CALL(owner_encoder_, encodeHeaders(HeaderMapEqualRef(&request_headers), false));
+  EXPECT_TRUE(encoder.encodeHeaders(request_headers, false).ok());
+  Buffer::OwnedImpl request_body("hello");
+  EXPECT_CALL(owner_encoder_, encodeData(BufferStringEqual("hello"), true));
+  encoder.encodeData(request_body, true);
+  // The body is moved out of the caller's buffer right away.
+  EXPECT_EQ(0, request_body.length());
+  run();
+
+  EXPECT_CALL(decoder_, decodeHeaders_(_, false));
+  owner_decoder_->decodeHeaders(
+      ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"}}}, false);
+  Buffer::OwnedImpl response_body("world");
+  owner_decoder_->decodeData(response_body, false);
+  owner_decoder_->decodeTrailers(
+      ResponseTrailerMapPtr{new TestResponseTrailerMapImpl{{"a", "b"}}});
+  EXPECT_CALL(decoder_, decodeData(BufferStringEqual("world"), false));
+  EXPECT_CALL(decoder_, decodeTrailers_(_));
+  EXPECT_CALL(idle_, ready());
+  run();
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+TEST_F(SharedConnPoolTest, CancelBeforeReady) {
+  EXPECT_CALL(owner_mock_pool_, newStream(_, _, _)).WillOnce(Return(&owner_cancellable_));
+  ConnectionPool::Cancellable* cancellable = pool_->newStream(decoder_, callbacks_, {false, true});
+  ASSERT_NE(nullptr, cancellable);
+  run();
+
+  EXPECT_CALL(idle_, ready());
+  cancellable->cancel(Envoy::ConnectionPool::CancelPolicy::CloseExcess);
+  EXPECT_CALL(owner_cancellable_, cancel(Envoy::ConnectionPool::CancelPolicy::CloseExcess));
+  run();
+}
+
+TEST_F(SharedConnPoolTest, PoolFailure) {
+  EXPECT_CALL(owner_mock_pool_, newStream(_, _, _))
+      .WillOnce(Invoke([this](ResponseDecoder&, ConnectionPool::Callbacks& callbacks,
+                              const ConnectionPool::Instance::StreamOptions&) {
+        callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, "", host_);
+        return nullptr;
+      }));
+  EXPECT_NE(nullptr, pool_->newStream(decoder_, callbacks_, {false, true}));
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  EXPECT_CALL(idle_, ready());
+  run();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::Overflow, callbacks_.reason_);
+}
+
+TEST_F(SharedConnPoolTest, NoOwnerPool) {
+  owner_pool_ = nullptr;
+  EXPECT_NE(nullptr, pool_->newStream(decoder_, callbacks_, {false, true}));
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  run();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::LocalConnectionFailure, callbacks_.reason_);
+}
+
+TEST_F(SharedConnPoolTest, OwnerWorkerGone) {
+  workers_->unregisterWorker(1);
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  EXPECT_EQ(nullptr, pool_->newStream(decoder_, callbacks_, {false, true}));
+}
+
+TEST_F(SharedConnPoolTest, RemoteReset) {
+  RequestEncoder& encoder = newReadyStream();
+  MockStreamCallbacks stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+
+  owner_encoder_.stream_.resetStream(StreamResetReason::RemoteReset);
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::RemoteReset, _));
+  EXPECT_CALL(idle_, ready());
+  run();
+}
+
+TEST_F(SharedConnPoolTest, LocalReset) {
+  RequestEncoder& encoder = newReadyStream();
+  EXPECT_CALL(idle_, ready());
+  encoder.getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  run();
+}
+
+TEST_F(SharedConnPoolTest, Watermarks) {
+  RequestEncoder& encoder = newReadyStream();
+  MockStreamCallbacks stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+
+  owner_encoder_.stream_.runHighWatermarkCallbacks();
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark());
+  run();
+  owner_encoder_.stream_.runLowWatermarkCallbacks();
+  EXPECT_CALL(stream_callbacks, onBelowWriteBufferLowWatermark());
+  run();
+
+  EXPECT_CALL(owner_encoder_.stream_, readDisable(true));
+  encoder.getStream().readDisable(true);
+  run();
+  encoder.getStream().removeCallbacks(stream_callbacks);
+}
+
+TEST_F(SharedConnPoolTest, PoolDestroyedWithActiveStream) {
+  RequestEncoder& encoder = newReadyStream();
+  MockStreamCallbacks stream_callbacks;
+  encoder.getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::ConnectionTermination, _));
+  pool_.reset();
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  run();
+}
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
@@ -3804,6 +3804,7 @@ virtual_hosts:
               numerator: 20
               denominator: HUNDRED
             runtime_key: foo
+          stream_body: true
       cluster: www2
   - match:
       prefix: "/baz"
@@ -3832,12 +3833,14 @@ virtual_hosts:
   EXPECT_EQ(1, foo_shadow_policies.size());
   EXPECT_EQ("some_cluster", foo_shadow_policies[0]->cluster());
   EXPECT_EQ("", foo_shadow_policies[0]->runtimeKey());
+  EXPECT_FALSE(foo_shadow_policies[0]->streamBody());
 
   const auto& bar_shadow_policies =
       config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)->routeEntry()->shadowPolicies();
   EXPECT_EQ(1, bar_shadow_policies.size());
   EXPECT_EQ("some_cluster2", bar_shadow_policies[0]->cluster());
   EXPECT_EQ("foo", bar_shadow_policies[0]->runtimeKey());
+  EXPECT_TRUE(bar_shadow_policies[0]->streamBody());
 
   EXPECT_EQ(0, config.route(genHeaders("www.lyft.com", "/baz", "GET"), 0)
                    ->routeEntry()
@@ -4533,6 +4536,61 @@ virtual_hosts:
   EXPECT_EQ(100, ProtobufPercentHelper::fractionalPercentDenominatorToInt(percent.denominator()));
 }
 
+TEST_F(RouteMatcherTest, HedgeLatencyBased) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+- domains: [www.lyft.com]
+  name: www
+  routes:
+  - match: {prefix: /foo}
+    route:
+      cluster: www
+      hedge_policy:
+        latency_based_hedging:
+          latency_percentile: {value: 99}
+          min_delay: 0.005s
+          min_samples: 50
+          budget_percent: {value: 5}
+  - match: {prefix: /bar}
+    route:
+      cluster: www
+      hedge_policy: {latency_based_hedging: {}}
+  - match: {prefix: /}
+    route: {cluster: www}
+  )EOF";
+
+  factory_context_.cluster_manager_.initializeClusters({"www"}, {});
+  TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, true);
+
+  const absl::optional<LatencyHedgingConfig>& foo =
+      config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)
+          ->routeEntry()
+          ->hedgePolicy()
+          .latencyHedging();
+  ASSERT_TRUE(foo.has_value());
+  EXPECT_EQ(99, foo->latency_percentile_);
+  EXPECT_EQ(std::chrono::milliseconds(5), foo->min_delay_);
+  EXPECT_EQ(50, foo->min_samples_);
+  EXPECT_EQ(5, foo->budget_percent_);
+
+  const absl::optional<LatencyHedgingConfig>& bar =
+      config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)
+          ->routeEntry()
+          ->hedgePolicy()
+          .latencyHedging();
+  ASSERT_TRUE(bar.has_value());
+  EXPECT_EQ(95, bar->latency_percentile_);
+  EXPECT_EQ(std::chrono::milliseconds(0), bar->min_delay_);
+  EXPECT_EQ(100, bar->min_samples_);
+  EXPECT_EQ(10, bar->budget_percent_);
+
+  EXPECT_FALSE(config.route(genHeaders("www.lyft.com", "/", "GET"), 0)
+                   ->routeEntry()
+                   ->hedgePolicy()
+                   .latencyHedging()
+                   .has_value());
+}
+
 TEST_F(RouteMatcherTest, HedgeVirtualHostLevel) {
   const std::string yaml = R"EOF(
 virtual_hosts:
@@ -216,6 +216,21 @@ TEST_F(RouterRetryStateImplTest, PolicyRefusedStream) {
   EXPECT_EQ(1UL, virtual_cluster_.stats().upstream_rq_retry_.value());
 }
 
+// Latency based hedges are sent on the next loop iteration, without backoff.
+TEST_F(RouterRetryStateImplTest, HedgeRetryLatency) {
+  Http::TestRequestHeaderMapImpl request_headers{{"x-envoy-retry-on", "5xx"}};
+  setup(request_headers);
+  EXPECT_TRUE(state_->enabled());
+
+  expectSchedulableCallback();
+  EXPECT_EQ(RetryStatus::Yes, state_->shouldHedgeRetryLatency(callback_));
+  EXPECT_CALL(callback_ready_, ready());
+  retry_schedulable_callback_->invokeCallback();
+
+  EXPECT_EQ(RetryStatus::NoRetryLimitExceeded, state_->shouldHedgeRetryLatency(callback_));
+  EXPECT_EQ(1UL, cluster_.stats().upstream_rq_retry_.value());
+}
+
 TEST_F(RouterRetryStateImplTest, PolicyAltProtocolPostHandshakeFailure) {
   if (!Runtime::runtimeFeatureEnabled(Runtime::conn_pool_new_stream_with_early_data_and_http3)) {
     return;
@@ -2116,6 +2116,270 @@ TEST_F(RouterTest, HedgedPerTryTimeoutFirstRequestSucceeds) {
   // TODO: Verify hedge stats here once they are implemented.
 }
 
+TEST_F(RouterTest, LatencyHedgeWins) {
+  enableLatencyHedging(50);
+
+  NiceMock<Http::MockRequestEncoder> encoder1;
+  EXPECT_CALL(cm_.thread_local_cluster_.conn_pool_, newStream(_, _, _))
+      .WillOnce(
+          Invoke([&](Http::ResponseDecoder&, Http::ConnectionPool::Callbacks& callbacks,
+                     const Http::ConnectionPool::Instance::StreamOptions&)
+                     -> Http::ConnectionPool::Cancellable* {
+            EXPECT_CALL(*router_.retry_state_, onHostAttempted(_));
+            callbacks.onPoolReady(encoder1, cm_.thread_local_cluster_.conn_pool_.host_,
+                                  upstream_stream_info_, Http::Protocol::Http10);
+            return nullptr;
+          }));
+  // The hedge timer is armed at the 95th percentile of the latency of the cluster, which falls
+  // in the [8192us, 10240us) bucket.
+  Event::MockTimer* hedge_timer1 = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer1, enableHRTimer(std::chrono::microseconds(10240), _));
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  // The first request is slow: a hedged request is sent right away, without resetting it.
+  EXPECT_CALL(encoder1.stream_, resetStream(_)).Times(0);
+  router_.retry_state_->expectHedgedLatencyRetry();
+  hedge_timer1->invokeCallback();
+  EXPECT_EQ(1U,
+            cm_.thread_local_cluster_.cluster_.info_->stats_.upstream_rq_latency_hedge_.value());
+
+  NiceMock<Http::MockRequestEncoder> encoder2;
+  Http::ResponseDecoder* response_decoder2 = nullptr;
+  EXPECT_CALL(cm_.thread_local_cluster_.conn_pool_, newStream(_, _, _))
+      .WillOnce(
+          Invoke([&](Http::ResponseDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks,
+                     const Http::ConnectionPool::Instance::StreamOptions&)
+                     -> Http::ConnectionPool::Cancellable* {
+            response_decoder2 = &decoder;
+            EXPECT_CALL(*router_.retry_state_, onHostAttempted(_));
+            callbacks.onPoolReady(encoder2, cm_.thread_local_cluster_.conn_pool_.host_,
+                                  upstream_stream_info_, Http::Protocol::Http10);
+            return nullptr;
+          }));
+  Event::MockTimer* hedge_timer2 = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer2, enableHRTimer(std::chrono::microseconds(10240), _));
+  router_.retry_state_->callback_();
+  EXPECT_EQ(2U,
+            callbacks_.route_->route_entry_.virtual_cluster_.stats().upstream_rq_total_.value());
+
+  // The hedged request answers first: the first request is reset.
+  EXPECT_CALL(*router_.retry_state_, shouldRetryHeaders(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(encoder1.stream_, resetStream(_));
+  EXPECT_CALL(encoder2.stream_, resetStream(_)).Times(0);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  Http::ResponseHeaderMapPtr response_headers(
+      new Http::TestResponseHeaderMapImpl{{":status", "200"}});
+  // NOLINTNEXTLINE: Silence null pointer access warning
+  response_decoder2->decodeHeaders(std::move(response_headers), true);
+  EXPECT_EQ(
+      1U, cm_.thread_local_cluster_.cluster_.info_->stats_.upstream_rq_latency_hedge_won_.value());
+}
+
+TEST_F(RouterTest, LatencyHedgeBudgetExceeded) {
+  // 20 recent responses and a 1% budget don't allow a single hedged request.
+  enableLatencyHedging(1);
+
+  NiceMock<Http::MockRequestEncoder> encoder;
+  Http::ResponseDecoder* response_decoder = nullptr;
+  expectNewStreamWithImmediateEncoder(encoder, &response_decoder, Http::Protocol::Http10);
+  Event::MockTimer* hedge_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer, enableHRTimer(_, _));
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  EXPECT_CALL(*router_.retry_state_, shouldHedgeRetryLatency(_)).Times(0);
+  hedge_timer->invokeCallback();
+  EXPECT_EQ(1U, cm_.thread_local_cluster_.cluster_.info_->stats_
+                    .upstream_rq_latency_hedge_budget_exceeded_.value());
+  EXPECT_EQ(0U,
+            cm_.thread_local_cluster_.cluster_.info_->stats_.upstream_rq_latency_hedge_.value());
+
+  EXPECT_CALL(*router_.retry_state_, shouldRetryHeaders(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  Http::ResponseHeaderMapPtr response_headers(
+      new Http::TestResponseHeaderMapImpl{{":status", "200"}});
+  // NOLINTNEXTLINE: Silence null pointer access warning
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_EQ(
+      0U, cm_.thread_local_cluster_.cluster_.info_->stats_.upstream_rq_latency_hedge_won_.value());
+}
+
+TEST_F(RouterTest, LatencyHedgeRefusedByRetryPolicy) {
+  // 20 recent responses and a 5% budget allow a single hedged request.
+  enableLatencyHedging(5);
+
+  NiceMock<Http::MockRequestEncoder> encoder;
+  Http::ResponseDecoder* response_decoder = nullptr;
+  expectNewStreamWithImmediateEncoder(encoder, &response_decoder, Http::Protocol::Http10);
+  Event::MockTimer* hedge_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer, enableHRTimer(_, _));
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  // The retry policy doesn't allow the hedge, so the hedge budget is left untouched.
+  EXPECT_CALL(*router_.retry_state_, shouldHedgeRetryLatency(_))
+      .WillOnce(Return(RetryStatus::NoRetryLimitExceeded));
+  hedge_timer->invokeCallback();
+  EXPECT_EQ(0U,
+            cm_.thread_local_cluster_.cluster_.info_->stats_.upstream_rq_latency_hedge_.value());
+  EXPECT_EQ(0U, cm_.thread_local_cluster_.cluster_.info_->stats_
+                    .upstream_rq_latency_hedge_budget_exceeded_.value());
+  EXPECT_TRUE(
+      cm_.thread_local_cluster_.cluster_.info_->response_latency_tracker_.hedgeBudgetAvailable(5));
+
+  EXPECT_CALL(*router_.retry_state_, shouldRetryHeaders(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  Http::ResponseHeaderMapPtr response_headers(
+      new Http::TestResponseHeaderMapImpl{{":status", "200"}});
+  // NOLINTNEXTLINE: Silence null pointer access warning
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+}
+
+// The per try timeout of the hedged request doesn't abort the latency hedge still in flight.
+TEST_F(RouterTest, LatencyHedgeOriginalPerTryTimeout) {
+  enableLatencyHedging(50);
+
+  NiceMock<Http::MockRequestEncoder> encoder1;
+  EXPECT_CALL(cm_.thread_local_cluster_.conn_pool_, newStream(_, _, _))
+      .WillOnce(
+          Invoke([&](Http::ResponseDecoder&, Http::ConnectionPool::Callbacks& callbacks,
+                     const Http::ConnectionPool::Instance::StreamOptions&)
+                     -> Http::ConnectionPool::Cancellable* {
+            EXPECT_CALL(*router_.retry_state_, onHostAttempted(_));
+            callbacks.onPoolReady(encoder1, cm_.thread_local_cluster_.conn_pool_.host_,
+                                  upstream_stream_info_, Http::Protocol::Http10);
+            return nullptr;
+          }));
+  Event::MockTimer* hedge_timer1 = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer1, enableHRTimer(_, _));
+  expectPerTryTimerCreate();
+  Event::MockTimer* per_try_timeout1 = per_try_timeout_;
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers{{"x-envoy-upstream-rq-timeout-ms", "400"},
+                                         {"x-envoy-upstream-rq-per-try-timeout-ms", "100"}};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  router_.retry_state_->expectHedgedLatencyRetry();
+  hedge_timer1->invokeCallback();
+
+  NiceMock<Http::MockRequestEncoder> encoder2;
+  Http::ResponseDecoder* response_decoder2 = nullptr;
+  EXPECT_CALL(cm_.thread_local_cluster_.conn_pool_, newStream(_, _, _))
+      .WillOnce(
+          Invoke([&](Http::ResponseDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks,
+                     const Http::ConnectionPool::Instance::StreamOptions&)
+                     -> Http::ConnectionPool::Cancellable* {
+            response_decoder2 = &decoder;
+            EXPECT_CALL(*router_.retry_state_, onHostAttempted(_));
+            callbacks.onPoolReady(encoder2, cm_.thread_local_cluster_.conn_pool_.host_,
+                                  upstream_stream_info_, Http::Protocol::Http10);
+            return nullptr;
+          }));
+  Event::MockTimer* hedge_timer2 = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer2, enableHRTimer(_, _));
+  expectPerTryTimerCreate();
+  router_.retry_state_->callback_();
+
+  // The hedged request times out: it is reset, but nothing is sent downstream while the hedge
+  // may still answer.
+  EXPECT_CALL(encoder1.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  EXPECT_CALL(encoder2.stream_, resetStream(_)).Times(0);
+  EXPECT_CALL(*router_.retry_state_, shouldRetryReset(_, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, _)).Times(0);
+  per_try_timeout1->invokeCallback();
+  EXPECT_EQ(1U, cm_.thread_local_cluster_.cluster_.info_->stats_store_
+                    .counter("upstream_rq_per_try_timeout")
+                    .value());
+
+  EXPECT_CALL(*router_.retry_state_, shouldRetryHeaders(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  Http::ResponseHeaderMapPtr response_headers(
+      new Http::TestResponseHeaderMapImpl{{":status", "200"}});
+  // NOLINTNEXTLINE: Silence null pointer access warning
+  response_decoder2->decodeHeaders(std::move(response_headers), true);
+  EXPECT_EQ(
+      1U, cm_.thread_local_cluster_.cluster_.info_->stats_.upstream_rq_latency_hedge_won_.value());
+}
+
+// The per try timeout of a latency hedge doesn't abort the hedged request still in flight, even
+// without retries left.
+TEST_F(RouterTest, LatencyHedgePerTryTimeout) {
+  enableLatencyHedging(50);
+
+  NiceMock<Http::MockRequestEncoder> encoder1;
+  Http::ResponseDecoder* response_decoder1 = nullptr;
+  EXPECT_CALL(cm_.thread_local_cluster_.conn_pool_, newStream(_, _, _))
+      .WillOnce(
+          Invoke([&](Http::ResponseDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks,
+                     const Http::ConnectionPool::Instance::StreamOptions&)
+                     -> Http::ConnectionPool::Cancellable* {
+            response_decoder1 = &decoder;
+            EXPECT_CALL(*router_.retry_state_, onHostAttempted(_));
+            callbacks.onPoolReady(encoder1, cm_.thread_local_cluster_.conn_pool_.host_,
+                                  upstream_stream_info_, Http::Protocol::Http10);
+            return nullptr;
+          }));
+  Event::MockTimer* hedge_timer1 = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer1, enableHRTimer(_, _));
+  expectPerTryTimerCreate();
+  expectResponseTimerCreate();
+
+  Http::TestRequestHeaderMapImpl headers{{"x-envoy-upstream-rq-timeout-ms", "400"},
+                                         {"x-envoy-upstream-rq-per-try-timeout-ms", "100"}};
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  router_.retry_state_->expectHedgedLatencyRetry();
+  hedge_timer1->invokeCallback();
+
+  NiceMock<Http::MockRequestEncoder> encoder2;
+  EXPECT_CALL(cm_.thread_local_cluster_.conn_pool_, newStream(_, _, _))
+      .WillOnce(
+          Invoke([&](Http::ResponseDecoder&, Http::ConnectionPool::Callbacks& callbacks,
+                     const Http::ConnectionPool::Instance::StreamOptions&)
+                     -> Http::ConnectionPool::Cancellable* {
+            EXPECT_CALL(*router_.retry_state_, onHostAttempted(_));
+            callbacks.onPoolReady(encoder2, cm_.thread_local_cluster_.conn_pool_.host_,
+                                  upstream_stream_info_, Http::Protocol::Http10);
+            return nullptr;
+          }));
+  Event::MockTimer* hedge_timer2 = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(*hedge_timer2, enableHRTimer(_, _));
+  expectPerTryTimerCreate();
+  Event::MockTimer* per_try_timeout2 = per_try_timeout_;
+  router_.retry_state_->callback_();
+
+  // The hedge times out with no retry left: it is reset, but nothing is sent downstream while the
+  // hedged request may still answer.
+  EXPECT_CALL(encoder1.stream_, resetStream(_)).Times(0);
+  EXPECT_CALL(encoder2.stream_, resetStream(Http::StreamResetReason::LocalReset));
+  EXPECT_CALL(*router_.retry_state_, shouldRetryReset(_, _, _))
+      .WillOnce(Return(RetryStatus::NoRetryLimitExceeded));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, _)).Times(0);
+  per_try_timeout2->invokeCallback();
+
+  EXPECT_CALL(*router_.retry_state_, shouldRetryHeaders(_, _, _)).WillOnce(Return(RetryStatus::No));
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, true));
+  Http::ResponseHeaderMapPtr response_headers(
+      new Http::TestResponseHeaderMapImpl{{":status", "200"}});
+  // NOLINTNEXTLINE: Silence null pointer access warning
+  response_decoder1->decodeHeaders(std::move(response_headers), true);
+  EXPECT_EQ(
+      0U, cm_.thread_local_cluster_.cluster_.info_->stats_.upstream_rq_latency_hedge_won_.value());
+}
+
 // Tests that an upstream request is reset even if it can't be retried as long as there is
 // another in-flight request we're waiting on.
 // Sequence:
@@ -4392,9 +4656,10 @@ namespace {
 std::shared_ptr<ShadowPolicyImpl>
 makeShadowPolicy(std::string cluster = "", absl::optional<std::string> runtime_key = absl::nullopt,
                  absl::optional<envoy::type::v3::FractionalPercent> default_value = absl::nullopt,
-                 bool trace_sampled = true) {
+                 bool trace_sampled = true, bool stream_body = false) {
   envoy::config::route::v3::RouteAction::RequestMirrorPolicy policy;
   policy.set_cluster(cluster);
+  policy.set_stream_body(stream_body);
   if (runtime_key.has_value()) {
     policy.mutable_runtime_fraction()->set_runtime_key(runtime_key.value());
   }
@@ -4470,6 +4735,62 @@ TEST_F(RouterTest, Shadow) {
   EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
 }
 
+TEST_F(RouterTest, StreamingShadow) {
+  ShadowPolicyPtr policy =
+      makeShadowPolicy("foo", "bar", absl::nullopt, true, /*stream_body=*/true);
+  callbacks_.route_->route_entry_.shadow_policies_.push_back(policy);
+  ON_CALL(callbacks_, streamId()).WillByDefault(Return(43));
+
+  NiceMock<Http::MockRequestEncoder> encoder;
+  Http::ResponseDecoder* response_decoder = nullptr;
+  expectNewStreamWithImmediateEncoder(encoder, &response_decoder, Http::Protocol::Http10);
+
+  EXPECT_CALL(
+      runtime_.snapshot_,
+      featureEnabled("bar", testing::Matcher<const envoy::type::v3::FractionalPercent&>(_), 43))
+      .WillOnce(Return(true));
+
+  // The shadow starts along with the upstream request.
+  auto* shadow_stream = new NiceMock<MockShadowStream>();
+  EXPECT_CALL(*shadow_writer_, streamingShadow_("foo", _, _))
+      .WillOnce(Invoke([shadow_stream](const std::string&, Http::RequestHeaderMapPtr& headers,
+                                       const Http::AsyncClient::StreamOptions& options)
+                           -> ShadowStream* {
+        EXPECT_EQ("/", headers->getPathValue());
+        EXPECT_EQ(absl::optional<std::chrono::milliseconds>(10), options.timeout);
+        return shadow_stream;
+      }));
+  EXPECT_CALL(*shadow_writer_, shadow_(_, _, _)).Times(0);
+  Http::TestRequestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, false);
+
+  // The body does not need to be buffered for the shadow, and the upstream request and the shadow
+  // share the data.
+  Buffer::OwnedImpl body_data("hello");
+  const void* upstream_mem = nullptr;
+  EXPECT_CALL(callbacks_, addDecodedData(_, _)).Times(0);
+  EXPECT_CALL(*shadow_stream, sendData(BufferStringEqual("hello"), false))
+      .WillOnce(Invoke([&upstream_mem](Buffer::Instance& data, bool) -> void {
+        upstream_mem = data.frontSlice().mem_;
+      }));
+  EXPECT_CALL(encoder, encodeData(BufferStringEqual("hello"), false))
+      .WillOnce(Invoke([&upstream_mem](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ(upstream_mem, data.frontSlice().mem_);
+      }));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, router_.decodeData(body_data, false));
+
+  Http::TestRequestTrailerMapImpl trailers{{"some", "trailer"}};
+  EXPECT_CALL(*shadow_stream, sendTrailers(HeaderMapEqualRef(&trailers)));
+  expectResponseTimerCreate();
+  router_.decodeTrailers(trailers);
+
+  Http::ResponseHeaderMapPtr response_headers(
+      new Http::TestResponseHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
 TEST_F(RouterTest, AltStatName) {
   // Also test no upstream timeout here.
   EXPECT_CALL(callbacks_.route_->route_entry_, timeout())
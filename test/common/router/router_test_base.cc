@@ -263,6 +263,16 @@ void RouterTestBase::enableHedgeOnPerTryTimeout() {
       envoy::type::v3::FractionalPercent::HUNDRED);
 }
 
+// Enables latency based hedging on a cluster which answered 20 requests in 10ms.
+void RouterTestBase::enableLatencyHedging(double budget_percent) {
+  callbacks_.route_->route_entry_.hedge_policy_.latency_hedging_ =
+      LatencyHedgingConfig{95, std::chrono::milliseconds(1), 10, budget_percent};
+  for (int i = 0; i < 20; ++i) {
+    cm_.thread_local_cluster_.cluster_.info_->response_latency_tracker_.recordLatency(
+        std::chrono::milliseconds(10));
+  }
+}
+
 // Validate that the cluster is appended to the response when configured.
 void RouterTestBase::testAppendCluster(absl::optional<Http::LowerCaseString> cluster_header_name) {
   auto debug_config = std::make_unique<DebugConfig>(
@@ -78,6 +78,7 @@ public:
   void setIncludeAttemptCountInResponse(bool include);
   void setUpstreamMaxStreamDuration(uint32_t seconds);
   void enableHedgeOnPerTryTimeout();
+  void enableLatencyHedging(double budget_percent);
 
   void testAppendCluster(absl::optional<Http::LowerCaseString> cluster_header_name);
   void testAppendUpstreamHost(absl::optional<Http::LowerCaseString> hostname_header_name,
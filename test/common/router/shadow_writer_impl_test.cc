@@ -5,7 +5,10 @@
 #include "source/common/http/message_impl.h"
 #include "source/common/router/shadow_writer_impl.h"
 
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/http/mocks.h"
 #include "test/mocks/upstream/cluster_manager.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -42,8 +45,32 @@ public:
     writer_.shadow("foo", std::move(message), options);
   }
 
+  ShadowStreamPtr expectStreamingShadow() {
+    Http::RequestHeaderMapPtr headers = Http::RequestHeaderMapImpl::create();
+    headers->setHost("cluster1");
+    cm_.initializeThreadLocalClusters({"foo"});
+    EXPECT_CALL(cm_, getThreadLocalCluster(Eq("foo")));
+    EXPECT_CALL(cm_.thread_local_cluster_, httpAsyncClient())
+        .WillOnce(ReturnRef(cm_.thread_local_cluster_.async_client_));
+    auto options = Http::AsyncClient::StreamOptions().setTimeout(std::chrono::milliseconds(5));
+    EXPECT_CALL(cm_.thread_local_cluster_.async_client_, start(_, options))
+        .WillOnce(Invoke(
+            [&](Http::AsyncClient::StreamCallbacks& callbacks,
+                const Http::AsyncClient::StreamOptions&) -> Http::AsyncClient::Stream* {
+              stream_callbacks_ = &callbacks;
+              return &stream_;
+            }));
+    EXPECT_CALL(stream_, sendHeaders(_, false))
+        .WillOnce(Invoke([](Http::RequestHeaderMap& headers, bool) -> void {
+          EXPECT_EQ("cluster1-shadow", headers.getHostValue());
+        }));
+    return writer_.streamingShadow("foo", std::move(headers), options);
+  }
+
   Upstream::MockClusterManager cm_;
   ShadowWriterImpl writer_{cm_};
+  Http::MockAsyncClientStream stream_;
+  Http::AsyncClient::StreamCallbacks* stream_callbacks_{};
   Http::MockAsyncClientRequest request_{&cm_.thread_local_cluster_.async_client_};
   Http::AsyncClient::Callbacks* callback_{};
 };
@@ -73,6 +100,67 @@ TEST_F(ShadowWriterImplTest, NoCluster) {
   writer_.shadow("foo", std::move(message), options);
 }
 
+TEST_F(ShadowWriterImplTest, StreamingSuccess) {
+  InSequence s;
+
+  ShadowStreamPtr shadow_stream = expectStreamingShadow();
+  ASSERT_NE(nullptr, shadow_stream);
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_CALL(stream_, sendData(BufferStringEqual("hello"), false));
+  shadow_stream->sendData(data, false);
+  EXPECT_CALL(stream_, sendTrailers(_));
+  shadow_stream->sendTrailers(Http::TestRequestTrailerMapImpl{{"some", "trailer"}});
+
+  // The request has been sent in full, it is left to complete.
+  EXPECT_CALL(stream_, reset()).Times(0);
+  shadow_stream.reset();
+  stream_callbacks_->onHeaders(
+      Http::ResponseHeaderMapPtr{new Http::TestResponseHeaderMapImpl{{":status", "200"}}}, true);
+  stream_callbacks_->onComplete();
+}
+
+TEST_F(ShadowWriterImplTest, StreamingIncompleteRequest) {
+  InSequence s;
+
+  ShadowStreamPtr shadow_stream = expectStreamingShadow();
+  ASSERT_NE(nullptr, shadow_stream);
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_CALL(stream_, sendData(_, false));
+  shadow_stream->sendData(data, false);
+
+  // The request did not end, the shadow is reset.
+  EXPECT_CALL(stream_, reset()).WillOnce(Invoke([this]() { stream_callbacks_->onReset(); }));
+  shadow_stream.reset();
+}
+
+TEST_F(ShadowWriterImplTest, StreamingRemoteReset) {
+  InSequence s;
+
+  ShadowStreamPtr shadow_stream = expectStreamingShadow();
+  ASSERT_NE(nullptr, shadow_stream);
+  stream_callbacks_->onReset();
+
+  // The rest of the request is dropped.
+  Buffer::OwnedImpl data("hello");
+  EXPECT_CALL(stream_, sendData(_, _)).Times(0);
+  EXPECT_CALL(stream_, reset()).Times(0);
+  shadow_stream->sendData(data, true);
+  EXPECT_EQ(0, data.length());
+  shadow_stream.reset();
+}
+
+TEST_F(ShadowWriterImplTest, StreamingNoCluster) {
+  InSequence s;
+
+  Http::RequestHeaderMapPtr headers = Http::RequestHeaderMapImpl::create();
+  EXPECT_CALL(cm_, getThreadLocalCluster(Eq("foo"))).WillOnce(Return(nullptr));
+  EXPECT_CALL(cm_.thread_local_cluster_, httpAsyncClient()).Times(0);
+  EXPECT_EQ(nullptr, writer_.streamingShadow("foo", std::move(headers),
+                                             Http::AsyncClient::StreamOptions()));
+}
+
 } // namespace
 } // namespace Router
 } // namespace Envoy
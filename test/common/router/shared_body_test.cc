@@ -0,0 +1,61 @@
+#include <memory>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/router/shared_body.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+TEST(SharedBodyChunkTest, SharesData) {
+  Buffer::OwnedImpl data("hello");
+  SharedBodyChunkConstSharedPtr chunk = SharedBodyChunk::create(data);
+  EXPECT_EQ(0, data.length());
+  EXPECT_EQ(5, chunk->length());
+
+  Buffer::OwnedImpl first;
+  Buffer::OwnedImpl second;
+  chunk->addTo(first);
+  chunk->addTo(second);
+  EXPECT_EQ("hello", first.toString());
+  EXPECT_EQ("hello", second.toString());
+  // Both buffers reference the data of the chunk.
+  EXPECT_EQ(first.frontSlice().mem_, second.frontSlice().mem_);
+
+  // The chunk lives until the last buffer referencing it drains its data.
+  std::weak_ptr<const SharedBodyChunk> weak_chunk = chunk;
+  chunk.reset();
+  first.drain(first.length());
+  EXPECT_FALSE(weak_chunk.expired());
+  second.drain(2);
+  EXPECT_FALSE(weak_chunk.expired());
+  EXPECT_EQ("llo", second.toString());
+  second.drain(second.length());
+  EXPECT_TRUE(weak_chunk.expired());
+}
+
+TEST(SharedBodyTest, AddTo) {
+  SharedBody body;
+  Buffer::OwnedImpl buffer;
+  body.addTo(buffer);
+  EXPECT_EQ(0, buffer.length());
+
+  Buffer::OwnedImpl hello("hello");
+  Buffer::OwnedImpl world(" world");
+  body.add(SharedBodyChunk::create(hello));
+  body.add(SharedBodyChunk::create(world));
+  EXPECT_EQ(11, body.length());
+  body.addTo(buffer);
+  EXPECT_EQ("hello world", buffer.toString());
+
+  body.clear();
+  EXPECT_EQ(0, body.length());
+  // The buffer keeps the data alive.
+  EXPECT_EQ("hello world", buffer.toString());
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
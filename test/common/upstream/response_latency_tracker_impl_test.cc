@@ -0,0 +1,102 @@
+#include <chrono>
+
+#include "source/common/upstream/response_latency_tracker_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+TEST(ResponseLatencyTrackerImplTest, Buckets) {
+  // Below 4us, one bucket per microsecond.
+  for (uint64_t micros = 0; micros < 4; ++micros) {
+    EXPECT_EQ(micros, ResponseLatencyTrackerImpl::bucketIndex(micros));
+    EXPECT_EQ(micros + 1, ResponseLatencyTrackerImpl::bucketUpperBound(micros));
+  }
+  // Above, 4 buckets per power of two.
+  EXPECT_EQ(4, ResponseLatencyTrackerImpl::bucketIndex(4));
+  EXPECT_EQ(7, ResponseLatencyTrackerImpl::bucketIndex(7));
+  EXPECT_EQ(8, ResponseLatencyTrackerImpl::bucketIndex(8));
+  EXPECT_EQ(8, ResponseLatencyTrackerImpl::bucketIndex(9));
+  EXPECT_EQ(10, ResponseLatencyTrackerImpl::bucketIndex(12));
+
+  // Every latency falls below the upper bound of its bucket and at or above the one of the
+  // previous bucket.
+  for (uint64_t micros = 1; micros < 1000000; micros = micros * 3 / 2 + 1) {
+    const uint32_t index = ResponseLatencyTrackerImpl::bucketIndex(micros);
+    EXPECT_LT(micros, ResponseLatencyTrackerImpl::bucketUpperBound(index));
+    EXPECT_GE(micros, ResponseLatencyTrackerImpl::bucketUpperBound(index - 1));
+  }
+
+  // Very large latencies end up in the last bucket.
+  EXPECT_EQ(ResponseLatencyTrackerImpl::NumBuckets - 1,
+            ResponseLatencyTrackerImpl::bucketIndex(UINT64_MAX));
+}
+
+TEST(ResponseLatencyTrackerImplTest, Percentile) {
+  ResponseLatencyTrackerImpl tracker;
+  EXPECT_EQ(absl::nullopt, tracker.latencyPercentile(50, 0));
+
+  for (int i = 0; i < 90; ++i) {
+    tracker.recordLatency(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(absl::nullopt, tracker.latencyPercentile(50, 100));
+  for (int i = 0; i < 10; ++i) {
+    tracker.recordLatency(std::chrono::milliseconds(100));
+  }
+
+  // 1ms falls in [896us, 1024us), 100ms in [98304us, 114688us).
+  EXPECT_EQ(std::chrono::microseconds(1024), tracker.latencyPercentile(50, 100));
+  EXPECT_EQ(std::chrono::microseconds(1024), tracker.latencyPercentile(90, 100));
+  EXPECT_EQ(std::chrono::microseconds(114688), tracker.latencyPercentile(95, 100));
+  EXPECT_EQ(std::chrono::microseconds(114688), tracker.latencyPercentile(100, 100));
+}
+
+TEST(ResponseLatencyTrackerImplTest, Decay) {
+  ResponseLatencyTrackerImpl tracker;
+  for (uint64_t i = 0; i < ResponseLatencyTrackerImpl::DecaySamples - 1; ++i) {
+    tracker.recordLatency(std::chrono::milliseconds(100));
+  }
+  EXPECT_TRUE(tracker.latencyPercentile(50, ResponseLatencyTrackerImpl::DecaySamples - 1));
+
+  // The counters are halved once the tracker holds DecaySamples samples, after which recent
+  // samples take over.
+  tracker.recordLatency(std::chrono::milliseconds(100));
+  EXPECT_EQ(absl::nullopt,
+            tracker.latencyPercentile(50, ResponseLatencyTrackerImpl::DecaySamples / 2 + 1));
+  for (uint64_t i = 0; i < ResponseLatencyTrackerImpl::DecaySamples / 2 + 1; ++i) {
+    tracker.recordLatency(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(std::chrono::microseconds(1024), tracker.latencyPercentile(50, 1));
+}
+
+TEST(ResponseLatencyTrackerImplTest, HedgeBudget) {
+  ResponseLatencyTrackerImpl tracker;
+  EXPECT_FALSE(tracker.hedgeBudgetAvailable(10));
+
+  for (int i = 0; i < 100; ++i) {
+    tracker.recordLatency(std::chrono::milliseconds(1));
+  }
+  // Checking the budget doesn't charge it.
+  EXPECT_TRUE(tracker.hedgeBudgetAvailable(10));
+  EXPECT_TRUE(tracker.hedgeBudgetAvailable(10));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(tracker.hedgeBudgetAvailable(10));
+    tracker.recordHedge();
+  }
+  EXPECT_FALSE(tracker.hedgeBudgetAvailable(10));
+  EXPECT_TRUE(tracker.hedgeBudgetAvailable(20));
+
+  // More samples make room for more hedges.
+  for (int i = 0; i < 20; ++i) {
+    tracker.recordLatency(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(tracker.hedgeBudgetAvailable(10));
+  tracker.recordHedge();
+  EXPECT_FALSE(tracker.hedgeBudgetAvailable(10));
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
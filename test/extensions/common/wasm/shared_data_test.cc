@@ -0,0 +1,70 @@
+#include "source/extensions/common/wasm/shared_data.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace Wasm {
+namespace {
+
+TEST(SharedDataTest, GetAndSet) {
+  SharedData shared_data;
+  std::pair<std::string, uint32_t> data;
+  EXPECT_EQ(WasmResult::NotFound, shared_data.get("vm_id", "key", &data));
+
+  EXPECT_EQ(WasmResult::Ok, shared_data.set("vm_id", "key", "value", 0));
+  EXPECT_EQ(WasmResult::Ok, shared_data.get("vm_id", "key", &data));
+  EXPECT_EQ("value", data.first);
+  EXPECT_NE(0, data.second);
+
+  // Values are separate by VM id and key.
+  EXPECT_EQ(WasmResult::NotFound, shared_data.get("other_vm_id", "key", &data));
+  EXPECT_EQ(WasmResult::NotFound, shared_data.get("vm_id", "other_key", &data));
+}
+
+TEST(SharedDataTest, CompareAndSwap) {
+  SharedData shared_data;
+  std::pair<std::string, uint32_t> data;
+  // A key without a value is set whatever the cas.
+  EXPECT_EQ(WasmResult::Ok, shared_data.set("vm_id", "key", "value1", 12345));
+  EXPECT_EQ(WasmResult::Ok, shared_data.get("vm_id", "key", &data));
+  const uint32_t cas = data.second;
+
+  EXPECT_EQ(WasmResult::Ok, shared_data.set("vm_id", "key", "value2", cas));
+  EXPECT_EQ(WasmResult::Ok, shared_data.get("vm_id", "key", &data));
+  EXPECT_EQ("value2", data.first);
+  EXPECT_NE(cas, data.second);
+
+  // The value has changed since cas was read.
+  EXPECT_EQ(WasmResult::CasMismatch, shared_data.set("vm_id", "key", "value3", cas));
+  EXPECT_EQ(WasmResult::Ok, shared_data.get("vm_id", "key", &data));
+  EXPECT_EQ("value2", data.first);
+
+  // A cas of 0 sets the value unconditionally.
+  EXPECT_EQ(WasmResult::Ok, shared_data.set("vm_id", "key", "value4", 0));
+  EXPECT_EQ(WasmResult::Ok, shared_data.get("vm_id", "key", &data));
+  EXPECT_EQ("value4", data.first);
+}
+
+TEST(SharedDataTest, DeletedWithLastVm) {
+  SharedData shared_data;
+  std::pair<std::string, uint32_t> data;
+  shared_data.addVm("vm_id");
+  shared_data.addVm("vm_id");
+  shared_data.addVm("other_vm_id");
+  EXPECT_EQ(WasmResult::Ok, shared_data.set("vm_id", "key", "value", 0));
+  EXPECT_EQ(WasmResult::Ok, shared_data.set("other_vm_id", "key", "value", 0));
+
+  shared_data.removeVm("vm_id");
+  EXPECT_EQ(WasmResult::Ok, shared_data.get("vm_id", "key", &data));
+  shared_data.removeVm("vm_id");
+  EXPECT_EQ(WasmResult::NotFound, shared_data.get("vm_id", "key", &data));
+  EXPECT_EQ(WasmResult::Ok, shared_data.get("other_vm_id", "key", &data));
+}
+
+} // namespace
+} // namespace Wasm
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
@@ -19,40 +19,62 @@ using bazel::tools::cpp::runfiles::Runfiles;
 
 namespace Envoy {
 
-void bmWasmSpeedTest(benchmark::State& state) {
-  Envoy::Thread::MutexBasicLockable lock;
-  Envoy::Logger::Context logging_state(spdlog::level::warn,
-                                       Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock, false);
-  Envoy::Logger::Registry::getLog(Envoy::Logger::Id::wasm).set_level(spdlog::level::off);
-  Envoy::Stats::IsolatedStoreImpl stats_store;
-  Envoy::Api::ApiPtr api = Envoy::Api::createApiForTest(stats_store);
-  Envoy::Upstream::MockClusterManager cluster_manager;
-  Envoy::Event::DispatcherPtr dispatcher(api->allocateDispatcher("wasm_test"));
-  auto scope = Envoy::Stats::ScopeSharedPtr(stats_store.createScope("wasm."));
-  proxy_wasm::AllowedCapabilitiesMap allowed_capabilities;
-
-  envoy::extensions::wasm::v3::PluginConfig plugin_config;
-  *plugin_config.mutable_vm_config()->mutable_runtime() = "envoy.wasm.runtime.null";
-  auto config = Envoy::Extensions::Common::Wasm::WasmConfig(plugin_config);
-  auto wasm = std::make_unique<Envoy::Extensions::Common::Wasm::Wasm>(config, "", scope, *api,
-                                                                      cluster_manager, *dispatcher);
-
-  auto context = std::make_shared<Envoy::Extensions::Common::Wasm::Context>(wasm.get());
+namespace {
+
+// Exposes the request headers of the context, as if the VM were processing them.
+class HeadersContext : public Envoy::Extensions::Common::Wasm::Context {
+public:
+  using Envoy::Extensions::Common::Wasm::Context::Context;
+
+  void setRequestHeaders(Envoy::Http::RequestHeaderMap* headers) { request_headers_ = headers; }
+};
+
+class WasmSpeedTest {
+public:
+  WasmSpeedTest()
+      : logging_state_(spdlog::level::warn, Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock_,
+                       false),
+        api_(Envoy::Api::createApiForTest(stats_store_)),
+        dispatcher_(api_->allocateDispatcher("wasm_test")),
+        scope_(stats_store_.createScope("wasm.")) {
+    Envoy::Logger::Registry::getLog(Envoy::Logger::Id::wasm).set_level(spdlog::level::off);
+    envoy::extensions::wasm::v3::PluginConfig plugin_config;
+    *plugin_config.mutable_vm_config()->mutable_runtime() = "envoy.wasm.runtime.null";
+    auto config = Envoy::Extensions::Common::Wasm::WasmConfig(plugin_config);
+    wasm_ = std::make_unique<Envoy::Extensions::Common::Wasm::Wasm>(
+        config, "", scope_, *api_, cluster_manager_, *dispatcher_);
+    context_ = std::make_shared<HeadersContext>(wasm_.get());
+  }
+
+  Envoy::Thread::MutexBasicLockable lock_;
+  Envoy::Logger::Context logging_state_;
+  Envoy::Stats::IsolatedStoreImpl stats_store_;
+  Envoy::Api::ApiPtr api_;
+  Envoy::Upstream::MockClusterManager cluster_manager_;
+  Envoy::Event::DispatcherPtr dispatcher_;
+  Envoy::Stats::ScopeSharedPtr scope_;
+  std::unique_ptr<Envoy::Extensions::Common::Wasm::Wasm> wasm_;
+  std::shared_ptr<HeadersContext> context_;
+};
+
+// Gets and sets shared data from 10 threads, either all on the same key or each on its own key.
+void sharedDataSpeedTest(benchmark::State& state, bool distinct_keys) {
+  WasmSpeedTest test;
   Envoy::Thread::ThreadFactory& thread_factory{Envoy::Thread::threadFactoryForTest()};
-  std::pair<std::string, uint32_t> data;
   int n_threads = 10;
 
   for (__attribute__((unused)) auto _ : state) {
-    auto thread_fn = [&]() {
-      for (int i = 0; i < 1000000; i++) {
-        context->getSharedData("foo", &data);
-        context->setSharedData("foo", "bar", 1);
-      }
-      return new uint32_t(42);
-    };
     std::vector<Envoy::Thread::ThreadPtr> threads;
     for (int i = 0; i < n_threads; ++i) {
       std::string name = absl::StrCat("thread", i);
+      const std::string key = distinct_keys ? name : "foo";
+      auto thread_fn = [&test, key]() {
+        std::pair<std::string, uint32_t> data;
+        for (int j = 0; j < 1000000; j++) {
+          test.context_->getSharedData(key, &data);
+          test.context_->setSharedData(key, "bar", 0);
+        }
+      };
       threads.emplace_back(thread_factory.createThread(thread_fn, Envoy::Thread::Options{name}));
     }
     for (auto& thread : threads) {
@@ -61,8 +83,101 @@ void bmWasmSpeedTest(benchmark::State& state) {
   }
 }
 
+Envoy::Http::TestRequestHeaderMapImpl requestHeaders() {
+  return {{":method", "GET"},
+          {":path", "/api/v1/users"},
+          {":scheme", "https"},
+          {":authority", "api.example.com"},
+          {"user-agent", "curl/7.79.1"},
+          {"accept", "application/json"},
+          {"x-request-id", "4d2f7c3a"},
+          {"x-tenant", "acme"}};
+}
+
+} // namespace
+
+void bmWasmSpeedTest(benchmark::State& state) { sharedDataSpeedTest(state, false); }
 BENCHMARK(bmWasmSpeedTest);
 
+void bmSharedDataDistinctKeys(benchmark::State& state) { sharedDataSpeedTest(state, true); }
+BENCHMARK(bmSharedDataDistinctKeys);
+
+// Reads every request header with one host call per header.
+void bmGetHeaderMapValues(benchmark::State& state) {
+  WasmSpeedTest test;
+  auto headers = requestHeaders();
+  test.context_->setRequestHeaders(&headers);
+  std::vector<std::string> keys;
+  headers.iterate([&keys](const Envoy::Http::HeaderEntry& header) {
+    keys.emplace_back(header.key().getStringView());
+    return Envoy::Http::HeaderMap::Iterate::Continue;
+  });
+
+  for (__attribute__((unused)) auto _ : state) {
+    for (const auto& key : keys) {
+      std::string_view value;
+      test.context_->getHeaderMapValue(proxy_wasm::WasmHeaderMapType::RequestHeaders, key,
+                                       &value);
+      benchmark::DoNotOptimize(value);
+    }
+  }
+}
+BENCHMARK(bmGetHeaderMapValues);
+
+// Reads every request header with a single host call.
+void bmGetHeaderMapPairs(benchmark::State& state) {
+  WasmSpeedTest test;
+  auto headers = requestHeaders();
+  test.context_->setRequestHeaders(&headers);
+  proxy_wasm::Pairs pairs;
+
+  for (__attribute__((unused)) auto _ : state) {
+    test.context_->getHeaderMapPairs(proxy_wasm::WasmHeaderMapType::RequestHeaders, &pairs);
+    benchmark::DoNotOptimize(pairs);
+  }
+}
+BENCHMARK(bmGetHeaderMapPairs);
+
+// Rewrites every request header with one host call per header.
+void bmReplaceHeaderMapValues(benchmark::State& state) {
+  WasmSpeedTest test;
+  auto headers = requestHeaders();
+  test.context_->setRequestHeaders(&headers);
+  std::vector<std::pair<std::string, std::string>> rewritten;
+  headers.iterate([&rewritten](const Envoy::Http::HeaderEntry& header) {
+    rewritten.emplace_back(header.key().getStringView(),
+                           absl::StrCat(header.value().getStringView(), "-rewritten"));
+    return Envoy::Http::HeaderMap::Iterate::Continue;
+  });
+
+  for (__attribute__((unused)) auto _ : state) {
+    for (const auto& [key, value] : rewritten) {
+      test.context_->replaceHeaderMapValue(proxy_wasm::WasmHeaderMapType::RequestHeaders, key,
+                                           value);
+    }
+  }
+}
+BENCHMARK(bmReplaceHeaderMapValues);
+
+// Rewrites every request header with a single host call.
+void bmSetHeaderMapPairs(benchmark::State& state) {
+  WasmSpeedTest test;
+  auto headers = requestHeaders();
+  test.context_->setRequestHeaders(&headers);
+  std::vector<std::pair<std::string, std::string>> rewritten;
+  headers.iterate([&rewritten](const Envoy::Http::HeaderEntry& header) {
+    rewritten.emplace_back(header.key().getStringView(),
+                           absl::StrCat(header.value().getStringView(), "-rewritten"));
+    return Envoy::Http::HeaderMap::Iterate::Continue;
+  });
+  proxy_wasm::Pairs pairs(rewritten.begin(), rewritten.end());
+
+  for (__attribute__((unused)) auto _ : state) {
+    test.context_->setHeaderMapPairs(proxy_wasm::WasmHeaderMapType::RequestHeaders, pairs);
+  }
+}
+BENCHMARK(bmSetHeaderMapPairs);
+
 } // namespace Envoy
 
 int main(int argc, char** argv) {
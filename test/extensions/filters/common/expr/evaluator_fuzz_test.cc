@@ -44,8 +44,14 @@ DEFINE_PROTO_FUZZER(const test::extensions::filters::common::expr::EvaluatorTest
 
     // Evaluate the CEL expression.
     Protobuf::Arena arena;
-    Expr::evaluate(*expr, arena, *stream_info, &request_headers, &response_headers,
-                   &response_trailers);
+    const absl::optional<CelValue> result = Expr::evaluate(
+        *expr, arena, *stream_info, &request_headers, &response_headers, &response_trailers);
+
+    // The short-circuit evaluation of the expression as a condition agrees with the interpreter.
+    Expr::Condition condition(*builder, input.expression());
+    FUZZ_ASSERT(condition.matches(*stream_info, &request_headers, &response_headers,
+                                  &response_trailers) ==
+                (result.has_value() && result->IsBool() && result->BoolOrDie()));
   } catch (const CelException& e) {
     ENVOY_LOG_MISC(debug, "CelException: {}", e.what());
   }
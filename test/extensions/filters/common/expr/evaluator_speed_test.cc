@@ -0,0 +1,153 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "source/extensions/filters/common/expr/evaluator.h"
+
+#include "test/common/stream_info/test_util.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace Expr {
+
+namespace {
+
+using ExprProto = google::api::expr::v1alpha1::Expr;
+
+ExprProto ident(const std::string& name) {
+  ExprProto expr;
+  expr.mutable_ident_expr()->set_name(name);
+  return expr;
+}
+
+ExprProto select(ExprProto operand, const std::string& field) {
+  ExprProto expr;
+  *expr.mutable_select_expr()->mutable_operand() = std::move(operand);
+  expr.mutable_select_expr()->set_field(field);
+  return expr;
+}
+
+ExprProto stringConstant(const std::string& value) {
+  ExprProto expr;
+  expr.mutable_const_expr()->set_string_value(value);
+  return expr;
+}
+
+ExprProto call(const std::string& function, std::vector<ExprProto> args) {
+  ExprProto expr;
+  expr.mutable_call_expr()->set_function(function);
+  for (auto& arg : args) {
+    *expr.mutable_call_expr()->add_args() = std::move(arg);
+  }
+  return expr;
+}
+
+ExprProto requestHeader(const std::string& name) {
+  return call("_[_]", {select(ident("request"), "headers"), stringConstant(name)});
+}
+
+ExprProto equal(ExprProto attribute, const std::string& value) {
+  return call("_==_", {std::move(attribute), stringConstant(value)});
+}
+
+// The conditions of typical RBAC policies, all evaluated on each request.
+std::vector<ExprProto> policies() {
+  return {
+      call("_&&_", {equal(requestHeader("x-tenant"), "acme"),
+                    equal(select(ident("request"), "method"), "GET")}),
+      call("_||_", {equal(select(ident("request"), "path"), "/api/v1/users"),
+                    equal(select(ident("request"), "host"), "api.example.com")}),
+      call("!_", {equal(requestHeader("x-debug"), "true")}),
+      equal(select(ident("connection"), "requested_server_name"), "api.example.com"),
+      call("_&&_", {equal(requestHeader("user-agent"), "curl/7.79.1"),
+                    call("!_", {equal(select(ident("request"), "scheme"), "http")})}),
+  };
+}
+
+class PolicyBenchmark {
+public:
+  PolicyBenchmark() : builder_(createBuilder(nullptr)), exprs_(policies()) {
+    for (const auto& expr : exprs_) {
+      expressions_.push_back(createExpression(*builder_, expr));
+      conditions_.push_back(createCondition(*builder_, expr));
+    }
+  }
+
+  BuilderPtr builder_;
+  const std::vector<ExprProto> exprs_;
+  std::vector<ExpressionPtr> expressions_;
+  std::vector<ConditionPtr> conditions_;
+  Event::SimulatedTimeSystem time_system_;
+  const Http::TestRequestHeaderMapImpl headers_{{":method", "GET"},
+                                                {":path", "/api/v1/users"},
+                                                {":scheme", "https"},
+                                                {":authority", "api.example.com"},
+                                                {"user-agent", "curl/7.79.1"},
+                                                {"x-debug", "false"},
+                                                {"x-tenant", "acme"}};
+};
+
+} // namespace
+
+// Evaluates the policies with the interpreter and an activation per evaluation.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_InterpretedPolicies(benchmark::State& state) {
+  PolicyBenchmark benchmark;
+  size_t matched = 0;
+  for (auto _ : state) { // NOLINT
+    TestStreamInfo info(benchmark.time_system_);
+    for (const auto& expression : benchmark.expressions_) {
+      Protobuf::Arena arena;
+      auto result = evaluate(*expression, arena, info, &benchmark.headers_, nullptr, nullptr);
+      matched += result.has_value() && result->IsBool() && result->BoolOrDie();
+    }
+  }
+  benchmark::DoNotOptimize(matched);
+}
+BENCHMARK(BM_InterpretedPolicies);
+
+// Evaluates the policies with the interpreter and the activation reused by the request.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_InterpretedPoliciesStreamActivation(benchmark::State& state) {
+  PolicyBenchmark benchmark;
+  size_t matched = 0;
+  for (auto _ : state) { // NOLINT
+    TestStreamInfo info(benchmark.time_system_);
+    StreamActivation::getOrCreate(info);
+    for (const auto& expression : benchmark.expressions_) {
+      Protobuf::Arena arena;
+      auto result = evaluate(*expression, arena, info, &benchmark.headers_, nullptr, nullptr);
+      matched += result.has_value() && result->IsBool() && result->BoolOrDie();
+    }
+  }
+  benchmark::DoNotOptimize(matched);
+}
+BENCHMARK(BM_InterpretedPoliciesStreamActivation);
+
+// Evaluates the policies as conditions, short-circuiting the interpreter, with the activation
+// reused by the request.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_ConditionPoliciesStreamActivation(benchmark::State& state) {
+  PolicyBenchmark benchmark;
+  size_t matched = 0;
+  for (auto _ : state) { // NOLINT
+    TestStreamInfo info(benchmark.time_system_);
+    StreamActivation::getOrCreate(info);
+    for (const auto& condition : benchmark.conditions_) {
+      matched += condition->matches(info, &benchmark.headers_, nullptr, nullptr);
+    }
+  }
+  benchmark::DoNotOptimize(matched);
+}
+BENCHMARK(BM_ConditionPoliciesStreamActivation);
+
+} // namespace Expr
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
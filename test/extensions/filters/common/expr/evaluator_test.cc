@@ -1,5 +1,7 @@
 #include "source/extensions/filters/common/expr/evaluator.h"
 
+#include "test/common/stream_info/test_util.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
 #include "absl/time/time.h"
@@ -40,6 +42,157 @@ TEST(Evaluator, Print) {
   EXPECT_EQ(print(CelValue::CreateError(&status)), "CelError value");
 }
 
+using ExprProto = google::api::expr::v1alpha1::Expr;
+
+ExprProto ident(const std::string& name) {
+  ExprProto expr;
+  expr.mutable_ident_expr()->set_name(name);
+  return expr;
+}
+
+ExprProto select(ExprProto operand, const std::string& field) {
+  ExprProto expr;
+  *expr.mutable_select_expr()->mutable_operand() = std::move(operand);
+  expr.mutable_select_expr()->set_field(field);
+  return expr;
+}
+
+ExprProto stringConstant(const std::string& value) {
+  ExprProto expr;
+  expr.mutable_const_expr()->set_string_value(value);
+  return expr;
+}
+
+ExprProto boolConstant(bool value) {
+  ExprProto expr;
+  expr.mutable_const_expr()->set_bool_value(value);
+  return expr;
+}
+
+ExprProto call(const std::string& function, std::vector<ExprProto> args) {
+  ExprProto expr;
+  expr.mutable_call_expr()->set_function(function);
+  for (auto& arg : args) {
+    *expr.mutable_call_expr()->add_args() = std::move(arg);
+  }
+  return expr;
+}
+
+// request.headers[name]
+ExprProto requestHeader(const std::string& name) {
+  return call("_[_]", {select(ident("request"), "headers"), stringConstant(name)});
+}
+
+class ConditionTest : public testing::Test {
+public:
+  ConditionTest() : builder_(createBuilder(nullptr)), info_(time_system_) {}
+
+  bool matches(const ExprProto& expr, const Http::RequestHeaderMap& headers) {
+    exprs_.push_back(std::make_unique<ExprProto>(expr));
+    auto condition = createCondition(*builder_, *exprs_.back());
+    short_circuited_ = condition->shortCircuited();
+    return condition->matches(info_, &headers, nullptr, nullptr);
+  }
+
+  BuilderPtr builder_;
+  Event::SimulatedTimeSystem time_system_;
+  TestStreamInfo info_;
+  std::vector<std::unique_ptr<ExprProto>> exprs_;
+  bool short_circuited_{};
+};
+
+TEST_F(ConditionTest, ShortCircuitComparisons) {
+  // request.headers['x-tenant'] == 'acme' && request.method != 'POST'
+  const ExprProto expr =
+      call("_&&_", {call("_==_", {requestHeader("x-tenant"), stringConstant("acme")}),
+                    call("_!=_", {select(ident("request"), "method"), stringConstant("POST")})});
+
+  EXPECT_TRUE(matches(expr, Http::TestRequestHeaderMapImpl{{":method", "GET"},
+                                                           {"x-tenant", "acme"}}));
+  EXPECT_TRUE(short_circuited_);
+  EXPECT_FALSE(matches(expr, Http::TestRequestHeaderMapImpl{{":method", "POST"},
+                                                            {"x-tenant", "acme"}}));
+  EXPECT_FALSE(
+      matches(expr, Http::TestRequestHeaderMapImpl{{":method", "GET"}, {"x-tenant", "other"}}));
+  // The comparison of a missing header is an error, which the interpreter handles.
+  EXPECT_FALSE(matches(expr, Http::TestRequestHeaderMapImpl{{":method", "GET"}}));
+}
+
+TEST_F(ConditionTest, MissingAttributeIsAnError) {
+  // !('true' == request.headers['x-debug']) fails to evaluate without the header.
+  const ExprProto expr =
+      call("!_", {call("_==_", {stringConstant("true"), requestHeader("x-debug")})});
+
+  EXPECT_TRUE(matches(expr, Http::TestRequestHeaderMapImpl{{"x-debug", "false"}}));
+  EXPECT_FALSE(matches(expr, Http::TestRequestHeaderMapImpl{{"x-debug", "true"}}));
+  EXPECT_FALSE(matches(expr, Http::TestRequestHeaderMapImpl{}));
+
+  // A false operand of a conjunction decides the result even if the other fails to evaluate.
+  const ExprProto conjunction =
+      call("_&&_", {expr, call("_==_", {requestHeader("x-tenant"), stringConstant("acme")})});
+  EXPECT_FALSE(matches(conjunction, Http::TestRequestHeaderMapImpl{{"x-tenant", "other"}}));
+}
+
+TEST_F(ConditionTest, ConstantFolding) {
+  const ExprProto comparison = call("_==_", {requestHeader("x-tenant"), stringConstant("acme")});
+
+  EXPECT_TRUE(matches(call("_||_", {comparison, boolConstant(true)}),
+                      Http::TestRequestHeaderMapImpl{}));
+  EXPECT_TRUE(short_circuited_);
+  EXPECT_FALSE(matches(call("_&&_", {call("!_", {boolConstant(true)}), comparison}),
+                       Http::TestRequestHeaderMapImpl{{"x-tenant", "acme"}}));
+  EXPECT_TRUE(short_circuited_);
+  EXPECT_TRUE(matches(call("_&&_", {boolConstant(true), comparison}),
+                      Http::TestRequestHeaderMapImpl{{"x-tenant", "acme"}}));
+  EXPECT_TRUE(short_circuited_);
+}
+
+TEST_F(ConditionTest, Interpreted) {
+  // request.headers['x-tenant'] == 'acme' || request.headers['x-tenant'] in ['a', 'b']
+  ExprProto list;
+  *list.mutable_list_expr()->add_elements() = stringConstant("a");
+  *list.mutable_list_expr()->add_elements() = stringConstant("b");
+  const ExprProto expr =
+      call("_||_", {call("_==_", {requestHeader("x-tenant"), stringConstant("acme")}),
+                    call("@in", {requestHeader("x-tenant"), list})});
+
+  EXPECT_TRUE(matches(expr, Http::TestRequestHeaderMapImpl{{"x-tenant", "b"}}));
+  EXPECT_FALSE(short_circuited_);
+  EXPECT_FALSE(matches(expr, Http::TestRequestHeaderMapImpl{{"x-tenant", "c"}}));
+}
+
+TEST_F(ConditionTest, StreamActivation) {
+  const StreamActivation* activation = StreamActivation::getOrCreate(info_);
+  ASSERT_NE(nullptr, activation);
+  EXPECT_EQ(activation, StreamActivation::getOrCreate(info_));
+  EXPECT_EQ(activation, StreamActivation::get(info_));
+
+  // The shared activation is bound to the headers of each evaluation.
+  const ExprProto expr = call("_==_", {requestHeader("x-tenant"), stringConstant("acme")});
+  EXPECT_TRUE(matches(expr, Http::TestRequestHeaderMapImpl{{"x-tenant", "acme"}}));
+  EXPECT_FALSE(matches(expr, Http::TestRequestHeaderMapImpl{{"x-tenant", "other"}}));
+
+  Protobuf::Arena arena;
+  Http::TestRequestHeaderMapImpl headers{{"x-tenant", "acme"}};
+  auto compiled = createExpression(*builder_, expr);
+  auto result = evaluate(*compiled, arena, info_, &headers, nullptr, nullptr);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_TRUE(result->BoolOrDie());
+
+  // The activation of another request is not shared.
+  TestStreamInfo other_info(time_system_);
+  EXPECT_EQ(nullptr, StreamActivation::get(other_info));
+
+  // The stream recreated by an internal redirect inherits the filter state of the request, but
+  // creates an activation of its own.
+  TestStreamInfo redirected_info(time_system_);
+  redirected_info.filter_state_ = std::make_shared<StreamInfo::FilterStateImpl>(
+      info_.filterState()->parent(), StreamInfo::FilterState::LifeSpan::FilterChain);
+  const StreamActivation* redirected_activation = StreamActivation::getOrCreate(redirected_info);
+  ASSERT_NE(nullptr, redirected_activation);
+  EXPECT_NE(activation, redirected_activation);
+}
+
 } // namespace
 } // namespace Expr
 } // namespace Common
@@ -160,6 +160,52 @@ TEST_F(LuaTest, MarkDead) {
   lua_gc(cr1->luaState(), LUA_GCCOLLECT, 0);
 }
 
+// Scripts precompiled to bytecode are loaded as is.
+TEST_F(LuaTest, PrecompiledBytecode) {
+  const std::string SCRIPT{R"EOF(
+    function callMe(object)
+      object:testCall()
+    end
+  )EOF"};
+
+  std::string bytecode;
+  {
+    CSmartPtr<lua_State, lua_close> state(luaL_newstate());
+    ASSERT_EQ(0, luaL_loadstring(state.get(), SCRIPT.c_str()));
+    lua_dump(
+        state.get(),
+        [](lua_State*, const void* chunk, size_t size, void* data) -> int {
+          static_cast<std::string*>(data)->append(static_cast<const char*>(chunk), size);
+          return 0;
+        },
+        &bytecode);
+  }
+  EXPECT_TRUE(ThreadLocalState::isBytecode(bytecode));
+  EXPECT_FALSE(ThreadLocalState::isBytecode(SCRIPT));
+
+  InSequence s;
+  setup(bytecode);
+  EXPECT_NE(LUA_REFNIL, state_->getGlobalRef(state_->registerGlobal("callMe", initializers_)));
+
+  CoroutinePtr cr(state_->createCoroutine());
+  LuaRef<TestObject> ref(TestObject::create(cr->luaState()), true);
+  EXPECT_CALL(*ref.get(), doTestCall(_));
+  cr->start(state_->getGlobalRef(0), 1, yield_callback_);
+  EXPECT_EQ(cr->state(), Coroutine::State::Finished);
+
+  EXPECT_CALL(*ref.get(), onDestroy());
+  ref.reset();
+  lua_gc(cr->luaState(), LUA_GCCOLLECT, 0);
+}
+
+// Corrupt bytecode and invalid source fail to load.
+TEST_F(LuaTest, LoadErrors) {
+  EXPECT_THROW_WITH_REGEX(setup(std::string("\033Lua\0garbage", 12)), LuaException,
+                          "script load error: .*");
+  EXPECT_THROW_WITH_REGEX(setup("function callMe("), LuaException, "script load error: .*");
+  EXPECT_THROW_WITH_REGEX(setup("error('failed')"), LuaException, "script load error: .*failed");
+}
+
 class ThreadSafeTest : public testing::Test {
 public:
   ThreadSafeTest()
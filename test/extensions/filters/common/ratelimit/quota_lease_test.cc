@@ -0,0 +1,387 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/common/ratelimit/v3/ratelimit.pb.h"
+#include "envoy/service/ratelimit/v3/rls.pb.h"
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/common/tracing/null_span_impl.h"
+#include "source/extensions/filters/common/ratelimit/quota_lease.h"
+
+#include "test/extensions/filters/common/ratelimit/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RateLimit {
+namespace {
+
+class MockRequestCallbacks : public RequestCallbacks {
+public:
+  void complete(LimitStatus status, DescriptorStatusListPtr&&, Http::ResponseHeaderMapPtr&&,
+                Http::RequestHeaderMapPtr&&, const std::string&, DynamicMetadataPtr&&) override {
+    complete_(status);
+  }
+
+  MOCK_METHOD(void, complete_, (LimitStatus status));
+};
+
+class QuotaLeasesTest : public testing::Test {
+public:
+  QuotaLeasesTest()
+      : async_client_(new Grpc::MockAsyncClient()),
+        stats_{ALL_QUOTA_LEASE_STATS(POOL_COUNTER_PREFIX(store_, "ratelimit.quota_lease."))} {}
+
+  void initialize(const std::string& yaml) {
+    envoy::extensions::common::ratelimit::v3::QuotaLease config;
+    TestUtility::loadFromYaml(yaml, config);
+    leases_ = std::make_unique<QuotaLeases>(config, Grpc::RawAsyncClientPtr{async_client_},
+                                            absl::nullopt, time_system_, stats_);
+  }
+
+  // Expects a request leasing a block of hits of a descriptor, and keeps its callbacks.
+  void expectLeaseRequest(const Envoy::RateLimit::Descriptor& descriptor, uint32_t block_size) {
+    envoy::service::ratelimit::v3::RateLimitRequest request;
+    GrpcClientImpl::createRequest(request, "domain", {descriptor});
+    request.set_hits_addend(block_size);
+    EXPECT_CALL(*async_client_, sendRaw(_, _, Grpc::ProtoBufferEq(request), _, _, _))
+        .WillOnce(Invoke([this](absl::string_view, absl::string_view, Buffer::InstancePtr&&,
+                                Grpc::RawAsyncRequestCallbacks& callbacks, Tracing::Span&,
+                                const Http::AsyncClient::RequestOptions&) -> Grpc::AsyncRequest* {
+          callbacks_ = dynamic_cast<RateLimitAsyncCallbacks*>(&callbacks);
+          return &async_request_;
+        }));
+  }
+
+  void respond(envoy::service::ratelimit::v3::RateLimitResponse::Code code) {
+    auto response = std::make_unique<envoy::service::ratelimit::v3::RateLimitResponse>();
+    response->set_overall_code(code);
+    callbacks_->onSuccess(std::move(response), Tracing::NullSpan::instance());
+  }
+
+  bool consume(const std::vector<Envoy::RateLimit::Descriptor>& descriptors) {
+    return leases_->consume("domain", descriptors);
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl store_;
+  Grpc::MockAsyncClient* async_client_;
+  NiceMock<Grpc::MockAsyncRequest> async_request_;
+  RateLimitAsyncCallbacks* callbacks_{};
+  QuotaLeaseStats stats_;
+  std::unique_ptr<QuotaLeases> leases_;
+  const Envoy::RateLimit::Descriptor descriptor_{{{"key", "value"}}};
+  const Envoy::RateLimit::Descriptor other_descriptor_{{{"key", "other_value"}}};
+};
+
+TEST_F(QuotaLeasesTest, LeaseAfterMinRequests) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 3
+  )EOF");
+
+  EXPECT_FALSE(consume({descriptor_}));
+  EXPECT_FALSE(consume({descriptor_}));
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  // A single lease request is in flight.
+  EXPECT_FALSE(consume({descriptor_}));
+
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+  EXPECT_EQ(1U, stats_.lease_granted_.value());
+  // The leased hits become available over the period.
+  EXPECT_FALSE(consume({descriptor_}));
+  time_system_.advanceTimeWait(std::chrono::milliseconds(200));
+  EXPECT_TRUE(consume({descriptor_}));
+  EXPECT_TRUE(consume({descriptor_}));
+  EXPECT_FALSE(consume({descriptor_}));
+  EXPECT_EQ(2U, stats_.leased_request_.value());
+
+  // Other descriptors have their own leases.
+  EXPECT_FALSE(consume({other_descriptor_}));
+}
+
+TEST_F(QuotaLeasesTest, DefaultMinRequestsIsBlockSize) {
+  initialize(R"EOF(
+  block_size: 2
+  )EOF");
+
+  EXPECT_FALSE(consume({descriptor_}));
+  expectLeaseRequest(descriptor_, 2);
+  EXPECT_FALSE(consume({descriptor_}));
+}
+
+TEST_F(QuotaLeasesTest, RenewBusyLease) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1000));
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_TRUE(consume({descriptor_}));
+  // The hits of the lease remain available while it is renewed.
+  EXPECT_TRUE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+  EXPECT_EQ(2U, stats_.lease_granted_.value());
+}
+
+TEST_F(QuotaLeasesTest, SpendOnlyGrantedHits) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  // The hits of the first grant are spent while the lease is renewed.
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1000));
+  expectLeaseRequest(descriptor_, 10);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(consume({descriptor_}));
+  }
+  EXPECT_FALSE(consume({descriptor_}));
+
+  // The new hits are paced from the grant, rather than from the last hit spent.
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+  EXPECT_FALSE(consume({descriptor_}));
+  time_system_.advanceTimeWait(std::chrono::milliseconds(500));
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(consume({descriptor_}));
+  }
+  EXPECT_FALSE(consume({descriptor_}));
+
+  // After a quiet gap shorter than a period, the bucket paces more hits than the 5 left.
+  time_system_.advanceTimeWait(std::chrono::milliseconds(900));
+  expectLeaseRequest(descriptor_, 10);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(consume({descriptor_}));
+  }
+  EXPECT_FALSE(consume({descriptor_}));
+  EXPECT_EQ(20U, stats_.leased_request_.value());
+}
+
+TEST_F(QuotaLeasesTest, RenewalDenied) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1000));
+  expectLeaseRequest(descriptor_, 10);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(consume({descriptor_}));
+  }
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OVER_LIMIT);
+  EXPECT_EQ(1U, stats_.lease_denied_.value());
+
+  // The hits left from the first grant can still be spent, but no more.
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(consume({descriptor_}));
+  }
+  EXPECT_FALSE(consume({descriptor_}));
+  time_system_.advanceTimeWait(std::chrono::milliseconds(500));
+  EXPECT_FALSE(consume({descriptor_}));
+  EXPECT_EQ(10U, stats_.leased_request_.value());
+}
+
+TEST_F(QuotaLeasesTest, DropQuietLease) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 2
+  period: 0.5s
+  )EOF");
+
+  EXPECT_FALSE(consume({descriptor_}));
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(500));
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_TRUE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+
+  // The descriptor received fewer requests than the minimum in the last period.
+  time_system_.advanceTimeWait(std::chrono::milliseconds(500));
+  EXPECT_FALSE(consume({descriptor_}));
+  EXPECT_EQ(2U, stats_.lease_granted_.value());
+}
+
+TEST_F(QuotaLeasesTest, LeaseDenied) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OVER_LIMIT);
+  EXPECT_EQ(1U, stats_.lease_denied_.value());
+
+  // No lease is requested again before the end of the period.
+  time_system_.advanceTimeWait(std::chrono::milliseconds(500));
+  EXPECT_FALSE(consume({descriptor_}));
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(500));
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+}
+
+TEST_F(QuotaLeasesTest, LeaseError) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  callbacks_->onFailure(Grpc::Status::Unavailable, "", Tracing::NullSpan::instance());
+  EXPECT_EQ(1U, stats_.lease_error_.value());
+
+  EXPECT_FALSE(consume({descriptor_}));
+}
+
+TEST_F(QuotaLeasesTest, AllDescriptorsLeased) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+  expectLeaseRequest(other_descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_, other_descriptor_}));
+  time_system_.advanceTimeWait(std::chrono::milliseconds(500));
+
+  // Only one of the descriptors has a lease.
+  EXPECT_TRUE(consume({descriptor_}));
+  EXPECT_FALSE(consume({descriptor_, other_descriptor_}));
+}
+
+TEST_F(QuotaLeasesTest, TrackOnlyBusyDescriptors) {
+  initialize(R"EOF(
+  block_size: 10
+  )EOF");
+
+  for (int i = 0; i < 100; i++) {
+    const Envoy::RateLimit::Descriptor descriptor{{{"key", absl::StrCat("value", i)}}};
+    EXPECT_FALSE(consume({descriptor}));
+  }
+  EXPECT_EQ(0U, leases_->size());
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1000));
+  for (int i = 0; i < 9; i++) {
+    EXPECT_FALSE(consume({descriptor_}));
+  }
+  EXPECT_EQ(0U, leases_->size());
+
+  // The requests are counted per period.
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1000));
+  for (int i = 0; i < 9; i++) {
+    EXPECT_FALSE(consume({descriptor_}));
+  }
+  EXPECT_EQ(0U, leases_->size());
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  EXPECT_EQ(1U, leases_->size());
+}
+
+TEST_F(QuotaLeasesTest, RemoveIdleDescriptors) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OVER_LIMIT);
+  expectLeaseRequest(other_descriptor_, 10);
+  EXPECT_FALSE(consume({other_descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OVER_LIMIT);
+  EXPECT_EQ(2U, leases_->size());
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1000));
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OVER_LIMIT);
+  EXPECT_EQ(2U, leases_->size());
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1000));
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  EXPECT_EQ(1U, leases_->size());
+}
+
+TEST_F(QuotaLeasesTest, CancelOnDestruction) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_FALSE(consume({descriptor_}));
+  EXPECT_CALL(async_request_, cancel());
+  leases_.reset();
+}
+
+TEST_F(QuotaLeasesTest, Client) {
+  initialize(R"EOF(
+  block_size: 10
+  min_requests_per_period: 1
+  )EOF");
+
+  auto* inner_client = new MockClient();
+  QuotaLeaseClient client(ClientPtr{inner_client}, *leases_);
+  MockRequestCallbacks request_callbacks;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info;
+
+  // Without a lease, the request is sent to the rate limit service.
+  expectLeaseRequest(descriptor_, 10);
+  EXPECT_CALL(*inner_client, limit(_, "domain", _, _, _));
+  client.limit(request_callbacks, "domain", {descriptor_}, Tracing::NullSpan::instance(),
+               stream_info);
+  EXPECT_CALL(*inner_client, cancel());
+  client.cancel();
+
+  // With a lease, the request completes at once.
+  respond(envoy::service::ratelimit::v3::RateLimitResponse::OK);
+  time_system_.advanceTimeWait(std::chrono::milliseconds(500));
+  EXPECT_CALL(*inner_client, limit(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(request_callbacks, complete_(LimitStatus::OK));
+  client.limit(request_callbacks, "domain", {descriptor_}, Tracing::NullSpan::instance(),
+               stream_info);
+}
+
+} // namespace
+} // namespace RateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
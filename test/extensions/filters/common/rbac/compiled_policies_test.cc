@@ -0,0 +1,278 @@
+#include "envoy/config/rbac/v3/rbac.pb.h"
+
+#include "source/common/network/utility.h"
+#include "source/extensions/filters/common/expr/evaluator.h"
+#include "source/extensions/filters/common/rbac/compiled_policies.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Const;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+namespace {
+
+class CompiledPoliciesTest : public testing::Test {
+public:
+  void compile(const std::string& yaml) {
+    TestUtility::loadFromYaml(yaml, rbac_);
+    policies_ = std::make_unique<CompiledPolicies>(rbac_.policies(), builder_.get(),
+                                                   ProtobufMessage::getStrictValidationVisitor());
+  }
+
+  std::string firstMatch() {
+    const std::string* policy = policies_->firstMatch(connection_, headers_, info_);
+    return policy == nullptr ? "" : *policy;
+  }
+
+  void setLocalAddress(const std::string& ip, uint32_t port) {
+    info_.downstream_connection_info_provider_->setLocalAddress(
+        Network::Utility::parseInternetAddress(ip, port, false));
+  }
+
+  Expr::BuilderPtr builder_;
+  envoy::config::rbac::v3::RBAC rbac_;
+  std::unique_ptr<CompiledPolicies> policies_;
+  NiceMock<Network::MockConnection> connection_;
+  Http::TestRequestHeaderMapImpl headers_;
+  NiceMock<StreamInfo::MockStreamInfo> info_;
+};
+
+// Identical rules are compiled once, whatever the policy using them.
+TEST_F(CompiledPoliciesTest, SharesIdenticalRules) {
+  compile(R"EOF(
+policies:
+  a:
+    permissions:
+    - destination_port: 80
+    - and_rules:
+        rules:
+        - header: { name: x-foo, present_match: true }
+        - not_rule: { destination_port: 81 }
+    principals:
+    - any: true
+  b:
+    permissions:
+    - and_rules:
+        rules:
+        - header: { name: x-foo, present_match: true }
+        - not_rule: { destination_port: 81 }
+    principals:
+    - any: true
+)EOF");
+
+  // Leaves: port 80, header, port 81, any. Composites: not, and, the permissions of a, those of b
+  // and the principals shared by both.
+  EXPECT_EQ(9, policies_->rules());
+}
+
+TEST_F(CompiledPoliciesTest, IndexesPoliciesByRequirement) {
+  compile(R"EOF(
+policies:
+  exact_path:
+    permissions:
+    - url_path: { path: { exact: /foo } }
+    principals:
+    - any: true
+  port:
+    permissions:
+    - and_rules:
+        rules:
+        - any: true
+        - destination_port: 80
+    principals:
+    - any: true
+  ip:
+    permissions:
+    - any: true
+    principals:
+    - or_ids:
+        ids:
+        - source_ip: { address_prefix: 10.0.0.0, prefix_len: 8 }
+        - source_ip: { address_prefix: 192.168.0.0, prefix_len: 16 }
+  prefix_path:
+    permissions:
+    - url_path: { path: { prefix: /foo } }
+    principals:
+    - any: true
+  mixed:
+    permissions:
+    - destination_port: 80
+    - url_path: { path: { exact: /foo } }
+    principals:
+    - any: true
+  ignore_case:
+    permissions:
+    - url_path: { path: { exact: /foo, ignore_case: true } }
+    principals:
+    - any: true
+)EOF");
+
+  EXPECT_EQ(3, policies_->unindexedPolicies());
+}
+
+// The first policy matching in name order is returned, whether it is indexed or not.
+TEST_F(CompiledPoliciesTest, FirstMatchInNameOrder) {
+  compile(R"EOF(
+policies:
+  a_path:
+    permissions:
+    - url_path: { path: { exact: /foo } }
+    principals:
+    - any: true
+  b_any:
+    permissions:
+    - any: true
+    principals:
+    - any: true
+  c_port:
+    permissions:
+    - destination_port: 80
+    principals:
+    - any: true
+)EOF");
+  setLocalAddress("1.2.3.4", 80);
+
+  headers_.setPath("/foo?bar");
+  EXPECT_EQ("a_path", firstMatch());
+  headers_.setPath("/bar");
+  EXPECT_EQ("b_any", firstMatch());
+}
+
+TEST_F(CompiledPoliciesTest, MatchesIndexedPolicies) {
+  compile(R"EOF(
+policies:
+  path:
+    permissions:
+    - url_path: { path: { exact: /foo } }
+    principals:
+    - any: true
+  port:
+    permissions:
+    - destination_port: 80
+    principals:
+    - any: true
+  ip:
+    permissions:
+    - any: true
+    principals:
+    - source_ip: { address_prefix: 10.0.0.0, prefix_len: 8 }
+)EOF");
+  EXPECT_EQ(0, policies_->unindexedPolicies());
+
+  setLocalAddress("1.2.3.4", 443);
+  EXPECT_EQ("", firstMatch());
+
+  headers_.setPath("/foo");
+  EXPECT_EQ("path", firstMatch());
+  headers_.setPath("/foo/bar");
+  EXPECT_EQ("", firstMatch());
+
+  setLocalAddress("1.2.3.4", 80);
+  EXPECT_EQ("port", firstMatch());
+
+  connection_.stream_info_.downstream_connection_info_provider_->setRemoteAddress(
+      Network::Utility::parseInternetAddress("10.1.2.3", 1234, false));
+  EXPECT_EQ("ip", firstMatch());
+}
+
+// A policy matches if any of its permissions and any of its principals match.
+TEST_F(CompiledPoliciesTest, MatchesPermissionsAndPrincipals) {
+  compile(R"EOF(
+policies:
+  a:
+    permissions:
+    - destination_port: 123
+    - destination_port: 456
+    principals:
+    - authenticated: { principal_name: { exact: foo } }
+    - authenticated: { principal_name: { exact: bar } }
+)EOF");
+
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  const std::vector<std::string> uri_sans{"bar", "baz"};
+  const std::vector<std::string> dns_sans;
+  const std::string subject = "subject";
+  ON_CALL(*ssl, uriSanPeerCertificate()).WillByDefault(Return(uri_sans));
+  ON_CALL(*ssl, dnsSansPeerCertificate()).WillByDefault(Return(dns_sans));
+  ON_CALL(*ssl, subjectPeerCertificate()).WillByDefault(ReturnRef(subject));
+
+  ON_CALL(Const(connection_), ssl()).WillByDefault(Return(ssl));
+  setLocalAddress("1.2.3.4", 456);
+  EXPECT_EQ("a", firstMatch());
+
+  setLocalAddress("1.2.3.4", 789);
+  EXPECT_EQ("", firstMatch());
+
+  ON_CALL(Const(connection_), ssl()).WillByDefault(Return(nullptr));
+  setLocalAddress("1.2.3.4", 456);
+  EXPECT_EQ("", firstMatch());
+}
+
+// A policy with a condition only matches if the condition holds.
+TEST_F(CompiledPoliciesTest, MatchesCondition) {
+  builder_ = Expr::createBuilder(nullptr);
+  compile(R"EOF(
+policies:
+  a:
+    permissions:
+    - any: true
+    principals:
+    - any: true
+    condition:
+      const_expr: { bool_value: false }
+  b:
+    permissions:
+    - any: true
+    principals:
+    - any: true
+    condition:
+      const_expr: { bool_value: true }
+)EOF");
+
+  EXPECT_EQ("b", firstMatch());
+}
+
+// A rule shared by several policies is evaluated once per request.
+TEST_F(CompiledPoliciesTest, EvaluatesSharedRulesOnce) {
+  compile(R"EOF(
+policies:
+  a:
+    permissions:
+    - header: { name: x-foo, present_match: true }
+    principals:
+    - authenticated: {}
+  b:
+    permissions:
+    - any: true
+    principals:
+    - authenticated: {}
+  c:
+    permissions:
+    - any: true
+    principals:
+    - not_id: { authenticated: {} }
+)EOF");
+
+  headers_.addCopy("x-foo", "bar");
+  EXPECT_CALL(Const(connection_), ssl()).WillOnce(Return(nullptr));
+  EXPECT_EQ("c", firstMatch());
+}
+
+} // namespace
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,83 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "envoy/config/rbac/v3/rbac.pb.h"
+
+#include "source/common/common/fmt.h"
+#include "source/common/network/utility.h"
+#include "source/extensions/filters/common/rbac/engine_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+static constexpr int PolicyCount = 1000;
+
+// Policies allowing a path each, for the clients of a network, and only for GET requests. With
+// exact paths the policies are indexed, with prefixes they are all evaluated.
+static envoy::config::rbac::v3::RBAC policies(bool exact_paths) {
+  envoy::config::rbac::v3::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v3::RBAC::ALLOW);
+  for (int i = 0; i < PolicyCount; ++i) {
+    envoy::config::rbac::v3::Policy policy;
+    auto* rules = policy.add_permissions()->mutable_and_rules();
+    auto* path = rules->add_rules()->mutable_url_path()->mutable_path();
+    if (exact_paths) {
+      path->set_exact(fmt::format("/api/v1/resource/{}", i));
+    } else {
+      path->set_prefix(fmt::format("/api/v1/resource/{}/", i));
+    }
+    auto* method = rules->add_rules()->mutable_header();
+    method->set_name(":method");
+    method->mutable_string_match()->set_exact("GET");
+    auto* source_ip = policy.add_principals()->mutable_source_ip();
+    source_ip->set_address_prefix("10.0.0.0");
+    source_ip->mutable_prefix_len()->set_value(8);
+    (*rbac.mutable_policies())[fmt::format("policy-{}", i)] = policy;
+  }
+  return rbac;
+}
+
+static void engineHandleAction(benchmark::State& state, bool exact_paths) {
+  RoleBasedAccessControlEngineImpl engine(policies(exact_paths),
+                                          ProtobufMessage::getStrictValidationVisitor());
+  NiceMock<Network::MockConnection> connection;
+  connection.stream_info_.downstream_connection_info_provider_->setRemoteAddress(
+      Network::Utility::parseInternetAddress("10.1.2.3", 1234, false));
+  NiceMock<StreamInfo::MockStreamInfo> info;
+  Http::TestRequestHeaderMapImpl headers{
+      {":method", "GET"},
+      {":path", exact_paths ? "/api/v1/resource/999" : "/api/v1/resource/999/"}};
+
+  for (auto _ : state) { // NOLINT
+    benchmark::DoNotOptimize(engine.handleAction(connection, headers, info, nullptr));
+  }
+}
+
+// Policies indexed by their exact path, a single one is evaluated.
+static void bmEngineIndexedPolicies(benchmark::State& state) { engineHandleAction(state, true); }
+BENCHMARK(bmEngineIndexedPolicies);
+
+// Unindexed policies, all evaluated, sharing the method and source IP rules.
+static void bmEngineUnindexedPolicies(benchmark::State& state) {
+  engineHandleAction(state, false);
+}
+BENCHMARK(bmEngineUnindexedPolicies);
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -6,7 +6,6 @@
 
 #include "source/common/network/address_impl.h"
 #include "source/common/network/utility.h"
-#include "source/extensions/filters/common/expr/evaluator.h"
 #include "source/extensions/filters/common/rbac/matchers.h"
 
 #include "test/mocks/network/mocks.h"
@@ -417,46 +416,6 @@ TEST(MetadataMatcher, MetadataMatcher) {
   checkMatcher(MetadataMatcher(matcher), true, conn, header, info);
 }
 
-TEST(PolicyMatcher, PolicyMatcher) {
-  envoy::config::rbac::v3::Policy policy;
-  policy.add_permissions()->set_destination_port(123);
-  policy.add_permissions()->set_destination_port(456);
-  policy.add_principals()->mutable_authenticated()->mutable_principal_name()->set_exact("foo");
-  policy.add_principals()->mutable_authenticated()->mutable_principal_name()->set_exact("bar");
-  Expr::BuilderPtr builder = Expr::createBuilder(nullptr);
-
-  RBAC::PolicyMatcher matcher(policy, builder.get(), ProtobufMessage::getStrictValidationVisitor());
-
-  Envoy::Network::MockConnection conn;
-  Envoy::Http::TestRequestHeaderMapImpl headers;
-  NiceMock<StreamInfo::MockStreamInfo> info;
-  auto ssl = std::make_shared<Ssl::MockConnectionInfo>();
-  Envoy::Network::Address::InstanceConstSharedPtr addr =
-      Envoy::Network::Utility::parseInternetAddress("1.2.3.4", 456, false);
-
-  const std::vector<std::string> uri_sans{"bar", "baz"};
-  const std::vector<std::string> dns_sans;
-  const std::string subject = "subject";
-  EXPECT_CALL(*ssl, uriSanPeerCertificate()).Times(4).WillRepeatedly(Return(uri_sans));
-  EXPECT_CALL(*ssl, dnsSansPeerCertificate()).WillRepeatedly(Return(dns_sans));
-  EXPECT_CALL(*ssl, subjectPeerCertificate()).WillRepeatedly(ReturnRef(subject));
-
-  EXPECT_CALL(Const(conn), ssl()).Times(2).WillRepeatedly(Return(ssl));
-  info.downstream_connection_info_provider_->setLocalAddress(addr);
-
-  checkMatcher(matcher, true, conn, headers, info);
-
-  EXPECT_CALL(Const(conn), ssl()).Times(2).WillRepeatedly(Return(nullptr));
-  info.downstream_connection_info_provider_->setLocalAddress(addr);
-
-  checkMatcher(matcher, false, conn, headers, info);
-
-  addr = Envoy::Network::Utility::parseInternetAddress("1.2.3.4", 789, false);
-  info.downstream_connection_info_provider_->setLocalAddress(addr);
-
-  checkMatcher(matcher, false, conn, headers, info);
-}
-
 TEST(RequestedServerNameMatcher, ValidRequestedServerName) {
   Envoy::Network::MockConnection conn;
   EXPECT_CALL(conn, requestedServerName())
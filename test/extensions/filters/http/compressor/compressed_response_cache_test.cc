@@ -0,0 +1,150 @@
+#include "envoy/extensions/cache/simple_http_cache/v3/config.pb.h"
+
+#include "source/extensions/filters/http/cache/simple_http_cache/simple_http_cache.h"
+#include "source/extensions/filters/http/compressor/compressed_response_cache.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+namespace {
+
+class CompressedResponseCacheTest : public testing::Test {
+public:
+  CompressedResponseConstSharedPtr lookup(CompressedResponseCache& cache, const std::string& path,
+                                          const std::string& encoding = "gzip") {
+    Http::TestRequestHeaderMapImpl headers{
+        {":method", "GET"}, {":scheme", "https"}, {":authority", "host"}, {":path", path}};
+    lookup_ = cache.lookup(headers, encoding, decoder_callbacks_);
+    EXPECT_TRUE(lookup_->completed());
+    return lookup_->response();
+  }
+
+  void insert(CompressedResponseCache& cache, const std::string& etag, const std::string& body) {
+    cache.insert(*lookup_,
+                 std::make_shared<const CompressedResponse>(CompressedResponse{etag, body}),
+                 encoder_callbacks_);
+  }
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  CompressedResponseLookupSharedPtr lookup_;
+};
+
+TEST_F(CompressedResponseCacheTest, InMemoryLookupAndInsert) {
+  InMemoryCompressedResponseCache cache(1024, 1024);
+  EXPECT_EQ(nullptr, lookup(cache, "/a.js"));
+  insert(cache, "\"v1\"", "compressed");
+
+  CompressedResponseConstSharedPtr response = lookup(cache, "/a.js");
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ("\"v1\"", response->etag_);
+  EXPECT_EQ("compressed", response->body_);
+  // The variants of other encodings and resources are distinct.
+  EXPECT_EQ(nullptr, lookup(cache, "/a.js", "br"));
+  EXPECT_EQ(nullptr, lookup(cache, "/b.js"));
+
+  // A new version of the resource replaces the previous one.
+  lookup(cache, "/a.js");
+  insert(cache, "\"v2\"", "compressed again");
+  EXPECT_EQ("\"v2\"", lookup(cache, "/a.js")->etag_);
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(16, cache.cacheBytes());
+}
+
+TEST_F(CompressedResponseCacheTest, InMemoryEvictsLeastRecentlyUsed) {
+  InMemoryCompressedResponseCache cache(10, 1024);
+  lookup(cache, "/a.js");
+  insert(cache, "a", "aaaa");
+  lookup(cache, "/b.js");
+  insert(cache, "b", "bbbb");
+  // Makes /b.js the least recently used.
+  EXPECT_NE(nullptr, lookup(cache, "/a.js"));
+
+  lookup(cache, "/c.js");
+  insert(cache, "c", "cccc");
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(8, cache.cacheBytes());
+  EXPECT_NE(nullptr, lookup(cache, "/a.js"));
+  EXPECT_EQ(nullptr, lookup(cache, "/b.js"));
+  EXPECT_NE(nullptr, lookup(cache, "/c.js"));
+
+  // A response larger than the cache is not inserted.
+  lookup(cache, "/d.js");
+  insert(cache, "d", "ddddddddddddddd");
+  EXPECT_EQ(2, cache.size());
+}
+
+// The dispatcher of the mock callbacks runs the completions of the cache inline.
+TEST_F(CompressedResponseCacheTest, HttpCacheLookupAndInsert) {
+  Event::SimulatedTimeSystem time_system;
+  HttpCacheCompressedResponseCache cache(std::make_shared<Cache::SimpleHttpCache>(), time_system,
+                                         1024);
+  EXPECT_EQ(nullptr, lookup(cache, "/a.js"));
+  insert(cache, "\"v1\"", "compressed");
+  lookup_->onDestroy();
+
+  CompressedResponseConstSharedPtr response = lookup(cache, "/a.js");
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ("\"v1\"", response->etag_);
+  EXPECT_EQ("compressed", response->body_);
+  EXPECT_EQ(nullptr, lookup(cache, "/a.js", "br"));
+  EXPECT_EQ(nullptr, lookup(cache, "/b.js"));
+}
+
+TEST_F(CompressedResponseCacheTest, HttpCacheSkipsLargeResponses) {
+  Event::SimulatedTimeSystem time_system;
+  HttpCacheCompressedResponseCache cache(std::make_shared<Cache::SimpleHttpCache>(), time_system,
+                                         4);
+  lookup(cache, "/a.js");
+  insert(cache, "\"v1\"", "compressed");
+  EXPECT_EQ(nullptr, lookup(cache, "/a.js"));
+}
+
+TEST(CacheableUrlsTest, InsertAndContains) {
+  CacheableUrls urls;
+  Http::TestRequestHeaderMapImpl a{{":scheme", "https"}, {":authority", "host"}, {":path", "/a"}};
+  Http::TestRequestHeaderMapImpl b{{":scheme", "https"}, {":authority", "host"}, {":path", "/b"}};
+  Http::TestRequestHeaderMapImpl http_a{
+      {":scheme", "http"}, {":authority", "host"}, {":path", "/a"}};
+  EXPECT_NE(0, CacheableUrls::hash(a));
+  EXPECT_NE(CacheableUrls::hash(a), CacheableUrls::hash(b));
+  EXPECT_NE(CacheableUrls::hash(a), CacheableUrls::hash(http_a));
+
+  EXPECT_FALSE(urls.contains(CacheableUrls::hash(a)));
+  urls.insert(CacheableUrls::hash(a));
+  EXPECT_TRUE(urls.contains(CacheableUrls::hash(a)));
+  EXPECT_FALSE(urls.contains(CacheableUrls::hash(b)));
+}
+
+TEST_F(CompressedResponseCacheTest, CreateFromConfig) {
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  envoy::extensions::filters::http::compressor::v3::Compressor::CompressedResponseCache config;
+  EXPECT_NE(nullptr, dynamic_cast<InMemoryCompressedResponseCache*>(
+                         createCompressedResponseCache(config, context).get()));
+
+  config.mutable_http_cache()->mutable_typed_config()->PackFrom(
+      envoy::extensions::cache::simple_http_cache::v3::SimpleHttpCacheConfig());
+  EXPECT_NE(nullptr, dynamic_cast<HttpCacheCompressedResponseCache*>(
+                         createCompressedResponseCache(config, context).get()));
+
+  config.mutable_http_cache()->mutable_typed_config()->PackFrom(
+      envoy::extensions::filters::http::compressor::v3::Compressor());
+  EXPECT_THROW_WITH_REGEX(createCompressedResponseCache(config, context), EnvoyException,
+                          "Didn't find a registered implementation for type");
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -59,13 +59,14 @@ public:
   }
 
   // CompressorFilterTest Helpers
-  void setUpFilter(std::string&& json) {
+  void setUpFilter(std::string&& json, CompressedResponseCacheSharedPtr response_cache = nullptr) {
     envoy::extensions::filters::http::compressor::v3::Compressor compressor;
     TestUtility::loadFromJson(json, compressor);
     auto compressor_factory = std::make_unique<TestCompressorFactory>("test");
     compressor_factory_ = compressor_factory.get();
     config_ = std::make_shared<CompressorFilterConfig>(compressor, "test.", stats_, runtime_,
-                                                       std::move(compressor_factory));
+                                                       std::move(compressor_factory),
+                                                       std::move(response_cache));
     filter_ = std::make_unique<CompressorFilter>(config_);
     filter_->setDecoderFilterCallbacks(decoder_callbacks_);
     filter_->setEncoderFilterCallbacks(encoder_callbacks_);
@@ -412,6 +413,139 @@ TEST_F(CompressorFilterTest, RemoveAcceptEncodingHeader) {
   }
 }
 
+class CompressedResponseCacheTest : public CompressorFilterTest {
+public:
+  void SetUp() override {
+    response_cache_ = std::make_shared<InMemoryCompressedResponseCache>(1024 * 1024, 512);
+    setUpFilter(R"EOF(
+{
+  "compressor_library": {
+     "name": "test",
+     "typed_config": {
+       "@type": "type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip"
+     }
+  }
+}
+)EOF",
+                response_cache_);
+  }
+
+  // Proxies a request for a static asset through a new filter, and returns the response headers.
+  // The body sent downstream is left in data_.
+  Http::TestResponseHeaderMapImpl doCachedResponse(const std::string& etag, uint64_t size,
+                                                   bool with_trailers = false,
+                                                   const std::string& vary = "") {
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"},
+                                                   {":authority", "host"},
+                                                   {":path", "/static.js"},
+                                                   {"accept-encoding", "test"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+    Http::TestResponseHeaderMapImpl headers{
+        {":status", "200"}, {"content-length", absl::StrCat(size)}, {"etag", etag}};
+    if (!vary.empty()) {
+      headers.addCopy("vary", vary);
+    }
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    populateBuffer(size);
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, !with_trailers));
+    if (with_trailers) {
+      EXPECT_CALL(encoder_callbacks_, addEncodedData(_, true))
+          .WillOnce(Invoke([&](Buffer::Instance& data, bool) { data_.move(data); }));
+      Http::TestResponseTrailerMapImpl trailers;
+      EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+    }
+    filter_->onDestroy();
+    return headers;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_.counter(absl::StrCat("test.compressor.test.test.", name)).value();
+  }
+
+  std::shared_ptr<InMemoryCompressedResponseCache> response_cache_;
+};
+
+// The compressed response is cached, and served in place of the next identical responses.
+TEST_F(CompressedResponseCacheTest, CompressOnce) {
+  // The cache is only looked up for the URLs which received a response with a strong entity tag.
+  doCachedResponse("\"v1\"", 256);
+  EXPECT_EQ(0, counter("response_cache_miss"));
+  EXPECT_EQ(0, response_cache_->size());
+
+  doCachedResponse("\"v1\"", 256);
+  const std::string compressed = data_.toString();
+  EXPECT_EQ(1, counter("response_cache_miss"));
+  EXPECT_EQ(1, counter("response_cache_insert"));
+  EXPECT_EQ(1, response_cache_->size());
+
+  // The upstream body is dropped, the cached one is served without creating a compressor.
+  compressor_factory_->setExpectedCompressCalls(0);
+  Http::TestResponseHeaderMapImpl headers = doCachedResponse("\"v1\"", 256);
+  EXPECT_EQ(compressed, data_.toString());
+  EXPECT_EQ("256", headers.get_("content-length"));
+  EXPECT_EQ("test", headers.get_("content-encoding"));
+  EXPECT_FALSE(headers.has("etag"));
+  EXPECT_EQ(1, counter("response_cache_hit"));
+  EXPECT_EQ(3, counter("compressed"));
+  EXPECT_EQ(768, counter("total_uncompressed_bytes"));
+  EXPECT_EQ(768, counter("total_compressed_bytes"));
+
+  // The cached response is served with trailers as well.
+  doCachedResponse("\"v1\"", 256, true);
+  EXPECT_EQ(compressed, data_.toString());
+  EXPECT_EQ(2, counter("response_cache_hit"));
+}
+
+// A new entity tag means a new version of the resource, which is compressed and replaces the
+// cached one.
+TEST_F(CompressedResponseCacheTest, EtagChanged) {
+  doCachedResponse("\"v1\"", 256);
+  doCachedResponse("\"v1\"", 256);
+  // The compressor is called for the body and then for the trailers.
+  compressor_factory_->setExpectedCompressCalls(2);
+  doCachedResponse("\"v2\"", 256, true);
+  const std::string compressed = data_.toString();
+  EXPECT_EQ(2, counter("response_cache_miss"));
+  EXPECT_EQ(2, counter("response_cache_insert"));
+
+  compressor_factory_->setExpectedCompressCalls(0);
+  doCachedResponse("\"v2\"", 256);
+  EXPECT_EQ(compressed, data_.toString());
+  EXPECT_EQ(1, counter("response_cache_hit"));
+}
+
+TEST_F(CompressedResponseCacheTest, NotCached) {
+  // Weak entity tags don't guarantee that the bodies are identical.
+  doCachedResponse("W/\"v1\"", 256);
+  doCachedResponse("W/\"v1\"", 256);
+  EXPECT_EQ(0, counter("response_cache_miss"));
+  // Compressed responses larger than the maximum entry size are not cached.
+  doCachedResponse("\"v1\"", 1024);
+  doCachedResponse("\"v1\"", 1024);
+  EXPECT_EQ(1, counter("response_cache_miss"));
+  EXPECT_EQ(0, counter("response_cache_insert"));
+  EXPECT_EQ(0, response_cache_->size());
+}
+
+// The cache is keyed by URL and content encoding, responses varying on other request headers are
+// not cached.
+TEST_F(CompressedResponseCacheTest, Vary) {
+  doCachedResponse("\"v1\"", 256, false, "Cookie");
+  doCachedResponse("\"v1\"", 256, false, "Accept-Encoding, Cookie");
+  EXPECT_EQ(0, counter("response_cache_miss"));
+  EXPECT_EQ(0, response_cache_->size());
+
+  doCachedResponse("\"v1\"", 256, false, "accept-encoding");
+  doCachedResponse("\"v1\"", 256, false, "accept-encoding");
+  EXPECT_EQ(1, counter("response_cache_miss"));
+  EXPECT_EQ(1, counter("response_cache_insert"));
+  EXPECT_EQ(1, response_cache_->size());
+}
+
 class IsAcceptEncodingAllowedTest
     : public CompressorFilterTest,
       public testing::WithParamInterface<std::tuple<std::string, bool, int, int, int, int>> {};
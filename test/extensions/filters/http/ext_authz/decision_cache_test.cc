@@ -0,0 +1,276 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/filters/http/ext_authz/v3/ext_authz.pb.h"
+
+#include "source/extensions/filters/http/ext_authz/decision_cache.h"
+
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+namespace {
+
+using Filters::Common::ExtAuthz::CheckStatus;
+using Filters::Common::ExtAuthz::Response;
+
+class DecisionCacheTest : public testing::Test {
+public:
+  void initialize(const std::string& yaml) {
+    envoy::extensions::filters::http::ext_authz::v3::DecisionCache config;
+    TestUtility::loadFromYaml(yaml, config);
+    cache_ = std::make_unique<DecisionCache>(config);
+  }
+
+  std::string key(const Http::RequestHeaderMap& headers) {
+    return cache_->key(headers, stream_info_, context_extensions_);
+  }
+
+  static Response okResponse() {
+    Response response{};
+    response.status = CheckStatus::OK;
+    response.headers_to_set = Http::HeaderVector{{Http::LowerCaseString{"x-user-id"}, "42"}};
+    return response;
+  }
+
+  std::unique_ptr<DecisionCache> cache_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  Protobuf::Map<std::string, std::string> context_extensions_;
+  const MonotonicTime now_{std::chrono::seconds(1000)};
+};
+
+TEST_F(DecisionCacheTest, KeyFromHeaders) {
+  initialize(R"EOF(
+  key_attributes:
+  - request_header: x-user
+  - request_header: :method
+  )EOF");
+
+  const std::string alice_get =
+      key(Http::TestRequestHeaderMapImpl{{":method", "GET"}, {"x-user", "alice"}});
+  EXPECT_EQ(alice_get, key(Http::TestRequestHeaderMapImpl{
+                           {":method", "GET"}, {"x-user", "alice"}, {"x-other", "value"}}));
+  EXPECT_NE(alice_get,
+            key(Http::TestRequestHeaderMapImpl{{":method", "POST"}, {"x-user", "alice"}}));
+  EXPECT_NE(alice_get, key(Http::TestRequestHeaderMapImpl{{":method", "GET"}, {"x-user", "bob"}}));
+  EXPECT_NE(alice_get, key(Http::TestRequestHeaderMapImpl{{":method", "GET"}}));
+  EXPECT_NE(alice_get, key(Http::TestRequestHeaderMapImpl{
+                           {":method", "GET"}, {"x-user", "alice"}, {"x-user", "bob"}}));
+  // A missing header differs from an empty one.
+  EXPECT_NE(key(Http::TestRequestHeaderMapImpl{{":method", "GET"}}),
+            key(Http::TestRequestHeaderMapImpl{{":method", "GET"}, {"x-user", ""}}));
+}
+
+TEST_F(DecisionCacheTest, KeyFromPath) {
+  initialize(R"EOF(
+  key_attributes:
+  - path: {}
+  )EOF");
+
+  EXPECT_EQ(key(Http::TestRequestHeaderMapImpl{{":path", "/users/1"}}),
+            key(Http::TestRequestHeaderMapImpl{{":path", "/users/1?verbose=true"}}));
+  EXPECT_NE(key(Http::TestRequestHeaderMapImpl{{":path", "/users/1"}}),
+            key(Http::TestRequestHeaderMapImpl{{":path", "/users/2"}}));
+  EXPECT_NE(key(Http::TestRequestHeaderMapImpl{{":path", ""}}),
+            key(Http::TestRequestHeaderMapImpl{}));
+}
+
+TEST_F(DecisionCacheTest, KeyFromPathTemplate) {
+  initialize(R"EOF(
+  key_attributes:
+  - path:
+      rewrite:
+        pattern:
+          regex: "^/users/[^/]+/"
+        substitution: "/users/*/"
+  )EOF");
+
+  EXPECT_EQ(key(Http::TestRequestHeaderMapImpl{{":path", "/users/1/orders"}}),
+            key(Http::TestRequestHeaderMapImpl{{":path", "/users/2/orders?page=3"}}));
+  EXPECT_NE(key(Http::TestRequestHeaderMapImpl{{":path", "/users/1/orders"}}),
+            key(Http::TestRequestHeaderMapImpl{{":path", "/users/1/profile"}}));
+}
+
+TEST_F(DecisionCacheTest, KeyFromConnection) {
+  initialize(R"EOF(
+  key_attributes:
+  - requested_server_name: true
+  - peer_identity: true
+  )EOF");
+
+  const Http::TestRequestHeaderMapImpl headers;
+  const std::string no_tls = key(headers);
+
+  stream_info_.downstream_connection_info_provider_->setRequestedServerName("a.example.com");
+  const std::string sni = key(headers);
+  EXPECT_NE(no_tls, sni);
+
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  const std::vector<std::string> uri_sans{"spiffe://example.com/alice"};
+  const std::vector<std::string> other_uri_sans{"spiffe://example.com/bob"};
+  EXPECT_CALL(*ssl, peerCertificatePresented()).WillRepeatedly(Return(true));
+  EXPECT_CALL(*ssl, uriSanPeerCertificate())
+      .WillOnce(Return(uri_sans))
+      .WillOnce(Return(uri_sans))
+      .WillOnce(Return(other_uri_sans));
+  stream_info_.downstream_connection_info_provider_->setSslConnection(ssl);
+  const std::string alice = key(headers);
+  EXPECT_NE(sni, alice);
+  EXPECT_EQ(alice, key(headers));
+  EXPECT_NE(alice, key(headers));
+}
+
+TEST_F(DecisionCacheTest, KeyIncludesSortedContextExtensions) {
+  initialize(R"EOF(
+  key_attributes:
+  - request_header: x-user
+  )EOF");
+
+  const Http::TestRequestHeaderMapImpl headers{{"x-user", "alice"}};
+  const std::string no_extensions = key(headers);
+  context_extensions_["service"] = "orders";
+  context_extensions_["tier"] = "gold";
+  const std::string extensions = key(headers);
+  EXPECT_NE(no_extensions, extensions);
+
+  Protobuf::Map<std::string, std::string> reversed;
+  reversed["tier"] = "gold";
+  reversed["service"] = "orders";
+  EXPECT_EQ(extensions, cache_->key(headers, stream_info_, reversed));
+}
+
+TEST_F(DecisionCacheTest, LookupHonoursDefaultTtl) {
+  initialize(R"EOF(
+  key_attributes:
+  - request_header: x-user
+  default_ttl: 10s
+  )EOF");
+
+  EXPECT_EQ(nullptr, cache_->lookup("alice", now_));
+  EXPECT_EQ(0, cache_->insert("alice", okResponse(), now_));
+
+  auto response = cache_->lookup("alice", now_ + std::chrono::seconds(9));
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ(CheckStatus::OK, response->status);
+  EXPECT_EQ(okResponse().headers_to_set, response->headers_to_set);
+
+  EXPECT_EQ(nullptr, cache_->lookup("alice", now_ + std::chrono::seconds(10)));
+  // The expired decision was removed.
+  EXPECT_EQ(nullptr, cache_->lookup("alice", now_));
+}
+
+TEST_F(DecisionCacheTest, Ttl) {
+  initialize(R"EOF(
+  key_attributes:
+  - request_header: x-user
+  default_ttl: 10s
+  ttl_metadata_key: ttl
+  )EOF");
+
+  Response response = okResponse();
+  EXPECT_EQ(std::chrono::seconds(10), cache_->ttl(response));
+
+  (*response.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::numberValue(2.5);
+  EXPECT_EQ(std::chrono::milliseconds(2500), cache_->ttl(response));
+
+  (*response.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::stringValue("30");
+  EXPECT_EQ(std::chrono::seconds(30), cache_->ttl(response));
+
+  // A time to live of zero disables caching, a malformed one is not trusted.
+  (*response.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::numberValue(0);
+  EXPECT_EQ(absl::nullopt, cache_->ttl(response));
+  (*response.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::numberValue(-1);
+  EXPECT_EQ(absl::nullopt, cache_->ttl(response));
+  (*response.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::stringValue("soon");
+  EXPECT_EQ(absl::nullopt, cache_->ttl(response));
+  (*response.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::boolValue(true);
+  EXPECT_EQ(absl::nullopt, cache_->ttl(response));
+
+  // Denied responses and errors are not cached by default.
+  response = okResponse();
+  response.status = CheckStatus::Denied;
+  EXPECT_EQ(absl::nullopt, cache_->ttl(response));
+  response.status = CheckStatus::Error;
+  EXPECT_EQ(absl::nullopt, cache_->ttl(response));
+}
+
+TEST_F(DecisionCacheTest, TtlOnlyFromMetadata) {
+  initialize(R"EOF(
+  key_attributes:
+  - request_header: x-user
+  ttl_metadata_key: ttl
+  cache_denied_responses: true
+  )EOF");
+
+  Response response = okResponse();
+  response.status = CheckStatus::Denied;
+  EXPECT_EQ(absl::nullopt, cache_->ttl(response));
+  EXPECT_EQ(0, cache_->insert("alice", response, now_));
+  EXPECT_EQ(nullptr, cache_->lookup("alice", now_));
+
+  (*response.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::numberValue(5);
+  EXPECT_EQ(std::chrono::seconds(5), cache_->ttl(response));
+  cache_->insert("alice", response, now_);
+  auto cached = cache_->lookup("alice", now_);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(CheckStatus::Denied, cached->status);
+}
+
+TEST_F(DecisionCacheTest, EvictLeastRecentlyUsedBeyondMemoryCap) {
+  // Each shard can hold a single decision.
+  const uint64_t entry_size = DecisionCache::entrySize("key-000", okResponse());
+  initialize(absl::StrCat(R"EOF(
+  key_attributes:
+  - request_header: x-user
+  default_ttl: 10s
+  max_cache_bytes: )EOF",
+                          (entry_size * 3 / 2) * DecisionCache::NumShards));
+
+  uint64_t evictions = 0;
+  for (int i = 0; i < 100; ++i) {
+    evictions += cache_->insert(fmt::format("key-{:03}", i), okResponse(), now_);
+  }
+  EXPECT_GE(evictions, 100 - DecisionCache::NumShards);
+  EXPECT_NE(nullptr, cache_->lookup("key-099", now_));
+
+  // Expired decisions are not counted as evictions.
+  evictions = 0;
+  for (int i = 100; i < 200; ++i) {
+    evictions += cache_->insert(fmt::format("key-{:03}", i), okResponse(),
+                                now_ + std::chrono::seconds(20));
+  }
+  EXPECT_LT(evictions, 100);
+  EXPECT_GE(evictions, 100 - DecisionCache::NumShards);
+}
+
+TEST_F(DecisionCacheTest, SkipDecisionsLargerThanShard) {
+  initialize(absl::StrCat(R"EOF(
+  key_attributes:
+  - request_header: x-user
+  default_ttl: 10s
+  max_cache_bytes: )EOF",
+                          DecisionCache::NumShards * 1024));
+
+  Response response = okResponse();
+  response.body = std::string(2048, 'a');
+  EXPECT_EQ(0, cache_->insert("alice", response, now_));
+  EXPECT_EQ(nullptr, cache_->lookup("alice", now_));
+}
+
+} // namespace
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -2422,6 +2422,138 @@ TEST_P(HttpFilterTestParam, DisableRequestBodyBufferingOnRoute) {
   EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data_, false));
 }
 
+// Verify that decisions are served from the decision cache until they expire.
+TEST_F(HttpFilterTest, DecisionCache) {
+  initialize(R"EOF(
+  transport_api_version: V3
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_authz_server"
+  decision_cache:
+    key_attributes:
+    - request_header: x-user
+    default_ttl: 10s
+  )EOF");
+  prepareCheck();
+
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::OK;
+  response.headers_to_set = Http::HeaderVector{{Http::LowerCaseString{"x-user-id"}, "42"}};
+  auto expect_check = [&]() {
+    EXPECT_CALL(*client_, check(_, _, _, _))
+        .WillOnce(Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks,
+                             const envoy::service::auth::v3::CheckRequest&, Tracing::Span&,
+                             const StreamInfo::StreamInfo&) -> void {
+          callbacks.onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(response));
+        }));
+  };
+  auto new_filter = [&]() {
+    client_ = new Filters::Common::ExtAuthz::MockClient();
+    filter_ = std::make_unique<Filter>(config_, Filters::Common::ExtAuthz::ClientPtr{client_});
+    filter_->setDecoderFilterCallbacks(decoder_filter_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_filter_callbacks_);
+  };
+
+  expect_check();
+  Http::TestRequestHeaderMapImpl alice_headers{{"x-user", "alice"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(alice_headers, true));
+  EXPECT_EQ("42", alice_headers.get_("x-user-id"));
+  EXPECT_EQ(1U, config_->stats().cache_miss_.value());
+
+  // The same user is authorized from the cache.
+  new_filter();
+  EXPECT_CALL(*client_, check(_, _, _, _)).Times(0);
+  Http::TestRequestHeaderMapImpl cached_headers{{"x-user", "alice"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(cached_headers, true));
+  EXPECT_EQ("42", cached_headers.get_("x-user-id"));
+  EXPECT_EQ(1U, config_->stats().cache_hit_.value());
+  EXPECT_EQ(2U, config_->stats().ok_.value());
+  // Only the decision of the authorization server is counted in the cluster stats.
+  Stats::Scope& cluster_scope = decoder_filter_callbacks_.clusterInfo()->statsScope();
+  EXPECT_EQ(1U, cluster_scope.counterFromString("ext_authz.ok").value());
+  EXPECT_EQ(1U, cluster_scope.counterFromString("ext_authz.cache_hit").value());
+
+  // Another user misses the cache.
+  new_filter();
+  expect_check();
+  Http::TestRequestHeaderMapImpl bob_headers{{"x-user", "bob"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(bob_headers, true));
+  EXPECT_EQ(2U, config_->stats().cache_miss_.value());
+
+  // The decision expires.
+  decoder_filter_callbacks_.dispatcher_.globalTimeSystem().advanceTimeWait(
+      std::chrono::seconds(10));
+  new_filter();
+  expect_check();
+  Http::TestRequestHeaderMapImpl expired_headers{{"x-user", "alice"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(expired_headers, true));
+  EXPECT_EQ(3U, config_->stats().cache_miss_.value());
+  EXPECT_EQ(1U, config_->stats().cache_hit_.value());
+}
+
+// Verify that a cached denied decision is replied without calling the authorization server.
+TEST_F(HttpFilterTest, DecisionCacheDenied) {
+  initialize(R"EOF(
+  transport_api_version: V3
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_authz_server"
+  decision_cache:
+    key_attributes:
+    - request_header: x-user
+    ttl_metadata_key: ttl
+    cache_denied_responses: true
+  )EOF");
+  prepareCheck();
+
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::Denied;
+  response.status_code = Http::Code::Unauthorized;
+  (*response.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::numberValue(60);
+  EXPECT_CALL(*client_, check(_, _, _, _))
+      .WillOnce(Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks,
+                           const envoy::service::auth::v3::CheckRequest&, Tracing::Span&,
+                           const StreamInfo::StreamInfo&) -> void {
+        callbacks.onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(response));
+      }));
+  EXPECT_CALL(decoder_filter_callbacks_, sendLocalReply(Http::Code::Unauthorized, _, _, _, _))
+      .Times(2);
+  Http::TestRequestHeaderMapImpl headers{{"x-user", "mallory"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopAllIterationAndWatermark,
+            filter_->decodeHeaders(headers, true));
+
+  client_ = new Filters::Common::ExtAuthz::MockClient();
+  filter_ = std::make_unique<Filter>(config_, Filters::Common::ExtAuthz::ClientPtr{client_});
+  filter_->setDecoderFilterCallbacks(decoder_filter_callbacks_);
+  EXPECT_CALL(*client_, check(_, _, _, _)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopAllIterationAndWatermark,
+            filter_->decodeHeaders(headers, true));
+  EXPECT_EQ(1U, config_->stats().cache_hit_.value());
+  EXPECT_EQ(2U, config_->stats().denied_.value());
+  Stats::Scope& cluster_scope = decoder_filter_callbacks_.clusterInfo()->statsScope();
+  EXPECT_EQ(1U, cluster_scope.counterFromString("ext_authz.denied").value());
+  EXPECT_EQ(1U, cluster_scope.counterFromString("ext_authz.cache_hit").value());
+}
+
+// Verify that the decision cache can not be used when the request body is sent to the
+// authorization server.
+TEST_F(HttpFilterTest, DecisionCacheWithRequestBody) {
+  EXPECT_THROW_WITH_MESSAGE(initialize(R"EOF(
+  transport_api_version: V3
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_authz_server"
+  with_request_body:
+    max_request_bytes: 1024
+  decision_cache:
+    key_attributes:
+    - request_header: x-user
+    default_ttl: 10s
+  )EOF"),
+                            EnvoyException,
+                            "ext_authz: decision_cache can not be used with with_request_body");
+}
+
 } // namespace
 } // namespace ExtAuthz
 } // namespace HttpFilters
@@ -23,6 +23,8 @@ namespace ExternalProcessing {
 namespace {
 
 using envoy::extensions::filters::http::ext_proc::v3::ProcessingMode;
+using envoy::service::ext_proc::v3::MultiplexedProcessingRequest;
+using envoy::service::ext_proc::v3::MultiplexedProcessingResponse;
 using envoy::service::ext_proc::v3::ProcessingRequest;
 using envoy::service::ext_proc::v3::ProcessingResponse;
 
@@ -247,6 +249,57 @@ TEST_F(BenchmarkTest, ProcessBufferedResponseBody) {
   measureHttpGets("buffered-response-body", 2000);
 }
 
+// Observe the request and response headers in async mode, without waiting for the processor.
+TEST_F(BenchmarkTest, AsyncObserveHeaders) {
+  proto_config_.set_async_mode(true);
+  test_processor_.start(
+      ipVersion(), [](grpc::ServerReaderWriter<ProcessingResponse, ProcessingRequest>* stream) {
+        ProcessingRequest request;
+        while (stream->Read(&request)) {
+          EXPECT_TRUE(request.async_mode());
+        }
+      });
+  initialize();
+  measureHttpGets("async-observe-headers");
+}
+
+// Add a request header, with the HTTP streams multiplexed over one gRPC stream per worker.
+TEST_F(BenchmarkTest, MultiplexedAddRequestHeader) {
+  proto_config_.mutable_stream_multiplexing();
+  test_processor_.startMultiplexed(
+      ipVersion(),
+      [](grpc::ServerReaderWriter<MultiplexedProcessingResponse, MultiplexedProcessingRequest>*
+             stream) {
+        MultiplexedProcessingRequest batch;
+        while (stream->Read(&batch)) {
+          MultiplexedProcessingResponse responses;
+          for (const auto& entry : batch.entries()) {
+            if (entry.request().has_request_headers()) {
+              auto* response = responses.add_entries();
+              response->set_stream_id(entry.stream_id());
+              auto* header = response->mutable_response()
+                                 ->mutable_request_headers()
+                                 ->mutable_response()
+                                 ->mutable_header_mutation()
+                                 ->add_set_headers()
+                                 ->mutable_header();
+              header->set_key("x-envoy-benchmark");
+              header->set_value("true");
+            } else if (entry.request().has_response_headers()) {
+              auto* response = responses.add_entries();
+              response->set_stream_id(entry.stream_id());
+              response->mutable_response()->mutable_response_headers();
+            }
+          }
+          if (responses.entries_size() > 0) {
+            stream->Write(responses);
+          }
+        }
+      });
+  initialize();
+  measureHttpGets("multiplexed-add-request-header");
+}
+
 } // namespace
 } // namespace ExternalProcessing
 } // namespace HttpFilters
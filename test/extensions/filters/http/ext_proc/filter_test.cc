@@ -1708,6 +1708,90 @@ TEST_F(HttpFilterTest, PostAndClose) {
   EXPECT_EQ(1, config_->stats().streams_closed_.value());
 }
 
+// In async mode, the filter sends the messages and continues without waiting for responses.
+TEST_F(HttpFilterTest, AsyncModeObservesStream) {
+  initialize(R"EOF(
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_proc_server"
+  async_mode: true
+  processing_mode:
+    request_body_mode: "STREAMED"
+    response_body_mode: "BUFFERED"
+    response_trailer_mode: "SEND"
+  )EOF");
+
+  EXPECT_TRUE(config_->asyncMode());
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_TRUE(last_request_.async_mode());
+  ASSERT_TRUE(last_request_.has_request_headers());
+  EXPECT_FALSE(last_request_.request_headers().end_of_stream());
+
+  Buffer::OwnedImpl req_data("foo");
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(req_data, true));
+  EXPECT_EQ("foo", req_data.toString());
+  EXPECT_TRUE(last_request_.async_mode());
+  ASSERT_TRUE(last_request_.has_request_body());
+  EXPECT_EQ("foo", last_request_.request_body().body());
+  EXPECT_TRUE(last_request_.request_body().end_of_stream());
+
+  // Responses from the processor are ignored.
+  auto resp = std::make_unique<ProcessingResponse>();
+  auto* header_mut =
+      resp->mutable_request_headers()->mutable_response()->mutable_header_mutation();
+  auto* added = header_mut->add_set_headers()->mutable_header();
+  added->set_key("x-new-header");
+  added->set_value("new");
+  stream_callbacks_->onReceiveMessage(std::move(resp));
+  EXPECT_FALSE(request_headers_.has("x-new-header"));
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers_, false));
+  ASSERT_TRUE(last_request_.has_response_headers());
+  Buffer::OwnedImpl resp_data("bar");
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->encodeData(resp_data, false));
+  ASSERT_TRUE(last_request_.has_response_body());
+  EXPECT_EQ("bar", last_request_.response_body().body());
+  EXPECT_FALSE(last_request_.response_body().end_of_stream());
+  EXPECT_EQ(FilterTrailersStatus::Continue, filter_->encodeTrailers(response_trailers_));
+  EXPECT_TRUE(last_request_.async_mode());
+  ASSERT_TRUE(last_request_.has_response_trailers());
+  filter_->onDestroy();
+
+  EXPECT_EQ(1, config_->stats().streams_started_.value());
+  EXPECT_EQ(5, config_->stats().stream_msgs_sent_.value());
+  EXPECT_EQ(0, config_->stats().stream_msgs_received_.value());
+  EXPECT_EQ(1, config_->stats().spurious_msgs_received_.value());
+  EXPECT_EQ(1, config_->stats().streams_closed_.value());
+}
+
+// In async mode, a failure of the processor does not affect the HTTP stream.
+TEST_F(HttpFilterTest, AsyncModeIgnoresFailure) {
+  initialize(R"EOF(
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_proc_server"
+  async_mode: true
+  )EOF");
+
+  EXPECT_FALSE(config_->failureModeAllow());
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_CALL(encoder_callbacks_, sendLocalReply(_, _, _, _, _)).Times(0);
+  server_closed_stream_ = true;
+  stream_callbacks_->onGrpcError(Grpc::Status::Internal);
+
+  Buffer::OwnedImpl req_data("foo");
+  EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(req_data, true));
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers_, true));
+  filter_->onDestroy();
+
+  EXPECT_EQ(1, config_->stats().streams_started_.value());
+  EXPECT_EQ(1, config_->stats().stream_msgs_sent_.value());
+  EXPECT_EQ(1, config_->stats().streams_failed_.value());
+  EXPECT_EQ(0, config_->stats().failure_mode_allowed_.value());
+}
+
 // Using a processing mode, configure the filter to only send the request_headers
 // message.
 TEST_F(HttpFilterTest, ProcessingModeRequestHeadersOnly) {
@@ -0,0 +1,347 @@
+#include <memory>
+#include <vector>
+
+#include "envoy/config/core/v3/grpc_service.pb.h"
+#include "envoy/extensions/filters/http/ext_proc/v3/ext_proc.pb.h"
+
+#include "source/common/grpc/common.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/http/ext_proc/multiplexed_client_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using envoy::service::ext_proc::v3::MultiplexedProcessingRequest;
+using envoy::service::ext_proc::v3::MultiplexedProcessingResponse;
+using envoy::service::ext_proc::v3::ProcessingRequest;
+using envoy::service::ext_proc::v3::ProcessingResponse;
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Unused;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExternalProcessing {
+namespace {
+
+class TestCallbacks : public ExternalProcessorCallbacks {
+public:
+  void onReceiveMessage(std::unique_ptr<ProcessingResponse>&& response) override {
+    responses_.push_back(std::move(response));
+  }
+  void onGrpcError(Grpc::Status::GrpcStatus status) override { grpc_status_ = status; }
+  void onGrpcClose() override { grpc_closed_ = true; }
+
+  std::vector<std::unique_ptr<ProcessingResponse>> responses_;
+  Grpc::Status::GrpcStatus grpc_status_ = Grpc::Status::WellKnownGrpcStatus::Ok;
+  bool grpc_closed_ = false;
+};
+
+// A mocked gRPC stream recording the batches sent on it.
+struct TestGrpcStream {
+  TestGrpcStream() {
+    ON_CALL(stream_, sendMessageRaw_(_, _))
+        .WillByDefault(Invoke([this](Buffer::InstancePtr& request, bool) {
+          MultiplexedProcessingRequest batch;
+          ASSERT_TRUE(batch.ParseFromString(request->toString()));
+          batches_.push_back(batch);
+        }));
+  }
+
+  void receive(const MultiplexedProcessingResponse& response) {
+    EXPECT_TRUE(callbacks_->onReceiveMessageRaw(Grpc::Common::serializeMessage(response)));
+  }
+
+  NiceMock<Grpc::MockAsyncStream> stream_;
+  Grpc::RawAsyncStreamCallbacks* callbacks_{};
+  Event::MockTimer* batch_timer_{};
+  std::vector<MultiplexedProcessingRequest> batches_;
+};
+
+class MultiplexedClientTest : public testing::Test {
+protected:
+  void initialize(const std::string& yaml) {
+    envoy::extensions::filters::http::ext_proc::v3::StreamMultiplexing proto_config;
+    TestUtility::loadFromYaml(yaml, proto_config);
+    grpc_service_.mutable_envoy_grpc()->set_cluster_name("test");
+    pool_ = std::make_unique<MultiplexedStreamPool>(
+        client_manager_, stats_store_, dispatcher_, MultiplexingConfig(proto_config),
+        ExtProcMultiplexingStats{
+            ALL_EXT_PROC_MULTIPLEXING_STATS(POOL_COUNTER_PREFIX(stats_store_, ""))});
+    client_ = std::make_unique<MultiplexedClientImpl>(*pool_);
+  }
+
+  // Expects a new gRPC stream to be opened, failing to open it if fail is true.
+  TestGrpcStream& expectGrpcStream(bool fail = false) {
+    TestGrpcStream& grpc_stream = *grpc_streams_.emplace_back(std::make_unique<TestGrpcStream>());
+    EXPECT_CALL(client_manager_, getOrCreateRawAsyncClient(_, _, true, _))
+        .WillOnce(Invoke([&grpc_stream, fail](Unused, Unused, Unused, Unused) {
+          auto async_client = std::make_shared<Grpc::MockAsyncClient>();
+          EXPECT_CALL(*async_client, startRaw("envoy.service.ext_proc.v3.ExternalProcessor",
+                                              "ProcessMultiplexed", _, _))
+              .WillOnce(Invoke([&grpc_stream, fail](Unused, Unused,
+                                                    Grpc::RawAsyncStreamCallbacks& callbacks,
+                                                    Unused) -> Grpc::RawAsyncStream* {
+                grpc_stream.callbacks_ = &callbacks;
+                return fail ? nullptr : &grpc_stream.stream_;
+              }));
+          return async_client;
+        }))
+        .RetiresOnSaturation();
+    grpc_stream.batch_timer_ = new NiceMock<Event::MockTimer>(&dispatcher_);
+    return grpc_stream;
+  }
+
+  ExternalProcessorStreamPtr start(TestCallbacks& callbacks) {
+    return client_->start(callbacks, grpc_service_, stream_info_);
+  }
+
+  static ProcessingRequest requestHeaders() {
+    ProcessingRequest request;
+    request.mutable_request_headers();
+    return request;
+  }
+
+  static ProcessingRequest requestBody() {
+    ProcessingRequest request;
+    request.mutable_request_body()->set_body("hello");
+    return request;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counterFromString(name).value();
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Grpc::MockAsyncClientManager client_manager_;
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  envoy::config::core::v3::GrpcService grpc_service_;
+  std::vector<std::unique_ptr<TestGrpcStream>> grpc_streams_;
+  std::unique_ptr<MultiplexedStreamPool> pool_;
+  ExternalProcessorClientPtr client_;
+};
+
+TEST_F(MultiplexedClientTest, StreamsShareOneGrpcStream) {
+  initialize("{}");
+  TestGrpcStream& grpc_stream = expectGrpcStream();
+  TestCallbacks callbacks1;
+  TestCallbacks callbacks2;
+  auto stream1 = start(callbacks1);
+  auto stream2 = start(callbacks2);
+  EXPECT_EQ(1, pool_->grpcStreams());
+  EXPECT_EQ(1, counter("multiplexed_grpc_streams_started"));
+
+  // Without a batch window every message is sent immediately.
+  stream1->send(requestHeaders(), false);
+  stream2->send(requestHeaders(), false);
+  ASSERT_EQ(2, grpc_stream.batches_.size());
+  ASSERT_EQ(1, grpc_stream.batches_[0].entries_size());
+  ASSERT_EQ(1, grpc_stream.batches_[1].entries_size());
+  const uint64_t id1 = grpc_stream.batches_[0].entries(0).stream_id();
+  const uint64_t id2 = grpc_stream.batches_[1].entries(0).stream_id();
+  EXPECT_NE(id1, id2);
+  EXPECT_TRUE(grpc_stream.batches_[0].entries(0).request().has_request_headers());
+  EXPECT_EQ(2, counter("multiplexed_batches_sent"));
+
+  // The responses are dispatched to their HTTP stream.
+  MultiplexedProcessingResponse response;
+  auto* entry = response.add_entries();
+  entry->set_stream_id(id2);
+  entry->mutable_response()->mutable_request_headers();
+  entry = response.add_entries();
+  entry->set_stream_id(id1);
+  entry->mutable_response()->mutable_request_body();
+  grpc_stream.receive(response);
+  ASSERT_EQ(1, callbacks1.responses_.size());
+  EXPECT_TRUE(callbacks1.responses_[0]->has_request_body());
+  ASSERT_EQ(1, callbacks2.responses_.size());
+  EXPECT_TRUE(callbacks2.responses_[0]->has_request_headers());
+
+  // Closing an HTTP stream leaves the gRPC stream open.
+  EXPECT_CALL(grpc_stream.stream_, closeStream()).Times(0);
+  EXPECT_TRUE(stream1->close());
+  EXPECT_FALSE(stream1->close());
+  ASSERT_EQ(3, grpc_stream.batches_.size());
+  EXPECT_EQ(id1, grpc_stream.batches_[2].entries(0).stream_id());
+  EXPECT_TRUE(grpc_stream.batches_[2].entries(0).end_of_stream());
+  EXPECT_FALSE(grpc_stream.batches_[2].entries(0).has_request());
+  EXPECT_EQ(1, pool_->grpcStreams());
+
+  // The gRPC stream is reset when the worker shuts down.
+  EXPECT_CALL(grpc_stream.stream_, resetStream());
+  stream2.reset();
+  pool_.reset();
+}
+
+TEST_F(MultiplexedClientTest, BatchHeadersWithinWindow) {
+  initialize("batch_window: 0.005s");
+  TestGrpcStream& grpc_stream = expectGrpcStream();
+  TestCallbacks callbacks1;
+  TestCallbacks callbacks2;
+  auto stream1 = start(callbacks1);
+  auto stream2 = start(callbacks2);
+
+  EXPECT_CALL(*grpc_stream.batch_timer_, enableTimer(std::chrono::milliseconds(5), _)).Times(2);
+  stream1->send(requestHeaders(), false);
+  stream2->send(requestHeaders(), false);
+  EXPECT_TRUE(grpc_stream.batches_.empty());
+
+  grpc_stream.batch_timer_->invokeCallback();
+  ASSERT_EQ(1, grpc_stream.batches_.size());
+  EXPECT_EQ(2, grpc_stream.batches_[0].entries_size());
+  EXPECT_EQ(1, counter("multiplexed_batches_sent"));
+
+  // A body is sent immediately, together with the headers waiting for the window.
+  stream1->send(requestHeaders(), false);
+  stream2->send(requestBody(), false);
+  ASSERT_EQ(2, grpc_stream.batches_.size());
+  ASSERT_EQ(2, grpc_stream.batches_[1].entries_size());
+  EXPECT_TRUE(grpc_stream.batches_[1].entries(0).request().has_request_headers());
+  EXPECT_TRUE(grpc_stream.batches_[1].entries(1).request().has_request_body());
+  EXPECT_FALSE(grpc_stream.batch_timer_->enabled());
+}
+
+TEST_F(MultiplexedClientTest, SendFullBatch) {
+  initialize(R"EOF(
+  batch_window: 0.1s
+  max_batch_size: 2
+  )EOF");
+  TestGrpcStream& grpc_stream = expectGrpcStream();
+  TestCallbacks callbacks1;
+  TestCallbacks callbacks2;
+  TestCallbacks callbacks3;
+  auto stream1 = start(callbacks1);
+  auto stream2 = start(callbacks2);
+  auto stream3 = start(callbacks3);
+
+  stream1->send(requestHeaders(), false);
+  stream2->send(requestHeaders(), false);
+  ASSERT_EQ(1, grpc_stream.batches_.size());
+  EXPECT_EQ(2, grpc_stream.batches_[0].entries_size());
+
+  stream3->send(requestHeaders(), false);
+  EXPECT_EQ(1, grpc_stream.batches_.size());
+  EXPECT_TRUE(grpc_stream.batch_timer_->enabled());
+}
+
+TEST_F(MultiplexedClientTest, RoundRobinOverGrpcStreams) {
+  initialize("max_grpc_streams: 2");
+  TestGrpcStream& grpc_stream1 = expectGrpcStream();
+  TestGrpcStream& grpc_stream2 = expectGrpcStream();
+  std::vector<TestCallbacks> callbacks(4);
+  std::vector<ExternalProcessorStreamPtr> streams;
+  for (auto& stream_callbacks : callbacks) {
+    streams.push_back(start(stream_callbacks));
+    streams.back()->send(requestHeaders(), false);
+  }
+  EXPECT_EQ(2, pool_->grpcStreams());
+  EXPECT_EQ(2, counter("multiplexed_grpc_streams_started"));
+  EXPECT_EQ(2, grpc_stream1.batches_.size());
+  EXPECT_EQ(2, grpc_stream2.batches_.size());
+}
+
+TEST_F(MultiplexedClientTest, EndStreamFromEnvoy) {
+  initialize("{}");
+  TestGrpcStream& grpc_stream = expectGrpcStream();
+  TestCallbacks callbacks;
+  auto stream = start(callbacks);
+
+  stream->send(requestBody(), true);
+  ASSERT_EQ(1, grpc_stream.batches_.size());
+  EXPECT_TRUE(grpc_stream.batches_[0].entries(0).end_of_stream());
+  EXPECT_TRUE(grpc_stream.batches_[0].entries(0).request().has_request_body());
+
+  // The HTTP stream is already detached.
+  stream->send(requestBody(), false);
+  EXPECT_FALSE(stream->close());
+  EXPECT_EQ(1, grpc_stream.batches_.size());
+}
+
+TEST_F(MultiplexedClientTest, EndStreamFromProcessor) {
+  initialize("{}");
+  TestGrpcStream& grpc_stream = expectGrpcStream();
+  TestCallbacks callbacks;
+  auto stream = start(callbacks);
+  stream->send(requestHeaders(), false);
+  const uint64_t id = grpc_stream.batches_[0].entries(0).stream_id();
+
+  MultiplexedProcessingResponse response;
+  auto* entry = response.add_entries();
+  entry->set_stream_id(id);
+  entry->set_end_of_stream(true);
+  grpc_stream.receive(response);
+  EXPECT_TRUE(callbacks.grpc_closed_);
+  EXPECT_TRUE(callbacks.responses_.empty());
+
+  // Nothing is sent for a stream closed by the external processor.
+  stream->send(requestBody(), false);
+  EXPECT_FALSE(stream->close());
+  EXPECT_EQ(1, grpc_stream.batches_.size());
+
+  // Responses for unknown streams are ignored.
+  entry->set_end_of_stream(false);
+  entry->mutable_response()->mutable_request_body();
+  grpc_stream.receive(response);
+  EXPECT_TRUE(callbacks.responses_.empty());
+}
+
+TEST_F(MultiplexedClientTest, GrpcStreamError) {
+  initialize("{}");
+  TestGrpcStream& grpc_stream = expectGrpcStream();
+  TestCallbacks callbacks1;
+  TestCallbacks callbacks2;
+  auto stream1 = start(callbacks1);
+  auto stream2 = start(callbacks2);
+
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  grpc_stream.callbacks_->onRemoteClose(Grpc::Status::WellKnownGrpcStatus::Unavailable, "");
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Unavailable, callbacks1.grpc_status_);
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Unavailable, callbacks2.grpc_status_);
+  EXPECT_EQ(0, pool_->grpcStreams());
+  EXPECT_FALSE(stream1->close());
+
+  // The next HTTP stream opens a new gRPC stream.
+  TestGrpcStream& new_grpc_stream = expectGrpcStream();
+  TestCallbacks callbacks3;
+  auto stream3 = start(callbacks3);
+  stream3->send(requestHeaders(), false);
+  EXPECT_EQ(1, new_grpc_stream.batches_.size());
+  EXPECT_TRUE(grpc_stream.batches_.empty());
+}
+
+TEST_F(MultiplexedClientTest, GrpcStreamClosed) {
+  initialize("{}");
+  TestGrpcStream& grpc_stream = expectGrpcStream();
+  TestCallbacks callbacks;
+  auto stream = start(callbacks);
+
+  grpc_stream.callbacks_->onRemoteClose(Grpc::Status::WellKnownGrpcStatus::Ok, "");
+  EXPECT_TRUE(callbacks.grpc_closed_);
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Ok, callbacks.grpc_status_);
+}
+
+TEST_F(MultiplexedClientTest, GrpcStreamStartFailure) {
+  initialize("{}");
+  expectGrpcStream(true);
+  TestCallbacks callbacks;
+  auto stream = start(callbacks);
+  EXPECT_EQ(Grpc::Status::WellKnownGrpcStatus::Unavailable, callbacks.grpc_status_);
+  EXPECT_EQ(0, pool_->grpcStreams());
+  stream->send(requestHeaders(), false);
+  EXPECT_FALSE(stream->close());
+}
+
+} // namespace
+} // namespace ExternalProcessing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -16,6 +16,9 @@ grpc::Status ProcessorWrapper::Process(
     grpc::ServerContext* ctx,
     grpc::ServerReaderWriter<envoy::service::ext_proc::v3::ProcessingResponse,
                              envoy::service::ext_proc::v3::ProcessingRequest>* stream) {
+  if (!callback_) {
+    return grpc::Status(grpc::StatusCode::UNIMPLEMENTED, "Multiplexed streams only");
+  }
   if (context_callback_) {
     (*context_callback_)(ctx);
   }
@@ -29,9 +32,33 @@ grpc::Status ProcessorWrapper::Process(
   return grpc::Status::OK;
 }
 
+grpc::Status ProcessorWrapper::ProcessMultiplexed(
+    grpc::ServerContext*,
+    grpc::ServerReaderWriter<envoy::service::ext_proc::v3::MultiplexedProcessingResponse,
+                             envoy::service::ext_proc::v3::MultiplexedProcessingRequest>* stream) {
+  if (!multiplexed_callback_) {
+    return grpc::Status(grpc::StatusCode::UNIMPLEMENTED, "Multiplexed streams not supported");
+  }
+  multiplexed_callback_(stream);
+  if (testing::Test::HasFatalFailure()) {
+    return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Fatal test error");
+  }
+  return grpc::Status::OK;
+}
+
 void TestProcessor::start(const Network::Address::IpVersion ip_version, ProcessingFunc cb,
                           absl::optional<ContextProcessingFunc> context_cb) {
   wrapper_ = std::make_unique<ProcessorWrapper>(cb, context_cb);
+  startServer(ip_version);
+}
+
+void TestProcessor::startMultiplexed(const Network::Address::IpVersion ip_version,
+                                     MultiplexedProcessingFunc cb) {
+  wrapper_ = std::make_unique<ProcessorWrapper>(cb);
+  startServer(ip_version);
+}
+
+void TestProcessor::startServer(const Network::Address::IpVersion ip_version) {
   grpc::ServerBuilder builder;
   builder.RegisterService(wrapper_.get());
   builder.AddListeningPort(
@@ -21,6 +21,12 @@ using ProcessingFunc =
     std::function<void(grpc::ServerReaderWriter<envoy::service::ext_proc::v3::ProcessingResponse,
                                                 envoy::service::ext_proc::v3::ProcessingRequest>*)>;
 
+// Implementations of this function are called for each multiplexed gRPC stream
+// sent to the external processing server.
+using MultiplexedProcessingFunc = std::function<void(
+    grpc::ServerReaderWriter<envoy::service::ext_proc::v3::MultiplexedProcessingResponse,
+                             envoy::service::ext_proc::v3::MultiplexedProcessingRequest>*)>;
+
 // An implementation of this function may be called so that a test may verify
 // the gRPC context.
 using ContextProcessingFunc = std::function<void(grpc::ServerContext*)>;
@@ -31,14 +37,22 @@ class ProcessorWrapper : public envoy::service::ext_proc::v3::ExternalProcessor:
 public:
   ProcessorWrapper(ProcessingFunc& cb, absl::optional<ContextProcessingFunc> context_cb)
       : callback_(cb), context_callback_(context_cb) {}
+  explicit ProcessorWrapper(MultiplexedProcessingFunc& cb) : multiplexed_callback_(cb) {}
 
   grpc::Status Process(
       grpc::ServerContext*,
       grpc::ServerReaderWriter<envoy::service::ext_proc::v3::ProcessingResponse,
                                envoy::service::ext_proc::v3::ProcessingRequest>* stream) override;
 
+  grpc::Status ProcessMultiplexed(
+      grpc::ServerContext*,
+      grpc::ServerReaderWriter<envoy::service::ext_proc::v3::MultiplexedProcessingResponse,
+                               envoy::service::ext_proc::v3::MultiplexedProcessingRequest>*
+          stream) override;
+
 private:
   ProcessingFunc callback_;
+  MultiplexedProcessingFunc multiplexed_callback_;
   absl::optional<ContextProcessingFunc> context_callback_;
 };
 
@@ -53,6 +67,10 @@ public:
   void start(const Network::Address::IpVersion ip_version, ProcessingFunc cb,
              absl::optional<ContextProcessingFunc> context_cb = absl::nullopt);
 
+  // Start the processor like "start", for multiplexed streams only.
+  void startMultiplexed(const Network::Address::IpVersion ip_version,
+                        MultiplexedProcessingFunc cb);
+
   // Stop the processor from listening once all streams are closed, and exit
   // the listening threads.
   void shutdown();
@@ -62,6 +80,8 @@ public:
   int port() const { return listening_port_; }
 
 private:
+  void startServer(const Network::Address::IpVersion ip_version);
+
   std::unique_ptr<ProcessorWrapper> wrapper_;
   std::unique_ptr<grpc::Server> server_;
   int listening_port_;
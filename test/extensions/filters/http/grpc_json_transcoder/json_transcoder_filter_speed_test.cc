@@ -0,0 +1,142 @@
+#include "envoy/extensions/filters/http/grpc_json_transcoder/v3/transcoder.pb.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/grpc/common.h"
+#include "source/extensions/filters/http/grpc_json_transcoder/json_transcoder_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+#include "google/api/httpbody.pb.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace GrpcJsonTranscoder {
+
+namespace {
+
+constexpr uint64_t PayloadSize = 10 * 1024 * 1024;
+constexpr uint64_t ChunkSize = 16 * 1024;
+
+class TranscoderBenchmark {
+public:
+  TranscoderBenchmark() : api_(Api::createApiForTest()), config_(protoConfig(), *api_) {
+    // Large enough for the filter to buffer the whole payload when it has to.
+    ON_CALL(decoder_callbacks_, decoderBufferLimit()).WillByDefault(Return(2 * PayloadSize));
+    ON_CALL(encoder_callbacks_, encoderBufferLimit()).WillByDefault(Return(2 * PayloadSize));
+  }
+
+  std::unique_ptr<JsonTranscoderFilter> createFilter() {
+    auto filter = std::make_unique<JsonTranscoderFilter>(config_);
+    filter->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter->setEncoderFilterCallbacks(encoder_callbacks_);
+    return filter;
+  }
+
+  Api::ApiPtr api_;
+  JsonTranscoderConfig config_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+
+private:
+  static envoy::extensions::filters::http::grpc_json_transcoder::v3::GrpcJsonTranscoder
+  protoConfig() {
+    envoy::extensions::filters::http::grpc_json_transcoder::v3::GrpcJsonTranscoder proto_config;
+    proto_config.set_proto_descriptor(
+        TestEnvironment::runfilesPath("test/proto/bookstore.descriptor"));
+    proto_config.add_services("bookstore.Bookstore");
+    return proto_config;
+  }
+};
+
+// Sends a 10MiB HttpBody request through the filter in 16KiB chunks. The largest amount of data
+// held by the filter at once is reported as the "retained_bytes" counter.
+void uploadHttpBody(benchmark::State& state, bool with_content_length) {
+  TranscoderBenchmark benchmark;
+  const std::string chunk(ChunkSize, 'a');
+  uint64_t retained_bytes = 0;
+
+  for (auto _ : state) { // NOLINT
+    auto filter = benchmark.createFilter();
+    Http::TestRequestHeaderMapImpl headers{
+        {":method", "POST"}, {":path", "/postBody"}, {"content-type", "application/octet-stream"}};
+    if (with_content_length) {
+      headers.setContentLength(PayloadSize);
+    }
+    filter->decodeHeaders(headers, false);
+
+    uint64_t received = 0;
+    uint64_t retained = 0;
+    while (received < PayloadSize) {
+      Buffer::OwnedImpl data(chunk);
+      received += chunk.size();
+      const bool end_stream = received == PayloadSize;
+      if (filter->decodeData(data, end_stream) == Http::FilterDataStatus::Continue) {
+        retained = 0;
+      } else {
+        retained += chunk.size();
+      }
+      retained_bytes = std::max(retained_bytes, retained);
+    }
+    filter->onDestroy();
+  }
+
+  state.counters["retained_bytes"] = retained_bytes;
+  state.SetBytesProcessed(state.iterations() * PayloadSize);
+}
+
+} // namespace
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_UploadHttpBodyWithContentLength(benchmark::State& state) {
+  uploadHttpBody(state, true);
+}
+BENCHMARK(BM_UploadHttpBodyWithContentLength)->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_UploadHttpBodyWithoutContentLength(benchmark::State& state) {
+  uploadHttpBody(state, false);
+}
+BENCHMARK(BM_UploadHttpBodyWithoutContentLength)->Unit(benchmark::kMillisecond);
+
+// Streams a 10MiB server-streaming HttpBody response through the filter, as 64KiB messages
+// delivered in 16KiB chunks.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_StreamHttpBodyResponse(benchmark::State& state) {
+  TranscoderBenchmark benchmark;
+  google::api::HttpBody message;
+  message.set_content_type("application/octet-stream");
+  message.set_data(std::string(64 * 1024, 'a'));
+  const std::string frame = Grpc::Common::serializeToGrpcFrame(message)->toString();
+
+  for (auto _ : state) { // NOLINT
+    auto filter = benchmark.createFilter();
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/indexStream"}};
+    filter->decodeHeaders(request_headers, true);
+    Http::TestResponseHeaderMapImpl response_headers{{":status", "200"},
+                                                     {"content-type", "application/grpc"}};
+    filter->encodeHeaders(response_headers, false);
+
+    for (uint64_t sent = 0; sent < PayloadSize; sent += message.data().size()) {
+      for (size_t offset = 0; offset < frame.size(); offset += ChunkSize) {
+        Buffer::OwnedImpl data(absl::string_view(frame).substr(offset, ChunkSize));
+        filter->encodeData(data, false);
+      }
+    }
+    filter->onDestroy();
+  }
+
+  state.SetBytesProcessed(state.iterations() * PayloadSize);
+}
+BENCHMARK(BM_StreamHttpBodyResponse)->Unit(benchmark::kMillisecond);
+
+} // namespace GrpcJsonTranscoder
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
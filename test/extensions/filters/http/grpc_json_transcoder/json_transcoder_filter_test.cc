@@ -890,6 +890,32 @@ TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryWithHttpBodyAsOutput) {
   EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_.decodeTrailers(request_trailers));
 }
 
+// The partial frame of a unary HttpBody response is held by the transcoder rather than by the
+// filter manager, so the transcoder enforces the buffer limit.
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryWithHttpBodyAsOutputExceedsBufferLimit) {
+  ON_CALL(encoder_callbacks_, encoderBufferLimit()).WillByDefault(Return(16));
+
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/index"}};
+  EXPECT_CALL(decoder_callbacks_, clearRouteCache());
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Http::TestResponseHeaderMapImpl response_headers{{"content-type", "application/grpc"},
+                                                   {":status", "200"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_.encodeHeaders(response_headers, false));
+
+  google::api::HttpBody http_body;
+  http_body.set_content_type("text/html");
+  http_body.set_data("<h1>Message larger than the limit</h1>");
+  auto frame = Grpc::Common::serializeToGrpcFrame(http_body);
+  Buffer::OwnedImpl fragment;
+  fragment.move(*frame, 8);
+  EXPECT_CALL(encoder_callbacks_,
+              sendLocalReply(Http::Code::InternalServerError, _, _, _,
+                             "grpc_json_transcode_failure{response_buffer_size_limit_reached}"));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_.encodeData(fragment, false));
+}
+
 TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryOnRootPath) {
   Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/"}};
 
@@ -1080,6 +1106,70 @@ TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPostWithHttpBodyExceedsBuff
             "grpc_json_transcode_failure{request_buffer_size_limit_reached}");
 }
 
+// Unary requests with HTTP bodies of a known length are streamed upstream as they are received,
+// so they are not subject to the buffer limits of the filter.
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPostWithHttpBodyAndContentLength) {
+  ON_CALL(decoder_callbacks_, decoderBufferLimit()).WillByDefault(Return(8));
+  EXPECT_CALL(decoder_callbacks_, addDecodedData(_, _)).Times(0);
+
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "POST"},
+                                                 {":path", "/postBody?arg=hi"},
+                                                 {"content-type", "text/plain"},
+                                                 {"content-length", "12"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+  EXPECT_EQ(nullptr, request_headers.ContentLength());
+  EXPECT_EQ("/bookstore.Bookstore/PostBody", request_headers.get_(":path"));
+
+  Buffer::OwnedImpl upstream_data;
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(buffer, false));
+  upstream_data.move(buffer);
+  buffer.add(" ");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(buffer, false));
+  upstream_data.move(buffer);
+  buffer.add("world!");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(buffer, true));
+  upstream_data.move(buffer);
+
+  Grpc::Decoder decoder;
+  std::vector<Grpc::Frame> frames;
+  decoder.decode(upstream_data, frames);
+  ASSERT_EQ(frames.size(), 1);
+
+  bookstore::EchoBodyRequest expected_request;
+  expected_request.set_arg("hi");
+  expected_request.mutable_nested()->mutable_content()->set_content_type("text/plain");
+  expected_request.mutable_nested()->mutable_content()->set_data("hello world!");
+
+  bookstore::EchoBodyRequest request;
+  request.ParseFromString(frames[0].data_->toString());
+
+  EXPECT_THAT(request, ProtoEq(expected_request));
+}
+
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPostWithHttpBodyLongerThanContentLength) {
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":method", "POST"}, {":path", "/postBody"}, {"content-length", "4"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl buffer("12345");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_.decodeData(buffer, false));
+  EXPECT_EQ(decoder_callbacks_.details(), "grpc_json_transcode_failure{content_length_mismatch}");
+}
+
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPostWithHttpBodyShorterThanContentLength) {
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":method", "POST"}, {":path", "/postBody"}, {"content-length", "8"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl buffer("1234");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(buffer, false));
+
+  Http::TestRequestTrailerMapImpl request_trailers;
+  EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, filter_.decodeTrailers(request_trailers));
+  EXPECT_EQ(decoder_callbacks_.details(), "grpc_json_transcode_failure{content_length_mismatch}");
+}
+
 TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryPostWithNestedHttpBody) {
   const std::string path = "/echoNestedBody?nested2.body.data=aGkh";
   Http::TestRequestHeaderMapImpl request_headers{
@@ -1296,6 +1386,31 @@ TEST_F(GrpcJsonTranscoderFilterTest, TranscodingStreamWithFragmentedHttpBody) {
   EXPECT_EQ(http_body.data(), fragment2->toString());
 }
 
+// The partial frame of a streamed HttpBody message is buffered by the transcoder, which must stay
+// within the buffer limit.
+TEST_F(GrpcJsonTranscoderFilterTest, TranscodingStreamWithHttpBodyExceedsBufferLimit) {
+  ON_CALL(encoder_callbacks_, encoderBufferLimit()).WillByDefault(Return(16));
+
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/indexStream"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Http::TestResponseHeaderMapImpl response_headers{{"content-type", "application/grpc"},
+                                                   {":status", "200"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_.encodeHeaders(response_headers, false));
+
+  google::api::HttpBody http_body;
+  http_body.set_content_type("text/html");
+  http_body.set_data("<h1>Message larger than the limit</h1>");
+  auto frame = Grpc::Common::serializeToGrpcFrame(http_body);
+  Buffer::OwnedImpl fragment;
+  fragment.move(*frame, 8);
+  EXPECT_CALL(encoder_callbacks_,
+              sendLocalReply(Http::Code::InternalServerError, _, _, _,
+                             "grpc_json_transcode_failure{response_buffer_size_limit_reached}"));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_.encodeData(fragment, false));
+}
+
 class GrpcJsonTranscoderFilterGrpcStatusTest : public GrpcJsonTranscoderFilterTest {
 public:
   GrpcJsonTranscoderFilterGrpcStatusTest(
@@ -11,6 +11,7 @@
 #include "test/extensions/filters/http/jwt_authn/mock.h"
 #include "test/extensions/filters/http/jwt_authn/test_common.h"
 #include "test/mocks/server/factory_context.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -120,6 +121,35 @@ TEST_F(AuthenticatorTest, TestOkJWTandCache) {
   EXPECT_EQ(0U, filter_config_->stats().jwks_fetch_failed_.value());
 }
 
+// Signatures are verified inline once the verification pool is saturated.
+TEST_F(AuthenticatorTest, TestVerificationPoolOverflow) {
+  envoy::extensions::filters::http::jwt_authn::v3::JwtVerificationThreadPool pool_config;
+  pool_config.set_thread_count(1);
+  pool_config.mutable_max_pending_verifications()->set_value(0);
+  VerificationThreadPool pool(pool_config, Thread::threadFactoryForTest(),
+                              mock_factory_ctx_.thread_local_);
+  auth_ = Authenticator::create(
+      nullptr, absl::make_optional<std::string>(ProviderName), false, false,
+      filter_config_->getJwksCache(), filter_config_->cm(),
+      [this](Upstream::ClusterManager&, const RemoteJwks&) { return std::move(fetcher_); },
+      filter_config_->timeSource(), &pool);
+  EXPECT_CALL(*raw_fetcher_, fetch(_, _))
+      .WillOnce(Invoke([this](Tracing::Span&, JwksFetcher::JwksReceiver& receiver) {
+        receiver.onJwksSuccess(std::move(jwks_));
+      }));
+
+  Http::TestRequestHeaderMapImpl headers{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  expectVerifyStatus(Status::Ok, headers);
+  EXPECT_EQ(headers.get_("sec-istio-auth-userinfo"), ExpectedPayloadValue);
+
+  Http::TestRequestHeaderMapImpl bad_headers{
+      {"Authorization", "Bearer " + std::string(NonExistKidToken)}};
+  expectVerifyStatus(Status::JwtVerificationFail, bad_headers);
+
+  EXPECT_EQ(0U, filter_config_->stats().signature_verification_offloaded_.value());
+  EXPECT_EQ(2U, filter_config_->stats().signature_verification_overflow_.value());
+}
+
 TEST_F(AuthenticatorTest, TestCompletePaddingInJwtPayload) {
   (*proto_config_.mutable_providers())[std::string(ProviderName)].set_pad_forward_payload_header(
       true);
@@ -80,6 +80,59 @@ TEST_F(JwtCacheTest, TestExpiredToken) {
   EXPECT_TRUE(jwt == nullptr);
 }
 
+// JWTs inserted by a worker are found by the others in the shared cache.
+TEST_F(JwtCacheTest, TestSharedCache) {
+  envoy::extensions::filters::http::jwt_authn::v3::JwtCacheConfig config;
+  config.set_shared_cache(true);
+  auto shared_cache = std::make_shared<SharedJwtCache>(config, time_system_);
+  auto worker1 = JwtCache::create(true, config, time_system_, shared_cache);
+  auto worker2 = JwtCache::create(true, config, time_system_, shared_cache);
+  loadJwt(GoodToken);
+  auto* origin_jwt = jwt_.get();
+
+  EXPECT_TRUE(worker2->lookup(GoodToken) == nullptr);
+  worker1->insert(GoodToken, std::move(jwt_));
+
+  // The other worker gets its own copy.
+  auto* jwt = worker2->lookup(GoodToken);
+  ASSERT_TRUE(jwt != nullptr);
+  EXPECT_NE(jwt, origin_jwt);
+  EXPECT_EQ(jwt->payload_str_base64url_, origin_jwt->payload_str_base64url_);
+  // Which is then in the cache of the worker.
+  EXPECT_EQ(jwt, worker2->lookup(GoodToken));
+}
+
+TEST_F(JwtCacheTest, TestSharedCacheExpiredToken) {
+  envoy::extensions::filters::http::jwt_authn::v3::JwtCacheConfig config;
+  SharedJwtCache shared_cache(config, time_system_);
+  loadJwt(ExpiredToken);
+
+  shared_cache.insert(ExpiredToken, *jwt_);
+  EXPECT_TRUE(shared_cache.lookup(ExpiredToken) == nullptr);
+}
+
+TEST_F(JwtCacheTest, TestSharedCacheEviction) {
+  envoy::extensions::filters::http::jwt_authn::v3::JwtCacheConfig config;
+  // A single entry per shard.
+  config.set_jwt_cache_size(1);
+  SharedJwtCache shared_cache(config, time_system_);
+  loadJwt(GoodToken);
+
+  // At most one token is kept per shard.
+  for (int i = 0; i < 100; i++) {
+    shared_cache.insert(absl::StrCat(GoodToken, i), *jwt_);
+  }
+  int cached = 0;
+  for (int i = 0; i < 100; i++) {
+    if (shared_cache.lookup(absl::StrCat(GoodToken, i)) != nullptr) {
+      cached++;
+    }
+  }
+  EXPECT_LE(cached, 16);
+  // The most recently inserted token is kept.
+  EXPECT_TRUE(shared_cache.lookup(absl::StrCat(GoodToken, 99)) != nullptr);
+}
+
 } // namespace
 } // namespace JwtAuthn
 } // namespace HttpFilters
@@ -81,6 +81,7 @@ public:
   MOCK_METHOD(const envoy::extensions::filters::http::jwt_authn::v3::JwtProvider&, getJwtProvider,
               (), (const));
   MOCK_METHOD(const ::google::jwt_verify::Jwks*, getJwksObj, (), (const));
+  MOCK_METHOD(JwksConstSharedPtr, getSharedJwksObj, (), (const));
   MOCK_METHOD(bool, isExpired, (), (const));
   MOCK_METHOD(const ::google::jwt_verify::Jwks*, setRemoteJwks, (JwksConstPtr &&), ());
   MOCK_METHOD(JwtCache&, getJwtCache, (), ());
@@ -0,0 +1,109 @@
+#include <memory>
+
+#include "envoy/extensions/filters/http/jwt_authn/v3/config.pb.h"
+
+#include "source/extensions/filters/http/jwt_authn/verification_pool.h"
+
+#include "test/extensions/filters/http/jwt_authn/test_common.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+using envoy::extensions::filters::http::jwt_authn::v3::JwtVerificationThreadPool;
+using ::google::jwt_verify::Jwks;
+using ::google::jwt_verify::Jwt;
+using ::google::jwt_verify::Status;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+class TestCallbacks : public VerificationCallbacks {
+public:
+  explicit TestCallbacks(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  void onVerificationComplete(VerificationOperation& operation) override {
+    completions_++;
+    status_ = operation.status_;
+    jwt_ = std::move(operation.jwt_);
+    dispatcher_.exit();
+  }
+
+  Event::Dispatcher& dispatcher_;
+  uint32_t completions_{};
+  Status status_{Status::Ok};
+  std::unique_ptr<Jwt> jwt_;
+};
+
+class VerificationThreadPoolTest : public testing::Test {
+protected:
+  VerificationThreadPoolTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        jwks_(Jwks::createFrom(PublicKey, Jwks::JWKS)), callbacks_(*dispatcher_) {
+    config_.set_thread_count(2);
+  }
+
+  VerificationOperationSharedPtr createOperation(const char* token) {
+    auto jwt = std::make_unique<Jwt>();
+    EXPECT_EQ(Status::Ok, jwt->parseFromString(token));
+    auto operation = std::make_shared<VerificationOperation>(*dispatcher_, std::move(jwt), jwks_);
+    operation->callbacks_ = &callbacks_;
+    return operation;
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  JwtVerificationThreadPool config_;
+  const JwksConstSharedPtr jwks_;
+  TestCallbacks callbacks_;
+};
+
+TEST_F(VerificationThreadPoolTest, GoodSignature) {
+  VerificationThreadPool pool(config_, api_->threadFactory(), tls_);
+  auto operation = createOperation(GoodToken);
+  EXPECT_TRUE(pool.enqueue(operation));
+
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_EQ(1, callbacks_.completions_);
+  EXPECT_EQ(Status::Ok, callbacks_.status_);
+  // The JWT is handed back to the worker.
+  ASSERT_NE(nullptr, callbacks_.jwt_);
+  EXPECT_EQ("https://example.com", callbacks_.jwt_->iss_);
+}
+
+TEST_F(VerificationThreadPoolTest, BadSignature) {
+  VerificationThreadPool pool(config_, api_->threadFactory(), tls_);
+  EXPECT_TRUE(pool.enqueue(createOperation(NonExistKidToken)));
+
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_EQ(1, callbacks_.completions_);
+  EXPECT_NE(Status::Ok, callbacks_.status_);
+}
+
+// A cancelled operation does not call back the worker.
+TEST_F(VerificationThreadPoolTest, Cancelled) {
+  VerificationThreadPool pool(config_, api_->threadFactory(), tls_);
+  auto cancelled = createOperation(GoodToken);
+  cancelled->cancel();
+  EXPECT_TRUE(pool.enqueue(cancelled));
+  EXPECT_TRUE(pool.enqueue(createOperation(GoodToken)));
+
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_EQ(1, callbacks_.completions_);
+}
+
+TEST_F(VerificationThreadPoolTest, MaxPendingVerifications) {
+  config_.mutable_max_pending_verifications()->set_value(0);
+  VerificationThreadPool pool(config_, api_->threadFactory(), tls_);
+  EXPECT_FALSE(pool.enqueue(createOperation(GoodToken)));
+}
+
+} // namespace
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,120 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/extensions/filters/http/lua/v3/lua.pb.h"
+
+#include "source/extensions/filters/http/lua/lua_filter.h"
+
+#include "test/mocks/api/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/mocks/upstream/cluster_manager.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Lua {
+
+namespace {
+
+// Does nothing, to measure the cost of running a script for each request.
+const std::string EMPTY_SCRIPT{R"EOF(
+  function envoy_on_request(request_handle)
+  end
+)EOF"};
+
+// A typical header rewrite, accessing the headers one at a time.
+const std::string HEADER_REWRITE_SCRIPT{R"EOF(
+  function envoy_on_request(request_handle)
+    local headers = request_handle:headers()
+    local tenant = headers:get("x-tenant")
+    local path = headers:get(":path")
+    local user_agent = headers:get("user-agent")
+    if tenant ~= nil then
+      headers:replace(":path", "/" .. tenant .. path)
+    end
+    if user_agent ~= nil and string.find(user_agent, "curl", 1, true) then
+      headers:add("x-client", "cli")
+    end
+    for key, value in pairs(headers) do
+      if string.sub(key, 1, 8) == "x-debug-" then
+        request_handle:logTrace(value)
+      end
+    end
+    headers:remove("x-tenant")
+  end
+)EOF"};
+
+// The same header rewrite, with the batched header accessors.
+const std::string BATCHED_HEADER_REWRITE_SCRIPT{R"EOF(
+  function envoy_on_request(request_handle)
+    local headers = request_handle:headers()
+    local tenant, path, user_agent = headers:getMany("x-tenant", ":path", "user-agent")
+    if tenant ~= nil then
+      headers:replace(":path", "/" .. tenant .. path)
+    end
+    if user_agent ~= nil and string.find(user_agent, "curl", 1, true) then
+      headers:add("x-client", "cli")
+    end
+    for key, value in pairs(headers:toTable()) do
+      if string.sub(key, 1, 8) == "x-debug-" then
+        request_handle:logTrace(value)
+      end
+    end
+    headers:remove("x-tenant")
+  end
+)EOF"};
+
+// Runs a script on the headers of each request, through the filter.
+void runScript(benchmark::State& state, const std::string& script) {
+  NiceMock<ThreadLocal::MockInstance> tls;
+  NiceMock<Api::MockApi> api;
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  Event::SimulatedTimeSystem time_system;
+
+  envoy::extensions::filters::http::lua::v3::Lua proto_config;
+  proto_config.set_inline_code(script);
+  auto config = std::make_shared<FilterConfig>(proto_config, tls, cluster_manager, api);
+
+  for (auto _ : state) { // NOLINT
+    Http::TestRequestHeaderMapImpl headers{{":method", "GET"},
+                                           {":path", "/api/v1/users"},
+                                           {":scheme", "https"},
+                                           {":authority", "api.example.com"},
+                                           {"user-agent", "curl/7.79.1"},
+                                           {"x-tenant", "acme"},
+                                           {"x-request-id", "4d2f7c3a"}};
+    Filter filter(config, time_system);
+    filter.setDecoderFilterCallbacks(decoder_callbacks);
+    filter.decodeHeaders(headers, true);
+    filter.onDestroy();
+  }
+}
+
+} // namespace
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_EmptyScript(benchmark::State& state) { runScript(state, EMPTY_SCRIPT); }
+BENCHMARK(BM_EmptyScript);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_HeaderRewrite(benchmark::State& state) { runScript(state, HEADER_REWRITE_SCRIPT); }
+BENCHMARK(BM_HeaderRewrite);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_BatchedHeaderRewrite(benchmark::State& state) {
+  runScript(state, BATCHED_HEADER_REWRITE_SCRIPT);
+}
+BENCHMARK(BM_BatchedHeaderRewrite);
+
+} // namespace Lua
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -119,6 +119,62 @@ TEST_F(LuaHeaderMapWrapperTest, GetAtIndex) {
   start("callMe");
 }
 
+// Get the values of several headers in a single call.
+TEST_F(LuaHeaderMapWrapperTest, GetMany) {
+  const std::string SCRIPT{R"EOF(
+    function callMe(object)
+      local path, test, missing, empty = object:getMany(":path", "X-Test", "foobar", "x-empty")
+      testPrint(path)
+      testPrint(test)
+      if missing == nil then
+        testPrint("nil_value")
+      end
+      testPrint(string.format("'%s'", empty))
+      testPrint(select("#", object:getMany()))
+    end
+  )EOF"};
+
+  InSequence s;
+  setup(SCRIPT);
+
+  Http::TestRequestHeaderMapImpl headers{
+      {":path", "/"}, {"x-test", "foo"}, {"x-test", "bar"}, {"x-empty", ""}};
+  HeaderMapWrapper::create(coroutine_->luaState(), headers, []() { return true; });
+  EXPECT_CALL(printer_, testPrint("/"));
+  EXPECT_CALL(printer_, testPrint("foo,bar"));
+  EXPECT_CALL(printer_, testPrint("nil_value"));
+  EXPECT_CALL(printer_, testPrint("''"));
+  EXPECT_CALL(printer_, testPrint("0"));
+  start("callMe");
+}
+
+// Copy the headers into a table, which does not prevent modifying the map.
+TEST_F(LuaHeaderMapWrapperTest, ToTable) {
+  const std::string SCRIPT{R"EOF(
+    function callMe(object)
+      local headers = object:toTable()
+      testPrint(headers[":path"])
+      testPrint(headers["x-test"])
+      for key, value in pairs(headers) do
+        object:replace(key, value .. "-copy")
+      end
+      testPrint(object:get(":path"))
+      testPrint(object:get("x-test"))
+    end
+  )EOF"};
+
+  InSequence s;
+  setup(SCRIPT);
+
+  Http::TestRequestHeaderMapImpl headers{{":path", "/"}, {"x-test", "foo"}, {"x-test", "bar"}};
+  HeaderMapWrapper::create(coroutine_->luaState(), headers, []() { return true; });
+  EXPECT_CALL(printer_, testPrint("/"));
+  EXPECT_CALL(printer_, testPrint("foo,bar"));
+  EXPECT_CALL(printer_, testPrint("/-copy"));
+  EXPECT_CALL(printer_, testPrint("foo,bar-copy"));
+  start("callMe");
+}
+
 // Test modifiable methods.
 TEST_F(LuaHeaderMapWrapperTest, ModifiableMethods) {
   const std::string SCRIPT{R"EOF(
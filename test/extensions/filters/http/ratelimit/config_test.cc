@@ -56,6 +56,39 @@ TEST(RateLimitFilterConfigTest, RatelimitCorrectProto) {
   cb(filter_callback);
 }
 
+TEST(RateLimitFilterConfigTest, QuotaLease) {
+  const std::string yaml = R"EOF(
+  domain: test
+  rate_limit_service:
+    transport_api_version: V3
+    grpc_service:
+      envoy_grpc:
+        cluster_name: ratelimit_cluster
+  quota_lease:
+    block_size: 100
+    period: 0.5s
+  )EOF";
+
+  envoy::extensions::filters::http::ratelimit::v3::RateLimit proto_config{};
+  TestUtility::loadFromYamlAndValidate(yaml, proto_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  // One client for the leases of the worker, and one for the stream.
+  EXPECT_CALL(context.cluster_manager_.async_client_manager_, getOrCreateRawAsyncClient(_, _, _, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(
+          [](const envoy::config::core::v3::GrpcService&, Stats::Scope&, bool, Grpc::CacheOption) {
+            return std::make_unique<NiceMock<Grpc::MockAsyncClient>>();
+          }));
+
+  RateLimitFilterConfig factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(proto_config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
 TEST(RateLimitFilterConfigTest, RateLimitFilterEmptyProto) {
   NiceMock<Server::Configuration::MockFactoryContext> context;
   NiceMock<Server::MockInstance> instance;
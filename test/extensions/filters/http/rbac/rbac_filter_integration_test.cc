@@ -1,3 +1,4 @@
+#include "envoy/config/route/v3/route_components.pb.h"
 #include "envoy/extensions/filters/http/rbac/v3/rbac.pb.h"
 #include "envoy/extensions/filters/network/http_connection_manager/v3/http_connection_manager.pb.h"
 
@@ -540,6 +541,41 @@ TEST_P(RBACIntegrationTest, HeaderMatchConditionDuplicateHeaderMatch) {
   EXPECT_EQ("200", response->headers().getStatusValue());
 }
 
+// The stream recreated by an internal redirect evaluates the conditions again, with an activation
+// of its own.
+TEST_P(RBACIntegrationTest, HeaderMatchConditionInternalRedirect) {
+  config_helper_.prependFilter(fmt::format(RBAC_CONFIG_HEADER_MATCH_CONDITION, "yyy"));
+  auto handle = config_helper_.createVirtualHost("handle.internal.redirect");
+  handle.mutable_routes(0)->mutable_route()->mutable_internal_redirect_policy();
+  config_helper_.addVirtualHost(handle);
+  initialize();
+
+  codec_client_ = makeHttpConnection(lookupPort("http"));
+
+  auto response = codec_client_->makeHeaderOnlyRequest(Http::TestRequestHeaderMapImpl{
+      {":method", "GET"},
+      {":path", "/path"},
+      {":scheme", "http"},
+      {":authority", "handle.internal.redirect"},
+      {"xxx", "yyy"},
+  });
+  waitForNextUpstreamRequest();
+  upstream_request_->encodeHeaders(
+      Http::TestResponseHeaderMapImpl{{":status", "302"},
+                                      {"location", "http://handle.internal.redirect/new/path"}},
+      true);
+
+  waitForNextUpstreamRequest();
+  EXPECT_EQ("/new/path", upstream_request_->headers().getPathValue());
+  upstream_request_->encodeHeaders(Http::TestResponseHeaderMapImpl{{":status", "200"}}, true);
+
+  ASSERT_TRUE(response->waitForEndStream());
+  ASSERT_TRUE(response->complete());
+  EXPECT_EQ("200", response->headers().getStatusValue());
+  EXPECT_EQ(1, test_server_->counter("cluster.cluster_0.upstream_internal_redirect_succeeded_total")
+                   ->value());
+}
+
 // Helper for integration testing of RBAC filter with dynamic forward proxy.
 class RbacDynamicForwardProxyIntegrationHelper
     : public testing::TestWithParam<Network::Address::IpVersion>,
@@ -0,0 +1,130 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <memory>
+#include <string>
+
+#include "envoy/http/filter.h"
+
+#include "source/common/filter/config_discovery_impl.h"
+#include "source/common/http/filter_manager.h"
+#include "source/common/stream_info/filter_state_impl.h"
+#include "source/extensions/filters/http/common/pass_through_filter.h"
+#include "source/extensions/filters/network/http_connection_manager/filter_chain_template.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/local_reply/mocks.h"
+#include "test/mocks/network/mocks.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace HttpConnectionManager {
+namespace {
+
+// Creates filter chains by looking up the config of each provider, as the connection manager did
+// before filter chain templates.
+class ProviderFilterChainFactory : public Http::FilterChainFactory {
+public:
+  explicit ProviderFilterChainFactory(const FilterFactoriesList& filter_factories)
+      : filter_factories_(filter_factories) {}
+
+  // Http::FilterChainFactory
+  void createFilterChain(Http::FilterChainFactoryCallbacks& callbacks) override {
+    for (const auto& filter_config_provider : filter_factories_) {
+      auto config = filter_config_provider->config();
+      if (config.has_value()) {
+        config.value()(callbacks);
+      }
+    }
+  }
+  bool createUpgradeFilterChain(absl::string_view, const UpgradeMap*,
+                                Http::FilterChainFactoryCallbacks&) override {
+    return false;
+  }
+
+private:
+  const FilterFactoriesList& filter_factories_;
+};
+
+class TemplateFilterChainFactory : public Http::FilterChainFactory {
+public:
+  explicit TemplateFilterChainFactory(const FilterFactoriesList& filter_factories)
+      : filter_chain_template_(filter_factories) {}
+
+  // Http::FilterChainFactory
+  void createFilterChain(Http::FilterChainFactoryCallbacks& callbacks) override {
+    filter_chain_template_.instantiate(callbacks);
+  }
+  bool createUpgradeFilterChain(absl::string_view, const UpgradeMap*,
+                                Http::FilterChainFactoryCallbacks&) override {
+    return false;
+  }
+
+private:
+  const FilterChainTemplate filter_chain_template_;
+};
+
+class StreamCreationFixture {
+public:
+  explicit StreamCreationFixture(uint32_t filter_count) {
+    for (uint32_t i = 0; i < filter_count; ++i) {
+      filter_factories_.push_back(
+          std::make_unique<Filter::StaticFilterConfigProviderImpl<Http::FilterFactoryCb>>(
+              [](Http::FilterChainFactoryCallbacks& callbacks) {
+                callbacks.addStreamFilter(std::make_shared<Http::PassThroughFilter>());
+              },
+              absl::StrCat("filter_", i)));
+    }
+  }
+
+  // Creates the filter manager of a stream with its filter chain, then tears it down.
+  void createStream(Http::FilterChainFactory& filter_chain_factory) {
+    Http::FilterManager filter_manager(filter_manager_callbacks_, dispatcher_, connection_, 0,
+                                       nullptr, true, 10000, filter_chain_factory, local_reply_,
+                                       Http::Protocol::Http2, time_source_, filter_state_,
+                                       StreamInfo::FilterState::LifeSpan::Connection);
+    filter_manager.createFilterChain();
+    filter_manager.destroyFilters();
+  }
+
+  FilterFactoriesList filter_factories_;
+  testing::NiceMock<Http::MockFilterManagerCallbacks> filter_manager_callbacks_;
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
+  testing::NiceMock<Network::MockConnection> connection_;
+  testing::NiceMock<LocalReply::MockLocalReply> local_reply_;
+  testing::NiceMock<MockTimeSystem> time_source_;
+  StreamInfo::FilterStateSharedPtr filter_state_ =
+      std::make_shared<StreamInfo::FilterStateImpl>(StreamInfo::FilterState::LifeSpan::Connection);
+};
+
+// Stream setup walking the filter config providers of the connection manager.
+static void BM_CreateStreamFromProviders(benchmark::State& state) {
+  StreamCreationFixture fixture(state.range(0));
+  ProviderFilterChainFactory filter_chain_factory(fixture.filter_factories_);
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    fixture.createStream(filter_chain_factory);
+  }
+}
+BENCHMARK(BM_CreateStreamFromProviders)->Arg(1)->Arg(15)->Unit(benchmark::kMicrosecond);
+
+// Stream setup instantiating a precomputed filter chain template.
+static void BM_CreateStreamFromTemplate(benchmark::State& state) {
+  StreamCreationFixture fixture(state.range(0));
+  TemplateFilterChainFactory filter_chain_factory(fixture.filter_factories_);
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    fixture.createStream(filter_chain_factory);
+  }
+}
+BENCHMARK(BM_CreateStreamFromTemplate)->Arg(1)->Arg(15)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace HttpConnectionManager
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
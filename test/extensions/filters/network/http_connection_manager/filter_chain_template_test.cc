@@ -0,0 +1,113 @@
+#include <memory>
+#include <string>
+
+#include "envoy/filter/config_provider_manager.h"
+
+#include "source/common/filter/config_discovery_impl.h"
+#include "source/extensions/filters/network/http_connection_manager/filter_chain_template.h"
+
+#include "test/mocks/http/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::InSequence;
+using testing::Invoke;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace HttpConnectionManager {
+namespace {
+
+// Provider standing in for one configured through discovery, whose config may change or be
+// missing.
+class TestDynamicFilterConfigProvider
+    : public Filter::DynamicFilterConfigProvider<Http::FilterFactoryCb> {
+public:
+  explicit TestDynamicFilterConfigProvider(const std::string& name) : name_(name) {}
+
+  // Config::ExtensionConfigProvider
+  const std::string& name() override { return name_; }
+  OptRef<Http::FilterFactoryCb> config() override {
+    if (config_.has_value()) {
+      return config_.value();
+    }
+    return absl::nullopt;
+  }
+
+  // Config::DynamicExtensionConfigProviderBase
+  void onConfigUpdate(const Protobuf::Message&, const std::string&,
+                      Config::ConfigAppliedCb) override {}
+  void onConfigRemoved(Config::ConfigAppliedCb) override {}
+  void applyDefaultConfiguration() override {}
+
+  const std::string name_;
+  absl::optional<Http::FilterFactoryCb> config_;
+};
+
+Http::FilterFactoryCb decoderFilterFactory(Http::StreamDecoderFilterSharedPtr filter) {
+  return [filter](Http::FilterChainFactoryCallbacks& callbacks) {
+    callbacks.addStreamDecoderFilter(filter);
+  };
+}
+
+TEST(FilterChainTemplateTest, StaticFiltersInConfigurationOrder) {
+  auto filter_a = std::make_shared<Http::MockStreamDecoderFilter>();
+  auto filter_b = std::make_shared<Http::MockStreamDecoderFilter>();
+  FilterFactoriesList filter_factories;
+  filter_factories.push_back(
+      std::make_unique<Filter::StaticFilterConfigProviderImpl<Http::FilterFactoryCb>>(
+          decoderFilterFactory(filter_a), "a"));
+  filter_factories.push_back(
+      std::make_unique<Filter::StaticFilterConfigProviderImpl<Http::FilterFactoryCb>>(
+          decoderFilterFactory(filter_b), "b"));
+
+  FilterChainTemplate filter_chain_template(filter_factories);
+  EXPECT_EQ(2, filter_chain_template.size());
+
+  // The template does not depend on the providers for inline filters.
+  filter_factories.clear();
+
+  Http::MockFilterChainFactoryCallbacks callbacks;
+  {
+    InSequence s;
+    EXPECT_CALL(callbacks, addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr(filter_a)));
+    EXPECT_CALL(callbacks, addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr(filter_b)));
+  }
+  filter_chain_template.instantiate(callbacks);
+}
+
+TEST(FilterChainTemplateTest, DynamicFilterConfigLookedUpPerStream) {
+  auto filter = std::make_shared<Http::MockStreamDecoderFilter>();
+  auto* provider_a = new TestDynamicFilterConfigProvider("a");
+  auto* provider_b = new TestDynamicFilterConfigProvider("b");
+  FilterFactoriesList filter_factories;
+  filter_factories.emplace_back(provider_a);
+  filter_factories.emplace_back(provider_b);
+  FilterChainTemplate filter_chain_template(filter_factories);
+
+  // Without config, a single filter sending a local reply is added for all the missing filters.
+  Http::MockFilterChainFactoryCallbacks missing_callbacks;
+  Http::StreamDecoderFilterSharedPtr missing_config_filter;
+  EXPECT_CALL(missing_callbacks, addStreamDecoderFilter(_))
+      .WillOnce(Invoke([&](Http::StreamDecoderFilterSharedPtr added) {
+        missing_config_filter = added;
+      }));
+  filter_chain_template.instantiate(missing_callbacks);
+  EXPECT_NE(nullptr, missing_config_filter);
+
+  provider_a->config_ = decoderFilterFactory(filter);
+  provider_b->config_ = decoderFilterFactory(filter);
+  Http::MockFilterChainFactoryCallbacks callbacks;
+  EXPECT_CALL(callbacks, addStreamDecoderFilter(Http::StreamDecoderFilterSharedPtr(filter)))
+      .Times(2);
+  filter_chain_template.instantiate(callbacks);
+}
+
+} // namespace
+} // namespace HttpConnectionManager
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,107 @@
+#include <string>
+
+#include "source/extensions/private_key_providers/thread_pool/config.h"
+#include "source/extensions/transport_sockets/tls/private_key/private_key_manager_impl.h"
+
+#include "test/mocks/server/transport_socket_factory_context.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+class ThreadPoolConfigTest : public testing::Test {
+public:
+  ThreadPoolConfigTest() : api_(Api::createApiForTest(store_)) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(factory_context_, sslContextManager()).WillByDefault(ReturnRef(context_manager_));
+    ON_CALL(context_manager_, privateKeyMethodManager())
+        .WillByDefault(ReturnRef(private_key_method_manager_));
+  }
+
+  Ssl::PrivateKeyMethodProviderSharedPtr createWithConfig(const std::string& yaml) {
+    envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider private_key_provider;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(yaml), private_key_provider);
+    return factory_context_.sslContextManager()
+        .privateKeyMethodManager()
+        .createPrivateKeyMethodProvider(private_key_provider, factory_context_);
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  NiceMock<Ssl::MockContextManager> context_manager_;
+  TransportSockets::Tls::PrivateKeyMethodManagerImpl private_key_method_manager_;
+};
+
+TEST_F(ThreadPoolConfigTest, CreateRsa) {
+  const std::string yaml = R"EOF(
+      provider_name: thread_pool
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+        thread_count: 2
+        private_key: { "filename": "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem" }
+)EOF";
+
+  Ssl::PrivateKeyMethodProviderSharedPtr provider = createWithConfig(yaml);
+  ASSERT_NE(nullptr, provider);
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method = provider->getBoringSslPrivateKeyMethod();
+  ASSERT_NE(nullptr, method);
+
+  // The methods fail for SSL objects the provider has not been registered with.
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL> ssl(SSL_new(ctx.get()));
+  EXPECT_EQ(ssl_private_key_failure, method->sign(ssl.get(), nullptr, nullptr, 0, 0, nullptr, 0));
+  EXPECT_EQ(ssl_private_key_failure, method->decrypt(ssl.get(), nullptr, nullptr, 0, nullptr, 0));
+  EXPECT_EQ(ssl_private_key_failure, method->complete(ssl.get(), nullptr, nullptr, 0));
+}
+
+TEST_F(ThreadPoolConfigTest, CreateEcdsa) {
+  const std::string yaml = R"EOF(
+      provider_name: thread_pool
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+        max_pending_operations: 16
+        private_key: { "filename": "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_ecdsa_p256_key.pem" }
+)EOF";
+
+  EXPECT_NE(nullptr, createWithConfig(yaml));
+}
+
+TEST_F(ThreadPoolConfigTest, InvalidPrivateKey) {
+  const std::string yaml = R"EOF(
+      provider_name: thread_pool
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+        private_key: { inline_string: "not a private key" }
+)EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(createWithConfig(yaml), EnvoyException, "Failed to read private key.");
+}
+
+TEST_F(ThreadPoolConfigTest, ZeroThreadCount) {
+  const std::string yaml = R"EOF(
+      provider_name: thread_pool
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+        thread_count: 0
+        private_key: { "filename": "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem" }
+)EOF";
+
+  EXPECT_THROW(createWithConfig(yaml), EnvoyException);
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
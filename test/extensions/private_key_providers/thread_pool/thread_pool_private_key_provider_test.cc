@@ -0,0 +1,192 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+class TestCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  explicit TestCallbacks(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  void onPrivateKeyMethodComplete() override {
+    completions_++;
+    dispatcher_.exit();
+  }
+
+  Event::Dispatcher& dispatcher_;
+  uint32_t completions_{};
+};
+
+class ThreadPoolPrivateKeyProviderTest : public testing::Test {
+protected:
+  ThreadPoolPrivateKeyProviderTest()
+      : api_(Api::createApiForTest(store_)), dispatcher_(api_->allocateDispatcher("test_thread")),
+        stats_({ALL_THREAD_POOL_PRIVATE_KEY_STATS(
+            POOL_COUNTER_PREFIX(store_, "thread_pool_private_key."),
+            POOL_GAUGE_PREFIX(store_, "thread_pool_private_key."),
+            POOL_HISTOGRAM_PREFIX(store_, "thread_pool_private_key."))}),
+        callbacks_(*dispatcher_) {}
+
+  bssl::UniquePtr<EVP_PKEY> loadKey(const std::string& file_name) {
+    const std::string key = TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/" + file_name));
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(key.data(), key.size()));
+    return bssl::UniquePtr<EVP_PKEY>(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  }
+
+  bool verify(EVP_PKEY* pkey, uint16_t signature_algorithm) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx = nullptr;
+    if (!EVP_DigestVerifyInit(ctx.get(), &pctx,
+                              SSL_get_signature_algorithm_digest(signature_algorithm), nullptr,
+                              pkey)) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) {
+      return false;
+    }
+    return EVP_DigestVerify(ctx.get(), out_, out_len_, in_, sizeof(in_));
+  }
+
+  Stats::TestUtil::TestStore store_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  ThreadPoolPrivateKeyStats stats_;
+  TestCallbacks callbacks_;
+
+  const uint8_t in_[32] = {0x7f};
+  uint8_t out_[1024] = {0};
+  size_t out_len_{};
+};
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RsaPssSign) {
+  bssl::UniquePtr<EVP_PKEY> pkey = loadKey("selfsigned_key.pem");
+  PrivateKeyThreadPool pool(api_->threadFactory(), 2, absl::nullopt, stats_);
+  ThreadPoolPrivateKeyConnection connection(callbacks_, *dispatcher_, bssl::UpRef(pkey), pool,
+                                            stats_);
+
+  EXPECT_EQ(ssl_private_key_retry,
+            connection.start(PrivateKeyOperation::Type::Sign, SSL_SIGN_RSA_PSS_RSAE_SHA256, in_,
+                             sizeof(in_), out_, &out_len_, sizeof(out_)));
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  EXPECT_EQ(1, callbacks_.completions_);
+
+  EXPECT_EQ(ssl_private_key_success, connection.complete(out_, &out_len_, sizeof(out_)));
+  EXPECT_TRUE(verify(pkey.get(), SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_EQ(1, store_.counter("thread_pool_private_key.offloaded").value());
+  EXPECT_EQ(0, store_.counter("thread_pool_private_key.overflow").value());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, EcdsaSign) {
+  bssl::UniquePtr<EVP_PKEY> pkey = loadKey("selfsigned_ecdsa_p256_key.pem");
+  PrivateKeyThreadPool pool(api_->threadFactory(), 1, absl::nullopt, stats_);
+  ThreadPoolPrivateKeyConnection connection(callbacks_, *dispatcher_, bssl::UpRef(pkey), pool,
+                                            stats_);
+
+  EXPECT_EQ(ssl_private_key_retry,
+            connection.start(PrivateKeyOperation::Type::Sign, SSL_SIGN_ECDSA_SECP256R1_SHA256, in_,
+                             sizeof(in_), out_, &out_len_, sizeof(out_)));
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+
+  EXPECT_EQ(ssl_private_key_success, connection.complete(out_, &out_len_, sizeof(out_)));
+  EXPECT_TRUE(verify(pkey.get(), SSL_SIGN_ECDSA_SECP256R1_SHA256));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, SignatureAlgorithmMismatch) {
+  bssl::UniquePtr<EVP_PKEY> pkey = loadKey("selfsigned_ecdsa_p256_key.pem");
+  PrivateKeyThreadPool pool(api_->threadFactory(), 1, absl::nullopt, stats_);
+  ThreadPoolPrivateKeyConnection connection(callbacks_, *dispatcher_, bssl::UpRef(pkey), pool,
+                                            stats_);
+
+  EXPECT_EQ(ssl_private_key_retry,
+            connection.start(PrivateKeyOperation::Type::Sign, SSL_SIGN_RSA_PSS_RSAE_SHA256, in_,
+                             sizeof(in_), out_, &out_len_, sizeof(out_)));
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+
+  EXPECT_EQ(ssl_private_key_failure, connection.complete(out_, &out_len_, sizeof(out_)));
+  EXPECT_EQ(1, store_.counter("thread_pool_private_key.failed").value());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RsaDecrypt) {
+  bssl::UniquePtr<EVP_PKEY> pkey = loadKey("selfsigned_key.pem");
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey.get());
+  const std::vector<uint8_t> plaintext(RSA_size(rsa), 0x01);
+  std::vector<uint8_t> ciphertext(RSA_size(rsa));
+  size_t ciphertext_len = 0;
+  ASSERT_TRUE(RSA_encrypt(rsa, &ciphertext_len, ciphertext.data(), ciphertext.size(),
+                          plaintext.data(), plaintext.size(), RSA_NO_PADDING));
+
+  PrivateKeyThreadPool pool(api_->threadFactory(), 1, absl::nullopt, stats_);
+  ThreadPoolPrivateKeyConnection connection(callbacks_, *dispatcher_, bssl::UpRef(pkey), pool,
+                                            stats_);
+  EXPECT_EQ(ssl_private_key_retry,
+            connection.start(PrivateKeyOperation::Type::Decrypt, 0, ciphertext.data(),
+                             ciphertext_len, out_, &out_len_, sizeof(out_)));
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+
+  EXPECT_EQ(ssl_private_key_success, connection.complete(out_, &out_len_, sizeof(out_)));
+  EXPECT_EQ(plaintext, std::vector<uint8_t>(out_, out_ + out_len_));
+}
+
+// Operations exceeding max_pending_operations run synchronously on the calling thread. The pool
+// has no threads so that the first operation deterministically stays pending.
+TEST_F(ThreadPoolPrivateKeyProviderTest, OverflowRunsInline) {
+  bssl::UniquePtr<EVP_PKEY> pkey = loadKey("selfsigned_ecdsa_p256_key.pem");
+  PrivateKeyThreadPool pool(api_->threadFactory(), 0, 1, stats_);
+  ThreadPoolPrivateKeyConnection queued(callbacks_, *dispatcher_, bssl::UpRef(pkey), pool, stats_);
+  ThreadPoolPrivateKeyConnection inline_connection(callbacks_, *dispatcher_, bssl::UpRef(pkey),
+                                                   pool, stats_);
+
+  EXPECT_EQ(ssl_private_key_retry,
+            queued.start(PrivateKeyOperation::Type::Sign, SSL_SIGN_ECDSA_SECP256R1_SHA256, in_,
+                         sizeof(in_), out_, &out_len_, sizeof(out_)));
+  EXPECT_EQ(ssl_private_key_retry, queued.complete(out_, &out_len_, sizeof(out_)));
+  EXPECT_EQ(1, store_.gauge("thread_pool_private_key.pending_operations",
+                            Stats::Gauge::ImportMode::Accumulate)
+                   .value());
+
+  EXPECT_EQ(ssl_private_key_success,
+            inline_connection.start(PrivateKeyOperation::Type::Sign,
+                                    SSL_SIGN_ECDSA_SECP256R1_SHA256, in_, sizeof(in_), out_,
+                                    &out_len_, sizeof(out_)));
+  EXPECT_TRUE(verify(pkey.get(), SSL_SIGN_ECDSA_SECP256R1_SHA256));
+  EXPECT_EQ(1, store_.counter("thread_pool_private_key.offloaded").value());
+  EXPECT_EQ(1, store_.counter("thread_pool_private_key.overflow").value());
+}
+
+// A connection going away while its operation is in flight must not be called back.
+TEST_F(ThreadPoolPrivateKeyProviderTest, ConnectionDestroyedBeforeCompletion) {
+  bssl::UniquePtr<EVP_PKEY> pkey = loadKey("selfsigned_key.pem");
+  PrivateKeyThreadPool pool(api_->threadFactory(), 1, absl::nullopt, stats_);
+  {
+    ThreadPoolPrivateKeyConnection connection(callbacks_, *dispatcher_, bssl::UpRef(pkey), pool,
+                                              stats_);
+    EXPECT_EQ(ssl_private_key_retry,
+              connection.start(PrivateKeyOperation::Type::Sign, SSL_SIGN_RSA_PSS_RSAE_SHA256, in_,
+                               sizeof(in_), out_, &out_len_, sizeof(out_)));
+  }
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(0, callbacks_.completions_);
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
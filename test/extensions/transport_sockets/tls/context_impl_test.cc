@@ -449,7 +449,7 @@ TEST_F(SslContextImplTest, TestNoCert) {
   EXPECT_TRUE(context->getCertChainInformation().empty());
 }
 
-// Multiple RSA certificates are rejected.
+// Multiple RSA certificates for the same names are rejected.
 TEST_F(SslContextImplTest, AtMostOneRsaCert) {
   envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
   const std::string tls_context_yaml = R"EOF(
@@ -471,7 +471,7 @@ TEST_F(SslContextImplTest, AtMostOneRsaCert) {
                           "at most one certificate of a given type may be specified");
 }
 
-// Multiple ECDSA certificates are rejected.
+// Multiple ECDSA certificates for the same names are rejected.
 TEST_F(SslContextImplTest, AtMostOneEcdsaCert) {
   envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
   const std::string tls_context_yaml = R"EOF(
@@ -493,6 +493,30 @@ TEST_F(SslContextImplTest, AtMostOneEcdsaCert) {
                           "at most one certificate of a given type may be specified");
 }
 
+// Multiple certificates of a type are accepted if each of them serves a name not served by the
+// previous ones.
+TEST_F(SslContextImplTest, MultipleRsaCertsForDifferentNames) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_key.pem"
+  )EOF";
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  Envoy::Ssl::ServerContextSharedPtr context(
+      manager_.createSslServerContext(store_, server_context_config, {}));
+  auto cleanup = cleanUpHelper(context);
+  EXPECT_EQ(2, context->getCertChainInformation().size());
+}
+
 // Certificates with no subject CN and no SANs are rejected.
 TEST_F(SslContextImplTest, MustHaveSubjectOrSAN) {
   envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
@@ -1033,6 +1057,41 @@ TEST_F(SslServerContextImplTicketTest, StatelessSessionResumptionEnabledWhenKeyI
   EXPECT_FALSE(server_context_config.disableStatelessSessionResumption());
 }
 
+TEST_F(SslServerContextImplTicketTest, StatefulSessionCacheDisabledByDefault) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+  )EOF";
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  EXPECT_EQ(0, server_context_config.maxStatefulSessions());
+}
+
+TEST_F(SslServerContextImplTicketTest, StatefulSessionCacheConfigured) {
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+  stateful_session_cache:
+    max_entries: 1024
+  )EOF";
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  EXPECT_EQ(1024, server_context_config.maxStatefulSessions());
+
+  EXPECT_NO_THROW(loadConfigYaml(tls_context_yaml));
+}
+
 class ClientContextConfigImplTest : public SslCertsTest {
 public:
   ABSL_MUST_USE_RESULT Cleanup cleanUpHelper(Envoy::Ssl::ClientContextSharedPtr& context) {
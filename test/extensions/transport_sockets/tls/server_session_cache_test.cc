@@ -0,0 +1,121 @@
+#include <string>
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/transport_sockets/tls/server_session_cache.h"
+#include "source/extensions/transport_sockets/tls/stats.h"
+
+#include "test/test_common/simulated_time_system.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+class ServerSessionCacheTest : public testing::Test {
+public:
+  ServerSessionCacheTest()
+      : ssl_ctx_(SSL_CTX_new(TLS_method())), stats_(generateSslStats(store_)) {}
+
+  // Returns a new session with the given ID. The caller owns the returned reference.
+  SSL_SESSION* newSession(const std::string& id, uint32_t timeout = 300) {
+    SSL_SESSION* session = SSL_SESSION_new(ssl_ctx_.get());
+    EXPECT_EQ(1, SSL_SESSION_set1_id(session, reinterpret_cast<const uint8_t*>(id.data()),
+                                     id.size()));
+    SSL_SESSION_set_timeout(session, timeout);
+    return session;
+  }
+
+  bssl::UniquePtr<SSL_SESSION> lookup(ServerSessionCache& cache, const std::string& id) {
+    return bssl::UniquePtr<SSL_SESSION>(cache.lookup(
+        absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(id.data()), id.size())));
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  Stats::IsolatedStoreImpl store_;
+  SslStats stats_;
+};
+
+TEST_F(ServerSessionCacheTest, InsertAndLookup) {
+  ServerSessionCache cache(100, stats_, time_system_);
+  SSL_SESSION* session = newSession("session1");
+  EXPECT_EQ(1, cache.insert(session));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(1, stats_.session_cache_size_.value());
+
+  auto found = lookup(cache, "session1");
+  EXPECT_EQ(session, found.get());
+  EXPECT_EQ(1, stats_.session_cache_hit_.value());
+
+  EXPECT_EQ(nullptr, lookup(cache, "session2"));
+  EXPECT_EQ(1, stats_.session_cache_miss_.value());
+}
+
+TEST_F(ServerSessionCacheTest, SessionWithoutIdIsNotCached) {
+  ServerSessionCache cache(100, stats_, time_system_);
+  bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ssl_ctx_.get()));
+  EXPECT_EQ(0, cache.insert(session.get()));
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST_F(ServerSessionCacheTest, ReinsertReplacesSession) {
+  ServerSessionCache cache(100, stats_, time_system_);
+  EXPECT_EQ(1, cache.insert(newSession("session1")));
+  SSL_SESSION* replacement = newSession("session1");
+  EXPECT_EQ(1, cache.insert(replacement));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(replacement, lookup(cache, "session1").get());
+  EXPECT_EQ(0, stats_.session_cache_eviction_.value());
+}
+
+TEST_F(ServerSessionCacheTest, ExpiredSessionIsEvicted) {
+  ServerSessionCache cache(100, stats_, time_system_);
+  EXPECT_EQ(1, cache.insert(newSession("session1", 10)));
+  time_system_.advanceTimeWait(std::chrono::seconds(9));
+  EXPECT_NE(nullptr, lookup(cache, "session1"));
+
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_EQ(nullptr, lookup(cache, "session1"));
+  EXPECT_EQ(1, stats_.session_cache_eviction_.value());
+  EXPECT_EQ(1, stats_.session_cache_miss_.value());
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, stats_.session_cache_size_.value());
+}
+
+// With a single shard, the oldest session is evicted once the cache is full.
+TEST_F(ServerSessionCacheTest, OldestSessionIsEvictedWhenFull) {
+  ServerSessionCache cache(1, stats_, time_system_);
+  EXPECT_EQ(1, cache.insert(newSession("session1")));
+  EXPECT_EQ(1, cache.insert(newSession("session2")));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(1, stats_.session_cache_eviction_.value());
+  EXPECT_EQ(nullptr, lookup(cache, "session1"));
+  EXPECT_NE(nullptr, lookup(cache, "session2"));
+}
+
+TEST_F(ServerSessionCacheTest, SizeIsBounded) {
+  {
+    ServerSessionCache cache(64, stats_, time_system_);
+    for (int i = 0; i < 1000; ++i) {
+      EXPECT_EQ(1, cache.insert(newSession(absl::StrCat("session", i))));
+    }
+    EXPECT_LE(cache.size(), 64);
+    EXPECT_EQ(cache.size(), stats_.session_cache_size_.value());
+    EXPECT_EQ(1000 - cache.size(), stats_.session_cache_eviction_.value());
+    // The most recent session is always available.
+    EXPECT_NE(nullptr, lookup(cache, "session999"));
+  }
+  // Destroying the cache releases its share of the gauge.
+  EXPECT_EQ(0, stats_.session_cache_size_.value());
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
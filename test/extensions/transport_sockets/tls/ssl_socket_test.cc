@@ -30,6 +30,7 @@
 #include "test/extensions/transport_sockets/tls/test_data/san_dns3_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_data/san_dns4_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_data/san_dns_cert_info.h"
+#include "test/extensions/transport_sockets/tls/test_data/san_multiple_dns_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_data/san_uri_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_data/selfsigned_ecdsa_p256_cert_info.h"
 #include "test/extensions/transport_sockets/tls/test_private_key_method_provider.h"
@@ -1252,6 +1253,106 @@ TEST_P(SslSocketTest, MultiCertPreferEcdsa) {
   testUtil(test_options);
 }
 
+namespace {
+
+// Server context holding certificates for different names, selected by SNI:
+// - san_dns_cert (RSA): server1.example.com
+// - san_multiple_dns_cert (RSA): *.example.com, server2.example.com
+// - selfsigned_ecdsa_p256_cert (ECDSA): server1.example.com
+const std::string sni_server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_ecdsa_p256_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_ecdsa_p256_key.pem"
+)EOF";
+
+std::string sniClientCtxYaml(absl::string_view sni, absl::string_view cipher_suites,
+                             absl::string_view expected_cert_hash) {
+  return absl::StrCat(R"EOF(
+    sni: )EOF",
+                      sni, R"EOF(
+    common_tls_context:
+      tls_params:
+        tls_minimum_protocol_version: TLSv1_2
+        tls_maximum_protocol_version: TLSv1_2
+        cipher_suites:
+)EOF",
+                      cipher_suites, R"EOF(
+      validation_context:
+        verify_certificate_hash: )EOF",
+                      expected_cert_hash);
+}
+
+constexpr absl::string_view RsaCipherSuites = "        - ECDHE-RSA-AES128-GCM-SHA256";
+constexpr absl::string_view EcdsaAndRsaCipherSuites = R"EOF(        - ECDHE-ECDSA-AES128-GCM-SHA256
+        - ECDHE-RSA-AES128-GCM-SHA256)EOF";
+
+} // namespace
+
+TEST_P(SslSocketTest, MultiCertSniExactMatch) {
+  TestUtilOptions test_options(sniClientCtxYaml("server2.example.com", RsaCipherSuites,
+                                                TEST_SAN_MULTIPLE_DNS_CERT_256_HASH),
+                               sni_server_ctx_yaml, true, GetParam());
+  testUtil(test_options.setExpectedSni("server2.example.com"));
+}
+
+TEST_P(SslSocketTest, MultiCertSniWildcardMatch) {
+  TestUtilOptions test_options(sniClientCtxYaml("www.example.com", RsaCipherSuites,
+                                                TEST_SAN_MULTIPLE_DNS_CERT_256_HASH),
+                               sni_server_ctx_yaml, true, GetParam());
+  testUtil(test_options.setExpectedSni("www.example.com"));
+}
+
+// An exact name takes precedence over a wildcard name matching the same server name.
+TEST_P(SslSocketTest, MultiCertSniExactMatchPrecedesWildcard) {
+  TestUtilOptions test_options(
+      sniClientCtxYaml("server1.example.com", RsaCipherSuites, TEST_SAN_DNS_CERT_256_HASH),
+      sni_server_ctx_yaml, true, GetParam());
+  testUtil(test_options.setExpectedSni("server1.example.com"));
+}
+
+// Server names are matched case insensitively.
+TEST_P(SslSocketTest, MultiCertSniCaseInsensitive) {
+  TestUtilOptions test_options(sniClientCtxYaml("Server2.Example.com", RsaCipherSuites,
+                                                TEST_SAN_MULTIPLE_DNS_CERT_256_HASH),
+                               sni_server_ctx_yaml, true, GetParam());
+  testUtil(test_options);
+}
+
+// Without a matching certificate, the selection falls back to all the certificates.
+TEST_P(SslSocketTest, MultiCertSniNoMatch) {
+  TestUtilOptions test_options(
+      sniClientCtxYaml("www.lyft.com", RsaCipherSuites, TEST_SAN_DNS_CERT_256_HASH),
+      sni_server_ctx_yaml, true, GetParam());
+  testUtil(test_options.setExpectedSni("www.lyft.com"));
+}
+
+// Among the certificates matching the server name, ECDSA is preferred for capable clients.
+TEST_P(SslSocketTest, MultiCertSniPreferEcdsa) {
+  TestUtilOptions test_options(sniClientCtxYaml("server1.example.com", EcdsaAndRsaCipherSuites,
+                                                TEST_SELFSIGNED_ECDSA_P256_CERT_256_HASH),
+                               sni_server_ctx_yaml, true, GetParam());
+  testUtil(test_options);
+}
+
+// An ECDSA certificate for another name is not selected.
+TEST_P(SslSocketTest, MultiCertSniEcdsaOtherName) {
+  TestUtilOptions test_options(sniClientCtxYaml("server2.example.com", EcdsaAndRsaCipherSuites,
+                                                TEST_SAN_MULTIPLE_DNS_CERT_256_HASH),
+                               sni_server_ctx_yaml, true, GetParam());
+  testUtil(test_options);
+}
+
 TEST_P(SslSocketTest, GetUriWithLocalUriSan) {
   const std::string client_ctx_yaml = R"EOF(
   common_tls_context:
@@ -3202,6 +3303,131 @@ void testSupportForStatelessSessionResumption(const std::string& server_ctx_yaml
   dispatcher->run(Event::Dispatcher::RunType::Block);
 }
 
+// Connects twice to the same listener, the second time with the session of the first connection.
+void testStatefulSessionResumption(const std::string& server_ctx_yaml,
+                                   const std::string& client_ctx_yaml,
+                                   const Network::Address::IpVersion ip_version) {
+  Event::SimulatedTimeSystem time_system;
+  ContextManagerImpl manager(*time_system);
+
+  Stats::TestUtil::TestStore server_stats_store;
+  Api::ApiPtr server_api = Api::createApiForTest(server_stats_store, time_system);
+  NiceMock<Runtime::MockLoader> runtime;
+  testing::NiceMock<Server::Configuration::MockTransportSocketFactoryContext>
+      server_factory_context;
+  ON_CALL(server_factory_context, api()).WillByDefault(ReturnRef(*server_api));
+
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext server_tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), server_tls_context);
+  auto server_cfg =
+      std::make_unique<ServerContextConfigImpl>(server_tls_context, server_factory_context);
+  ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager,
+                                                   server_stats_store, {});
+
+  auto tcp_socket = std::make_shared<Network::Test::TcpListenSocketImmediateListen>(
+      Network::Test::getCanonicalLoopbackAddress(ip_version));
+  NiceMock<Network::MockTcpListenerCallbacks> callbacks;
+  Event::DispatcherPtr dispatcher(server_api->allocateDispatcher("test_thread"));
+  Network::ListenerPtr listener =
+      dispatcher->createListener(tcp_socket, callbacks, runtime, true, false);
+
+  envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext client_tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml), client_tls_context);
+
+  Stats::TestUtil::TestStore client_stats_store;
+  Api::ApiPtr client_api = Api::createApiForTest(client_stats_store, time_system);
+  testing::NiceMock<Server::Configuration::MockTransportSocketFactoryContext>
+      client_factory_context;
+  ON_CALL(client_factory_context, api()).WillByDefault(ReturnRef(*client_api));
+
+  auto client_cfg =
+      std::make_unique<ClientContextConfigImpl>(client_tls_context, client_factory_context);
+  ClientSslSocketFactory ssl_socket_factory(std::move(client_cfg), manager, client_stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher->createClientConnection(
+      tcp_socket->connectionInfoProvider().localAddress(),
+      Network::Address::InstanceConstSharedPtr(), ssl_socket_factory.createTransportSocket(nullptr),
+      nullptr);
+
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  client_connection->connect();
+
+  SSL_SESSION* ssl_session = nullptr;
+  Network::ConnectionPtr server_connection;
+  StreamInfo::StreamInfoImpl stream_info(time_system, nullptr);
+  EXPECT_CALL(callbacks, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server_connection = dispatcher->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket(nullptr),
+            stream_info);
+      }));
+
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        const SslHandshakerImpl* ssl_socket =
+            dynamic_cast<const SslHandshakerImpl*>(client_connection->ssl().get());
+        ssl_session = SSL_get1_session(ssl_socket->ssl());
+        EXPECT_TRUE(SSL_SESSION_is_resumable(ssl_session));
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+        server_connection->close(Network::ConnectionCloseType::NoFlush);
+        dispatcher->exit();
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+  dispatcher->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(0UL, server_stats_store.counter("ssl.session_reused").value());
+  EXPECT_EQ(0UL, server_stats_store.counter("ssl.session_cache_hit").value());
+
+  client_connection = dispatcher->createClientConnection(
+      tcp_socket->connectionInfoProvider().localAddress(),
+      Network::Address::InstanceConstSharedPtr(), ssl_socket_factory.createTransportSocket(nullptr),
+      nullptr);
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  const SslHandshakerImpl* ssl_socket =
+      dynamic_cast<const SslHandshakerImpl*>(client_connection->ssl().get());
+  SSL_set_session(ssl_socket->ssl(), ssl_session);
+  SSL_SESSION_free(ssl_session);
+
+  client_connection->connect();
+
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  StreamInfo::StreamInfoImpl stream_info2(time_system, nullptr);
+  EXPECT_CALL(callbacks, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server_connection = dispatcher->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket(nullptr),
+            stream_info2);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+
+  // The client or the server may get the Connected event first, so wait until both have.
+  size_t connect_count = 0;
+  auto connect_second_time = [&]() {
+    if (++connect_count == 2) {
+      EXPECT_NE(EMPTY_STRING, server_connection->ssl()->sessionId());
+      EXPECT_EQ(server_connection->ssl()->sessionId(), client_connection->ssl()->sessionId());
+      client_connection->close(Network::ConnectionCloseType::NoFlush);
+      server_connection->close(Network::ConnectionCloseType::NoFlush);
+      dispatcher->exit();
+    }
+  };
+
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { connect_second_time(); }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { connect_second_time(); }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+  dispatcher->run(Event::Dispatcher::RunType::Block);
+
+  // The session was resumed from the stateful session cache.
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.session_reused").value());
+  EXPECT_EQ(1UL, client_stats_store.counter("ssl.session_reused").value());
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.session_cache_hit").value());
+}
+
 } // namespace
 
 TEST_P(SslSocketTest, TicketSessionResumption) {
@@ -3699,6 +3925,29 @@ TEST_P(SslSocketTest, StatelessSessionResumptionEnabledByDefault) {
   testSupportForStatelessSessionResumption(server_ctx_yaml, client_ctx_yaml, true, GetParam());
 }
 
+// Test that sessions are resumed with session IDs through the stateful session cache.
+TEST_P(SslSocketTest, StatefulSessionCacheResumption) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+  disable_stateless_session_resumption: true
+  stateful_session_cache:
+    max_entries: 16
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      tls_params:
+        tls_maximum_protocol_version: TLSv1_2
+  )EOF";
+
+  testStatefulSessionResumption(server_ctx_yaml, client_ctx_yaml, GetParam());
+}
+
 // Test that if two listeners use the same cert and session ticket key, but
 // different client CA, that sessions cannot be resumed.
 TEST_P(SslSocketTest, ClientAuthCrossListenerSessionResumption) {
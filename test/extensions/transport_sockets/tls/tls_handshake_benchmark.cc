@@ -0,0 +1,384 @@
+// Handshake rate benchmarks for the TLS transport socket. The handshakes are driven through
+// SslHandshakerImpl on both sides of a local socket pair, with SSL objects created by the real
+// client and server contexts, so that certificate selection, OCSP stapling, session resumption and
+// certificate validation in ContextImpl are part of the measurement.
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/transport_sockets/tls/v3/cert.pb.h"
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/transport_sockets/tls/context_config_impl.h"
+#include "source/extensions/transport_sockets/tls/context_impl.h"
+#include "source/extensions/transport_sockets/tls/context_manager_impl.h"
+#include "source/extensions/transport_sockets/tls/ssl_handshaker.h"
+
+#include "test/mocks/network/connection.h"
+#include "test/mocks/server/transport_socket_factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+#include "openssl/x509.h"
+#include "tools/cpp/runfiles/runfiles.h"
+
+namespace Envoy {
+namespace Extensions::TransportSockets::Tls {
+
+namespace {
+
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+constexpr absl::string_view TestDataDir = "{{ test_rundir }}/test/extensions/transport_sockets/tls";
+
+enum class KeyType { Rsa, Ecdsa };
+
+class BenchmarkHandshakeCallbacks : public Ssl::HandshakeCallbacks {
+public:
+  explicit BenchmarkHandshakeCallbacks(Network::Connection& connection) : connection_(connection) {}
+
+  // Ssl::HandshakeCallbacks
+  Network::Connection& connection() const override { return connection_; }
+  void onSuccess(SSL*) override { complete_ = true; }
+  void onFailure() override { PANIC("TLS handshake failed"); }
+  Network::TransportSocketCallbacks* transportSocketCallbacks() override { return nullptr; }
+
+  bool complete_{};
+
+private:
+  Network::Connection& connection_;
+};
+
+/**
+ * Client and server contexts built from YAML, and the loop running one handshake between them.
+ */
+class HandshakeFixture {
+public:
+  HandshakeFixture(const std::string& server_yaml, const std::string& client_yaml)
+      : api_(Api::createApiForTest(store_)), manager_(api_->timeSource()) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(connection_, state()).WillByDefault(Return(Network::Connection::State::Open));
+
+    envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext server_tls_context;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(server_yaml), server_tls_context);
+    ServerContextConfigImpl server_config(server_tls_context, factory_context_);
+    server_context_ = std::dynamic_pointer_cast<ContextImpl>(
+        manager_.createSslServerContext(store_, server_config, {}));
+
+    envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext client_tls_context;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(client_yaml), client_tls_context);
+    ClientContextConfigImpl client_config(client_tls_context, factory_context_);
+    client_context_ =
+        std::dynamic_pointer_cast<ContextImpl>(manager_.createSslClientContext(store_, client_config));
+  }
+
+  /**
+   * Runs a handshake to completion.
+   * @param session supplies a session to resume, if not nullptr.
+   * @param request_ocsp whether the client requests a stapled OCSP response.
+   * @return the client session, which can be resumed by later handshakes.
+   */
+  bssl::UniquePtr<SSL_SESSION> handshake(SSL_SESSION* session, bool request_ocsp) {
+    int sockets[2];
+    RELEASE_ASSERT(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets) == 0,
+                   "socketpair");
+
+    bssl::UniquePtr<SSL> server_ssl = server_context_->newSsl(nullptr);
+    SSL_set_fd(server_ssl.get(), sockets[0]);
+    SSL_set_accept_state(server_ssl.get());
+
+    bssl::UniquePtr<SSL> client_ssl = client_context_->newSsl(nullptr);
+    SSL_set_fd(client_ssl.get(), sockets[1]);
+    SSL_set_connect_state(client_ssl.get());
+    if (session != nullptr) {
+      SSL_set_session(client_ssl.get(), session);
+    }
+    if (request_ocsp) {
+      SSL_enable_ocsp_stapling(client_ssl.get());
+    }
+
+    BenchmarkHandshakeCallbacks server_callbacks(connection_);
+    BenchmarkHandshakeCallbacks client_callbacks(connection_);
+    SslHandshakerImpl server(std::move(server_ssl), ContextImpl::sslExtendedSocketInfoIndex(),
+                             &server_callbacks);
+    SslHandshakerImpl client(std::move(client_ssl), ContextImpl::sslExtendedSocketInfoIndex(),
+                             &client_callbacks);
+
+    for (int i = 0; i < 50 && !(server_callbacks.complete_ && client_callbacks.complete_); i++) {
+      if (!client_callbacks.complete_) {
+        client.doHandshake();
+      }
+      if (!server_callbacks.complete_) {
+        server.doHandshake();
+      }
+    }
+    RELEASE_ASSERT(server_callbacks.complete_ && client_callbacks.complete_,
+                   "handshake did not complete");
+    RELEASE_ASSERT(session == nullptr || SSL_session_reused(client.ssl()),
+                   "session was not resumed");
+
+    bssl::UniquePtr<SSL_SESSION> client_session(SSL_get1_session(client.ssl()));
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+    return client_session;
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  ContextManagerImpl manager_;
+  // Shared by all the handshakes, as mock construction would otherwise dominate the measurement.
+  NiceMock<Network::MockConnection> connection_;
+  ContextImplSharedPtr server_context_;
+  ContextImplSharedPtr client_context_;
+};
+
+void initializeRunfiles() {
+  static std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles = []() {
+    std::string error;
+    std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles(
+        bazel::tools::cpp::runfiles::Runfiles::Create("tls_handshake_benchmark", &error));
+    TestEnvironment::setRunfiles(runfiles.get());
+    return runfiles;
+  }();
+}
+
+std::string certificateYaml(absl::string_view cert, absl::string_view key,
+                            absl::string_view ocsp_staple = "") {
+  std::string yaml = absl::StrCat(R"EOF(
+    - certificate_chain:
+        filename: ")EOF",
+                                  TestDataDir, "/", cert, R"EOF("
+      private_key:
+        filename: ")EOF",
+                                  TestDataDir, "/", key, "\"\n");
+  if (!ocsp_staple.empty()) {
+    absl::StrAppend(&yaml, "      ocsp_staple:\n        filename: \"", TestDataDir, "/",
+                    ocsp_staple, "\"\n");
+  }
+  return yaml;
+}
+
+std::string serverYaml(const std::string& certificates, absl::string_view extra = "") {
+  return absl::StrCat("common_tls_context:\n  tls_certificates:", certificates, extra);
+}
+
+// Clients negotiate TLS 1.2, their default maximum version, so that the certificate key type can
+// be selected through the offered cipher suites, and so that the session established by a first
+// handshake is available once it completes and can be resumed any number of times.
+std::string clientYaml(KeyType key_type, absl::string_view validation = "",
+                       absl::string_view sni = "") {
+  return absl::StrCat(sni.empty() ? "" : absl::StrCat("sni: ", sni, "\n"), R"EOF(
+max_session_keys: 0
+common_tls_context:
+  tls_params:
+    cipher_suites:
+)EOF",
+                      key_type == KeyType::Rsa ? "    - ECDHE-RSA-AES128-GCM-SHA256\n"
+                                               : "    - ECDHE-ECDSA-AES128-GCM-SHA256\n",
+                      validation);
+}
+
+std::string certificatesFor(KeyType key_type) {
+  return key_type == KeyType::Rsa
+             ? certificateYaml("test_data/san_dns_cert.pem", "test_data/san_dns_key.pem")
+             : certificateYaml("test_data/selfsigned_ecdsa_p256_cert.pem",
+                               "test_data/selfsigned_ecdsa_p256_key.pem");
+}
+
+// Generates a self-signed P-256 ECDSA certificate for the given subject CN and writes it, with its
+// key, to temporary files.
+// @return the certificate as a tls_certificates entry.
+std::string generateCertificate(const std::string& name) {
+  bssl::UniquePtr<EC_KEY> ec_key(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  RELEASE_ASSERT(ec_key != nullptr && EC_KEY_generate_key(ec_key.get()), "EC_KEY_generate_key");
+  bssl::UniquePtr<EVP_PKEY> key(EVP_PKEY_new());
+  RELEASE_ASSERT(EVP_PKEY_set1_EC_KEY(key.get(), ec_key.get()), "EVP_PKEY_set1_EC_KEY");
+
+  bssl::UniquePtr<X509> cert(X509_new());
+  X509_NAME* subject = X509_get_subject_name(cert.get());
+  RELEASE_ASSERT(X509_set_version(cert.get(), 2) &&
+                     ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1) &&
+                     X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0) &&
+                     X509_gmtime_adj(X509_getm_notAfter(cert.get()), 24 * 3600) &&
+                     X509_NAME_add_entry_by_txt(subject, "CN", MBSTRING_ASC,
+                                                reinterpret_cast<const uint8_t*>(name.c_str()),
+                                                -1, -1, 0) &&
+                     X509_set_issuer_name(cert.get(), subject) &&
+                     X509_set_pubkey(cert.get(), key.get()) &&
+                     X509_sign(cert.get(), key.get(), EVP_sha256()),
+                 "failed to generate certificate");
+
+  auto toPem = [](auto write) {
+    bssl::UniquePtr<BIO> bio(BIO_new(BIO_s_mem()));
+    RELEASE_ASSERT(write(bio.get()), "PEM write failed");
+    const uint8_t* data;
+    size_t len;
+    BIO_mem_contents(bio.get(), &data, &len);
+    return std::string(reinterpret_cast<const char*>(data), len);
+  };
+  const std::string cert_path = TestEnvironment::writeStringToFileForTest(
+      absl::StrCat(name, "_cert.pem"),
+      toPem([&](BIO* bio) { return PEM_write_bio_X509(bio, cert.get()); }));
+  const std::string key_path = TestEnvironment::writeStringToFileForTest(
+      absl::StrCat(name, "_key.pem"), toPem([&](BIO* bio) {
+        return PEM_write_bio_PrivateKey(bio, key.get(), nullptr, nullptr, 0, nullptr, nullptr);
+      }));
+  return absl::StrCat("\n    - certificate_chain:\n        filename: \"", cert_path,
+                      "\"\n      private_key:\n        filename: \"", key_path, "\"\n");
+}
+
+void reportRate(benchmark::State& state) {
+  state.counters["handshakes_per_second"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+} // namespace
+
+// Full handshakes. range(0) selects the server key type.
+static void BM_FullHandshake(benchmark::State& state) {
+  initializeRunfiles();
+  const KeyType key_type = static_cast<KeyType>(state.range(0));
+  HandshakeFixture fixture(serverYaml(certificatesFor(key_type)), clientYaml(key_type));
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    fixture.handshake(nullptr, false);
+  }
+  reportRate(state);
+}
+BENCHMARK(BM_FullHandshake)
+    ->Arg(static_cast<int>(KeyType::Rsa))
+    ->Arg(static_cast<int>(KeyType::Ecdsa))
+    ->Unit(benchmark::kMicrosecond);
+
+// Abbreviated handshakes resuming the session of a first full handshake. range(0) selects the
+// server key type, range(1) whether the session is resumed from a session ticket (1) or from the
+// stateful session cache (0).
+static void BM_ResumedHandshake(benchmark::State& state) {
+  initializeRunfiles();
+  const KeyType key_type = static_cast<KeyType>(state.range(0));
+  const bool tickets = state.range(1) != 0;
+  HandshakeFixture fixture(
+      serverYaml(certificatesFor(key_type),
+                 tickets ? "" : "\ndisable_stateless_session_resumption: true\n"),
+      clientYaml(key_type));
+  bssl::UniquePtr<SSL_SESSION> session = fixture.handshake(nullptr, false);
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    fixture.handshake(session.get(), false);
+  }
+  reportRate(state);
+}
+BENCHMARK(BM_ResumedHandshake)
+    ->ArgsProduct({{static_cast<int>(KeyType::Rsa), static_cast<int>(KeyType::Ecdsa)}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Full handshakes with OCSP stapling. range(0) selects the server key type, range(1) whether the
+// client requests the stapled response.
+static void BM_OcspStapledHandshake(benchmark::State& state) {
+  initializeRunfiles();
+  const KeyType key_type = static_cast<KeyType>(state.range(0));
+  const bool request_ocsp = state.range(1) != 0;
+  const std::string certificates =
+      key_type == KeyType::Rsa
+          ? certificateYaml("ocsp/test_data/good_cert.pem", "ocsp/test_data/good_key.pem",
+                            "ocsp/test_data/good_ocsp_resp.der")
+          : certificateYaml("ocsp/test_data/ecdsa_cert.pem", "ocsp/test_data/ecdsa_key.pem",
+                            "ocsp/test_data/ecdsa_ocsp_resp.der");
+  HandshakeFixture fixture(serverYaml(certificates, "\nocsp_staple_policy: lenient_stapling\n"),
+                           clientYaml(key_type));
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    fixture.handshake(nullptr, request_ocsp);
+  }
+  reportRate(state);
+}
+BENCHMARK(BM_OcspStapledHandshake)
+    ->ArgsProduct({{static_cast<int>(KeyType::Rsa), static_cast<int>(KeyType::Ecdsa)}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+// Full handshakes with the client validating the server certificate. range(0) selects the
+// default certificate validator (0) or the SPIFFE validator (1).
+static void BM_ValidatedHandshake(benchmark::State& state) {
+  initializeRunfiles();
+  const std::string ca = absl::StrCat(TestDataDir, "/test_data/ca_cert.pem");
+  const std::string validation =
+      state.range(0) == 0
+          ? absl::StrCat("  validation_context:\n    trusted_ca:\n      filename: \"", ca, "\"\n")
+          : absl::StrCat(R"EOF(  validation_context:
+    custom_validator_config:
+      name: envoy.tls.cert_validator.spiffe
+      typed_config:
+        "@type": type.googleapis.com/envoy.extensions.transport_sockets.tls.v3.SPIFFECertValidatorConfig
+        trust_domains:
+        - name: example.com
+          trust_bundle:
+            filename: ")EOF",
+                         ca, "\"\n");
+  HandshakeFixture fixture(serverYaml(certificateYaml("test_data/spiffe_san_cert.pem",
+                                                      "test_data/spiffe_san_key.pem")),
+                           clientYaml(KeyType::Rsa, validation));
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    fixture.handshake(nullptr, false);
+  }
+  reportRate(state);
+}
+BENCHMARK(BM_ValidatedHandshake)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Full handshakes against a server context holding both an RSA and an ECDSA certificate, so that
+// the certificate has to be selected from the ClientHello. range(0) selects the key type the
+// client supports.
+static void BM_CertificateSelectionHandshake(benchmark::State& state) {
+  initializeRunfiles();
+  const KeyType key_type = static_cast<KeyType>(state.range(0));
+  HandshakeFixture fixture(serverYaml(certificatesFor(KeyType::Rsa) +
+                                      certificatesFor(KeyType::Ecdsa)),
+                           clientYaml(key_type));
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    fixture.handshake(nullptr, false);
+  }
+  reportRate(state);
+}
+BENCHMARK(BM_CertificateSelectionHandshake)
+    ->Arg(static_cast<int>(KeyType::Rsa))
+    ->Arg(static_cast<int>(KeyType::Ecdsa))
+    ->Unit(benchmark::kMicrosecond);
+
+// Full handshakes against a server context holding range(0) certificates for different server
+// names, the client requesting the name of the last one. This tracks the cost of selecting the
+// certificate by SNI as the number of certificates served by a single context grows.
+static void BM_SniCertificateSelectionHandshake(benchmark::State& state) {
+  initializeRunfiles();
+  const int64_t certificate_count = state.range(0);
+  std::string certificates;
+  for (int64_t i = 0; i < certificate_count; i++) {
+    certificates += generateCertificate(absl::StrCat("server", i, ".example.com"));
+  }
+  HandshakeFixture fixture(
+      serverYaml(certificates),
+      clientYaml(KeyType::Ecdsa, "", absl::StrCat("server", certificate_count - 1, ".example.com")));
+
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    fixture.handshake(nullptr, false);
+  }
+  reportRate(state);
+}
+BENCHMARK(BM_SniCertificateSelectionHandshake)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace Extensions::TransportSockets::Tls
+} // namespace Envoy
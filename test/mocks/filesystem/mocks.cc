@@ -33,6 +33,18 @@ Api::IoCallSizeResult MockFile::write(absl::string_view buffer) {
   return result;
 }
 
+Api::IoCallSizeResult MockFile::writev(absl::Span<const absl::string_view> buffers) {
+  ssize_t written = 0;
+  for (const absl::string_view buffer : buffers) {
+    Api::IoCallSizeResult result = write(buffer);
+    if (result.return_value_ == -1) {
+      return result;
+    }
+    written += result.return_value_;
+  }
+  return {written, Api::IoErrorPtr(nullptr, [](Api::IoError*) { PANIC("unimplemented"); })};
+}
+
 Api::IoCallBoolResult MockFile::close() {
   Api::IoCallBoolResult result = close_();
   is_open_ = !result.return_value_;
@@ -21,6 +21,8 @@ public:
   // Filesystem::File
   Api::IoCallBoolResult open(FlagSet flag) override;
   Api::IoCallSizeResult write(absl::string_view buffer) override;
+  // Writes the buffers one by one through write().
+  Api::IoCallSizeResult writev(absl::Span<const absl::string_view> buffers) override;
   Api::IoCallBoolResult close() override;
   bool isOpen() const override { return is_open_; };
   MOCK_METHOD(std::string, path, (), (const));
@@ -44,6 +44,11 @@ void MockRetryState::expectHedgedPerTryTimeoutRetry() {
       .WillOnce(DoAll(SaveArg<0>(&callback_), Return(RetryStatus::Yes)));
 }
 
+void MockRetryState::expectHedgedLatencyRetry() {
+  EXPECT_CALL(*this, shouldHedgeRetryLatency(_))
+      .WillOnce(DoAll(SaveArg<0>(&callback_), Return(RetryStatus::Yes)));
+}
+
 void MockRetryState::expectResetRetry() {
   EXPECT_CALL(*this, shouldRetryReset(_, _, _))
       .WillOnce(Invoke([this](const Http::StreamResetReason, RetryState::Http3Used,
@@ -68,6 +73,9 @@ MockRateLimitPolicy::MockRateLimitPolicy() {
 
 MockRateLimitPolicy::~MockRateLimitPolicy() = default;
 
+MockShadowStream::MockShadowStream() = default;
+MockShadowStream::~MockShadowStream() = default;
+
 MockShadowWriter::MockShadowWriter() = default;
 MockShadowWriter::~MockShadowWriter() = default;
 
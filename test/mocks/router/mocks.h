@@ -93,10 +93,14 @@ public:
     return additional_request_chance_;
   }
   bool hedgeOnPerTryTimeout() const override { return hedge_on_per_try_timeout_; }
+  const absl::optional<LatencyHedgingConfig>& latencyHedging() const override {
+    return latency_hedging_;
+  }
 
   uint32_t initial_requests_{};
   envoy::type::v3::FractionalPercent additional_request_chance_{};
   bool hedge_on_per_try_timeout_{};
+  absl::optional<LatencyHedgingConfig> latency_hedging_;
 };
 
 class TestRetryPolicy : public RetryPolicy {
@@ -171,6 +175,7 @@ public:
 
   void expectHeadersRetry();
   void expectHedgedPerTryTimeoutRetry();
+  void expectHedgedLatencyRetry();
   void expectResetRetry();
 
   MOCK_METHOD(bool, enabled, ());
@@ -186,6 +191,7 @@ public:
               (const Http::StreamResetReason reset_reason, Http3Used alternate_protocol_used,
                DoRetryResetCallback callback));
   MOCK_METHOD(RetryStatus, shouldHedgeRetryPerTryTimeout, (DoRetryCallback callback));
+  MOCK_METHOD(RetryStatus, shouldHedgeRetryLatency, (DoRetryCallback callback));
   MOCK_METHOD(void, onHostAttempted, (Upstream::HostDescriptionConstSharedPtr));
   MOCK_METHOD(bool, shouldSelectAnotherHost, (const Upstream::Host& host));
   MOCK_METHOD(const Upstream::HealthyAndDegradedLoad&, priorityLoadForRetry,
@@ -233,6 +239,16 @@ public:
   std::vector<std::reference_wrapper<const Router::RateLimitPolicyEntry>> rate_limit_policy_entry_;
 };
 
+class MockShadowStream : public ShadowStream {
+public:
+  MockShadowStream();
+  ~MockShadowStream() override;
+
+  // Router::ShadowStream
+  MOCK_METHOD(void, sendData, (Buffer::Instance & data, bool end_stream));
+  MOCK_METHOD(void, sendTrailers, (const Http::RequestTrailerMap& trailers));
+};
+
 class MockShadowWriter : public ShadowWriter {
 public:
   MockShadowWriter();
@@ -243,10 +259,17 @@ public:
               const Http::AsyncClient::RequestOptions& options) override {
     shadow_(cluster, request, options);
   }
+  ShadowStreamPtr streamingShadow(const std::string& cluster, Http::RequestHeaderMapPtr&& headers,
+                                  const Http::AsyncClient::StreamOptions& options) override {
+    return ShadowStreamPtr{streamingShadow_(cluster, headers, options)};
+  }
 
   MOCK_METHOD(void, shadow_,
               (const std::string& cluster, Http::RequestMessagePtr& request,
                const Http::AsyncClient::RequestOptions& options));
+  MOCK_METHOD(ShadowStream*, streamingShadow_,
+              (const std::string& cluster, Http::RequestHeaderMapPtr& headers,
+               const Http::AsyncClient::StreamOptions& options));
 };
 
 class TestVirtualCluster : public VirtualCluster {
@@ -98,6 +98,7 @@ public:
               (const));
   MOCK_METHOD(float, perUpstreamPreconnectRatio, (), (const));
   MOCK_METHOD(float, peekaheadRatio, (), (const));
+  MOCK_METHOD(const absl::optional<AdaptivePreconnectConfig>&, adaptivePreconnect, (), (const));
   MOCK_METHOD(uint32_t, perConnectionBufferLimitBytes, (), (const));
   MOCK_METHOD(uint64_t, features, (), (const));
   MOCK_METHOD(const Http::Http1Settings&, http1Settings, (), (const));
@@ -147,6 +148,8 @@ public:
               (const));
   MOCK_METHOD(bool, drainConnectionsOnHostRemoval, (), (const));
   MOCK_METHOD(bool, connectionPoolPerDownstreamConnection, (), (const));
+  MOCK_METHOD(absl::optional<uint32_t>, sharedHttp2PoolOwnerWorkers, (), (const));
+  MOCK_METHOD(ResponseLatencyTracker&, responseLatencyTracker, (), (const));
   MOCK_METHOD(bool, warmHosts, (), (const));
   MOCK_METHOD(bool, setLocalInterfaceNameOnUpstreamConnections, (), (const));
   MOCK_METHOD(const absl::optional<envoy::config::core::v3::UpstreamHttpProtocolOptions>&,
@@ -209,6 +212,8 @@ public:
   envoy::config::core::v3::Metadata metadata_;
   std::unique_ptr<Envoy::Config::TypedMetadata> typed_metadata_;
   absl::optional<std::chrono::milliseconds> max_stream_duration_;
+  absl::optional<AdaptivePreconnectConfig> adaptive_preconnect_;
+  mutable ResponseLatencyTrackerImpl response_latency_tracker_;
   Stats::ScopeSharedPtr stats_scope_;
   mutable Http::Http1::CodecStats::AtomicPtr http1_codec_stats_;
   mutable Http::Http2::CodecStats::AtomicPtr http2_codec_stats_;
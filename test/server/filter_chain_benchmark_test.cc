@@ -7,6 +7,7 @@
 #include "envoy/network/listen_socket.h"
 #include "envoy/protobuf/message_validator.h"
 
+#include "source/common/memory/stats.h"
 #include "source/common/network/socket_impl.h"
 #include "source/server/filter_chain_manager_impl.h"
 
@@ -189,6 +190,22 @@ const char YamlSingleDstPortBottom[] = R"EOF(
           session_ticket_keys:
             keys:
             - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a")EOF";
+const char YamlSingleServerNameTop[] = R"EOF(
+    - filter_chain_match:
+        transport_protocol: "tls"
+        server_names: )EOF";
+const char YamlSingleServerNameBottom[] = R"EOF(
+      transport_socket:
+        name: "envoy.transport_sockets.tls"
+        typed_config:
+          "@type": "type.googleapis.com/envoy.extensions.transport_sockets.tls.v3.DownstreamTlsContext"
+          common_tls_context:
+            tls_certificates:
+              - certificate_chain: { filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem" }
+                private_key: { filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem" }
+          session_ticket_keys:
+            keys:
+            - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a")EOF";
 } // namespace
 
 class FilterChainBenchmarkFixture : public ::benchmark::Fixture {
@@ -207,6 +224,32 @@ public:
     filter_chains_ = listener_config_.filter_chains();
   }
 
+  // Every other chain matches a wildcard server name, e.g. "*.tenant1.example.com".
+  void initializeServerNames(::benchmark::State& state) {
+    int64_t input_size = state.range(0);
+    std::vector<std::string> server_name_chains;
+    server_name_chains.reserve(input_size);
+    for (int i = 0; i < input_size; i++) {
+      server_name_chains.push_back(absl::StrCat(YamlSingleServerNameTop, "\"", serverName(i),
+                                                "\"", YamlSingleServerNameBottom));
+    }
+    listener_yaml_config_ = TestEnvironment::substitute(
+        absl::StrCat(YamlHeader, absl::StrJoin(server_name_chains, "")),
+        Network::Address::IpVersion::v4);
+    TestUtility::loadFromYaml(listener_yaml_config_, listener_config_);
+    filter_chains_ = listener_config_.filter_chains();
+  }
+
+  static std::string serverName(int i) {
+    return i % 2 == 0 ? absl::StrCat("server", i, ".example.com")
+                      : absl::StrCat("*.tenant", i, ".example.com");
+  }
+
+  // The name requested by a client for the chain generated by serverName(i).
+  static std::string requestedServerName(int i) {
+    return i % 2 == 0 ? serverName(i) : absl::StrCat("www.tenant", i, ".example.com");
+  }
+
   Envoy::Thread::MutexBasicLockable lock_;
   Logger::Context logging_state_{spdlog::level::warn, Logger::Logger::DEFAULT_LOG_FORMAT, lock_,
                                  false};
@@ -264,6 +307,93 @@ BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindTest)
     }
   }
 }
+// NOLINTNEXTLINE(readability-redundant-member-init)
+BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainManagerServerNamesBuildTest)
+(::benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  initializeServerNames(state);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
+    FilterChainManagerImpl filter_chain_manager{
+        std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+        init_manager_};
+    filter_chain_manager.addFilterChains(nullptr, filter_chains_, nullptr, dummy_builder_,
+                                         filter_chain_manager);
+    state.PauseTiming();
+    const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
+    state.counters["memory"] = end_mem - start_mem;
+    state.counters["memory_per_chain"] = (end_mem - start_mem) / state.range(0);
+    state.ResumeTiming();
+  }
+}
+
+// Simulates a LDS update which modifies a single filter chain: all the other filter chains are
+// reused from the previous generation and only the matching index is rebuilt.
+// NOLINTNEXTLINE(readability-redundant-member-init)
+BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainManagerServerNamesUpdateTest)
+(::benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  initializeServerNames(state);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  FilterChainManagerImpl origin_filter_chain_manager{
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+      init_manager_};
+  origin_filter_chain_manager.addFilterChains(nullptr, filter_chains_, nullptr, dummy_builder_,
+                                              origin_filter_chain_manager);
+
+  envoy::config::listener::v3::Listener updated_listener_config = listener_config_;
+  updated_listener_config.mutable_filter_chains(0)->set_name("updated");
+  const absl::Span<const envoy::config::listener::v3::FilterChain* const> updated_filter_chains =
+      updated_listener_config.filter_chains();
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    FilterChainManagerImpl filter_chain_manager{
+        std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+        init_manager_, origin_filter_chain_manager};
+    filter_chain_manager.addFilterChains(nullptr, updated_filter_chains, nullptr, dummy_builder_,
+                                         filter_chain_manager);
+  }
+}
+
+BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainServerNamesFindTest)
+(::benchmark::State& state) {
+  if (benchmark::skipExpensiveBenchmarks() && state.range(0) > 64) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  initializeServerNames(state);
+  std::vector<MockConnectionSocket> sockets;
+  sockets.reserve(state.range(0));
+  for (int i = 0; i < state.range(0); i++) {
+    sockets.push_back(std::move(*MockConnectionSocket::createMockConnectionSocket(
+        1234, "127.0.0.1", requestedServerName(i), "", "tls", {}, "8.8.8.8", 111)));
+  }
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  FilterChainManagerImpl filter_chain_manager{
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+      init_manager_};
+
+  filter_chain_manager.addFilterChains(nullptr, filter_chains_, nullptr, dummy_builder_,
+                                       filter_chain_manager);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    for (int i = 0; i < state.range(0); i++) {
+      filter_chain_manager.findFilterChain(sockets[i]);
+    }
+  }
+}
+
 BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerBuildTest)
     ->Ranges({
         // scale of the chains
@@ -276,6 +406,24 @@ BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindTest)
         {1, 4096},
     })
     ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerServerNamesBuildTest)
+    ->Ranges({
+        // scale of the chains
+        {1, 65536},
+    })
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerServerNamesUpdateTest)
+    ->Ranges({
+        // scale of the chains
+        {1, 65536},
+    })
+    ->Unit(::benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainServerNamesFindTest)
+    ->Ranges({
+        // scale of the chains
+        {1, 65536},
+    })
+    ->Unit(::benchmark::kMillisecond);
 
 /*
 clang-format off
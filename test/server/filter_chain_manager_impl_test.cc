@@ -254,6 +254,52 @@ TEST_P(FilterChainManagerImplTest, DuplicateContextsAreNotBuilt) {
       nullptr, filter_chain_factory_builder_, new_filter_chain_manager);
 }
 
+// Server name only filter chains skip the source matching, while filter chains restricting the
+// source on the same server name still use it.
+TEST_P(FilterChainManagerImplTest, ServerNameFilterChainsWithAndWithoutSourceMatching) {
+  std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages;
+  std::vector<std::shared_ptr<Network::MockFilterChain>> filter_chains;
+  for (int i = 0; i < 4; i++) {
+    envoy::config::listener::v3::FilterChain new_filter_chain = filter_chain_template_;
+    new_filter_chain.set_name(absl::StrCat("filter_chain_", i));
+    filter_chain_messages.push_back(std::move(new_filter_chain));
+    filter_chains.push_back(std::make_shared<Network::MockFilterChain>());
+  }
+  filter_chain_messages[0].mutable_filter_chain_match()->add_server_names("foo.example.com");
+  filter_chain_messages[1].mutable_filter_chain_match()->add_server_names("*.example.com");
+  filter_chain_messages[2].mutable_filter_chain_match()->add_server_names("bar.example.com");
+  filter_chain_messages[3].mutable_filter_chain_match()->add_server_names("bar.example.com");
+  auto* source_prefix_range =
+      filter_chain_messages[3].mutable_filter_chain_match()->add_source_prefix_ranges();
+  source_prefix_range->set_address_prefix("10.0.0.0");
+  source_prefix_range->mutable_prefix_len()->set_value(8);
+
+  for (int i = 0; i < 4; i++) {
+    EXPECT_CALL(filter_chain_factory_builder_, buildFilterChain(_, _))
+        .WillOnce(Return(filter_chains[i]))
+        .RetiresOnSaturation();
+  }
+  filter_chain_manager_.addFilterChains(
+      nullptr,
+      std::vector<const envoy::config::listener::v3::FilterChain*>{
+          &filter_chain_messages[3], &filter_chain_messages[2], &filter_chain_messages[1],
+          &filter_chain_messages[0]},
+      nullptr, filter_chain_factory_builder_, filter_chain_manager_);
+
+  EXPECT_EQ(filter_chains[0].get(),
+            findFilterChainHelper(10000, "127.0.0.1", "foo.example.com", "tls", {}, "8.8.8.8", 111));
+  EXPECT_EQ(filter_chains[1].get(),
+            findFilterChainHelper(10000, "127.0.0.1", "baz.example.com", "tls", {}, "8.8.8.8", 111));
+  EXPECT_EQ(filter_chains[2].get(),
+            findFilterChainHelper(10000, "127.0.0.1", "bar.example.com", "tls", {}, "8.8.8.8", 111));
+  EXPECT_EQ(filter_chains[3].get(), findFilterChainHelper(10000, "127.0.0.1", "bar.example.com",
+                                                          "tls", {}, "10.1.2.3", 111));
+  EXPECT_EQ(filter_chains[0].get(),
+            findFilterChainHelper(10000, "127.0.0.1", "foo.example.com", "tls", {}, "/pipe", 0));
+  EXPECT_EQ(nullptr,
+            findFilterChainHelper(10000, "127.0.0.1", "example.com", "tls", {}, "8.8.8.8", 111));
+}
+
 TEST_P(FilterChainManagerImplTest, CreatedFilterChainFactoryContextHasIndependentDrainClose) {
   std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages;
   for (int i = 0; i < 3; i++) {